@@ -564,13 +564,12 @@ static void eth_rx(struct gmac_queue *queue)
 	}
 }
 
-static int eth_tx(struct net_if *iface, struct net_buf *buf)
+/*
+ * Fill in the TX descriptors of a frame, the transmission is started by the
+ * caller.
+ */
+static void frame_queue(struct gmac_queue *queue, struct net_buf *buf)
 {
-	struct device *const dev = net_if_get_device(iface);
-	const struct eth_sam_dev_cfg *const cfg = DEV_CFG(dev);
-	struct eth_sam_dev_data *const dev_data = DEV_DATA(dev);
-	Gmac *gmac = cfg->regs;
-	struct gmac_queue *queue = &dev_data->queue_list[0];
 	struct gmac_desc_list *tx_desc_list = &queue->tx_desc_list;
 	struct gmac_desc *tx_desc;
 	struct net_buf *frag;
@@ -580,8 +579,6 @@ static int eth_tx(struct net_if *iface, struct net_buf *buf)
 	__ASSERT(buf, "buf pointer is NULL");
 	__ASSERT(buf->frags, "Frame data missing");
 
-	SYS_LOG_DBG("ETH tx");
-
 	/* First fragment is special - it contains link layer (Ethernet
 	 * in our case) header.
 	 */
@@ -638,6 +635,18 @@ static int eth_tx(struct net_if *iface, struct net_buf *buf)
 
 	/* Account for a sent frame */
 	ring_buf_put(&queue->tx_frames, POINTER_TO_UINT(buf));
+}
+
+static int eth_tx(struct net_if *iface, struct net_buf *buf)
+{
+	struct device *const dev = net_if_get_device(iface);
+	const struct eth_sam_dev_cfg *const cfg = DEV_CFG(dev);
+	struct eth_sam_dev_data *const dev_data = DEV_DATA(dev);
+	Gmac *gmac = cfg->regs;
+
+	SYS_LOG_DBG("ETH tx");
+
+	frame_queue(&dev_data->queue_list[0], buf);
 
 	/* Start transmission */
 	gmac->GMAC_NCR |= GMAC_NCR_TSTART;
@@ -645,6 +654,26 @@ static int eth_tx(struct net_if *iface, struct net_buf *buf)
 	return 0;
 }
 
+static int eth_tx_batch(struct net_if *iface, struct net_buf **bufs,
+			int count)
+{
+	struct device *const dev = net_if_get_device(iface);
+	const struct eth_sam_dev_cfg *const cfg = DEV_CFG(dev);
+	struct eth_sam_dev_data *const dev_data = DEV_DATA(dev);
+	Gmac *gmac = cfg->regs;
+
+	SYS_LOG_DBG("ETH tx %d frames", count);
+
+	for (int i = 0; i < count; i++) {
+		frame_queue(&dev_data->queue_list[0], bufs[i]);
+	}
+
+	/* Start transmission of all the frames at once */
+	gmac->GMAC_NCR |= GMAC_NCR_TSTART;
+
+	return count;
+}
+
 static void queue0_isr(void *arg)
 {
 	struct device *const dev = (struct device *const)arg;
@@ -756,8 +785,9 @@ static void eth0_iface_init(struct net_if *iface)
 }
 
 static struct net_if_api eth0_api = {
-	.init	= eth0_iface_init,
-	.send	= eth_tx,
+	.init		= eth0_iface_init,
+	.send		= eth_tx,
+	.send_batch	= eth_tx_batch,
 };
 
 static struct device DEVICE_NAME_GET(eth0_sam_gmac);
@@ -39,6 +39,12 @@
  * it expires on the next tick, and announces the number of elapsed ticks (if
  * any) to the kernel.
  *
+ * When configured as a tickless kernel timer0 is programmed in one-shot mode
+ * at all times, to expire at the next kernel deadline requested through
+ * _timer_expiry_set(). The timer interrupt handler announces all the complete
+ * ticks that have elapsed since the previous announcement, and the kernel
+ * then reprograms the timer for its following deadline.
+ *
  */
 
 #include <kernel.h>
@@ -264,6 +270,18 @@ void _timer_int_handler(void *unused)
 		}
 	}
 
+#ifdef CONFIG_TICKLESS_KERNEL
+	/*
+	 * announce all complete ticks since the previous announcement; the
+	 * kernel reprograms the timer for its next deadline
+	 */
+
+	_sys_idle_elapsed_ticks = _timer_elapsed_ticks_get();
+	counter_last_value +=
+		(uint64_t)_sys_idle_elapsed_ticks * counter_load_value;
+
+	_sys_clock_tick_announce();
+#else
 	/* configure timer to expire on next tick */
 
 	counter_last_value = *_HPET_TIMER0_COMPARATOR;
@@ -272,10 +290,71 @@ void _timer_int_handler(void *unused)
 	programmed_ticks = 1;
 
 	_sys_clock_final_tick_announce();
+#endif /* CONFIG_TICKLESS_KERNEL */
 #endif /* !CONFIG_TICKLESS_IDLE */
 
 }
 
+#ifdef CONFIG_TICKLESS_KERNEL
+
+/**
+ *
+ * @brief Get the number of ticks not yet announced
+ *
+ * @return number of complete ticks elapsed since the last tick announced to
+ * the kernel
+ */
+
+uint32_t _timer_elapsed_ticks_get(void)
+{
+	return (uint32_t)((_hpetMainCounterAtomic() - counter_last_value) /
+			  counter_load_value);
+}
+
+/**
+ *
+ * @brief Program the timer to expire at the next kernel deadline
+ *
+ * Re-program the timer to expire the given number of ticks after the last
+ * tick announced to the kernel (-1 means infinite number of ticks). A deadline
+ * that has already passed, or that is too close for the comparator to catch,
+ * is moved to the first tick boundary that can still be caught.
+ *
+ * @return N/A
+ *
+ * \INTERNAL IMPLEMENTATION DETAILS
+ * Called while interrupts are locked.
+ */
+
+void _timer_expiry_set(int32_t ticks)
+{
+	uint64_t currTime = _hpetMainCounterAtomic();
+	uint64_t counterNextValue;
+
+	if (ticks == K_FOREVER) {
+		counterNextValue = ~(uint64_t)0;
+	} else {
+		counterNextValue = counter_last_value +
+			(uint64_t)max(ticks, 0) * counter_load_value;
+
+		if (counterNextValue <= currTime + HPET_COMP_DELAY) {
+			/* first tick boundary after the comparator delay */
+			counterNextValue = currTime + HPET_COMP_DELAY -
+					   counter_last_value;
+			counterNextValue = counter_last_value +
+				(counterNextValue / counter_load_value + 1) *
+				counter_load_value;
+		}
+	}
+
+	*_HPET_TIMER0_CONFIG_CAPS |= HPET_Tn_VAL_SET_CNF;
+	*_HPET_TIMER0_COMPARATOR = counterNextValue;
+	stale_irq_check = 1;
+	programmed_ticks = ticks;
+}
+
+#endif /* CONFIG_TICKLESS_KERNEL */
+
 #ifdef CONFIG_TICKLESS_IDLE
 
 /*
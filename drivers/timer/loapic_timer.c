@@ -28,6 +28,13 @@
  * another interrupt is detected, the kernel's interrupt stub invokes
  * _timer_idle_exit() to leave the tickless idle state.
  *
+ * If the TICKLESS_KERNEL kernel configuration option is enabled, the timer
+ * always operates in one-shot mode. The kernel invokes _timer_expiry_set() to
+ * program the down counter for its next deadline; cycles that elapsed since
+ * the last tick announcement are carried over each time the counter is
+ * reprogrammed, and the timer interrupt handler announces all the complete
+ * ticks that elapsed.
+ *
  * @internal
  * Factors that increase the driver's complexity:
  *
@@ -139,6 +146,11 @@ static bool timer_known_to_have_expired;
 static unsigned char timer_mode = TIMER_MODE_PERIODIC;
 #endif /* CONFIG_TICKLESS_IDLE */
 
+#if defined(CONFIG_TICKLESS_KERNEL)
+/* cycles elapsed since the last announced tick when the timer was programmed */
+static uint32_t cycles_since_tick;
+#endif /* CONFIG_TICKLESS_KERNEL */
+
 #ifdef CONFIG_DEVICE_POWER_MANAGEMENT
 static uint32_t loapic_timer_device_power_state;
 static uint32_t reg_timer_save;
@@ -238,12 +250,78 @@ static inline uint32_t initial_count_register_get(void)
 }
 #endif /* CONFIG_TICKLESS_IDLE */
 
+#if defined(CONFIG_TICKLESS_KERNEL)
+/**
+ *
+ * @brief Get the number of cycles elapsed since the last announced tick
+ *
+ * NOTE: Although the cycle count is supposed to stop decrementing once it
+ * hits zero in one-shot mode, not all targets implement this properly (and
+ * continue to decrement).  Thus a second comparison is required to check for
+ * wrap-around.
+ *
+ * @return number of cycles
+ */
+static uint32_t elapsed_cycles_get(void)
+{
+	uint32_t count = current_count_register_get();
+
+	if ((count == 0) || (count > programmed_cycles)) {
+		return cycles_since_tick + programmed_cycles;
+	}
+
+	return cycles_since_tick + (programmed_cycles - count);
+}
+
+/**
+ *
+ * @brief Restart the timer to expire at the given cycle count
+ *
+ * The counter restarts from its new value when the initial count register is
+ * written, so the elapsed cycles are read right before writing it and carried
+ * into 'cycles_since_tick'. Only the few cycles of the write itself are not
+ * accounted for.
+ *
+ * @param target cycles since the last announced tick the timer expires at
+ * @return N/A
+ */
+static void expiry_cycles_set(uint32_t target)
+{
+	uint32_t elapsed = elapsed_cycles_get();
+
+	if (target <= elapsed) {
+		/* the count is never zero, which would stop the timer */
+		target = elapsed + 1;
+	}
+
+	cycles_since_tick = elapsed;
+	programmed_cycles = target - elapsed;
+	initial_count_register_set(programmed_cycles);
+}
+#endif /* CONFIG_TICKLESS_KERNEL */
+
 void _timer_int_handler(void *unused /* parameter is not used */
 				 )
 {
 	ARG_UNUSED(unused);
 
-#ifdef CONFIG_TICKLESS_IDLE
+#if defined(CONFIG_TICKLESS_KERNEL)
+	uint32_t cycles = elapsed_cycles_get();
+
+	/*
+	 * Announce all complete ticks and keep the remaining cycles for the
+	 * next announcement. The counter is restarted right away so that the
+	 * time spent handling the expired timeouts, until the kernel
+	 * reprograms it for its next deadline, is accounted for.
+	 */
+
+	_sys_idle_elapsed_ticks = cycles / cycles_per_tick;
+	cycles_since_tick = cycles % cycles_per_tick;
+	programmed_cycles = 0;
+	expiry_cycles_set(cycles_per_max_ticks);
+
+	_sys_clock_tick_announce();
+#elif defined(CONFIG_TICKLESS_IDLE)
 	if (timer_mode == TIMER_MODE_ONE_SHOT) {
 		if (!timer_known_to_have_expired) {
 			uint32_t  cycles;
@@ -458,6 +536,61 @@ void _timer_idle_exit(void)
 }
 #endif /* CONFIG_TICKLESS_IDLE */
 
+#if defined(CONFIG_TICKLESS_KERNEL)
+/**
+ *
+ * @brief Get the number of ticks not yet announced
+ *
+ * @return number of complete ticks elapsed since the last tick announced to
+ * the kernel
+ */
+uint32_t _timer_elapsed_ticks_get(void)
+{
+	return elapsed_cycles_get() / cycles_per_tick;
+}
+
+/**
+ *
+ * @brief Program the timer to expire at the next kernel deadline
+ *
+ * Re-program the timer in one shot mode to fire the given number of ticks
+ * after the last tick announced to the kernel, or after the maximum number of
+ * ticks that can be programmed into hardware. A value of -1 means inifinite
+ * number of ticks. A deadline that has already passed is moved to the end of
+ * the current tick.
+ *
+ * The kernel asks for the same deadline on most context switches, the timer
+ * is then left running: each reprogramming loses the few cycles it takes to
+ * reload the counter.
+ *
+ * Called while interrupts are locked.
+ *
+ * @return N/A
+ */
+void _timer_expiry_set(int32_t ticks)
+{
+	uint32_t elapsed = elapsed_cycles_get();
+	uint32_t target;
+
+	if ((ticks == K_FOREVER) || (ticks > max_system_ticks)) {
+		target = cycles_per_max_ticks;
+	} else {
+		target = max(ticks, 0) * cycles_per_tick;
+	}
+
+	if (target <= elapsed) {
+		target = (elapsed / cycles_per_tick + 1) * cycles_per_tick;
+	}
+
+	if ((target == cycles_since_tick + programmed_cycles) &&
+	    (current_count_register_get() != 0)) {
+		return;
+	}
+
+	expiry_cycles_set(target);
+}
+#endif /* CONFIG_TICKLESS_KERNEL */
+
 /**
  *
  * @brief Initialize and enable the system clock
@@ -481,8 +614,14 @@ int _sys_clock_driver_init(struct device *device)
 #ifndef CONFIG_MVIC
 	divide_configuration_register_set();
 #endif
+#if defined(CONFIG_TICKLESS_KERNEL)
+	programmed_cycles = cycles_per_tick;
+	initial_count_register_set(programmed_cycles);
+	one_shot_mode_set();
+#else
 	initial_count_register_set(cycles_per_tick - 1);
 	periodic_mode_set();
+#endif
 #ifdef CONFIG_DEVICE_POWER_MANAGEMENT
 	loapic_timer_device_power_state = DEVICE_PM_ACTIVE_STATE;
 #endif
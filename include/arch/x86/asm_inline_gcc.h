@@ -474,6 +474,45 @@ static ALWAYS_INLINE
 	return ret;
 }
 
+/**
+ *
+ * @brief Ones' complement sum of 32-bit words
+ *
+ * Adds the words with carry, so the carries are folded back into the sum
+ * as they happen instead of being accumulated in a wider register. The
+ * final carry is added twice, so the sum has no carry left over whatever
+ * the result of the first end-around add.
+ *
+ * @param words 32-bit aligned words to sum
+ * @param count number of words
+ *
+ * @return sum of the words, with the end-around carries added
+ */
+
+static ALWAYS_INLINE
+	uint32_t _arch_net_chksum_words(const uint32_t *words, size_t count)
+{
+	uint32_t sum = 0;
+
+	if (!count) {
+		return 0;
+	}
+
+	__asm__ volatile("clc\n\t"
+			 "1:\n\t"
+			 "adcl	(%1), %0\n\t"
+			 "lea	4(%1), %1\n\t"
+			 "dec	%2\n\t"
+			 "jnz	1b\n\t"
+			 "adcl	$0, %0\n\t"
+			 "adcl	$0, %0\n\t"
+			 : "+r" (sum), "+r" (words), "+r" (count)
+			 :
+			 : "memory", "cc");
+
+	return sum;
+}
+
 #define sys_bitfield_set_bit sys_set_bit
 #define sys_bitfield_clear_bit sys_clear_bit
 #define sys_bitfield_test_bit sys_test_bit
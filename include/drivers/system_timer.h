@@ -40,6 +40,11 @@ extern void _timer_idle_enter(int32_t ticks);
 extern void _timer_idle_exit(void);
 #endif /* CONFIG_TICKLESS_IDLE */
 
+#ifdef CONFIG_TICKLESS_KERNEL
+extern void _timer_expiry_set(int32_t ticks);
+extern uint32_t _timer_elapsed_ticks_get(void);
+#endif /* CONFIG_TICKLESS_KERNEL */
+
 extern void _nano_sys_clock_tick_announce(int32_t ticks);
 
 extern int sys_clock_device_ctrl(struct device *device,
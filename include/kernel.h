@@ -634,6 +634,68 @@ extern void k_thread_custom_data_set(void *value);
  */
 extern void *k_thread_custom_data_get(void);
 
+#ifdef CONFIG_THREAD_STATS
+/**
+ * @brief Thread runtime statistics.
+ *
+ * Execution and ready times are measured in hardware clock cycles, as
+ * returned by k_cycle_get_32().
+ */
+struct k_thread_stats {
+	/** Cycles spent running. */
+	uint64_t execution_cycles;
+	/** Cycles spent ready to run, but not running. */
+	uint64_t ready_cycles;
+	/** Number of times the thread was switched in. */
+	uint32_t switches_in;
+	/** Number of times the thread was switched out. */
+	uint32_t switches_out;
+	/** Size of the stack area usable by the thread, in bytes. */
+	size_t stack_size;
+	/** Highest stack usage, in bytes (0 without CONFIG_INIT_STACKS). */
+	size_t stack_used;
+};
+
+/**
+ * @brief Get a thread's runtime statistics.
+ *
+ * This routine takes a snapshot of the runtime statistics of @a thread. The
+ * counters are updated each time a thread is switched in or out, and when it
+ * becomes ready to run or stops being ready.
+ *
+ * @param thread ID of thread to get the statistics of.
+ * @param stats Address of the statistics to fill.
+ *
+ * @return N/A
+ */
+extern void k_thread_stats_get(k_tid_t thread, struct k_thread_stats *stats);
+#endif /* CONFIG_THREAD_STATS */
+
+#ifdef CONFIG_THREAD_MONITOR
+/**
+ * @typedef k_thread_user_cb_t
+ * @brief Thread iteration callback.
+ *
+ * @param thread ID of the thread.
+ * @param user_data Data passed to k_thread_foreach().
+ */
+typedef void (*k_thread_user_cb_t)(k_tid_t thread, void *user_data);
+
+/**
+ * @brief Iterate over all the threads in the system.
+ *
+ * This routine invokes @a user_cb for each thread known to the thread
+ * monitor. The scheduler is locked during the iteration, so the callback
+ * must not block.
+ *
+ * @param user_cb Function to call for each thread.
+ * @param user_data Data to pass to @a user_cb.
+ *
+ * @return N/A
+ */
+extern void k_thread_foreach(k_thread_user_cb_t user_cb, void *user_data);
+#endif /* CONFIG_THREAD_MONITOR */
+
 /**
  * @} end addtogroup thread_apis
  */
@@ -2499,6 +2561,8 @@ struct k_pipe {
 	size_t         bytes_used;      /* # bytes used in buffer */
 	size_t         read_index;      /* Where in buffer to read from */
 	size_t         write_index;     /* Where in buffer to write */
+	size_t         put_claim;       /* # bytes claimed by a writer */
+	size_t         get_claim;       /* # bytes claimed by a reader */
 
 	struct {
 		_wait_q_t      readers; /* Reader wait queue */
@@ -2515,6 +2579,8 @@ struct k_pipe {
 	.bytes_used = 0,                                              \
 	.read_index = 0,                                              \
 	.write_index = 0,                                             \
+	.put_claim = 0,                                               \
+	.get_claim = 0,                                               \
 	.wait_q.writers = SYS_DLIST_STATIC_INIT(&obj.wait_q.writers), \
 	.wait_q.readers = SYS_DLIST_STATIC_INIT(&obj.wait_q.readers), \
 	_OBJECT_TRACING_INIT                            \
@@ -2628,6 +2694,97 @@ extern int k_pipe_get(struct k_pipe *pipe, void *data,
 extern void k_pipe_block_put(struct k_pipe *pipe, struct k_mem_block *block,
 			     size_t size, struct k_sem *sem);
 
+/**
+ * @brief Claim free space in a pipe's buffer.
+ *
+ * This routine gives the caller direct access to the free space of the
+ * pipe's buffer, so that data can be written to the pipe without being
+ * copied. The claimed region starts at the pipe's write position and is
+ * contiguous; it therefore never wraps around the end of the buffer. A
+ * writer that needs more space commits the data it has written, then
+ * claims again to get the region at the start of the buffer.
+ *
+ * The data becomes available to readers only once it has been committed
+ * by k_pipe_put_commit(). Only one claim per direction may be outstanding;
+ * threads writing with k_pipe_put() while a claim is held wait for it to be
+ * committed, so that their data does not overtake the claimed region.
+ *
+ * @param pipe Address of the pipe.
+ * @param data Address of area to hold the start of the claimed region.
+ * @param size Address of the maximum number of bytes to claim; on success
+ *             it holds the number of bytes actually claimed.
+ * @param timeout Waiting period to wait for free space (in milliseconds),
+ *                or one of the special values K_NO_WAIT and K_FOREVER.
+ *
+ * @retval 0 At least one byte of free space was claimed.
+ * @retval -EIO Returned without waiting; the pipe's buffer is full.
+ * @retval -EAGAIN Waiting period timed out.
+ * @retval -EBUSY Another claim is outstanding.
+ * @retval -ENOTSUP The pipe has no buffer.
+ */
+extern int k_pipe_put_claim(struct k_pipe *pipe, void **data, size_t *size,
+			    int32_t timeout);
+
+/**
+ * @brief Commit data written to a claimed region of a pipe's buffer.
+ *
+ * This routine makes the first @a size bytes of the region claimed by
+ * k_pipe_put_claim() available to readers, and releases the claim. The
+ * rest of the claimed region is returned to the pipe's free space.
+ *
+ * @param pipe Address of the pipe.
+ * @param size Number of bytes written, which may be less than claimed.
+ *
+ * @retval 0 Data committed.
+ * @retval -EINVAL No claim is outstanding, or @a size exceeds the claim.
+ */
+extern int k_pipe_put_commit(struct k_pipe *pipe, size_t size);
+
+/**
+ * @brief Claim data in a pipe's buffer.
+ *
+ * This routine gives the caller direct access to the data held in the
+ * pipe's buffer, so that it can be read without being copied. The claimed
+ * region starts at the pipe's read position and is contiguous; it
+ * therefore never wraps around the end of the buffer. A reader that needs
+ * more data finishes with the data it has processed, then claims again.
+ *
+ * The space is returned to writers only once the data has been released
+ * by k_pipe_get_finish(). Only one claim per direction may be outstanding;
+ * threads reading with k_pipe_get() while a claim is held wait for it to be
+ * released, so that they do not consume the claimed region.
+ *
+ * @param pipe Address of the pipe.
+ * @param data Address of area to hold the start of the claimed region.
+ * @param size Address of the maximum number of bytes to claim; on success
+ *             it holds the number of bytes actually claimed.
+ * @param timeout Waiting period to wait for data (in milliseconds),
+ *                or one of the special values K_NO_WAIT and K_FOREVER.
+ *
+ * @retval 0 At least one byte of data was claimed.
+ * @retval -EIO Returned without waiting; the pipe's buffer is empty.
+ * @retval -EAGAIN Waiting period timed out.
+ * @retval -EBUSY Another claim is outstanding.
+ * @retval -ENOTSUP The pipe has no buffer.
+ */
+extern int k_pipe_get_claim(struct k_pipe *pipe, void **data, size_t *size,
+			    int32_t timeout);
+
+/**
+ * @brief Release data read from a claimed region of a pipe's buffer.
+ *
+ * This routine frees the first @a size bytes of the region claimed by
+ * k_pipe_get_claim(), and releases the claim. The rest of the claimed
+ * region stays in the pipe and is returned by the next read.
+ *
+ * @param pipe Address of the pipe.
+ * @param size Number of bytes consumed, which may be less than claimed.
+ *
+ * @retval 0 Data released.
+ * @retval -EINVAL No claim is outstanding, or @a size exceeds the claim.
+ */
+extern int k_pipe_get_finish(struct k_pipe *pipe, size_t size);
+
 /**
  * @} end defgroup pipe_apis
  */
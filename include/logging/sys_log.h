@@ -30,6 +30,40 @@ extern "C" {
 #define SYS_LOG_LEVEL CONFIG_SYS_LOG_OVERRIDE_LEVEL
 #endif
 
+#if defined(CONFIG_SYS_LOG_DEFERRED)
+#include <stdint.h>
+#include <toolchain.h>
+#include <misc/slist.h>
+
+/**
+ * @brief Per compilation unit log module descriptor.
+ *
+ * @details Used by the deferred backend for runtime level filtering. The
+ * descriptor is registered to the logging subsystem the first time the
+ * module logs something.
+ */
+struct sys_log_module {
+	sys_snode_t node;
+	const char *name;
+	uint8_t level;
+	uint8_t max_level;
+};
+
+/**
+ * @brief Maximum number of 32-bit arguments stored per deferred message.
+ *
+ * @details This includes the domain, level tag, function name and color
+ * arguments added by the logging macros themselves, which leaves 15 for the
+ * message. Logging a message with more arguments fails the build.
+ */
+#define SYS_LOG_DEFERRED_MAX_ARGS 20
+
+__printf_like(4, 6) void sys_log_deferred_put(struct sys_log_module *module,
+					      const char *domain, int level,
+					      const char *fmt, int nargs,
+					      ...);
+#endif /* CONFIG_SYS_LOG_DEFERRED */
+
 /**
  * @brief System Log
  * @defgroup system_log System Log
@@ -96,30 +130,72 @@ void syslog_hook_install(void (*hook)(const char *, ...));
 
 /* [domain] [level] function: */
 #define LOG_LAYOUT "[%s]%s %s: %s"
-#define LOG_BACKEND_CALL(log_lv, log_color, log_format, color_off, ...)	\
+
+#if defined(CONFIG_SYS_LOG_DEFERRED)
+static struct sys_log_module _sys_log_module __unused = {
+	.level = SYS_LOG_LEVEL,
+	.max_level = SYS_LOG_LEVEL,
+};
+
+#define _SYS_LOG_NARGS_(_0, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10,	\
+			_11, _12, _13, _14, _15, _16, _17, _18, _19, _20,\
+			_21, _22, _23, _24, _25, _26, _27, _28, _29, _30,\
+			N, ...) N
+#define _SYS_LOG_NARGS(...)						\
+	_SYS_LOG_NARGS_(_, ##__VA_ARGS__, 30, 29, 28, 27, 26, 25, 24, 23,\
+			22, 21, 20, 19, 18, 17, 16, 15, 14, 13, 12, 11, 10,\
+			9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+
+/* Argument count of a deferred message, the build fails if the message has
+ * more arguments than SYS_LOG_DEFERRED_MAX_ARGS.
+ */
+#define _SYS_LOG_DEFERRED_NARGS(n)					\
+	((n) + 0 * sizeof(char[(n) <= SYS_LOG_DEFERRED_MAX_ARGS ? 1 : -1]))
+
+#define LOG_BACKEND_CALL(log_level, log_lv, log_color, log_format, color_off,\
+			 ...)						\
+	do {								\
+		if ((log_level) <= _sys_log_module.level) {		\
+			sys_log_deferred_put(&_sys_log_module,		\
+				SYS_LOG_DOMAIN, log_level,		\
+				LOG_LAYOUT log_format "%s" SYS_LOG_NL,	\
+				_SYS_LOG_DEFERRED_NARGS(_SYS_LOG_NARGS(	\
+					SYS_LOG_DOMAIN, log_lv,		\
+					__func__, log_color,		\
+					##__VA_ARGS__, color_off)),	\
+				SYS_LOG_DOMAIN, log_lv, __func__,	\
+				log_color, ##__VA_ARGS__, color_off);	\
+		}							\
+	} while (0)
+#else
+#define LOG_BACKEND_CALL(log_level, log_lv, log_color, log_format, color_off,\
+			 ...)						\
 	SYS_LOG_BACKEND_FN(LOG_LAYOUT log_format "%s" SYS_LOG_NL,	\
 	SYS_LOG_DOMAIN, log_lv, __func__, log_color, ##__VA_ARGS__, color_off)
+#endif /* CONFIG_SYS_LOG_DEFERRED */
 
-#define LOG_NO_COLOR(log_lv, log_format, ...)				\
-	LOG_BACKEND_CALL(log_lv, "", log_format, "", ##__VA_ARGS__)
-#define LOG_COLOR(log_lv, log_color, log_format, ...)			\
-	LOG_BACKEND_CALL(log_lv, log_color, log_format,			\
+#define LOG_NO_COLOR(log_level, log_lv, log_format, ...)		\
+	LOG_BACKEND_CALL(log_level, log_lv, "", log_format, "", ##__VA_ARGS__)
+#define LOG_COLOR(log_level, log_lv, log_color, log_format, ...)	\
+	LOG_BACKEND_CALL(log_level, log_lv, log_color, log_format,		\
 	SYS_LOG_COLOR_OFF, ##__VA_ARGS__)
 
-#define SYS_LOG_ERR(...) LOG_COLOR(SYS_LOG_TAG_ERR, SYS_LOG_COLOR_RED,	\
-	##__VA_ARGS__)
+#define SYS_LOG_ERR(...) LOG_COLOR(SYS_LOG_LEVEL_ERROR, SYS_LOG_TAG_ERR,\
+	SYS_LOG_COLOR_RED, ##__VA_ARGS__)
 
 #if (SYS_LOG_LEVEL >= SYS_LOG_LEVEL_WARNING)
-#define SYS_LOG_WRN(...) LOG_COLOR(SYS_LOG_TAG_WRN,			\
-	SYS_LOG_COLOR_YELLOW, ##__VA_ARGS__)
+#define SYS_LOG_WRN(...) LOG_COLOR(SYS_LOG_LEVEL_WARNING,		\
+	SYS_LOG_TAG_WRN, SYS_LOG_COLOR_YELLOW, ##__VA_ARGS__)
 #endif
 
 #if (SYS_LOG_LEVEL >= SYS_LOG_LEVEL_INFO)
-#define SYS_LOG_INF(...) LOG_NO_COLOR(SYS_LOG_TAG_INF, ##__VA_ARGS__)
+#define SYS_LOG_INF(...) LOG_NO_COLOR(SYS_LOG_LEVEL_INFO,		\
+	SYS_LOG_TAG_INF, ##__VA_ARGS__)
 #endif
 
 #if (SYS_LOG_LEVEL == SYS_LOG_LEVEL_DEBUG)
-#define SYS_LOG_DBG(...) LOG_NO_COLOR(SYS_LOG_TAG_DBG, ##__VA_ARGS__)
+#define SYS_LOG_DBG(...) LOG_NO_COLOR(SYS_LOG_LEVEL_DEBUG,		\
+	SYS_LOG_TAG_DBG, ##__VA_ARGS__)
 #endif
 
 #else
@@ -193,6 +269,45 @@ void syslog_hook_install(void (*hook)(const char *, ...));
  */
 #define SYS_LOG_DBG(...) { ; }
 #endif
+
+#if defined(CONFIG_SYS_LOG_DEFERRED)
+/**
+ * @brief Set the runtime log level of a logging domain.
+ *
+ * @details Messages above @a level issued by modules of @a domain are
+ * discarded at the call site, before any argument is stored. A module
+ * level can only be lowered below, or restored up to, the level it was
+ * compiled with. The setting also applies to modules that have not
+ * logged anything yet. The @a domain string is referenced, not copied.
+ *
+ * @param domain Logging domain (see SYS_LOG_DOMAIN), or NULL for all domains.
+ * @param level New log level, SYS_LOG_LEVEL_OFF to SYS_LOG_LEVEL_DEBUG.
+ *
+ * @return 0 on success, -EINVAL if the level is invalid, -ENOMEM if there
+ * is no room left to remember a per domain setting.
+ */
+int sys_log_level_set(const char *domain, int level);
+
+/**
+ * @brief Get the number of messages dropped by the deferred backend.
+ *
+ * @details A message is dropped when the log buffer has no room for it.
+ *
+ * @return Number of messages dropped since boot.
+ */
+uint32_t sys_log_dropped_get(void);
+
+/**
+ * @brief Output all pending deferred log messages.
+ *
+ * @details Formats and outputs the buffered messages in the context of the
+ * caller, e.g. before a reboot or from a fatal error handler.
+ */
+void sys_log_flush(void);
+#else
+static inline void sys_log_flush(void) { }
+#endif /* CONFIG_SYS_LOG_DEFERRED */
+
 /**
  * @}
  */
@@ -100,6 +100,134 @@ int dns_init(struct dns_context *ctx);
  */
 int dns_resolve(struct dns_context *ctx);
 
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+/**
+ * Drops all the entries of the DNS cache
+ */
+void dns_cache_flush(void);
+#endif
+
+#if defined(CONFIG_DNS_RESOLVER_ASYNC)
+struct dns_resolver;
+
+/**
+ * Addresses resolved by an asynchronous query
+ */
+struct dns_addrinfo {
+	/** Name given to dns_resolve_async() */
+	const char *name;
+
+	/** Query type: IPv4 or IPv6 */
+	uint16_t query_type;
+
+	/** Number of addresses stored in 'address' */
+	uint8_t items;
+
+	/** Time left before the addresses expire, in seconds */
+	uint32_t ttl;
+
+	/** An array of IPv4 or IPv6 addresses */
+	union {
+		struct in_addr ipv4[CONFIG_DNS_RESOLVER_MAX_ADDRESSES];
+		struct in6_addr ipv6[CONFIG_DNS_RESOLVER_MAX_ADDRESSES];
+	} address;
+};
+
+/**
+ * Callback executed when an asynchronous query completes
+ *
+ * @details It runs in the context of the caller of dns_resolve_async() when
+ * the answer is found in the cache, in the RX thread when the answer is
+ * received and in the system workqueue when the query times out.
+ *
+ * @param resolver DNS resolver
+ * @param status 0 on success, -ENOENT if the name does not exist or has no
+ *        address of the requested type, -ETIMEDOUT if no answer was
+ *        received, -EIO if the server failed, -EINVAL on malformed answer,
+ *        -ENOMEM if the query for a CNAME could not be sent
+ * @param info Query type and, on success, addresses found
+ * @param user_data User data given to dns_resolve_async()
+ */
+typedef void (*dns_resolve_cb_t)(struct dns_resolver *resolver, int status,
+				 struct dns_addrinfo *info, void *user_data);
+
+/* Outstanding query, for internal use only */
+struct dns_pending_query {
+	struct k_delayed_work timer;
+	struct dns_resolver *resolver;
+	struct net_buf *query;
+	dns_resolve_cb_t cb;
+	void *user_data;
+	const char *name;
+	uint16_t query_type;
+	uint16_t id;
+	uint8_t queries;
+	uint8_t resends;
+	bool unsent;
+	bool stale_timeout;
+};
+
+/**
+ * Asynchronous DNS resolver structure
+ *
+ * @details Queries are matched with their answers by transaction
+ * identifier, so several queries may be outstanding at the same time.
+ */
+struct dns_resolver {
+	/** Previously initialized network context */
+	struct net_context *net_ctx;
+
+	/** IP address and port number of the DNS server. */
+	struct sockaddr *dns_server;
+
+	/** Time to wait for an answer, also used for TX buffers */
+	int32_t timeout;
+
+	/* Outstanding queries, for internal use only */
+	struct k_sem lock;
+	struct dns_pending_query pending[CONFIG_DNS_RESOLVER_MAX_QUERIES];
+};
+
+/**
+ * Asynchronous DNS resolver initialization routine
+ *
+ * @details The net_ctx, dns_server and timeout fields must be set before
+ * calling this routine, it installs the receive callback of net_ctx.
+ *
+ * @param resolver DNS resolver
+ * @retval 0 on success
+ * @retval -EINVAL if a field is not set
+ */
+int dns_resolver_init(struct dns_resolver *resolver);
+
+/**
+ * Resolves a domain name without waiting for the answer
+ *
+ * @details The callback is executed once per query type. With AF_UNSPEC,
+ * the A and AAAA queries are sent at the same time and the callback is
+ * executed twice. Answers found in the cache are reported before this
+ * routine returns, and the others may be as well. If the second query
+ * cannot be sent right away, it is sent again later and its failure is
+ * reported through the callback.
+ *
+ * @param resolver DNS resolver
+ * @param name Domain name to resolve, it must be valid until the callbacks
+ *        are executed
+ * @param family AF_INET for IPv4, AF_INET6 for IPv6 or AF_UNSPEC for both
+ * @param cb Callback executed with the answer
+ * @param user_data User data passed to the callback
+ *
+ * @retval 0 on success
+ * @retval -EINVAL if an invalid parameter was passed
+ * @retval -EAGAIN if too many queries are outstanding
+ * @retval -ENOMEM if there are no buffers available
+ * @retval -EIO on network error
+ */
+int dns_resolve_async(struct dns_resolver *resolver, const char *name,
+		      sa_family_t family, dns_resolve_cb_t cb,
+		      void *user_data);
+#endif
+
 /**
  * @}
  */
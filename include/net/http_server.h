@@ -0,0 +1,269 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _HTTP_SERVER_H_
+#define _HTTP_SERVER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <misc/util.h>
+#include <net/net_context.h>
+#include <net/http_parser.h>
+
+/**
+ * @brief HTTP server library
+ * @defgroup http_server HTTP server library
+ * @{
+ */
+
+/** The route also matches the resources below its URL: a route for
+ * /images matches /images/img.png, but not /images_and_docs.
+ */
+#define HTTP_SERVER_ROUTE_PREFIX	BIT(0)
+
+/** Keep the header fields of the requests to this route, see
+ * CONFIG_HTTP_SERVER_HEADERS_LEN.
+ */
+#define HTTP_SERVER_ROUTE_HEADERS	BIT(1)
+
+struct http_server_conn;
+
+/**
+ * HTTP request being served
+ */
+struct http_server_request {
+	/** Route matched by the request, NULL if none */
+	const struct http_server_route *route;
+
+	/** Path of the request URL */
+	const char *url;
+	/** Query of the request URL, after the '?', NULL if none */
+	const char *query;
+
+	/** Header fields, as received but without the final empty line.
+	 * Only kept for routes with HTTP_SERVER_ROUTE_HEADERS, and
+	 * truncated to CONFIG_HTTP_SERVER_HEADERS_LEN bytes.
+	 */
+	const char *headers;
+
+	/** Length of the path */
+	uint16_t url_len;
+	/** Length of the query */
+	uint16_t query_len;
+	/** Length of the header fields */
+	uint16_t headers_len;
+
+	/** HTTP method, see enum http_method */
+	uint8_t method;
+};
+
+/**
+ * @brief Route handler
+ *
+ * @details Called in the server thread once the request has been received,
+ * the handler answers it with http_server_send() or
+ * http_server_send_static().
+ *
+ * @param conn Connection the request was received on
+ * @param req Request
+ *
+ * @return 0 on success, a negative error code otherwise. A 500 Internal
+ *         Server Error is sent if the handler fails without answering.
+ */
+typedef int (*http_server_handler_t)(struct http_server_conn *conn,
+				     const struct http_server_request *req);
+
+/**
+ * @brief Request body callback
+ *
+ * @details Called in the server thread with the body of the request, in as
+ * many pieces as it spans network buffers. The data is not copied and is
+ * only valid during the call.
+ *
+ * @param conn Connection the request was received on
+ * @param req Request
+ * @param data Piece of the body
+ * @param len Length of the piece
+ *
+ * @return 0 on success, -EFBIG to reject the request with a 413 Payload Too
+ *         Large, another negative error code to reject it with a 400 Bad
+ *         Request.
+ */
+typedef int (*http_server_body_cb_t)(struct http_server_conn *conn,
+				     const struct http_server_request *req,
+				     const char *data, size_t len);
+
+/**
+ * Entry of the route table of a server
+ */
+struct http_server_route {
+	/** URL of the route, without query */
+	const char *url;
+	/** Content-Type of the static content */
+	const char *content_type;
+	/** Static content, sent without copying when handler is NULL */
+	const void *content;
+	/** Length of the static content */
+	size_t content_len;
+	/** Handler, called when the request has been received */
+	http_server_handler_t handler;
+	/** Body callback, may be NULL */
+	http_server_body_cb_t body;
+	/** Length of the URL */
+	uint16_t url_len;
+	/** HTTP_SERVER_ROUTE_* flags */
+	uint8_t flags;
+};
+
+/**
+ * @brief Define a route served by a handler
+ *
+ * @param _url URL of the route, a string literal
+ * @param _flags HTTP_SERVER_ROUTE_* flags
+ * @param _handler Route handler
+ * @param _body Body callback, or NULL
+ */
+#define HTTP_SERVER_ROUTE(_url, _flags, _handler, _body)		\
+	{								\
+		.url = _url,						\
+		.url_len = sizeof(_url) - 1,				\
+		.flags = _flags,					\
+		.handler = _handler,					\
+		.body = _body,						\
+	}
+
+/**
+ * @brief Define a route serving static content
+ *
+ * @details The content is sent from where it lives, typically flash, so it
+ * must not change while the server runs.
+ *
+ * @param _url URL of the route, a string literal
+ * @param _content_type Content-Type of the content
+ * @param _content Content
+ * @param _content_len Length of the content
+ */
+#define HTTP_SERVER_ROUTE_STATIC(_url, _content_type, _content,	\
+				 _content_len)				\
+	{								\
+		.url = _url,						\
+		.url_len = sizeof(_url) - 1,				\
+		.content_type = _content_type,				\
+		.content = _content,					\
+		.content_len = _content_len,				\
+	}
+
+/**
+ * HTTP server
+ */
+struct http_server {
+	/** Route table */
+	const struct http_server_route *routes;
+	/** Number of routes */
+	size_t routes_len;
+	/** Listening context */
+	struct net_context *net_ctx;
+};
+
+/**
+ * @brief Initialize an HTTP server
+ *
+ * @details Routes are matched in order, the first one matching the URL of
+ * a request serves it. Requests matching no route get a 404 Not Found.
+ *
+ * @param server HTTP server
+ * @param routes Route table, it must remain valid while the server runs
+ * @param routes_len Number of routes
+ *
+ * @return 0 on success, -EINVAL if a parameter is not valid
+ */
+int http_server_init(struct http_server *server,
+		     const struct http_server_route *routes,
+		     size_t routes_len);
+
+/**
+ * @brief Start accepting connections
+ *
+ * @details Requests are parsed and answered in the server thread, shared by
+ * all the servers. Connections are kept open between requests, and the
+ * pipelined requests are answered in order.
+ *
+ * @param server HTTP server
+ * @param addr Local address and port to listen on
+ * @param addrlen Length of the address
+ *
+ * @return 0 on success, a negative error code otherwise
+ */
+int http_server_start(struct http_server *server, const struct sockaddr *addr,
+		      socklen_t addrlen);
+
+/**
+ * @brief Stop accepting connections
+ *
+ * @details The connections already accepted are closed by the server
+ * thread soon after, without answering the requests still pending on them.
+ *
+ * @param server HTTP server
+ *
+ * @return 0 on success, -EALREADY if the server is not started
+ */
+int http_server_stop(struct http_server *server);
+
+/**
+ * @brief Find the route serving a URL
+ *
+ * @param server HTTP server
+ * @param url URL, it may include a query
+ * @param url_len Length of the URL
+ *
+ * @return The first route matching the URL, NULL if none
+ */
+const struct http_server_route *
+http_server_route_find(const struct http_server *server, const char *url,
+		       uint16_t url_len);
+
+/**
+ * @brief Answer a request with a copy of the body
+ *
+ * @details The body is copied into network buffers before the function
+ * returns, so it may be built in a temporary buffer.
+ *
+ * @param conn Connection of the request
+ * @param status HTTP status code
+ * @param content_type Content-Type of the body, NULL if there is none
+ * @param body Body
+ * @param len Length of the body
+ *
+ * @return 0 on success, -EALREADY if the request has already been
+ *         answered, -ENOMEM if the network buffers run out
+ */
+int http_server_send(struct http_server_conn *conn, int status,
+		     const char *content_type, const void *body, size_t len);
+
+/**
+ * @brief Answer a request with a body sent in place
+ *
+ * @details The body is not copied: it is read from where it lives as the
+ * segments of the response are sent, once the handler has returned. It
+ * must not change until the connection is closed.
+ *
+ * @param conn Connection of the request
+ * @param status HTTP status code
+ * @param content_type Content-Type of the body, NULL if there is none
+ * @param body Body
+ * @param len Length of the body
+ *
+ * @return 0 on success, -EALREADY if the request has already been answered
+ */
+int http_server_send_static(struct http_server_conn *conn, int status,
+			    const char *content_type, const void *body,
+			    size_t len);
+
+/**
+ * @}
+ */
+
+#endif /* _HTTP_SERVER_H_ */
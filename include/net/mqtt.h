@@ -9,6 +9,7 @@
 
 #include <net/mqtt_types.h>
 #include <net/net_context.h>
+#include <net/nbuf.h>
 
 /**
  * @brief MQTT library
@@ -30,6 +31,26 @@ enum mqtt_app {
 	MQTT_APP_SERVER
 };
 
+#if defined(CONFIG_MQTT_INFLIGHT)
+/**
+ * QoS 1 or QoS 2 PUBLISH message sent and not acknowledged yet
+ */
+struct mqtt_inflight {
+	/** Uptime of the last transmission, in ms */
+	uint32_t sent;
+	/** Packet Identifier */
+	uint16_t pkt_id;
+	/** Length of the packed PUBLISH message, 0 once it is received */
+	uint16_t len;
+	/** Acknowledgement expected: MQTT_PUBACK, MQTT_PUBREC or
+	 * MQTT_PUBCOMP. MQTT_INVALID if the entry is not used.
+	 */
+	uint8_t ack;
+	/** Packed PUBLISH message */
+	uint8_t data[CONFIG_MQTT_MSG_MAX_SIZE];
+};
+#endif
+
 /**
  * MQTT context structure
  *
@@ -53,8 +74,16 @@ enum mqtt_app {
  * collection of #mqtt_publish_msg structs (array of structs) to store those
  * messages.
  *
+ * Received data is split into MQTT messages by the API: a TCP segment may
+ * carry several messages or only a part of one. A message split over several
+ * segments is kept until it is complete, it must not be longer than
+ * CONFIG_MQTT_MSG_MAX_SIZE.
+ *
  * <b>NOTE: The application (and not the API) is in charge of keeping track of
- * the state of the received and sent messages.</b>
+ * the state of the received and sent messages.</b> Unless
+ * CONFIG_MQTT_INFLIGHT is enabled: the QoS 1 and QoS 2 PUBLISH messages sent
+ * are then kept in the context until they are acknowledged, see
+ * mqtt_session_save().
  */
 struct mqtt_ctx {
 	/** IP stack context structure */
@@ -148,7 +177,26 @@ struct mqtt_ctx {
 	void (*malformed)(struct mqtt_ctx *ctx, uint16_t pkt_type);
 
 	/* Internal use only */
-	int (*rcv)(struct mqtt_ctx *ctx, struct net_buf *);
+	int (*rcv)(struct mqtt_ctx *ctx, struct net_nbuf_cursor *);
+
+	/* Internal use only, received data not parsed yet. It holds the
+	 * beginning of a message split over several segments.
+	 */
+	struct net_buf *rx_frags;
+
+	/* Internal use only, bytes left of a discarded message */
+	uint32_t rx_skip;
+
+#if defined(CONFIG_MQTT_INFLIGHT)
+	/* Internal use only, messages sent and not acknowledged yet */
+	struct mqtt_inflight inflight[CONFIG_MQTT_INFLIGHT_WINDOW];
+	/* Internal use only, free entries of the in-flight table */
+	struct k_sem inflight_free;
+	/* Internal use only, serializes the access to the in-flight table */
+	struct k_sem inflight_lock;
+	/* Internal use only, retransmission timer */
+	struct k_delayed_work inflight_timer;
+#endif
 
 	/** Application type, see: enum mqtt_app */
 	uint8_t app_type;
@@ -166,6 +214,11 @@ struct mqtt_ctx {
 /**
  * Initializes the MQTT context structure
  *
+ * @details When CONFIG_MQTT_INFLIGHT is enabled, the in-flight table is
+ * emptied. To resume a session on a new network context, save the table with
+ * mqtt_session_save() before calling this routine and restore it with
+ * mqtt_session_load() afterwards.
+ *
  * @param ctx MQTT context structure
  * @param app_type See enum mqtt_app
  * @retval 0, always.
@@ -251,6 +304,12 @@ int mqtt_tx_pubrel(struct mqtt_ctx *ctx, uint16_t id);
 /**
  * Sends the MQTT PUBLISH message
  *
+ * @details When CONFIG_MQTT_INFLIGHT is enabled, QoS 1 and QoS 2 messages are
+ * kept in the in-flight table until they are acknowledged. This routine
+ * waits up to ctx->net_timeout for a free entry when the table is full.
+ * Once in the table, a message that cannot be sent is not reported as an
+ * error: it is sent again by the retransmission timer.
+ *
  * @param [in] ctx MQTT context structure
  * @param [in] msg MQTT PUBLISH msg
  *
@@ -258,6 +317,7 @@ int mqtt_tx_pubrel(struct mqtt_ctx *ctx, uint16_t id);
  * @retval -EINVAL
  * @retval -ENOMEM
  * @retval -EIO
+ * @retval -EAGAIN if the in-flight table is full
  */
 int mqtt_tx_publish(struct mqtt_ctx *ctx, struct mqtt_publish_msg *msg);
 
@@ -316,7 +376,7 @@ int mqtt_tx_unsubscribe(struct mqtt_ctx *ctx, uint16_t pkt_id, uint8_t items,
  * Parses and validates the MQTT CONNACK msg
  *
  * @param [in] ctx MQTT context structure
- * @param [in] rx Data buffer
+ * @param [in] rx RX buffer, the message is its application data
  * @param [in] clean_session MQTT clean session parameter
  *
  * @retval 0 on success
@@ -329,7 +389,7 @@ int mqtt_rx_connack(struct mqtt_ctx *ctx, struct net_buf *rx,
  * Parses and validates the MQTT PUBACK message
  *
  * @param [in] ctx MQTT context structure
- * @param [in] rx Data buffer
+ * @param [in] rx RX buffer, the message is its application data
  *
  * @retval 0 on success
  * @retval -EINVAL
@@ -340,7 +400,7 @@ int mqtt_rx_puback(struct mqtt_ctx *ctx, struct net_buf *rx);
  * Parses and validates the MQTT PUBCOMP message
  *
  * @param [in] ctx MQTT context structure
- * @param [in] rx Data buffer
+ * @param [in] rx RX buffer, the message is its application data
  *
  * @retval 0 on success
  * @retval -EINVAL
@@ -351,7 +411,7 @@ int mqtt_rx_pubcomp(struct mqtt_ctx *ctx, struct net_buf *rx);
  * Parses and validates the MQTT PUBREC message
  *
  * @param [in] ctx MQTT context structure
- * @param [in] rx Data buffer
+ * @param [in] rx RX buffer, the message is its application data
  *
  * @retval 0 on success
  * @retval -EINVAL
@@ -362,7 +422,7 @@ int mqtt_rx_pubrec(struct mqtt_ctx *ctx, struct net_buf *rx);
  * Parses and validates the MQTT PUBREL message
  *
  * @param [in] ctx MQTT context structure
- * @param [in] rx Data buffer
+ * @param [in] rx RX buffer, the message is its application data
  *
  * @retval 0 on success
  * @retval -EINVAL
@@ -373,7 +433,7 @@ int mqtt_rx_pubrel(struct mqtt_ctx *ctx, struct net_buf *rx);
  * Parses the MQTT PINGRESP message
  *
  * @param [in] ctx MQTT context structure
- * @param [in] rx Data buffer
+ * @param [in] rx RX buffer, the message is its application data
  *
  * @retval 0 on success
  * @retval -EINVAL
@@ -384,7 +444,7 @@ int mqtt_rx_pingresp(struct mqtt_ctx *ctx, struct net_buf *rx);
  * Parses the MQTT SUBACK message
  *
  * @param [in] ctx MQTT context structure
- * @param [in] rx Data buffer
+ * @param [in] rx RX buffer, the message is its application data
  *
  * @retval 0 on success
  * @retval -EINVAL
@@ -395,7 +455,7 @@ int mqtt_rx_suback(struct mqtt_ctx *ctx, struct net_buf *rx);
  * Parses the MQTT UNSUBACK message
  *
  * @param [in] ctx MQTT context structure
- * @param [in] rx Data buffer
+ * @param [in] rx RX buffer, the message is its application data
  *
  * @retval 0 on success
  * @retval -EINVAL
@@ -406,7 +466,7 @@ int mqtt_rx_unsuback(struct mqtt_ctx *ctx, struct net_buf *rx);
  * Parses the MQTT PUBLISH message
  *
  * @param [in] ctx MQTT context structure
- * @param [in] rx Data buffer
+ * @param [in] rx RX buffer, the message is its application data
  *
  * @retval 0 on success
  * @retval -EINVAL
@@ -414,6 +474,41 @@ int mqtt_rx_unsuback(struct mqtt_ctx *ctx, struct net_buf *rx);
  */
 int mqtt_rx_publish(struct mqtt_ctx *ctx, struct net_buf *rx);
 
+#if defined(CONFIG_MQTT_INFLIGHT)
+/**
+ * Saves the state of the messages in flight
+ *
+ * @details The state may be kept by the application, for example in flash,
+ * and restored with mqtt_session_load() to resume the session with clean
+ * session set to 0.
+ *
+ * @param [in] ctx MQTT context structure
+ * @param [out] buf Buffer where the state is written
+ * @param [in] size Buffer size
+ *
+ * @retval Number of bytes written on success
+ * @retval -ENOMEM if the buffer is too small
+ */
+int mqtt_session_save(struct mqtt_ctx *ctx, uint8_t *buf, uint16_t size);
+
+/**
+ * Restores the state of the messages in flight
+ *
+ * @details This routine must be called after mqtt_init() and before sending
+ * the MQTT CONNECT message. The messages are sent again once the server acks
+ * that the session is resumed.
+ *
+ * @param [in] ctx MQTT context structure
+ * @param [in] buf State saved by mqtt_session_save()
+ * @param [in] len State length
+ *
+ * @retval 0 on success
+ * @retval -EINVAL if the state is not valid
+ * @retval -ENOMEM if the in-flight table is too small
+ */
+int mqtt_session_load(struct mqtt_ctx *ctx, const uint8_t *buf, uint16_t len);
+#endif
+
 /**
  * @}
  */
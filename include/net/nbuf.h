@@ -69,6 +69,11 @@ struct net_nbuf {
 
 #if defined(CONFIG_NET_TCP)
 	bool buf_sent; /* Is this net_buf sent or not */
+	bool sacked; /* Is this net_buf selectively acknowledged */
+#endif
+
+#if defined(CONFIG_NET_STATISTICS_PERF)
+	uint32_t queued; /* Cycle count when queued for RX or TX */
 #endif
 	/* @endcond */
 };
@@ -200,6 +205,28 @@ static inline void net_nbuf_set_buf_sent(struct net_buf *buf, bool sent)
 {
 	((struct net_nbuf *)net_buf_user_data(buf))->buf_sent = sent;
 }
+
+static inline bool net_nbuf_sacked(struct net_buf *buf)
+{
+	return ((struct net_nbuf *)net_buf_user_data(buf))->sacked;
+}
+
+static inline void net_nbuf_set_sacked(struct net_buf *buf, bool sacked)
+{
+	((struct net_nbuf *)net_buf_user_data(buf))->sacked = sacked;
+}
+#endif
+
+#if defined(CONFIG_NET_STATISTICS_PERF)
+static inline uint32_t net_nbuf_queued(struct net_buf *buf)
+{
+	return ((struct net_nbuf *)net_buf_user_data(buf))->queued;
+}
+
+static inline void net_nbuf_set_queued(struct net_buf *buf, uint32_t queued)
+{
+	((struct net_nbuf *)net_buf_user_data(buf))->queued = queued;
+}
 #endif
 
 static inline uint16_t net_nbuf_get_len(struct net_buf *buf)
@@ -795,6 +822,171 @@ struct net_buf *net_nbuf_read_be16(struct net_buf *buf, uint16_t offset,
 struct net_buf *net_nbuf_read_be32(struct net_buf *buf, uint16_t offset,
 				   uint16_t *pos, uint32_t *value);
 
+/**
+ * @brief Cursor over the data of a fragment chain
+ *
+ * @details A cursor reads data spread over several fragments without
+ * copying it into a linear buffer first. Every access is bounded by the
+ * length given when the cursor is set up, so a parser cannot run past the
+ * end of the message it is handling.
+ */
+struct net_nbuf_cursor {
+	/** Fragment holding the next byte to read */
+	struct net_buf *frag;
+
+	/** Offset of the next byte in the fragment */
+	uint16_t pos;
+
+	/** Number of bytes left to read */
+	uint16_t left;
+};
+
+/**
+ * @brief Set up a cursor over a fragment chain
+ *
+ * @details The cursor covers len bytes starting at offset, or less if the
+ * fragment chain is shorter.
+ *
+ * @param cur Cursor to set up
+ * @param frag First fragment of the chain
+ * @param offset Offset of the first byte to read, from the start of frag
+ * @param len Number of bytes the cursor may read
+ */
+void net_nbuf_cursor_init(struct net_nbuf_cursor *cur, struct net_buf *frag,
+			  uint16_t offset, uint16_t len);
+
+/**
+ * @brief Set up a cursor over the application data of a buffer
+ *
+ * @param cur Cursor to set up
+ * @param buf Network buffer, its application data runs until the end of its
+ *            fragment chain
+ */
+static inline void net_nbuf_cursor_init_appdata(struct net_nbuf_cursor *cur,
+						struct net_buf *buf)
+{
+	uint16_t len = net_nbuf_appdatalen(buf);
+
+	net_nbuf_cursor_init(cur, buf->frags,
+			     net_buf_frags_len(buf->frags) - len, len);
+}
+
+/**
+ * @brief Get the number of bytes left to read
+ *
+ * @param cur Cursor
+ *
+ * @return Number of bytes left to read
+ */
+static inline uint16_t net_nbuf_cursor_left(struct net_nbuf_cursor *cur)
+{
+	return cur->left;
+}
+
+/**
+ * @brief Read data and advance the cursor
+ *
+ * @param cur Cursor
+ * @param data Data is copied here, or skipped if NULL
+ * @param len Number of bytes to read
+ *
+ * @return 0 on success, -ENODATA if less than len bytes are left, the
+ *         cursor is then not moved.
+ */
+int net_nbuf_cursor_read(struct net_nbuf_cursor *cur, void *data,
+			 uint16_t len);
+
+/**
+ * @brief Read data without advancing the cursor
+ *
+ * @param cur Cursor
+ * @param data Data is copied here
+ * @param len Number of bytes to read
+ *
+ * @return 0 on success, -ENODATA if less than len bytes are left.
+ */
+static inline int net_nbuf_cursor_peek(struct net_nbuf_cursor *cur,
+				       void *data, uint16_t len)
+{
+	struct net_nbuf_cursor tmp = *cur;
+
+	return net_nbuf_cursor_read(&tmp, data, len);
+}
+
+/**
+ * @brief Skip data
+ *
+ * @param cur Cursor
+ * @param len Number of bytes to skip
+ *
+ * @return 0 on success, -ENODATA if less than len bytes are left.
+ */
+static inline int net_nbuf_cursor_skip(struct net_nbuf_cursor *cur,
+				       uint16_t len)
+{
+	return net_nbuf_cursor_read(cur, NULL, len);
+}
+
+/**
+ * @brief Read a byte
+ *
+ * @param cur Cursor
+ * @param value Value is returned
+ *
+ * @return 0 on success, -ENODATA if no byte is left.
+ */
+static inline int net_nbuf_cursor_read_u8(struct net_nbuf_cursor *cur,
+					  uint8_t *value)
+{
+	return net_nbuf_cursor_read(cur, value, sizeof(uint8_t));
+}
+
+/**
+ * @brief Read a 16 bit big endian value
+ *
+ * @param cur Cursor
+ * @param value Value is returned in host byte order
+ *
+ * @return 0 on success, -ENODATA if less than 2 bytes are left.
+ */
+int net_nbuf_cursor_read_be16(struct net_nbuf_cursor *cur, uint16_t *value);
+
+/**
+ * @brief Read a 32 bit big endian value
+ *
+ * @param cur Cursor
+ * @param value Value is returned in host byte order
+ *
+ * @return 0 on success, -ENODATA if less than 4 bytes are left.
+ */
+int net_nbuf_cursor_read_be32(struct net_nbuf_cursor *cur, uint32_t *value);
+
+/**
+ * @brief Get the data available in place at the cursor
+ *
+ * @details Gives access to the bytes at the cursor that are contiguous in the
+ * current fragment, without copying them. The cursor is not moved, use
+ * net_nbuf_cursor_skip() once the data has been consumed.
+ *
+ * @param cur Cursor
+ * @param len Number of contiguous bytes is returned here, it is 0 when no
+ *            data is left
+ *
+ * @return Pointer to the data at the cursor
+ */
+static inline uint8_t *net_nbuf_cursor_data(struct net_nbuf_cursor *cur,
+					    uint16_t *len)
+{
+	if (!cur->left) {
+		*len = 0;
+		return NULL;
+	}
+
+	*len = min(cur->left, cur->frag->len - cur->pos);
+
+	return cur->frag->data + cur->pos;
+}
+
 /**
  * @brief Write data to an arbitrary offset in a series of fragments.
  *
@@ -963,10 +1155,75 @@ static inline bool net_nbuf_insert_be32(struct net_buf *buf,
 			       (uint8_t *)&value, K_FOREVER);
 }
 
+/**
+ * @brief Get a DATA buffer able to hold the given amount of data.
+ *
+ * @details Drivers use this to receive a frame into a single fragment.
+ * If CONFIG_NET_NBUF_VAR_DATA is set and the data does not fit into a
+ * regular fragment, the fragment is allocated from a memory pool. In
+ * interrupt context, or if the memory pool is exhausted, a regular
+ * fragment is returned instead, so the caller must still check the
+ * tailroom of the fragment.
+ *
+ * @param reserve_head How many bytes to reserve for headroom.
+ * @param len How many bytes of data the fragment should hold.
+ * @param timeout Affects the action taken should the net buf pool be empty.
+ *        If K_NO_WAIT, then return immediately. If K_FOREVER, then
+ *        wait as long as necessary. Otherwise, wait up to the specified
+ *        number of milliseconds before timing out.
+ *
+ * @return Network buffer if successful, NULL otherwise.
+ */
+struct net_buf *net_nbuf_get_reserve_data_len(uint16_t reserve_head,
+					      uint16_t len, int32_t timeout);
+
+/**
+ * @brief Watermark on the number of free DATA buffers.
+ *
+ * The callback is called with low set to true when the number of free
+ * data fragments drops to the low mark, and with low set to false when
+ * it climbs back to the high mark. It can be called from interrupt
+ * context and is called with interrupts locked, so it must be short and
+ * must not block.
+ */
+struct net_nbuf_watermark {
+	sys_snode_t node;
+
+	/** Called when the watermark is crossed */
+	void (*cb)(struct net_nbuf_watermark *wm, bool low);
+
+	/** Free fragment count at or below which the pool is low */
+	uint16_t low;
+
+	/** Free fragment count at or above which the pool is not low */
+	uint16_t high;
+
+	/** Whether the pool is currently low, for internal use */
+	bool is_low;
+};
+
+/**
+ * @brief Register a watermark on the DATA buffer pool.
+ *
+ * @details If the pool is already low, the callback is called right
+ * away.
+ *
+ * @param wm Watermark with the callback and the marks set, the low mark
+ * being below the high one.
+ */
+void net_nbuf_watermark_add(struct net_nbuf_watermark *wm);
+
+/**
+ * @brief Unregister a watermark on the DATA buffer pool.
+ *
+ * @param wm Watermark previously registered.
+ */
+void net_nbuf_watermark_remove(struct net_nbuf_watermark *wm);
+
 /**
  * @brief Get information about available free buffer count in
- * various network buffer pools. The amount of free buffers is
- * only returned if network buffer debugging is enabled.
+ * various network buffer pools. The amount of free TX and RX
+ * buffers is only returned if network buffer debugging is enabled.
  *
  * @param tx_size Size of TX pool. Value is returned.
  * @param rx_size Size of RX pool. Value is returned.
@@ -197,6 +197,11 @@ struct net_context {
 	/** Flags for the context */
 	uint8_t flags;
 
+#if CONFIG_NET_CONTEXT_NBUF_QUOTA > 0
+	/** Number of data fragments charged to this context */
+	atomic_t data_held;
+#endif /* CONFIG_NET_CONTEXT_NBUF_QUOTA > 0 */
+
 #if defined(CONFIG_NET_TCP)
 	/** TCP connection information */
 	struct net_tcp *tcp;
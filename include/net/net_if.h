@@ -153,6 +153,9 @@ enum {
 	/* interface is pointopoint */
 	NET_IF_POINTOPOINT,
 
+	/* device computes the checksums of sent packets */
+	NET_IF_TX_CHKSUM_OFFLOAD,
+
 	/* Total number of flags - must be at the end of the enum */
 	NET_IF_NUM_FLAGS
 };
@@ -198,6 +201,14 @@ struct net_if {
 	/** Queue for outgoing packets from apps */
 	struct k_fifo tx_queue;
 
+#if defined(CONFIG_NET_STATISTICS_PERF)
+	/** Number of packets in the TX queue */
+	atomic_t tx_queue_len;
+#endif
+
+	/** Max number of received packets processed in one RX burst */
+	uint8_t rx_burst;
+
 	/** Stack for the TX thread tied to this interface */
 #ifndef CONFIG_NET_TX_STACK_SIZE
 #define CONFIG_NET_TX_STACK_SIZE 1024
@@ -366,8 +377,17 @@ static inline struct device *net_if_get_device(struct net_if *iface)
  * @param iface Pointer to a network interface structure
  * @param buf Pointer on a net buffer to queue
  */
+#if defined(CONFIG_NET_STATISTICS_PERF)
+/* Account a packet queued for transmission, for internal use */
+void net_if_tx_queued(struct net_if *iface, struct net_buf *buf);
+#endif
+
 static inline void net_if_queue_tx(struct net_if *iface, struct net_buf *buf)
 {
+#if defined(CONFIG_NET_STATISTICS_PERF)
+	net_if_tx_queued(iface, buf);
+#endif
+
 	net_buf_put(&iface->tx_queue, buf);
 }
 
@@ -383,6 +403,66 @@ static inline bool net_if_is_ip_offloaded(struct net_if *iface)
 	return iface->offload_ip;
 }
 
+/**
+ * @brief Get the RX burst size of a given interface
+ *
+ * @param iface Network interface
+ *
+ * @return Max number of received packets processed in one RX burst
+ */
+static inline uint8_t net_if_get_rx_burst(struct net_if *iface)
+{
+	return iface->rx_burst;
+}
+
+/**
+ * @brief Set the RX burst size of a given interface
+ *
+ * @details The RX thread processes up to this many queued packets before
+ * yielding, when the first packet of the burst was received by this
+ * interface.
+ *
+ * @param iface Network interface
+ * @param burst New RX burst size, at least 1
+ */
+static inline void net_if_set_rx_burst(struct net_if *iface, uint8_t burst)
+{
+	iface->rx_burst = burst ? burst : 1;
+}
+
+/**
+ * @brief Enable or disable TX checksum offloading on a given interface
+ *
+ * @details When enabled, the IPv4 header, UDP and TCP checksums of sent
+ * packets are left at zero for the device to fill in. Drivers whose hardware
+ * computes them call this from their interface init function.
+ *
+ * @param iface Network interface
+ * @param offload True if the device computes the checksums
+ */
+static inline void net_if_set_tx_chksum_offload(struct net_if *iface,
+						bool offload)
+{
+	if (offload) {
+		atomic_set_bit(iface->flags, NET_IF_TX_CHKSUM_OFFLOAD);
+	} else {
+		atomic_clear_bit(iface->flags, NET_IF_TX_CHKSUM_OFFLOAD);
+	}
+}
+
+/**
+ * @brief Check if the checksums of sent packets must be computed in software
+ *
+ * @param iface Network interface, can be NULL
+ *
+ * @return True if the stack must compute the checksums, false otherwise.
+ */
+static inline bool net_if_need_tx_chksum(struct net_if *iface)
+{
+	return !iface || !atomic_test_bit(iface->flags,
+					  NET_IF_TX_CHKSUM_OFFLOAD);
+}
+
 /**
  * @brief Get an network interface's link address
  *
@@ -1129,6 +1209,14 @@ int net_if_down(struct net_if *iface);
 struct net_if_api {
 	void (*init)(struct net_if *iface);
 	int (*send)(struct net_if *iface, struct net_buf *buf);
+
+	/** Optional: send several packets at once. Returns the number of
+	 * packets, taken in order from the start of the array, that the
+	 * driver accepted and now owns; the remaining ones are passed to
+	 * send() one at a time. A negative value means none was accepted.
+	 */
+	int (*send_batch)(struct net_if *iface, struct net_buf **bufs,
+			  int count);
 };
 
 #define NET_IF_GET_NAME(dev_name, sfx) (__net_if_##dev_name##_##sfx)
@@ -201,6 +201,66 @@ struct net_stats_bytes {
 	uint32_t received;
 };
 
+struct net_stats_time {
+	/** Number of samples. */
+	net_stats_t count;
+
+	/** Longest sample, in hardware cycles. */
+	uint32_t max;
+
+	/** Sum of the samples, in hardware cycles. */
+	uint64_t sum;
+};
+
+struct net_stats_perf {
+	/** Largest number of packets waiting in the RX queue. */
+	net_stats_t rx_queue_max;
+
+	/** Largest number of packets waiting in a TX queue. */
+	net_stats_t tx_queue_max;
+
+	/** Time spent by packets in the RX queue. */
+	struct net_stats_time rx_queue;
+
+	/** Time spent by packets in the TX queues. */
+	struct net_stats_time tx_queue;
+
+	/** Lowest number of free data fragments. */
+	net_stats_t data_free_min;
+
+	/** Number of failed RX buffer allocations. */
+	net_stats_t rx_alloc_fail;
+
+	/** Number of failed TX buffer allocations. */
+	net_stats_t tx_alloc_fail;
+
+	/** Number of failed data fragment allocations. */
+	net_stats_t data_alloc_fail;
+
+	/** Time spent processing received IPv6 packets, including the
+	 * upper layers.
+	 */
+	struct net_stats_time ipv6;
+
+	/** Time spent processing received IPv4 packets, including the
+	 * upper layers.
+	 */
+	struct net_stats_time ipv4;
+
+	/** Time spent processing received ICMP packets. */
+	struct net_stats_time icmp;
+
+	/** Time spent processing received UDP packets, including the
+	 * receive callbacks.
+	 */
+	struct net_stats_time udp;
+
+	/** Time spent processing received TCP segments, including the
+	 * receive callbacks.
+	 */
+	struct net_stats_time tcp;
+};
+
 struct net_stats {
 	net_stats_t processing_error;
 
@@ -239,6 +299,10 @@ struct net_stats {
 #if defined(CONFIG_NET_STATISTICS_RPL)
 	struct net_stats_rpl rpl;
 #endif
+
+#if defined(CONFIG_NET_STATISTICS_PERF)
+	struct net_stats_perf perf;
+#endif
 };
 
 #if defined(CONFIG_NET_STATISTICS_USER_API)
@@ -263,6 +327,7 @@ enum net_request_stats_cmd {
 	NET_REQUEST_STATS_CMD_GET_UDP,
 	NET_REQUEST_STATS_CMD_GET_TCP,
 	NET_REQUEST_STATS_CMD_GET_RPL,
+	NET_REQUEST_STATS_CMD_GET_PERF,
 };
 
 #define NET_REQUEST_STATS_GET_ALL				\
@@ -334,6 +399,13 @@ NET_MGMT_DEFINE_REQUEST_HANDLER(NET_REQUEST_STATS_GET_TCP);
 NET_MGMT_DEFINE_REQUEST_HANDLER(NET_REQUEST_STATS_GET_RPL);
 #endif /* CONFIG_NET_STATISTICS_RPL */
 
+#if defined(CONFIG_NET_STATISTICS_PERF)
+#define NET_REQUEST_STATS_GET_PERF				\
+	(_NET_STATS_BASE | NET_REQUEST_STATS_CMD_GET_PERF)
+
+NET_MGMT_DEFINE_REQUEST_HANDLER(NET_REQUEST_STATS_GET_PERF);
+#endif /* CONFIG_NET_STATISTICS_PERF */
+
 #endif /* CONFIG_NET_STATISTICS_USER_API */
 
 #ifdef __cplusplus
@@ -229,6 +229,18 @@ struct zoap_reply {
 	uint8_t tkl;
 };
 
+/**
+ * @brief Represents a request recently received, and the response sent
+ * to it, so its retransmissions are not processed again.
+ */
+struct zoap_dedup {
+	struct sockaddr addr;
+	uint32_t timestamp;
+	uint16_t id;
+	uint16_t len;
+	uint8_t data[CONFIG_ZOAP_DEDUP_RESPONSE_SIZE];
+};
+
 /**
  * @brief Indicates that the remote device referenced by @a addr, with
  * @a request, wants to observe a resource.
@@ -447,6 +459,71 @@ void zoap_pending_clear(struct zoap_pending *pending);
  */
 void zoap_reply_clear(struct zoap_reply *reply);
 
+/**
+ * @brief Remembers that @a response was sent to @a request, so
+ * retransmissions of @a request can be answered with it.
+ *
+ * The encoded response is copied to the entry, up to
+ * CONFIG_ZOAP_DEDUP_RESPONSE_SIZE bytes. A larger response is not kept
+ * and the entry is left cleared, so the retransmissions of @a request
+ * are not seen as duplicates and are processed again.
+ *
+ * @param dedup Entry to be initialized
+ * @param request Request received
+ * @param response Response sent, NULL if there is none, duplicates are
+ * then only to be dropped
+ * @param addr Address from which the request was received
+ *
+ * @return 0 in case of success, -EMSGSIZE if the response is too large
+ * to be kept, the request is then not recorded.
+ */
+int zoap_dedup_init(struct zoap_dedup *dedup,
+		    const struct zoap_packet *request,
+		    const struct zoap_packet *response,
+		    const struct sockaddr *addr);
+
+/**
+ * @brief Returns the next available entry of the deduplication window.
+ *
+ * Entries are kept for EXCHANGE_LIFETIME (RFC 7252, section 4.8.2).
+ * When all of them are in use, the oldest one is cleared and returned.
+ *
+ * @param dedups Pointer to the array of entries
+ * @param len Size of the array of entries
+ *
+ * @return A pointer to an entry, NULL only if @a len is 0.
+ */
+struct zoap_dedup *zoap_dedup_next_unused(
+	struct zoap_dedup *dedups, size_t len);
+
+/**
+ * @brief Checks whether @a request is a duplicate, as defined in RFC
+ * 7252, section 4.5: same message ID from the same endpoint.
+ *
+ * A duplicate must not be processed again. If the @a len of the entry
+ * returned is not 0, the @a data of the entry is the encoded response
+ * to be sent back.
+ *
+ * @param request Request received
+ * @param from Address from which the request was received
+ * @param dedups Pointer to the array of entries
+ * @param len Size of the array of entries
+ *
+ * @return The entry of the original request, NULL if @a request is not
+ * a duplicate.
+ */
+struct zoap_dedup *zoap_dedup_received(
+	const struct zoap_packet *request,
+	const struct sockaddr *from,
+	struct zoap_dedup *dedups, size_t len);
+
+/**
+ * @brief Releases an entry of the deduplication window.
+ *
+ * @param dedup Entry to be cleared
+ */
+void zoap_dedup_clear(struct zoap_dedup *dedup);
+
 /**
  * @brief When a request is received, call the appropriate methods of
  * the matching resources.
@@ -461,6 +538,57 @@ int zoap_handle_request(struct zoap_packet *pkt,
 			struct zoap_resource *resources,
 			const struct sockaddr *from);
 
+/**
+ * @brief Node of a resource tree, one per distinct path segment.
+ */
+struct zoap_resource_node {
+	const char *segment;
+	struct zoap_resource_node *child;
+	struct zoap_resource_node *next;
+	struct zoap_resource *resource;
+	uint16_t len;
+};
+
+/**
+ * @brief Resources indexed by path, so a request is dispatched with a
+ * lookup per URI-Path segment instead of a comparison per resource.
+ */
+struct zoap_resource_tree {
+	struct zoap_resource_node *nodes;
+	size_t len;
+	size_t used;
+};
+
+/**
+ * @brief Builds the tree of the resources in @a resources, the array
+ * must not be modified while the tree is used.
+ *
+ * @param tree Tree to be initialized
+ * @param resources Array of known resources
+ * @param nodes Storage for the nodes of the tree
+ * @param len Number of nodes: one plus the number of distinct path
+ * prefixes of the resources is enough.
+ *
+ * @return 0 in case of success or -ENOMEM if @a nodes is too small.
+ */
+int zoap_resource_tree_init(struct zoap_resource_tree *tree,
+			    struct zoap_resource *resources,
+			    struct zoap_resource_node *nodes, size_t len);
+
+/**
+ * @brief Same as zoap_handle_request(), looking up the matching resource
+ * in @a tree.
+ *
+ * @param pkt Packet received
+ * @param tree Tree of known resources
+ * @param from Address from which the packet was received
+ *
+ * @return 0 in case of success or negative in case of error.
+ */
+int zoap_handle_request_tree(struct zoap_packet *pkt,
+			     struct zoap_resource_tree *tree,
+			     const struct sockaddr *from);
+
 /**
  * @brief Indicates that this resource was updated and that the @a
  * notify callback should be called for every registered observer.
@@ -703,6 +831,143 @@ int zoap_update_from_block(const struct zoap_packet *pkt,
  */
 size_t zoap_next_block(struct zoap_block_context *ctx);
 
+/**
+ * @typedef zoap_block_read_t
+ * @brief Type of the callback producing the body of a block-wise
+ * transfer, one block at a time.
+ *
+ * @param ctx Block context, the block starts at @a ctx->current
+ * @param data Where to copy the block
+ * @param len Length of the block
+ * @param user_data User data given with the callback
+ *
+ * @return The number of bytes copied, @a len, or negative in case of
+ * error.
+ */
+typedef int (*zoap_block_read_t)(struct zoap_block_context *ctx,
+				 uint8_t *data, uint16_t len,
+				 void *user_data);
+
+/**
+ * @typedef zoap_block_write_t
+ * @brief Type of the callback consuming the body of a block-wise
+ * transfer, one block at a time.
+ *
+ * @param ctx Block context, the block starts at @a ctx->current
+ * @param data Content of the block
+ * @param len Length of the block
+ * @param last Whether this is the last block of the body
+ * @param user_data User data given with the callback
+ *
+ * @return 0 in case of success or negative in case of error.
+ */
+typedef int (*zoap_block_write_t)(struct zoap_block_context *ctx,
+				  const uint8_t *data, uint16_t len,
+				  bool last, void *user_data);
+
+/**
+ * @brief Server side of a Block2 transfer: adds the block of the body
+ * requested by @a request, and its Block2 option, to @a response.
+ *
+ * The block size is the smallest of the one of the request and the one
+ * of @a ctx, so @a ctx must be initialized with the largest block size
+ * the server supports and the size of the body before every call. Only
+ * options with a lower number than Block2 may be added to @a response
+ * before.
+ *
+ * @param request Request received
+ * @param response Response being built
+ * @param ctx Block context of the body
+ * @param read Callback producing the block
+ * @param user_data User data passed to @a read
+ *
+ * @return 0 in case of success, -EINVAL if the block requested is past
+ * the end of the body or negative in case of error.
+ */
+int zoap_block2_response_fill(const struct zoap_packet *request,
+			      struct zoap_packet *response,
+			      struct zoap_block_context *ctx,
+			      zoap_block_read_t read, void *user_data);
+
+/**
+ * @brief Client side of a Block2 transfer: passes the block carried by
+ * @a response to @a write and updates @a ctx.
+ *
+ * @a ctx must be initialized with the largest block size the client
+ * accepts. While there are blocks left, the next request is built with
+ * zoap_add_block2_option().
+ *
+ * @param response Response received
+ * @param ctx Block context of the body
+ * @param write Callback consuming the block
+ * @param user_data User data passed to @a write
+ *
+ * @return 1 if more blocks are to be requested, 0 once the body is
+ * complete, -EINVAL if the block is not the one expected or negative
+ * in case of error.
+ */
+int zoap_block2_response_received(const struct zoap_packet *response,
+				  struct zoap_block_context *ctx,
+				  zoap_block_write_t write, void *user_data);
+
+/**
+ * @brief Client side of a Block1 transfer: adds the block at
+ * @a ctx->current, and its Block1 and Size1 options, to @a request.
+ *
+ * @a ctx must be initialized with the block size and the size of the
+ * body. Only options with a lower number than Block1 may be added to
+ * @a request before.
+ *
+ * @param request Request being built
+ * @param ctx Block context of the body
+ * @param read Callback producing the block
+ * @param user_data User data passed to @a read
+ *
+ * @return 0 in case of success or negative in case of error.
+ */
+int zoap_block1_request_fill(struct zoap_packet *request,
+			     struct zoap_block_context *ctx,
+			     zoap_block_read_t read, void *user_data);
+
+/**
+ * @brief Server side of a Block1 transfer: passes the block carried by
+ * @a request to @a write and adds the Block1 option to @a response.
+ *
+ * @a ctx must be initialized with the largest block size the server
+ * supports before the first block. Retransmitted blocks are
+ * acknowledged without being written again. While more blocks are
+ * expected, the code of @a response is set to 2.31 Continue.
+ *
+ * @param request Request received
+ * @param response Response being built
+ * @param ctx Block context of the body
+ * @param write Callback consuming the block
+ * @param user_data User data passed to @a write
+ *
+ * @return 1 if more blocks are expected, 0 once the body is complete,
+ * -EINVAL if a block is missing, the response should then be 4.08
+ * Request Entity Incomplete, or negative in case of error.
+ */
+int zoap_block1_request_received(const struct zoap_packet *request,
+				 struct zoap_packet *response,
+				 struct zoap_block_context *ctx,
+				 zoap_block_write_t write, void *user_data);
+
+/**
+ * @brief Client side of a Block1 transfer: updates @a ctx from the
+ * acknowledgement of a block, adopting the block size of the server
+ * when it is smaller.
+ *
+ * @param response Response received
+ * @param ctx Block context of the body
+ *
+ * @return 1 if the next block is to be sent with
+ * zoap_block1_request_fill(), 0 once the server handled the whole body,
+ * -EINVAL if the response does not match the last block sent.
+ */
+int zoap_block1_response_received(const struct zoap_packet *response,
+				  struct zoap_block_context *ctx);
+
 /**
  * @brief Returns the version present in a CoAP packet.
  *
@@ -56,7 +56,12 @@ static void set_kernel_idle_time_in_ticks(int32_t ticks)
 
 static void _sys_power_save_idle(int32_t ticks __unused)
 {
-#if defined(CONFIG_TICKLESS_IDLE)
+#if defined(CONFIG_TICKLESS_KERNEL)
+	/*
+	 * The system timer is already programmed to expire at the next kernel
+	 * timeout: it was done when switching to the idle thread.
+	 */
+#elif defined(CONFIG_TICKLESS_IDLE)
 	if ((ticks == K_FOREVER) || ticks >= _sys_idle_threshold_ticks) {
 		/*
 		 * Stop generating system timer interrupts until it's time for
@@ -108,7 +113,7 @@ void _sys_power_save_idle_exit(int32_t ticks)
 		_sys_soc_resume();
 	}
 #endif
-#ifdef CONFIG_TICKLESS_IDLE
+#if defined(CONFIG_TICKLESS_IDLE) && !defined(CONFIG_TICKLESS_KERNEL)
 	if ((ticks == K_FOREVER) || ticks >= _sys_idle_threshold_ticks) {
 		/* Resume normal periodic system timer interrupts */
 
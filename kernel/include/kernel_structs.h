@@ -147,6 +147,14 @@ struct k_thread {
 	int errno_var;
 #endif
 
+#ifdef CONFIG_THREAD_STATS
+	/* runtime statistics */
+	struct k_thread_stats stats;
+
+	/* cycle count when last switched in, or when last made ready */
+	uint32_t stats_timestamp;
+#endif
+
 	/* arch-specifics: must always be at the end */
 	struct _thread_arch arch;
 };
@@ -69,6 +69,24 @@ extern void _thread_monitor_exit(struct k_thread *thread);
 	} while (0)
 #endif /* CONFIG_THREAD_MONITOR */
 
+/* runtime statistics accounting */
+
+#if defined(CONFIG_THREAD_STATS)
+extern void _thread_stats_init(struct k_thread *thread, size_t stack_size);
+extern void _thread_stats_ready(struct k_thread *thread);
+extern void _thread_stats_unready(struct k_thread *thread);
+#else
+#define _thread_stats_init(thread, stack_size) \
+	do {/* nothing */    \
+	} while (0)
+#define _thread_stats_ready(thread) \
+	do {/* nothing */    \
+	} while (0)
+#define _thread_stats_unready(thread) \
+	do {/* nothing */    \
+	} while (0)
+#endif /* CONFIG_THREAD_STATS */
+
 #ifdef __cplusplus
 }
 #endif
@@ -15,11 +15,16 @@
  */
 
 #include <misc/dlist.h>
+#include <drivers/system_timer.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#ifdef CONFIG_TICKLESS_KERNEL
+extern void _sys_clock_next_deadline_set(struct k_thread *thread);
+#endif
+
 /* initialize the timeouts part of k_thread when enabled in the kernel */
 
 static inline void _init_timeout(struct _timeout *t, _timeout_func_t func)
@@ -201,6 +206,14 @@ static inline void _add_timeout(struct k_thread *thread,
 {
 	__ASSERT(timeout_in_ticks > 0, "");
 
+#ifdef CONFIG_TICKLESS_KERNEL
+	/*
+	 * Deltas in the _timeout_q are relative to the last tick announced to
+	 * the kernel: account for the ticks that have elapsed since then.
+	 */
+	timeout_in_ticks += _timer_elapsed_ticks_get();
+#endif
+
 	timeout->delta_ticks_from_prev = timeout_in_ticks;
 	timeout->thread = thread;
 	timeout->wait_q = (sys_dlist_t *)wait_q;
@@ -229,6 +242,13 @@ inserted:
 	K_DEBUG("after adding timeout %p\n", timeout);
 	_dump_timeout(timeout, 0);
 	_dump_timeout_q();
+
+#ifdef CONFIG_TICKLESS_KERNEL
+	/* the new timeout is the next deadline: reprogram the system timer */
+	if (sys_dlist_peek_head(&_timeout_q) == &timeout->node) {
+		_sys_clock_next_deadline_set(_current);
+	}
+#endif
 }
 
 /*
@@ -287,6 +287,7 @@ static void prepare_multithreading(struct k_thread *dummy_thread)
 	_new_thread(_main_stack, MAIN_STACK_SIZE,
 		    _main, NULL, NULL, NULL,
 		    CONFIG_MAIN_THREAD_PRIORITY, K_ESSENTIAL);
+	_thread_stats_init(_main_thread, MAIN_STACK_SIZE);
 	_mark_thread_as_started(_main_thread);
 	_add_thread_to_ready_q(_main_thread);
 
@@ -294,6 +295,7 @@ static void prepare_multithreading(struct k_thread *dummy_thread)
 	_new_thread(_idle_stack, IDLE_STACK_SIZE,
 		    idle, NULL, NULL, NULL,
 		    K_LOWEST_THREAD_PRIO, K_ESSENTIAL);
+	_thread_stats_init(_idle_thread, IDLE_STACK_SIZE);
 	_mark_thread_as_started(_idle_thread);
 	_add_thread_to_ready_q(_idle_thread);
 #endif
@@ -131,6 +131,8 @@ void k_pipe_init(struct k_pipe *pipe, unsigned char *buffer, size_t size)
 	pipe->bytes_used = 0;
 	pipe->read_index = 0;
 	pipe->write_index = 0;
+	pipe->put_claim = 0;
+	pipe->get_claim = 0;
 	sys_dlist_init(&pipe->wait_q.writers);
 	sys_dlist_init(&pipe->wait_q.readers);
 	SYS_TRACING_OBJ_INIT(k_pipe, pipe);
@@ -156,6 +158,33 @@ static size_t _pipe_xfer(unsigned char *dest, size_t dest_size,
 	return num_bytes;
 }
 
+/**
+ * @brief Get the free space of the pipe's circular buffer
+ *
+ * A region claimed by a writer starts at the write index, so the space is
+ * reserved for the claimer: data put after the region could not be read
+ * before it.
+ *
+ * @return Number of bytes that may be put into the pipe's circular buffer
+ */
+static size_t _pipe_space_get(struct k_pipe *pipe)
+{
+	return pipe->put_claim ? 0 : pipe->size - pipe->bytes_used;
+}
+
+/**
+ * @brief Get the data of the pipe's circular buffer
+ *
+ * A region claimed by a reader starts at the read index, so the data is
+ * reserved for the claimer until it is released.
+ *
+ * @return Number of bytes that may be got from the pipe's circular buffer
+ */
+static size_t _pipe_data_get(struct k_pipe *pipe)
+{
+	return pipe->get_claim ? 0 : pipe->bytes_used;
+}
+
 /**
  * @brief Put data from @a src into the pipe's circular buffer
  *
@@ -174,7 +203,7 @@ static size_t _pipe_buffer_put(struct k_pipe *pipe,
 
 
 	for (i = 0; i < 2; i++) {
-		run_length = min(pipe->size - pipe->bytes_used,
+		run_length = min(_pipe_space_get(pipe),
 				 pipe->size - pipe->write_index);
 
 		bytes_copied = _pipe_xfer(pipe->buffer + pipe->write_index,
@@ -210,7 +239,7 @@ static size_t _pipe_buffer_get(struct k_pipe *pipe,
 	int     i;
 
 	for (i = 0; i < 2; i++) {
-		run_length = min(pipe->bytes_used,
+		run_length = min(_pipe_data_get(pipe),
 				 pipe->size - pipe->read_index);
 
 		bytes_copied = _pipe_xfer(dest + num_bytes_read,
@@ -257,6 +286,10 @@ static size_t _pipe_buffer_get(struct k_pipe *pipe,
  * 3. The amount of space available in the pipe is the sum of the bytes unused
  *    in the pipe (@a pipe_space) and all the requests from the waiting readers.
  *
+ * While a region of the pipe's buffer is claimed, the waiting threads are
+ * left pended: data exchanged directly with them would overtake the claimed
+ * region. They are served when the claim is committed or finished.
+ *
  * @return false if request is unsatisfiable, otherwise true
  */
 static bool _pipe_xfer_prepare(sys_dlist_t      *xfer_list,
@@ -265,13 +298,25 @@ static bool _pipe_xfer_prepare(sys_dlist_t      *xfer_list,
 			       size_t            pipe_space,
 			       size_t            bytes_to_xfer,
 			       size_t            min_xfer,
-			       int32_t           timeout)
+			       int32_t           timeout,
+			       bool              claimed)
 {
 	sys_dnode_t      *node;
 	struct k_thread  *thread;
 	struct k_pipe_desc *desc;
 	size_t num_bytes = 0;
 
+	if (claimed) {
+		if (timeout == K_NO_WAIT && pipe_space < min_xfer) {
+			return false;
+		}
+
+		sys_dlist_init(xfer_list);
+		*waiter = NULL;
+
+		return true;
+	}
+
 	if (timeout == K_NO_WAIT) {
 		for (node = sys_dlist_peek_head(wait_q); node != NULL;
 		     node = sys_dlist_peek_next(wait_q, node)) {
@@ -405,8 +450,9 @@ int _k_pipe_put_internal(struct k_pipe *pipe, struct k_pipe_async *async_desc,
 	 */
 
 	if (!_pipe_xfer_prepare(&xfer_list, &reader, &pipe->wait_q.readers,
-				pipe->size - pipe->bytes_used, bytes_to_write,
-				min_xfer, timeout)) {
+				_pipe_space_get(pipe), bytes_to_write,
+				min_xfer, timeout,
+				pipe->put_claim || pipe->get_claim)) {
 		irq_unlock(key);
 		*bytes_written = 0;
 		return -EIO;
@@ -545,8 +591,9 @@ int k_pipe_get(struct k_pipe *pipe, void *data, size_t bytes_to_read,
 	 */
 
 	if (!_pipe_xfer_prepare(&xfer_list, &writer, &pipe->wait_q.writers,
-				pipe->bytes_used, bytes_to_read,
-				min_xfer, timeout)) {
+				_pipe_data_get(pipe), bytes_to_read,
+				min_xfer, timeout,
+				pipe->put_claim || pipe->get_claim)) {
 		irq_unlock(key);
 		*bytes_read = 0;
 		return -EIO;
@@ -700,3 +747,284 @@ void k_pipe_block_put(struct k_pipe *pipe, struct k_mem_block *block,
 				    block->req_size, K_FOREVER);
 }
 #endif
+
+/**
+ * @brief Hand the data of the pipe's circular buffer to waiting readers
+ *
+ * Waiting readers whose request can be completed are readied. The first
+ * reader that can not be satisfied gets what is left and stays pended.
+ * Claimers waiting for data have nothing to transfer and are readied.
+ *
+ * Must be called with the scheduler locked.
+ *
+ * @return true if data was transferred, false otherwise
+ */
+static bool _pipe_readers_feed(struct k_pipe *pipe)
+{
+	struct k_thread    *thread;
+	struct k_pipe_desc *desc;
+	unsigned int   key;
+	size_t         bytes_copied;
+	bool           satisfied;
+	bool           fed = false;
+
+	while (1) {
+		key = irq_lock();
+
+		thread = (struct k_thread *)
+			 sys_dlist_peek_head(&pipe->wait_q.readers);
+		if (!thread) {
+			irq_unlock(key);
+			return fed;
+		}
+
+		desc = (struct k_pipe_desc *)thread->base.swap_data;
+		satisfied = (_pipe_data_get(pipe) >= desc->bytes_to_xfer);
+		if (satisfied) {
+			_unpend_thread(thread);
+			_abort_thread_timeout(thread);
+		}
+
+		irq_unlock(key);
+
+		bytes_copied = _pipe_buffer_get(pipe, desc->buffer,
+						desc->bytes_to_xfer);
+
+		desc->buffer        += bytes_copied;
+		desc->bytes_to_xfer -= bytes_copied;
+		fed |= (bytes_copied > 0);
+
+		if (!satisfied) {
+			return fed;
+		}
+
+		_pipe_thread_ready(thread);
+	}
+}
+
+/**
+ * @brief Move the data of waiting writers into the pipe's circular buffer
+ *
+ * Waiting writers whose request can be completed are readied. The first
+ * writer that can not be satisfied puts what fits and stays pended.
+ * Claimers waiting for space have nothing to transfer and are readied.
+ *
+ * Must be called with the scheduler locked.
+ *
+ * @return true if data was transferred, false otherwise
+ */
+static bool _pipe_writers_drain(struct k_pipe *pipe)
+{
+	struct k_thread    *thread;
+	struct k_pipe_desc *desc;
+	unsigned int   key;
+	size_t         bytes_copied;
+	bool           satisfied;
+	bool           drained = false;
+
+	while (1) {
+		key = irq_lock();
+
+		thread = (struct k_thread *)
+			 sys_dlist_peek_head(&pipe->wait_q.writers);
+		if (!thread) {
+			irq_unlock(key);
+			return drained;
+		}
+
+		desc = (struct k_pipe_desc *)thread->base.swap_data;
+		satisfied = (_pipe_space_get(pipe) >= desc->bytes_to_xfer);
+		if (satisfied) {
+			_unpend_thread(thread);
+			_abort_thread_timeout(thread);
+		}
+
+		irq_unlock(key);
+
+		bytes_copied = _pipe_buffer_put(pipe, desc->buffer,
+						desc->bytes_to_xfer);
+
+		desc->buffer        += bytes_copied;
+		desc->bytes_to_xfer -= bytes_copied;
+		drained |= (bytes_copied > 0);
+
+		if (!satisfied) {
+			return drained;
+		}
+
+		_pipe_thread_ready(thread);
+	}
+}
+
+/**
+ * @brief Serve the threads left pended while a region was claimed
+ *
+ * Readers are fed first, as the data of the pipe's circular buffer comes
+ * before the data of the waiting writers. Each pass may make room or data
+ * for the other direction, so this loops until nothing is transferred.
+ *
+ * Must be called with the scheduler locked.
+ *
+ * @return N/A
+ */
+static void _pipe_waiters_serve(struct k_pipe *pipe)
+{
+	bool progress;
+
+	do {
+		progress = _pipe_readers_feed(pipe);
+		progress |= _pipe_writers_drain(pipe);
+	} while (progress);
+}
+
+/**
+ * @brief Claim a contiguous region of the pipe's circular buffer
+ *
+ * The region is computed by @a avail from the pipe's state. While it is
+ * empty the caller pends on @a wait_q with an empty transfer request, so
+ * that it is readied by the next operation in the opposite direction. Being
+ * readied does not guarantee the region is no longer empty, so the caller
+ * waits again for the rest of its waiting period.
+ *
+ * @return See k_pipe_put_claim() and k_pipe_get_claim()
+ */
+static int _pipe_claim(struct k_pipe *pipe, size_t *claim, _wait_q_t *wait_q,
+		       size_t (*avail)(struct k_pipe *pipe, size_t *index),
+		       void **data, size_t *size, int32_t timeout)
+{
+	struct k_pipe_desc  pipe_desc;
+	int64_t        end = k_uptime_get() + timeout;
+	unsigned int   key;
+	size_t         index;
+	size_t         bytes;
+
+	__ASSERT(data != NULL, "");
+	__ASSERT(size != NULL && *size > 0, "");
+
+	if (pipe->size == 0) {
+		return -ENOTSUP;
+	}
+
+	while (1) {
+		key = irq_lock();
+
+		if (*claim) {
+			irq_unlock(key);
+			return -EBUSY;
+		}
+
+		bytes = avail(pipe, &index);
+		if (bytes) {
+			*size = min(*size, bytes);
+			*claim = *size;
+			*data = pipe->buffer + index;
+			irq_unlock(key);
+			return 0;
+		}
+
+		if (timeout == K_NO_WAIT) {
+			irq_unlock(key);
+			return -EIO;
+		}
+
+		if (timeout != K_FOREVER) {
+			timeout = end - k_uptime_get();
+			if (timeout <= 0) {
+				irq_unlock(key);
+				return -EAGAIN;
+			}
+		}
+
+		pipe_desc.buffer        = NULL;
+		pipe_desc.bytes_to_xfer = 0;
+
+		_current->base.swap_data = &pipe_desc;
+		_pend_current_thread(wait_q, timeout);
+		_Swap(key);
+	}
+}
+
+static size_t _pipe_space_avail(struct k_pipe *pipe, size_t *index)
+{
+	*index = pipe->write_index;
+
+	return min(pipe->size - pipe->bytes_used,
+		   pipe->size - pipe->write_index);
+}
+
+static size_t _pipe_data_avail(struct k_pipe *pipe, size_t *index)
+{
+	*index = pipe->read_index;
+
+	return min(pipe->bytes_used, pipe->size - pipe->read_index);
+}
+
+int k_pipe_put_claim(struct k_pipe *pipe, void **data, size_t *size,
+		     int32_t timeout)
+{
+	return _pipe_claim(pipe, &pipe->put_claim, &pipe->wait_q.writers,
+			   _pipe_space_avail, data, size, timeout);
+}
+
+int k_pipe_put_commit(struct k_pipe *pipe, size_t size)
+{
+	unsigned int  key;
+
+	key = irq_lock();
+
+	if (!pipe->put_claim || size > pipe->put_claim) {
+		irq_unlock(key);
+		return -EINVAL;
+	}
+
+	pipe->put_claim = 0;
+	pipe->bytes_used += size;
+	pipe->write_index += size;
+	if (pipe->write_index == pipe->size) {
+		pipe->write_index = 0;
+	}
+
+	_sched_lock();
+	irq_unlock(key);
+
+	_pipe_waiters_serve(pipe);
+
+	k_sched_unlock();
+
+	return 0;
+}
+
+int k_pipe_get_claim(struct k_pipe *pipe, void **data, size_t *size,
+		     int32_t timeout)
+{
+	return _pipe_claim(pipe, &pipe->get_claim, &pipe->wait_q.readers,
+			   _pipe_data_avail, data, size, timeout);
+}
+
+int k_pipe_get_finish(struct k_pipe *pipe, size_t size)
+{
+	unsigned int  key;
+
+	key = irq_lock();
+
+	if (!pipe->get_claim || size > pipe->get_claim) {
+		irq_unlock(key);
+		return -EINVAL;
+	}
+
+	pipe->get_claim = 0;
+	pipe->bytes_used -= size;
+	pipe->read_index += size;
+	if (pipe->read_index == pipe->size) {
+		pipe->read_index = 0;
+	}
+
+	_sched_lock();
+	irq_unlock(key);
+
+	_pipe_waiters_serve(pipe);
+
+	k_sched_unlock();
+
+	return 0;
+}
@@ -76,6 +76,7 @@ void _add_thread_to_ready_q(struct k_thread *thread)
 
 	_set_ready_q_prio_bit(thread->base.prio);
 	sys_dlist_append(q, &thread->base.k_q_node);
+	_thread_stats_ready(thread);
 
 	struct k_thread **cache = &_ready_q.cache;
 
@@ -104,6 +105,7 @@ void _remove_thread_from_ready_q(struct k_thread *thread)
 	if (sys_dlist_is_empty(q)) {
 		_clear_ready_q_prio_bit(thread->base.prio);
 	}
+	_thread_stats_unready(thread);
 
 	struct k_thread **cache = &_ready_q.cache;
 
@@ -40,6 +40,16 @@ int32_t _sys_idle_elapsed_ticks = 1;
 
 int64_t _sys_clock_tick_count;
 
+#ifdef CONFIG_TICKLESS_KERNEL
+/*
+ * The system timer is not announcing every tick: the ticks elapsed since the
+ * last announcement are also part of the current system tick count.
+ */
+#define _unannounced_ticks() _timer_elapsed_ticks_get()
+#else
+#define _unannounced_ticks() 0
+#endif
+
 /**
  *
  * @brief Return the lower part of the current system tick count
@@ -49,7 +59,7 @@ int64_t _sys_clock_tick_count;
  */
 uint32_t _tick_get_32(void)
 {
-	return (uint32_t)_sys_clock_tick_count;
+	return (uint32_t)_sys_clock_tick_count + _unannounced_ticks();
 }
 FUNC_ALIAS(_tick_get_32, sys_tick_get_32, uint32_t);
 
@@ -76,7 +86,7 @@ int64_t _tick_get(void)
 	 */
 	unsigned int imask = irq_lock();
 
-	tmp_sys_clock_tick_count = _sys_clock_tick_count;
+	tmp_sys_clock_tick_count = _sys_clock_tick_count + _unannounced_ticks();
 	irq_unlock(imask);
 	return tmp_sys_clock_tick_count;
 }
@@ -128,7 +138,7 @@ static ALWAYS_INLINE int64_t _nano_tick_delta(int64_t *reftime)
 	 */
 	unsigned int imask = irq_lock();
 
-	saved = _sys_clock_tick_count;
+	saved = _sys_clock_tick_count + _unannounced_ticks();
 	irq_unlock(imask);
 	delta = saved - (*reftime);
 	*reftime = saved;
@@ -215,15 +225,22 @@ static inline void handle_timeouts(int32_t ticks)
 	 * Dequeue all expired timeouts from _timeout_q, relieving irq lock
 	 * pressure between each of them, allowing handling of higher priority
 	 * interrupts. We know that no new timeout will be prepended in front
-	 * of a timeout which delta is 0, since timeouts of 0 ticks are
+	 * of a timeout which delta is 0 or less, since timeouts of 0 ticks are
 	 * prohibited.
+	 *
+	 * A tickless timer driver may announce more ticks than the head
+	 * timeout was waiting for: the ticks in excess are carried over to the
+	 * following timeouts, which may then expire as well.
 	 */
 	sys_dnode_t *next = &head->node;
 	struct _timeout *timeout = (struct _timeout *)next;
+	int32_t overdue;
 
 	_handling_timeouts = 1;
 
-	while (timeout && timeout->delta_ticks_from_prev == 0) {
+	while (timeout && timeout->delta_ticks_from_prev <= 0) {
+
+		overdue = -timeout->delta_ticks_from_prev;
 
 		sys_dlist_remove(next);
 
@@ -240,6 +257,12 @@ static inline void handle_timeouts(int32_t ticks)
 
 		timeout->delta_ticks_from_prev = _EXPIRED;
 
+		next = sys_dlist_peek_head(&_timeout_q);
+		if (next) {
+			((struct _timeout *)next)->delta_ticks_from_prev -=
+				overdue;
+		}
+
 		irq_unlock(key);
 		key = irq_lock();
 
@@ -297,6 +320,61 @@ static void handle_time_slicing(int32_t ticks)
 #else
 #define handle_time_slicing(ticks) do { } while (0)
 #endif
+
+#ifdef CONFIG_TICKLESS_KERNEL
+/*
+ * Number of ticks, counted from the last announced tick, until the end of the
+ * time slice of @a thread, or K_FOREVER if @a thread is not time sliced.
+ */
+static int32_t time_slice_expiry(struct k_thread *thread)
+{
+#ifdef CONFIG_TIMESLICING
+	int32_t remaining;
+
+	if ((_time_slice_duration == 0) || (thread == _idle_thread) ||
+	    _is_prio_higher(thread->base.prio, _time_slice_prio_ceiling)) {
+		return K_FOREVER;
+	}
+
+	remaining = _time_slice_duration - _time_slice_elapsed;
+
+	return remaining > 0 ? _ms_to_ticks(remaining) : 1;
+#else
+	ARG_UNUSED(thread);
+
+	return K_FOREVER;
+#endif
+}
+
+/*
+ * Program the system timer to expire at the next kernel deadline while
+ * @a thread is running: the first timeout in the _timeout_q or the end of the
+ * thread's time slice, whichever comes first.
+ *
+ * Must be called with interrupts locked.
+ */
+void _sys_clock_next_deadline_set(struct k_thread *thread)
+{
+	int32_t ticks = _get_next_timeout_expiry();
+	int32_t slice = time_slice_expiry(thread);
+
+	if ((slice != K_FOREVER) && ((ticks == K_FOREVER) || (slice < ticks))) {
+		ticks = slice;
+	}
+
+	_timer_expiry_set(ticks);
+}
+
+/*
+ * Called by _Swap() with interrupts locked, right before switching to the
+ * thread cached as the next one to run in the ready queue.
+ */
+void _sys_clock_next_deadline_set_before_swap(void)
+{
+	_sys_clock_next_deadline_set(_kernel.ready_q.cache);
+}
+#endif /* CONFIG_TICKLESS_KERNEL */
+
 /**
  *
  * @brief Announce a tick to the kernel
@@ -322,4 +400,10 @@ void _nano_sys_clock_tick_announce(int32_t ticks)
 
 	/* time slicing is basically handled like just yet another timeout */
 	handle_time_slicing(ticks);
+
+#ifdef CONFIG_TICKLESS_KERNEL
+	key = irq_lock();
+	_sys_clock_next_deadline_set(_current);
+	irq_unlock(key);
+#endif
 }
@@ -156,6 +156,21 @@ void _thread_monitor_exit(struct k_thread *thread)
 
 	irq_unlock(key);
 }
+
+void k_thread_foreach(k_thread_user_cb_t user_cb, void *user_data)
+{
+	struct k_thread *thread;
+
+	__ASSERT(user_cb, "user_cb can not be NULL");
+
+	k_sched_lock();
+
+	for (thread = _kernel.threads; thread; thread = thread->next_thread) {
+		user_cb(thread, user_data);
+	}
+
+	k_sched_unlock();
+}
 #endif /* CONFIG_THREAD_MONITOR */
 
 /*
@@ -244,6 +259,7 @@ k_tid_t k_thread_spawn(char *stack, size_t stack_size,
 	struct k_thread *new_thread = (struct k_thread *)stack;
 
 	_new_thread(stack, stack_size, entry, p1, p2, p3, prio, options);
+	_thread_stats_init(new_thread, stack_size);
 
 	schedule_new_thread(new_thread, delay);
 
@@ -394,6 +410,8 @@ void _init_static_threads(void)
 			thread_data->init_p3,
 			thread_data->init_prio,
 			thread_data->init_options);
+		_thread_stats_init(thread_data->thread,
+				   thread_data->init_stack_size);
 
 		thread_data->thread->init_data = thread_data;
 	}
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Thread runtime statistics
+ *
+ * Each thread keeps a single timestamp: the cycle count when it was last
+ * switched in while it is running, or the cycle count when it was last made
+ * ready while it is waiting in the ready queue. Both states are exclusive, so
+ * the time elapsed since the timestamp is accounted either as execution time
+ * or as ready time when the thread leaves its current state.
+ */
+
+#include <kernel.h>
+#include <kernel_structs.h>
+#include <nano_internal.h>
+#include <string.h>
+
+void _thread_stats_init(struct k_thread *thread, size_t stack_size)
+{
+	memset(&thread->stats, 0, sizeof(thread->stats));
+
+	/* the thread structure lives at the bottom of the stack area */
+	thread->stats.stack_size = stack_size - sizeof(struct k_thread);
+	thread->stats_timestamp = k_cycle_get_32();
+}
+
+/* must be called with interrupts locked */
+void _thread_stats_ready(struct k_thread *thread)
+{
+	if (thread != _current) {
+		thread->stats_timestamp = k_cycle_get_32();
+	}
+}
+
+/* must be called with interrupts locked */
+void _thread_stats_unready(struct k_thread *thread)
+{
+	if (thread != _current) {
+		thread->stats.ready_cycles +=
+			k_cycle_get_32() - thread->stats_timestamp;
+	}
+}
+
+/*
+ * Called by _Swap() right before switching from the current thread to the
+ * thread cached as the next one to run in the ready queue.
+ *
+ * If the outgoing thread is still ready, its new timestamp marks the point
+ * from which it is waiting in the ready queue; if not, the timestamp is set
+ * again when it is made ready.
+ *
+ * _Swap() returns to the current thread when it is still the next one to
+ * run, which is not a switch: the thread keeps running from its timestamp.
+ */
+void _thread_stats_switch(void)
+{
+	struct k_thread *from = _current;
+	struct k_thread *to = _ready_q.cache;
+	unsigned int key;
+	uint32_t now;
+
+	if (from == to) {
+		return;
+	}
+
+	key = irq_lock();
+
+	now = k_cycle_get_32();
+
+	from->stats.execution_cycles += now - from->stats_timestamp;
+	from->stats.switches_out++;
+	from->stats_timestamp = now;
+
+	to->stats.ready_cycles += now - to->stats_timestamp;
+	to->stats.switches_in++;
+	to->stats_timestamp = now;
+
+	irq_unlock(key);
+}
+
+void k_thread_stats_get(k_tid_t thread, struct k_thread_stats *stats)
+{
+	unsigned int key;
+
+	key = irq_lock();
+
+	*stats = thread->stats;
+
+	if (thread == _current) {
+		stats->execution_cycles +=
+			k_cycle_get_32() - thread->stats_timestamp;
+	}
+
+	irq_unlock(key);
+
+#ifdef CONFIG_INIT_STACKS
+	/*
+	 * Stacks grow down towards the thread structure and are filled with
+	 * 0xaa when the thread is created: the bytes that were never written
+	 * to give the high-water mark.
+	 */
+	const unsigned char *stack = (const unsigned char *)thread +
+				     sizeof(struct k_thread);
+	size_t unused = 0;
+
+	while ((unused < stats->stack_size) && (stack[unused] == 0xaa)) {
+		unused++;
+	}
+
+	stats->stack_used = stats->stack_size - unused;
+#endif
+}
@@ -4,7 +4,6 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
-#include <assert.h>
 #include <ctype.h>
 #include <errno.h>
 #include <limits.h>
@@ -13,6 +12,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(CONFIG_NET_BUF)
+#include <net/buf.h>
+#endif
+
 #include "json.h"
 
 struct token {
@@ -241,7 +244,8 @@ static void *lexer_number(struct lexer *lexer)
 	while (true) {
 		char chr = next(lexer);
 
-		if (isdigit(chr) || chr == '.') {
+		if (isdigit(chr) || chr == '.' || chr == 'e' || chr == 'E' ||
+		    chr == '+' || chr == '-') {
 			continue;
 		}
 
@@ -263,6 +267,8 @@ static void *lexer_json(struct lexer *lexer)
 			return NULL;
 		case '}':
 		case '{':
+		case ']':
+		case '[':
 		case ',':
 		case ':':
 			emit(lexer, (enum json_tokens)chr);
@@ -282,6 +288,7 @@ static void *lexer_json(struct lexer *lexer)
 			/* fallthrough */
 		default:
 			if (isspace(chr)) {
+				ignore(lexer);
 				continue;
 			}
 
@@ -370,6 +377,8 @@ static int obj_next(struct json_obj *json, struct json_obj_key_value *kv)
 	}
 
 	switch (kv->value.type) {
+	case JSON_TOK_OBJECT_START:
+	case JSON_TOK_ARRAY_START:
 	case JSON_TOK_STRING:
 	case JSON_TOK_NUMBER:
 	case JSON_TOK_TRUE:
@@ -402,109 +411,444 @@ static int decode_num(const struct token *token, int32_t *num)
 		return -errno;
 	}
 
-	if (*endptr) {
+	if (endptr != token->end) {
 		return -EINVAL;
 	}
 
 	return 0;
 }
 
+static int decode_int64(const struct token *token, int64_t *num)
+{
+	/* strtoll() is not available in minimal libc either */
+	const char *pos = token->start;
+	bool negative = false;
+	uint64_t value = 0;
+
+	if (pos < token->end && *pos == '-') {
+		negative = true;
+		pos++;
+	}
+
+	if (pos == token->end) {
+		return -EINVAL;
+	}
+
+	for (; pos < token->end; pos++) {
+		if (!isdigit(*pos)) {
+			return -EINVAL;
+		}
+
+		if (value > (UINT64_MAX - 9) / 10) {
+			return -ERANGE;
+		}
+
+		value = value * 10 + (*pos - '0');
+	}
+
+	if (value > (uint64_t)INT64_MAX + negative) {
+		return -ERANGE;
+	}
+
+	*num = negative ? (int64_t)(0 - value) : (int64_t)value;
+
+	return 0;
+}
+
+#if defined(CONFIG_JSON_LIBRARY_FLOAT)
+static double scale10(double value, int exp)
+{
+	double factor = 10.0;
+	bool divide = exp < 0;
+
+	if (divide) {
+		exp = -exp;
+	}
+
+	/* Exponentiation by squaring: 10^exp in log2(exp) steps */
+	for (; exp; exp >>= 1) {
+		if (exp & 1) {
+			value = divide ? value / factor : value * factor;
+		}
+
+		factor *= factor;
+	}
+
+	return value;
+}
+
+static int decode_float(const struct token *token, double *num)
+{
+	/* FIXME: no strtod(), see decode_num(). Up to 19 significant
+	 * digits are kept and then scaled, so the result may be off by
+	 * a few units in the last place.
+	 */
+	const char *pos = token->start;
+	bool negative = false;
+	bool digits = false;
+	uint64_t mantissa = 0;
+	int exp = 0;
+	int exp_value = 0;
+	bool exp_negative = false;
+
+	if (pos < token->end && *pos == '-') {
+		negative = true;
+		pos++;
+	}
+
+	for (; pos < token->end && isdigit(*pos); pos++) {
+		digits = true;
+
+		if (mantissa < UINT64_MAX / 10 - 9) {
+			mantissa = mantissa * 10 + (*pos - '0');
+		} else {
+			exp++;
+		}
+	}
+
+	if (pos < token->end && *pos == '.') {
+		for (pos++; pos < token->end && isdigit(*pos); pos++) {
+			digits = true;
+
+			if (mantissa < UINT64_MAX / 10 - 9) {
+				mantissa = mantissa * 10 + (*pos - '0');
+				exp--;
+			}
+		}
+	}
+
+	if (!digits) {
+		return -EINVAL;
+	}
+
+	if (pos < token->end && (*pos == 'e' || *pos == 'E')) {
+		pos++;
+
+		if (pos < token->end && (*pos == '+' || *pos == '-')) {
+			exp_negative = *pos == '-';
+			pos++;
+		}
+
+		if (pos == token->end) {
+			return -EINVAL;
+		}
+
+		for (; pos < token->end && isdigit(*pos); pos++) {
+			if (exp_value < 10000) {
+				exp_value = exp_value * 10 + (*pos - '0');
+			}
+		}
+
+		exp += exp_negative ? -exp_value : exp_value;
+	}
+
+	if (pos != token->end) {
+		return -EINVAL;
+	}
+
+	*num = scale10((double)mantissa, exp);
+	if (negative) {
+		*num = -*num;
+	}
+
+	return 0;
+}
+#endif
+
 static bool equivalent_types(enum json_tokens type1, enum json_tokens type2)
 {
 	if (type1 == JSON_TOK_TRUE || type1 == JSON_TOK_FALSE) {
 		return type2 == JSON_TOK_TRUE || type2 == JSON_TOK_FALSE;
 	}
 
+	if (type1 == JSON_TOK_NUMBER) {
+		return type2 == JSON_TOK_NUMBER ||
+		       type2 == JSON_TOK_NUMBER_INT64 ||
+		       type2 == JSON_TOK_NUMBER_FLOAT;
+	}
+
 	return type1 == type2;
 }
 
-int json_obj_parse(char *payload, size_t len,
-		   const struct json_obj_descr *descr, size_t descr_len,
-		   void *val)
+/* Fields are chained in buckets hashed from the key length and first
+ * character, so looking up a key does not walk the whole descriptor.
+ */
+#define FIELD_BUCKETS 16
+#define FIELD_NONE 0xff
+
+/* Decoded fields are flagged in the bits of an int32_t */
+#define FIELD_MAX 30
+
+struct field_index {
+	uint8_t bucket[FIELD_BUCKETS];
+	uint8_t next[FIELD_MAX];
+};
+
+static inline uint8_t field_hash(const char *key, size_t key_len)
 {
-	struct json_obj obj;
-	struct json_obj_key_value kv;
-	int32_t decoded_fields = 0;
+	if (!key_len) {
+		return 0;
+	}
+
+	return (key_len + (uint8_t)key[0]) % FIELD_BUCKETS;
+}
+
+static void field_index_init(struct field_index *index,
+			     const struct json_obj_descr *descr,
+			     size_t descr_len)
+{
+	uint8_t hash;
 	size_t i;
+
+	memset(index->bucket, FIELD_NONE, sizeof(index->bucket));
+
+	/* Walk backwards so buckets keep the descriptor order */
+	for (i = descr_len; i-- > 0;) {
+		hash = field_hash(descr[i].field_name,
+				  descr[i].field_name_len);
+
+		index->next[i] = index->bucket[hash];
+		index->bucket[hash] = i;
+	}
+}
+
+static int field_index_find(const struct field_index *index,
+			    const struct json_obj_descr *descr,
+			    const char *key, size_t key_len)
+{
+	uint8_t i;
+
+	for (i = index->bucket[field_hash(key, key_len)]; i != FIELD_NONE;
+	     i = index->next[i]) {
+		if (descr[i].field_name_len == key_len &&
+		    !memcmp(descr[i].field_name, key, key_len)) {
+			return i;
+		}
+	}
+
+	return -ENOENT;
+}
+
+static int skip_value(struct json_obj *obj, const struct token *value)
+{
+	struct token token;
+	int depth;
+
+	if (value->type != JSON_TOK_OBJECT_START &&
+	    value->type != JSON_TOK_ARRAY_START) {
+		return 0;
+	}
+
+	for (depth = 1; depth; ) {
+		if (!lexer_next(&obj->lexer, &token)) {
+			return -EINVAL;
+		}
+
+		switch (token.type) {
+		case JSON_TOK_OBJECT_START:
+		case JSON_TOK_ARRAY_START:
+			depth++;
+			break;
+		case JSON_TOK_OBJECT_END:
+		case JSON_TOK_ARRAY_END:
+			depth--;
+			break;
+		case JSON_TOK_ERROR:
+		case JSON_TOK_EOF:
+			return -EINVAL;
+		default:
+			break;
+		}
+	}
+
+	return 0;
+}
+
+static int obj_parse(struct json_obj *obj,
+		     const struct json_obj_descr *descr, size_t descr_len,
+		     void *val);
+
+static int arr_parse(struct json_obj *obj,
+		     const struct json_obj_descr *descr, void *val);
+
+static int decode_value(struct json_obj *obj,
+			const struct json_obj_descr *descr,
+			struct token *value, void *val)
+{
+	void *field = (char *)val + descr->offset;
 	int ret;
 
-	assert(descr_len < (sizeof(decoded_fields) * CHAR_BIT - 1));
+	switch (descr->type) {
+	case JSON_TOK_FALSE:
+	case JSON_TOK_TRUE: {
+		bool *b = field;
 
-	ret = obj_init(&obj, payload, len);
-	if (ret < 0) {
-		return ret;
+		*b = value->type == JSON_TOK_TRUE;
+
+		return 0;
 	}
+	case JSON_TOK_NUMBER:
+		return decode_num(value, field) < 0 ? -EINVAL : 0;
+	case JSON_TOK_NUMBER_INT64:
+		return decode_int64(value, field) < 0 ? -EINVAL : 0;
+#if defined(CONFIG_JSON_LIBRARY_FLOAT)
+	case JSON_TOK_NUMBER_FLOAT:
+		return decode_float(value, field);
+#endif
+	case JSON_TOK_STRING: {
+		char **str = field;
+
+		*value->end = '\0';
+		*str = value->start;
 
-	while (!obj_next(&obj, &kv)) {
-		if (kv.value.type == JSON_TOK_OBJECT_END) {
-			if (decoded_fields == (1 << descr_len) - 1) {
-				return decoded_fields;
-			}
+		return 0;
+	}
+	case JSON_TOK_OBJECT_START:
+		ret = obj_parse(obj, descr->object.sub_descr,
+				descr->object.sub_descr_len, field);
 
+		return ret < 0 ? ret : 0;
+	case JSON_TOK_ARRAY_START:
+		return arr_parse(obj, descr, val);
+	default:
+		return -EINVAL;
+	}
+}
+
+static int arr_parse(struct json_obj *obj,
+		     const struct json_obj_descr *descr, void *val)
+{
+	const struct json_obj_descr elem_descr = {
+		.type = descr->array.element_type,
+		.object = {
+			.sub_descr = descr->array.element_descr,
+			.sub_descr_len = descr->array.element_descr_len,
+		},
+	};
+	size_t *count = (size_t *)((char *)val + descr->array.count_offset);
+	char *elem = (char *)val + descr->offset;
+	struct token token;
+	int ret;
+
+	if (elem_descr.type == JSON_TOK_ARRAY_START) {
+		return -EINVAL;
+	}
+
+	*count = 0;
+
+	if (!lexer_next(&obj->lexer, &token)) {
+		return -EINVAL;
+	}
+
+	if (token.type == JSON_TOK_ARRAY_END) {
+		return 0;
+	}
+
+	while (true) {
+		if (*count == descr->array.n_elements) {
+			return -ENOSPC;
+		}
+
+		if (!equivalent_types(token.type, elem_descr.type)) {
 			return -EINVAL;
 		}
 
-		for (i = 0; i < descr_len; i++) {
-			void *field = (char *)val + descr[i].offset;
+		ret = decode_value(obj, &elem_descr, &token, elem);
+		if (ret < 0) {
+			return ret;
+		}
 
-			/* Field has been decoded already, skip */
-			if (decoded_fields & (1 << i)) {
-				continue;
-			}
+		(*count)++;
+		elem += descr->array.element_size;
 
-			/* Check if it's the i-th field */
-			if (kv.key_len != descr[i].field_name_len) {
-				continue;
-			}
+		/* Match end of array or next element */
+		if (!lexer_next(&obj->lexer, &token)) {
+			return -EINVAL;
+		}
 
-			if (memcmp(kv.key, descr[i].field_name,
-				    descr[i].field_name_len)) {
-				continue;
-			}
+		if (token.type == JSON_TOK_ARRAY_END) {
+			return 0;
+		}
 
-			/* Is the value of the expected type? */
-			if (!equivalent_types(kv.value.type, descr[i].type)) {
-				return -EINVAL;
-			}
+		if (token.type != JSON_TOK_COMMA) {
+			return -EINVAL;
+		}
 
-			/* Store the decoded value */
-			switch (descr[i].type) {
-			case JSON_TOK_FALSE:
-			case JSON_TOK_TRUE: {
-				bool *value = field;
+		if (!lexer_next(&obj->lexer, &token)) {
+			return -EINVAL;
+		}
+	}
+}
 
-				*value = descr[i].type == JSON_TOK_TRUE;
+static int obj_parse(struct json_obj *obj,
+		     const struct json_obj_descr *descr, size_t descr_len,
+		     void *val)
+{
+	struct field_index index;
+	struct json_obj_key_value kv;
+	int32_t decoded_fields = 0;
+	int ret;
+	int i;
 
-				break;
-			}
-			case JSON_TOK_NUMBER: {
-				int32_t *num = field;
+	if (descr_len > FIELD_MAX) {
+		return -EINVAL;
+	}
 
-				if (decode_num(&kv.value, num) < 0) {
-					return -EINVAL;
-				}
+	field_index_init(&index, descr, descr_len);
 
-				break;
+	while (!obj_next(obj, &kv)) {
+		if (kv.value.type == JSON_TOK_OBJECT_END) {
+			if (decoded_fields == (1 << descr_len) - 1) {
+				return decoded_fields;
 			}
-			case JSON_TOK_STRING: {
-				char **str = field;
 
-				*kv.value.end = '\0';
-				*str = kv.value.start;
+			return -EINVAL;
+		}
 
-				break;
-			}
-			default:
-				return -EINVAL;
+		i = field_index_find(&index, descr, kv.key, kv.key_len);
+
+		/* Unknown field, or decoded already: skip its value */
+		if (i < 0 || (decoded_fields & (1 << i))) {
+			ret = skip_value(obj, &kv.value);
+			if (ret < 0) {
+				return ret;
 			}
 
-			decoded_fields |= 1<<i;
+			continue;
+		}
+
+		/* Is the value of the expected type? */
+		if (!equivalent_types(kv.value.type, descr[i].type)) {
+			return -EINVAL;
+		}
+
+		/* Store the decoded value */
+		ret = decode_value(obj, &descr[i], &kv.value, val);
+		if (ret < 0) {
+			return ret;
 		}
+
+		decoded_fields |= 1 << i;
 	}
 
 	return -EINVAL;
 }
 
+int json_obj_parse(char *payload, size_t len,
+		   const struct json_obj_descr *descr, size_t descr_len,
+		   void *val)
+{
+	struct json_obj obj;
+	int ret;
+
+	ret = obj_init(&obj, payload, len);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return obj_parse(&obj, descr, descr_len, val);
+}
+
 static const char escapable[] = "\"\\/\b\f\n\r\t";
 
 static int json_escape_internal(char *str, size_t *len, size_t buf_size)
@@ -562,3 +906,425 @@ ssize_t json_escape(char *str, size_t *len, size_t buf_size)
 
 	return json_escape_internal(str, len, escaped_len);
 }
+
+static int encode_str(const char *str, json_append_bytes_t append_bytes,
+		      void *data)
+{
+	const char *chunk;
+	const char *escape;
+	char escaped[2] = { '\\' };
+	char control[] = "\\u00XX";
+	int ret;
+
+	if (!str) {
+		return append_bytes("null", 4, data);
+	}
+
+	ret = append_bytes("\"", 1, data);
+	if (ret < 0) {
+		return ret;
+	}
+
+	/* Hand over runs of plain characters in one go */
+	for (chunk = str; *str; str++) {
+		escape = memchr(escapable, *str, sizeof(escapable) - 1);
+		if (!escape && (uint8_t)*str >= 0x20) {
+			continue;
+		}
+
+		ret = append_bytes(chunk, str - chunk, data);
+		if (ret < 0) {
+			return ret;
+		}
+
+		/* Other control characters must be escaped as \u00XX */
+		if (escape) {
+			escaped[1] = "\"\\/bfnrt"[escape - escapable];
+			ret = append_bytes(escaped, sizeof(escaped), data);
+		} else {
+			control[4] = "0123456789abcdef"[(uint8_t)*str >> 4];
+			control[5] = "0123456789abcdef"[*str & 0xf];
+			ret = append_bytes(control, sizeof(control) - 1,
+					   data);
+		}
+
+		if (ret < 0) {
+			return ret;
+		}
+
+		chunk = str + 1;
+	}
+
+	ret = append_bytes(chunk, str - chunk, data);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return append_bytes("\"", 1, data);
+}
+
+static int encode_int64(int64_t num, json_append_bytes_t append_bytes,
+			void *data)
+{
+	char buf[sizeof("-9223372036854775808")];
+	char *pos = buf + sizeof(buf);
+	uint64_t value = num < 0 ? 0 - (uint64_t)num : (uint64_t)num;
+
+	do {
+		*--pos = '0' + value % 10;
+		value /= 10;
+	} while (value);
+
+	if (num < 0) {
+		*--pos = '-';
+	}
+
+	return append_bytes(pos, buf + sizeof(buf) - pos, data);
+}
+
+#if defined(CONFIG_JSON_LIBRARY_FLOAT)
+/* Significant digits of the encoded floating point numbers */
+#define FLOAT_DIGITS 9
+
+static int encode_float(double num, json_append_bytes_t append_bytes,
+			void *data)
+{
+	/* Sign, "0.", leading zeros, digits, "e-308" */
+	char buf[1 + 2 + 3 + FLOAT_DIGITS + 5];
+	char digits[FLOAT_DIGITS];
+	char *pos = buf;
+	uint64_t mantissa;
+	int exp = 0;
+	int last;
+	int i;
+
+	/* NaN and infinities have no JSON representation */
+	if (num != num || num - num != 0.0) {
+		return -EINVAL;
+	}
+
+	if (num == 0.0) {
+		return append_bytes("0", 1, data);
+	}
+
+	if (num < 0) {
+		*pos++ = '-';
+		num = -num;
+	}
+
+	/* Bring num within [1, 10) */
+	while (num >= 10.0) {
+		num /= 10.0;
+		exp++;
+	}
+
+	while (num < 1.0) {
+		num *= 10.0;
+		exp--;
+	}
+
+	mantissa = (uint64_t)(scale10(num, FLOAT_DIGITS - 1) + 0.5);
+	if (mantissa >= 1000000000ULL) {
+		mantissa /= 10;
+		exp++;
+	}
+
+	for (i = FLOAT_DIGITS - 1; i >= 0; i--) {
+		digits[i] = '0' + mantissa % 10;
+		mantissa /= 10;
+	}
+
+	for (last = FLOAT_DIGITS - 1; last > 0 && digits[last] == '0';
+	     last--) {
+	}
+
+	if (exp >= 0 && exp < FLOAT_DIGITS) {
+		/* Plain notation: 123.456 */
+		for (i = 0; i <= exp; i++) {
+			*pos++ = digits[i];
+		}
+
+		if (last > exp) {
+			*pos++ = '.';
+			for (; i <= last; i++) {
+				*pos++ = digits[i];
+			}
+		}
+	} else if (exp < 0 && exp >= -3) {
+		/* Plain notation: 0.00123 */
+		*pos++ = '0';
+		*pos++ = '.';
+		for (i = exp + 1; i < 0; i++) {
+			*pos++ = '0';
+		}
+
+		for (i = 0; i <= last; i++) {
+			*pos++ = digits[i];
+		}
+	} else {
+		/* Exponent notation: 1.23e-7 */
+		*pos++ = digits[0];
+		if (last > 0) {
+			*pos++ = '.';
+			for (i = 1; i <= last; i++) {
+				*pos++ = digits[i];
+			}
+		}
+
+		*pos++ = 'e';
+		if (exp < 0) {
+			*pos++ = '-';
+			exp = -exp;
+		}
+
+		if (exp >= 100) {
+			*pos++ = '0' + exp / 100;
+		}
+
+		if (exp >= 10) {
+			*pos++ = '0' + exp / 10 % 10;
+		}
+
+		*pos++ = '0' + exp % 10;
+	}
+
+	return append_bytes(buf, pos - buf, data);
+}
+#endif
+
+static int encode_value(const struct json_obj_descr *descr, const void *val,
+			json_append_bytes_t append_bytes, void *data);
+
+static int encode_array(const struct json_obj_descr *descr, const void *val,
+			json_append_bytes_t append_bytes, void *data)
+{
+	const struct json_obj_descr elem_descr = {
+		.type = descr->array.element_type,
+		.object = {
+			.sub_descr = descr->array.element_descr,
+			.sub_descr_len = descr->array.element_descr_len,
+		},
+	};
+	const char *elem = (const char *)val + descr->offset;
+	size_t count;
+	size_t i;
+	int ret;
+
+	count = *(const size_t *)((const char *)val +
+				  descr->array.count_offset);
+	if (count > descr->array.n_elements ||
+	    elem_descr.type == JSON_TOK_ARRAY_START) {
+		return -EINVAL;
+	}
+
+	ret = append_bytes("[", 1, data);
+	if (ret < 0) {
+		return ret;
+	}
+
+	for (i = 0; i < count; i++) {
+		if (i) {
+			ret = append_bytes(",", 1, data);
+			if (ret < 0) {
+				return ret;
+			}
+		}
+
+		ret = encode_value(&elem_descr, elem, append_bytes, data);
+		if (ret < 0) {
+			return ret;
+		}
+
+		elem += descr->array.element_size;
+	}
+
+	return append_bytes("]", 1, data);
+}
+
+static int encode_value(const struct json_obj_descr *descr, const void *val,
+			json_append_bytes_t append_bytes, void *data)
+{
+	const void *field = (const char *)val + descr->offset;
+
+	switch (descr->type) {
+	case JSON_TOK_FALSE:
+	case JSON_TOK_TRUE:
+		if (*(const bool *)field) {
+			return append_bytes("true", 4, data);
+		}
+
+		return append_bytes("false", 5, data);
+	case JSON_TOK_NUMBER:
+		return encode_int64(*(const int32_t *)field, append_bytes,
+				    data);
+	case JSON_TOK_NUMBER_INT64:
+		return encode_int64(*(const int64_t *)field, append_bytes,
+				    data);
+#if defined(CONFIG_JSON_LIBRARY_FLOAT)
+	case JSON_TOK_NUMBER_FLOAT:
+		return encode_float(*(const double *)field, append_bytes,
+				    data);
+#endif
+	case JSON_TOK_STRING:
+		return encode_str(*(char * const *)field, append_bytes, data);
+	case JSON_TOK_OBJECT_START:
+		return json_obj_encode(descr->object.sub_descr,
+				       descr->object.sub_descr_len, field,
+				       append_bytes, data);
+	case JSON_TOK_ARRAY_START:
+		return encode_array(descr, val, append_bytes, data);
+	default:
+		return -EINVAL;
+	}
+}
+
+int json_obj_encode(const struct json_obj_descr *descr, size_t descr_len,
+		    const void *val, json_append_bytes_t append_bytes,
+		    void *data)
+{
+	size_t i;
+	int ret;
+
+	ret = append_bytes("{", 1, data);
+	if (ret < 0) {
+		return ret;
+	}
+
+	for (i = 0; i < descr_len; i++) {
+		ret = append_bytes(i ? ",\"" : "\"", i ? 2 : 1, data);
+		if (ret < 0) {
+			return ret;
+		}
+
+		ret = append_bytes(descr[i].field_name,
+				   descr[i].field_name_len, data);
+		if (ret < 0) {
+			return ret;
+		}
+
+		ret = append_bytes("\":", 2, data);
+		if (ret < 0) {
+			return ret;
+		}
+
+		ret = encode_value(&descr[i], val, append_bytes, data);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	return append_bytes("}", 1, data);
+}
+
+struct appender {
+	char *buffer;
+	size_t used;
+	size_t size;
+};
+
+static int append_bytes_to_buf(const char *bytes, size_t len, void *data)
+{
+	struct appender *appender = data;
+
+	/* Keep room for the NUL terminator */
+	if (len >= appender->size - appender->used) {
+		return -ENOMEM;
+	}
+
+	memcpy(appender->buffer + appender->used, bytes, len);
+	appender->used += len;
+
+	return 0;
+}
+
+int json_obj_encode_buf(const struct json_obj_descr *descr, size_t descr_len,
+			const void *val, char *buffer, size_t buf_size)
+{
+	struct appender appender = {
+		.buffer = buffer,
+		.size = buf_size,
+	};
+	int ret;
+
+	if (!buf_size) {
+		return -ENOMEM;
+	}
+
+	ret = json_obj_encode(descr, descr_len, val, append_bytes_to_buf,
+			      &appender);
+	if (ret < 0) {
+		return ret;
+	}
+
+	buffer[appender.used] = '\0';
+
+	return 0;
+}
+
+static int measure_bytes(const char *bytes, size_t len, void *data)
+{
+	ssize_t *total = data;
+
+	*total += len;
+
+	return 0;
+}
+
+ssize_t json_calc_encoded_len(const struct json_obj_descr *descr,
+			      size_t descr_len, const void *val)
+{
+	ssize_t total = 0;
+	int ret;
+
+	ret = json_obj_encode(descr, descr_len, val, measure_bytes, &total);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return total;
+}
+
+#if defined(CONFIG_NET_BUF)
+static int append_bytes_to_net_buf(const char *bytes, size_t len,
+				   void *data)
+{
+	struct net_buf **frag = data;
+	size_t room;
+
+	while (len) {
+		room = net_buf_tailroom(*frag);
+		if (!room) {
+			if (!(*frag)->frags) {
+				return -ENOMEM;
+			}
+
+			*frag = (*frag)->frags;
+			continue;
+		}
+
+		room = min(room, len);
+		net_buf_add_mem(*frag, bytes, room);
+		bytes += room;
+		len -= room;
+	}
+
+	return 0;
+}
+
+int json_obj_encode_net_buf(const struct json_obj_descr *descr,
+			    size_t descr_len, const void *val,
+			    struct net_buf *buf)
+{
+	struct net_buf *frag = buf;
+
+	/* Start after the data already in the chain */
+	for (; buf; buf = buf->frags) {
+		if (buf->len) {
+			frag = buf;
+		}
+	}
+
+	return json_obj_encode(descr, descr_len, val,
+			       append_bytes_to_net_buf, &frag);
+}
+#endif
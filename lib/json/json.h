@@ -7,18 +7,25 @@
 #ifndef __JSON_H
 #define __JSON_H
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <sys/types.h>
+#include <misc/util.h>
 
 enum json_tokens {
 	JSON_TOK_NONE = '_',
 	JSON_TOK_OBJECT_START = '{',
 	JSON_TOK_OBJECT_END = '}',
+	JSON_TOK_ARRAY_START = '[',
+	JSON_TOK_ARRAY_END = ']',
 	JSON_TOK_STRING = '"',
 	JSON_TOK_COLON = ':',
 	JSON_TOK_COMMA = ',',
 	JSON_TOK_NUMBER = '0',
+	/* Only used in descriptors: both are decoded from JSON_TOK_NUMBER */
+	JSON_TOK_NUMBER_INT64 = 'L',
+	JSON_TOK_NUMBER_FLOAT = 'F',
 	JSON_TOK_TRUE = 't',
 	JSON_TOK_FALSE = 'f',
 	JSON_TOK_NULL = 'n',
@@ -31,12 +38,135 @@ struct json_obj_descr {
 	size_t field_name_len;
 	size_t offset;
 
-	/* Valid values here: JSON_TOK_STRING, JSON_TOK_NUMBER,
-	 * JSON_TOK_TRUE, JSON_TOK_FALSE. (All others ignored.)
+	/* Valid values here: JSON_TOK_STRING, JSON_TOK_NUMBER (int32_t),
+	 * JSON_TOK_NUMBER_INT64 (int64_t), JSON_TOK_NUMBER_FLOAT (double,
+	 * if CONFIG_JSON_LIBRARY_FLOAT is set), JSON_TOK_TRUE and
+	 * JSON_TOK_FALSE (bool), JSON_TOK_OBJECT_START and
+	 * JSON_TOK_ARRAY_START. (All others ignored.)
 	 */
 	enum json_tokens type;
+
+	union {
+		/* JSON_TOK_OBJECT_START: descriptor of the nested struct */
+		struct {
+			const struct json_obj_descr *sub_descr;
+			size_t sub_descr_len;
+		} object;
+
+		/* JSON_TOK_ARRAY_START: the field is a C array of at most
+		 * n_elements elements of element_size bytes; the number of
+		 * elements in use is the size_t at count_offset in the
+		 * enclosing struct. Arrays of arrays are not supported.
+		 */
+		struct {
+			enum json_tokens element_type;
+			const struct json_obj_descr *element_descr;
+			size_t element_descr_len;
+			size_t element_size;
+			size_t n_elements;
+			size_t count_offset;
+		} array;
+	};
 };
 
+/**
+ * @brief Describes a field of type string, number or boolean
+ *
+ * @param struct_ Struct holding the field
+ * @param field_name_ Name of the field, used as the JSON key as well
+ * @param type_ JSON_TOK_STRING, JSON_TOK_NUMBER, JSON_TOK_NUMBER_INT64,
+ * JSON_TOK_NUMBER_FLOAT or JSON_TOK_TRUE
+ */
+#define JSON_OBJ_DESCR_PRIM(struct_, field_name_, type_) \
+	{ \
+		.field_name = (#field_name_), \
+		.field_name_len = sizeof(#field_name_) - 1, \
+		.offset = offsetof(struct_, field_name_), \
+		.type = type_, \
+	}
+
+/**
+ * @brief Describes a field holding a nested struct
+ *
+ * @param struct_ Struct holding the field
+ * @param field_name_ Name of the field, used as the JSON key as well
+ * @param sub_descr_ Array of descriptors of the nested struct
+ */
+#define JSON_OBJ_DESCR_OBJECT(struct_, field_name_, sub_descr_) \
+	{ \
+		.field_name = (#field_name_), \
+		.field_name_len = sizeof(#field_name_) - 1, \
+		.offset = offsetof(struct_, field_name_), \
+		.type = JSON_TOK_OBJECT_START, \
+		.object = { \
+			.sub_descr = sub_descr_, \
+			.sub_descr_len = ARRAY_SIZE(sub_descr_), \
+		}, \
+	}
+
+/**
+ * @brief Describes an array of strings, numbers or booleans
+ *
+ * @param struct_ Struct holding the field
+ * @param field_name_ Name of the array, used as the JSON key as well
+ * @param len_field_ Name of the size_t field holding the element count
+ * @param elem_type_ Type of the elements, as in JSON_OBJ_DESCR_PRIM()
+ */
+#define JSON_OBJ_DESCR_ARRAY(struct_, field_name_, len_field_, elem_type_) \
+	{ \
+		.field_name = (#field_name_), \
+		.field_name_len = sizeof(#field_name_) - 1, \
+		.offset = offsetof(struct_, field_name_), \
+		.type = JSON_TOK_ARRAY_START, \
+		.array = { \
+			.element_type = elem_type_, \
+			.element_size = \
+				sizeof(((struct_ *)0)->field_name_[0]), \
+			.n_elements = \
+				ARRAY_SIZE(((struct_ *)0)->field_name_), \
+			.count_offset = offsetof(struct_, len_field_), \
+		}, \
+	}
+
+/**
+ * @brief Describes an array of nested structs
+ *
+ * @param struct_ Struct holding the field
+ * @param field_name_ Name of the array, used as the JSON key as well
+ * @param len_field_ Name of the size_t field holding the element count
+ * @param elem_descr_ Array of descriptors of the element struct
+ */
+#define JSON_OBJ_DESCR_OBJ_ARRAY(struct_, field_name_, len_field_, \
+				 elem_descr_) \
+	{ \
+		.field_name = (#field_name_), \
+		.field_name_len = sizeof(#field_name_) - 1, \
+		.offset = offsetof(struct_, field_name_), \
+		.type = JSON_TOK_ARRAY_START, \
+		.array = { \
+			.element_type = JSON_TOK_OBJECT_START, \
+			.element_descr = elem_descr_, \
+			.element_descr_len = ARRAY_SIZE(elem_descr_), \
+			.element_size = \
+				sizeof(((struct_ *)0)->field_name_[0]), \
+			.n_elements = \
+				ARRAY_SIZE(((struct_ *)0)->field_name_), \
+			.count_offset = offsetof(struct_, len_field_), \
+		}, \
+	}
+
+/**
+ * @brief Function called by the encoder to output a chunk of JSON text
+ *
+ * @param bytes Pointer to the chunk, not NUL-terminated
+ * @param len Length of the chunk
+ * @param data User data passed to json_obj_encode()
+ *
+ * @return 0 on success, a negative value to abort the encoding
+ */
+typedef int (*json_append_bytes_t)(const char *bytes, size_t len,
+				   void *data);
+
 /**
  * @brief Parses the JSON-encoded object pointer to by @param json, with
  * size @param len, according to the descriptor pointed to by @param descr.
@@ -55,11 +185,17 @@ struct json_obj_descr {
  *         .type = JSON_TOK_STRING }
  *    };
  *
+ * Nested objects and arrays are described with the JSON_OBJ_DESCR_*()
+ * macros; every nested object must have all of its fields present.
+ * Keys are looked up through a hash of their length and first character
+ * built from the descriptor, and values of unknown keys (including
+ * nested objects and arrays) are skipped.
+ *
  * Since this parser is designed for machine-to-machine communications,
  * some liberties were taken to simplify the design: (1) strings are not
- * unescaped; (2) no UTF-8 validation is performed; (3) only integer
- * numbers are supported; (4) nested objects are not supported, including
- * arrays and objects within objects.
+ * unescaped; (2) no UTF-8 validation is performed; (3) floating point
+ * numbers are only supported with CONFIG_JSON_LIBRARY_FLOAT, and are not
+ * correctly rounded; (4) arrays of arrays are not supported.
  *
  * @param json Pointer to JSON-encoded value to be parsed
  *
@@ -69,7 +205,7 @@ struct json_obj_descr {
  *
  * @param descr_len Number of elements in the descriptor array. Must be less
  * than 31 due to implementation detail reasons (if more fields are
- * necessary, use two descriptors)
+ * necessary, use two descriptors), -EINVAL is returned otherwise
  *
  * @param val Pointer to the struct to hold the decoded values
  *
@@ -80,6 +216,91 @@ int json_obj_parse(char *json, size_t len,
 	const struct json_obj_descr *descr, size_t descr_len,
 	void *val);
 
+/**
+ * @brief Encodes the struct pointed to by @param val as a JSON object,
+ * according to the descriptor pointed to by @param descr. The text is
+ * handed in chunks to @param append_bytes, nothing is allocated.
+ *
+ * Strings are escaped, NULL strings are encoded as null. Field names
+ * are output verbatim and must not need escaping.
+ *
+ * @param descr Pointer to the descriptor array
+ *
+ * @param descr_len Number of elements in the descriptor array
+ *
+ * @param val Pointer to the struct holding the values to encode
+ *
+ * @param append_bytes Function called with each chunk of JSON text
+ *
+ * @param data User data passed to @param append_bytes
+ *
+ * @return 0 on success, the error returned by @param append_bytes, or
+ * -EINVAL if a value cannot be represented
+ */
+int json_obj_encode(const struct json_obj_descr *descr, size_t descr_len,
+		    const void *val, json_append_bytes_t append_bytes,
+		    void *data);
+
+/**
+ * @brief Encodes a struct as a NUL-terminated JSON object into a buffer
+ *
+ * @param descr Pointer to the descriptor array
+ *
+ * @param descr_len Number of elements in the descriptor array
+ *
+ * @param val Pointer to the struct holding the values to encode
+ *
+ * @param buffer Buffer receiving the JSON text
+ *
+ * @param buf_size Size of the buffer, including the NUL terminator
+ *
+ * @return 0 on success, -ENOMEM if the buffer is too small, or -EINVAL
+ * if a value cannot be represented
+ */
+int json_obj_encode_buf(const struct json_obj_descr *descr, size_t descr_len,
+			const void *val, char *buffer, size_t buf_size);
+
+/**
+ * @brief Calculates the length of the JSON encoding of a struct
+ *
+ * @param descr Pointer to the descriptor array
+ *
+ * @param descr_len Number of elements in the descriptor array
+ *
+ * @param val Pointer to the struct holding the values to encode
+ *
+ * @return The length, without NUL terminator, or -EINVAL if a value
+ * cannot be represented
+ */
+ssize_t json_calc_encoded_len(const struct json_obj_descr *descr,
+			      size_t descr_len, const void *val);
+
+#if defined(CONFIG_NET_BUF)
+struct net_buf;
+
+/**
+ * @brief Encodes a struct as a JSON object into a net_buf chain
+ *
+ * The text is appended after the data of the last fragment holding any,
+ * spilling into the fragments that follow it. No fragment is allocated:
+ * the chain must already have enough tailroom.
+ *
+ * @param descr Pointer to the descriptor array
+ *
+ * @param descr_len Number of elements in the descriptor array
+ *
+ * @param val Pointer to the struct holding the values to encode
+ *
+ * @param buf First buffer of the chain
+ *
+ * @return 0 on success, -ENOMEM if the chain is too small, or -EINVAL
+ * if a value cannot be represented
+ */
+int json_obj_encode_net_buf(const struct json_obj_descr *descr,
+			    size_t descr_len, const void *val,
+			    struct net_buf *buf);
+#endif
+
 /**
  * @brief Escapes the string so it can be used to encode JSON objects
  *
@@ -107,4 +328,122 @@ ssize_t json_escape(char *str, size_t *len, size_t buf_size);
  */
 size_t json_calc_escaped_len(const char *str, size_t len);
 
+#if defined(CONFIG_JSON_STREAM)
+struct json_stream;
+
+/* Longest number the incremental parser accepts */
+#define JSON_STREAM_NUMBER_LEN 32
+
+/**
+ * @brief Event reported by the incremental parser
+ *
+ * type is JSON_TOK_OBJECT_START, JSON_TOK_OBJECT_END,
+ * JSON_TOK_ARRAY_START, JSON_TOK_ARRAY_END, JSON_TOK_STRING,
+ * JSON_TOK_NUMBER, JSON_TOK_TRUE, JSON_TOK_FALSE or JSON_TOK_NULL.
+ *
+ * key is the key of the value when it is a member of an object, and NULL
+ * otherwise (array elements, end of containers). depth is the number of
+ * containers enclosing the value, 0 for the document itself.
+ *
+ * value points to the text of strings (without quotes, not unescaped),
+ * numbers and literals. Strings are not copied: a string spanning several
+ * chunks is reported in several events, all but the last one having
+ * partial set. The pointers are only valid during the callback.
+ */
+struct json_stream_event {
+	enum json_tokens type;
+	const char *key;
+	size_t key_len;
+	const char *value;
+	size_t value_len;
+	uint8_t depth;
+	bool partial;
+};
+
+/**
+ * @brief Function called by the incremental parser for each event
+ *
+ * @return 0 to carry on parsing, a negative value to abort it
+ */
+typedef int (*json_stream_cb_t)(struct json_stream *stream,
+				const struct json_stream_event *event,
+				void *user_data);
+
+/**
+ * @brief State of the incremental parser, kept between chunks
+ *
+ * Keys and numbers are copied here, as they may span chunks; up to 32
+ * levels of nesting are supported.
+ */
+struct json_stream {
+	json_stream_cb_t cb;
+	void *user_data;
+	const char *literal;
+	/* Bit n is set if the container at depth n is an object */
+	uint32_t objects;
+	uint8_t depth;
+	uint8_t state;
+	uint8_t escape;
+	uint8_t literal_pos;
+	uint8_t key_len;
+	uint8_t number_len;
+	uint8_t number_state;
+	char key[CONFIG_JSON_STREAM_KEY_LEN];
+	char number[JSON_STREAM_NUMBER_LEN];
+};
+
+/**
+ * @brief Prepares the incremental parser for a new document
+ *
+ * The document must be an object or an array.
+ *
+ * @param stream Parser state
+ *
+ * @param cb Function called for each event
+ *
+ * @param user_data User data passed to @param cb
+ */
+void json_stream_init(struct json_stream *stream, json_stream_cb_t cb,
+		      void *user_data);
+
+/**
+ * @brief Feeds the next chunk of the document to the incremental parser
+ *
+ * Chunks may be split anywhere. Only whitespace may follow the end of
+ * the document.
+ *
+ * @param stream Parser state
+ *
+ * @param data Pointer to the chunk, which is not modified
+ *
+ * @param len Length of the chunk
+ *
+ * @return 1 if the document is complete, 0 if more data is expected,
+ * -EINVAL on malformed JSON, -ENOMEM if a key or a number is too long
+ * or the document too deeply nested, or the error returned by the
+ * callback. Once an error has been returned, -EINVAL is returned until
+ * the parser is initialized anew.
+ */
+int json_stream_feed(struct json_stream *stream, const char *data,
+		     size_t len);
+
+#if defined(CONFIG_NET_BUF)
+/**
+ * @brief Feeds the data of a net_buf chain to the incremental parser
+ *
+ * Each fragment is fed in place, the chain is not linearized.
+ *
+ * @param stream Parser state
+ *
+ * @param buf First buffer of the chain
+ *
+ * @param offset Offset of the JSON data within the chain
+ *
+ * @return As json_stream_feed()
+ */
+int json_stream_feed_net_buf(struct json_stream *stream, struct net_buf *buf,
+			     uint16_t offset);
+#endif
+#endif /* CONFIG_JSON_STREAM */
+
 #endif /* __JSON_H */
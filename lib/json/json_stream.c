@@ -0,0 +1,506 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(CONFIG_NET_BUF)
+#include <net/buf.h>
+#endif
+
+#include "json.h"
+
+/* Unlike the lexer in json.c, which needs the whole document, this
+ * parser is driven one character at a time, so everything it needs to
+ * resume in the middle of a token is kept in struct json_stream.
+ */
+enum stream_state {
+	STATE_START,
+	STATE_VALUE,
+	STATE_VALUE_OR_END,
+	STATE_KEY,
+	STATE_KEY_OR_END,
+	STATE_IN_KEY,
+	STATE_COLON,
+	STATE_IN_STRING,
+	STATE_IN_NUMBER,
+	STATE_IN_LITERAL,
+	STATE_AFTER_VALUE,
+	STATE_DONE,
+	STATE_ERROR,
+};
+
+#define MAX_DEPTH 32
+
+/* Escape states: after a backslash, then the 4 hex digits of \uXXXX */
+#define ESCAPE_NONE 0
+#define ESCAPE_START 1
+#define ESCAPE_HEX 2
+
+/* Number states, the parts of RFC 7159 section 6 seen so far */
+#define NUMBER_MINUS 0
+#define NUMBER_ZERO 1
+#define NUMBER_INT 2
+#define NUMBER_POINT 3
+#define NUMBER_FRAC 4
+#define NUMBER_EXP 5
+#define NUMBER_EXP_SIGN 6
+#define NUMBER_EXP_INT 7
+
+static inline bool in_object(struct json_stream *stream)
+{
+	return stream->depth && (stream->objects & BIT(stream->depth - 1));
+}
+
+static int report(struct json_stream *stream, enum json_tokens type,
+		  const char *value, size_t value_len, bool partial)
+{
+	struct json_stream_event event = {
+		.type = type,
+		.value = value,
+		.value_len = value_len,
+		.depth = stream->depth,
+		.partial = partial,
+	};
+
+	if (in_object(stream) && type != JSON_TOK_OBJECT_END &&
+	    type != JSON_TOK_ARRAY_END) {
+		event.key = stream->key;
+		event.key_len = stream->key_len;
+	}
+
+	return stream->cb(stream, &event, stream->user_data);
+}
+
+static int container_start(struct json_stream *stream, bool object)
+{
+	int ret;
+
+	if (stream->depth == MAX_DEPTH) {
+		return -ENOMEM;
+	}
+
+	ret = report(stream, object ? JSON_TOK_OBJECT_START :
+		     JSON_TOK_ARRAY_START, NULL, 0, false);
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (object) {
+		stream->objects |= BIT(stream->depth);
+		stream->state = STATE_KEY_OR_END;
+	} else {
+		stream->objects &= ~BIT(stream->depth);
+		stream->state = STATE_VALUE_OR_END;
+	}
+
+	stream->depth++;
+
+	return 0;
+}
+
+static int container_end(struct json_stream *stream, bool object)
+{
+	if (!stream->depth || in_object(stream) != object) {
+		return -EINVAL;
+	}
+
+	stream->depth--;
+	stream->state = stream->depth ? STATE_AFTER_VALUE : STATE_DONE;
+
+	return report(stream, object ? JSON_TOK_OBJECT_END :
+		      JSON_TOK_ARRAY_END, NULL, 0, false);
+}
+
+/* Checks one character of a string: returns 1 if it closes the string,
+ * 0 if it does not, or a negative error.
+ */
+static int string_char(struct json_stream *stream, char chr)
+{
+	switch (stream->escape) {
+	case ESCAPE_NONE:
+		if (chr == '\\') {
+			stream->escape = ESCAPE_START;
+			return 0;
+		}
+
+		return chr == '"';
+	case ESCAPE_START:
+		switch (chr) {
+		case '"':
+		case '\\':
+		case '/':
+		case 'b':
+		case 'f':
+		case 'n':
+		case 'r':
+		case 't':
+			stream->escape = ESCAPE_NONE;
+			return 0;
+		case 'u':
+			stream->escape = ESCAPE_HEX;
+			return 0;
+		default:
+			return -EINVAL;
+		}
+	default:
+		if (!isxdigit(chr)) {
+			return -EINVAL;
+		}
+
+		if (++stream->escape == ESCAPE_HEX + 4) {
+			stream->escape = ESCAPE_NONE;
+		}
+
+		return 0;
+	}
+}
+
+static int value_start(struct json_stream *stream, char chr)
+{
+	switch (chr) {
+	case '{':
+		return container_start(stream, true);
+	case '[':
+		return container_start(stream, false);
+	case '"':
+		stream->escape = ESCAPE_NONE;
+		stream->state = STATE_IN_STRING;
+		return 0;
+	case 't':
+		stream->literal = "true";
+		break;
+	case 'f':
+		stream->literal = "false";
+		break;
+	case 'n':
+		stream->literal = "null";
+		break;
+	default:
+		if (chr == '-') {
+			stream->number_state = NUMBER_MINUS;
+		} else if (chr == '0') {
+			stream->number_state = NUMBER_ZERO;
+		} else if (isdigit(chr)) {
+			stream->number_state = NUMBER_INT;
+		} else {
+			return -EINVAL;
+		}
+
+		stream->number[0] = chr;
+		stream->number_len = 1;
+		stream->state = STATE_IN_NUMBER;
+		return 0;
+	}
+
+	stream->literal_pos = 1;
+	stream->state = STATE_IN_LITERAL;
+
+	return 0;
+}
+
+static int structural_char(struct json_stream *stream, char chr)
+{
+	switch (stream->state) {
+	case STATE_START:
+		if (chr != '{' && chr != '[') {
+			return -EINVAL;
+		}
+
+		return value_start(stream, chr);
+	case STATE_VALUE_OR_END:
+		if (chr == ']') {
+			return container_end(stream, false);
+		}
+
+		/* fallthrough */
+	case STATE_VALUE:
+		return value_start(stream, chr);
+	case STATE_KEY_OR_END:
+		if (chr == '}') {
+			return container_end(stream, true);
+		}
+
+		/* fallthrough */
+	case STATE_KEY:
+		if (chr != '"') {
+			return -EINVAL;
+		}
+
+		stream->escape = ESCAPE_NONE;
+		stream->key_len = 0;
+		stream->state = STATE_IN_KEY;
+		return 0;
+	case STATE_COLON:
+		if (chr != ':') {
+			return -EINVAL;
+		}
+
+		stream->state = STATE_VALUE;
+		return 0;
+	case STATE_AFTER_VALUE:
+		switch (chr) {
+		case ',':
+			stream->state = in_object(stream) ? STATE_KEY :
+				STATE_VALUE;
+			return 0;
+		case '}':
+			return container_end(stream, true);
+		case ']':
+			return container_end(stream, false);
+		default:
+			return -EINVAL;
+		}
+	default:
+		return -EINVAL;
+	}
+}
+
+/* Checks one character of a number: returns 1 if it belongs to the
+ * number, 0 if it ends it, or a negative error.
+ */
+static int number_char(struct json_stream *stream, char chr)
+{
+	bool exp = chr == 'e' || chr == 'E';
+
+	switch (stream->number_state) {
+	case NUMBER_MINUS:
+		if (!isdigit(chr)) {
+			return -EINVAL;
+		}
+
+		stream->number_state = chr == '0' ? NUMBER_ZERO : NUMBER_INT;
+		return 1;
+	case NUMBER_INT:
+		if (isdigit(chr)) {
+			return 1;
+		}
+
+		/* fallthrough */
+	case NUMBER_ZERO:
+		if (chr == '.') {
+			stream->number_state = NUMBER_POINT;
+			return 1;
+		}
+
+		if (exp) {
+			stream->number_state = NUMBER_EXP;
+			return 1;
+		}
+
+		break;
+	case NUMBER_POINT:
+		if (!isdigit(chr)) {
+			return -EINVAL;
+		}
+
+		stream->number_state = NUMBER_FRAC;
+		return 1;
+	case NUMBER_FRAC:
+		if (isdigit(chr)) {
+			return 1;
+		}
+
+		if (exp) {
+			stream->number_state = NUMBER_EXP;
+			return 1;
+		}
+
+		break;
+	case NUMBER_EXP:
+		if (chr == '+' || chr == '-') {
+			stream->number_state = NUMBER_EXP_SIGN;
+			return 1;
+		}
+
+		/* fallthrough */
+	case NUMBER_EXP_SIGN:
+		if (!isdigit(chr)) {
+			return -EINVAL;
+		}
+
+		stream->number_state = NUMBER_EXP_INT;
+		return 1;
+	default:
+		if (isdigit(chr)) {
+			return 1;
+		}
+
+		break;
+	}
+
+	/* The number is complete, it cannot go on with a leading zero,
+	 * a second fraction or exponent, or a sign.
+	 */
+	if (isdigit(chr) || chr == '.' || exp || chr == '+' || chr == '-') {
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+/* Consumes characters from *pos, returns a negative error or 0 */
+static int stream_step(struct json_stream *stream, const char **pos,
+		       const char *end)
+{
+	const char *start = *pos;
+	int ret;
+
+	switch (stream->state) {
+	case STATE_IN_STRING:
+		/* Report the string in place, in as few pieces as possible */
+		for (; *pos < end; (*pos)++) {
+			ret = string_char(stream, **pos);
+			if (ret < 0) {
+				return ret;
+			}
+
+			if (ret) {
+				stream->state = STATE_AFTER_VALUE;
+				ret = report(stream, JSON_TOK_STRING, start,
+					     *pos - start, false);
+				(*pos)++;
+				return ret;
+			}
+		}
+
+		if (*pos == start) {
+			return 0;
+		}
+
+		return report(stream, JSON_TOK_STRING, start, *pos - start,
+			      true);
+	case STATE_IN_KEY:
+		for (; *pos < end; (*pos)++) {
+			ret = string_char(stream, **pos);
+			if (ret < 0) {
+				return ret;
+			}
+
+			if (ret) {
+				stream->state = STATE_COLON;
+				(*pos)++;
+				return 0;
+			}
+
+			if (stream->key_len == sizeof(stream->key)) {
+				return -ENOMEM;
+			}
+
+			stream->key[stream->key_len++] = **pos;
+		}
+
+		return 0;
+	case STATE_IN_NUMBER:
+		for (; *pos < end; (*pos)++) {
+			ret = number_char(stream, **pos);
+			if (ret < 0) {
+				return ret;
+			}
+
+			if (!ret) {
+				break;
+			}
+
+			if (stream->number_len == sizeof(stream->number)) {
+				return -ENOMEM;
+			}
+
+			stream->number[stream->number_len++] = **pos;
+		}
+
+		if (*pos == end) {
+			return 0;
+		}
+
+		/* The number ends with the current character, which is
+		 * left for the next step.
+		 */
+		stream->state = STATE_AFTER_VALUE;
+		return report(stream, JSON_TOK_NUMBER, stream->number,
+			      stream->number_len, false);
+	case STATE_IN_LITERAL:
+		if (**pos != stream->literal[stream->literal_pos]) {
+			return -EINVAL;
+		}
+
+		(*pos)++;
+
+		if (stream->literal[++stream->literal_pos]) {
+			return 0;
+		}
+
+		stream->state = STATE_AFTER_VALUE;
+		return report(stream, (enum json_tokens)stream->literal[0],
+			      stream->literal, stream->literal_pos, false);
+	default:
+		if (isspace(**pos)) {
+			(*pos)++;
+			return 0;
+		}
+
+		return structural_char(stream, *(*pos)++);
+	}
+}
+
+void json_stream_init(struct json_stream *stream, json_stream_cb_t cb,
+		      void *user_data)
+{
+	memset(stream, 0, sizeof(*stream));
+
+	stream->cb = cb;
+	stream->user_data = user_data;
+	stream->state = STATE_START;
+}
+
+int json_stream_feed(struct json_stream *stream, const char *data,
+		     size_t len)
+{
+	const char *end = data + len;
+	int ret;
+
+	if (stream->state == STATE_ERROR) {
+		return -EINVAL;
+	}
+
+	while (data < end) {
+		ret = stream_step(stream, &data, end);
+		if (ret < 0) {
+			stream->state = STATE_ERROR;
+			return ret;
+		}
+	}
+
+	return stream->state == STATE_DONE;
+}
+
+#if defined(CONFIG_NET_BUF)
+int json_stream_feed_net_buf(struct json_stream *stream, struct net_buf *buf,
+			     uint16_t offset)
+{
+	int ret = stream->state == STATE_DONE;
+
+	for (; buf; buf = buf->frags) {
+		if (offset >= buf->len) {
+			offset -= buf->len;
+			continue;
+		}
+
+		ret = json_stream_feed(stream, (const char *)buf->data + offset,
+				       buf->len - offset);
+		if (ret < 0) {
+			return ret;
+		}
+
+		offset = 0;
+	}
+
+	return ret;
+}
+#endif
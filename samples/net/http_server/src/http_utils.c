@@ -36,14 +36,6 @@ void print_ipaddr(const struct sockaddr *ip_addr)
 	printf("Address: %s, port: %d\n", str, ntohs(port));
 }
 
-void print_client_banner(const struct sockaddr *addr)
-{
-	printf("\n----------------------------------------------------\n");
-	printf("[%s:%d] Connection accepted\n", __func__, __LINE__);
-	print_ipaddr(addr);
-}
-
-
 void print_server_banner(const struct sockaddr *addr)
 {
 	printf("Zephyr HTTP Server\n");
@@ -11,8 +11,6 @@
 
 #define RC_STR(rc)	(rc == 0 ? "OK" : "ERROR")
 
-void print_client_banner(const struct sockaddr *addr);
-
 void print_server_banner(const struct sockaddr *addr);
 
 #endif
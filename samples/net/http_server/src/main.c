@@ -1,52 +1,141 @@
-/*
- * Copyright (c) 2017 Intel Corporation
- *
- * SPDX-License-Identifier: Apache-2.0
- */
-
 #include <zephyr.h>
+#include <stdio.h>
+#include <string.h>
 #include <net/net_context.h>
+#include <net/http_server.h>
 
 #include <misc/printk.h>
 
-#include "http_types.h"
-#include "http_server.h"
 #include "http_utils.h"
-#include "http_write_utils.h"
 #include "config.h"
 
+#define HTML_STR_HEADER		"<html><head>\r\n" \
+				"<title>Zephyr HTTP Server</title>\r\n" \
+				"</head>\r\n"
+
+#define HTML_STR_FOOTER		"</html>\r\n"
+
 /* Sets the network parameters */
 static
-int network_setup(struct net_context **net_ctx, net_tcp_accept_cb_t accept_cb,
-		  const char *addr, uint16_t port);
+int network_setup(const char *addr, uint16_t port);
 
 #if defined(CONFIG_MBEDTLS)
 #include "ssl_utils.h"
 #endif
 
-void main(void)
+/* Sent from flash, as they are */
+static const char it_works_html[] = HTML_STR_HEADER
+	"<body><h1><center>It Works!</center></h1></body>\r\n"
+	HTML_STR_FOOTER;
+
+static const char soft_404_html[] = HTML_STR_HEADER
+	"<body><h1><center>404 Not Found</center></h1></body>\r\n"
+	HTML_STR_FOOTER;
+
+#define HTTP_MAX_BODY_STR_SIZE		512
+static char html_body[HTTP_MAX_BODY_STR_SIZE];
+
+/* Prints the received HTTP header fields as an HTML list */
+static int print_http_headers(const struct http_server_request *req,
+			      char *str, uint16_t size)
+{
+	const char *field = req->headers;
+	const char *end = req->headers + req->headers_len;
+	const char *eol;
+	uint16_t offset;
+
+	offset = snprintf(str, size, HTML_STR_HEADER
+			  "<body><h1>Zephyr HTTP server</h1>"
+			  "<h2>HTTP Header Fields</h2>\r\n<ul>\r\n");
+	if (offset >= size) {
+		return size - 1;
+	}
+
+	/* One "field: value" per line */
+	while (field < end) {
+		eol = memchr(field, '\r', end - field);
+		if (!eol) {
+			eol = end;
+		}
+
+		offset += snprintf(str + offset, size - offset,
+				   "<li>%.*s</li>\r\n", (int)(eol - field),
+				   field);
+		if (offset >= size) {
+			return size - 1;
+		}
+
+		field = eol + 2;
+	}
+
+	offset += snprintf(str + offset, size - offset,
+			   "</ul>\r\n<h2>HTTP Method: %s</h2>\r\n",
+			   http_method_str(req->method));
+	if (offset >= size) {
+		return size - 1;
+	}
+
+	offset += snprintf(str + offset, size - offset,
+			   "<h2>URL: %.*s</h2>\r\n", req->url_len, req->url);
+	if (offset >= size) {
+		return size - 1;
+	}
+
+	offset += snprintf(str + offset, size - offset,
+			   "<h2>Server: %s</h2></body>\r\n" HTML_STR_FOOTER,
+			   CONFIG_ARCH);
+	if (offset >= size) {
+		return size - 1;
+	}
+
+	return offset;
+}
+
+static int http_write_header_fields(struct http_server_conn *conn,
+				    const struct http_server_request *req)
 {
-	struct net_context *net_ctx = NULL;
+	int len;
 
-	http_ctx_init();
+	len = print_http_headers(req, html_body, sizeof(html_body));
 
-	http_url_default_handler(http_write_soft_404_not_found);
-	http_url_add("/headers", HTTP_URL_STANDARD, http_write_header_fields);
-	http_url_add("/index.html", HTTP_URL_STANDARD, http_write_it_works);
+	/* html_body is copied, it may be reused for the next request */
+	return http_server_send(conn, 200, "text/html", html_body, len);
+}
 
-	network_setup(&net_ctx, http_accept_cb, ZEPHYR_ADDR, ZEPHYR_PORT);
+static int http_write_soft_404_not_found(struct http_server_conn *conn,
+					 const struct http_server_request *req)
+{
+	return http_server_send_static(conn, 200, "text/html", soft_404_html,
+				       sizeof(soft_404_html) - 1);
+}
+
+/* Matched in order, the last route catches the unknown URLs */
+static const struct http_server_route routes[] = {
+	HTTP_SERVER_ROUTE_STATIC("/index.html", "text/html", it_works_html,
+				 sizeof(it_works_html) - 1),
+	HTTP_SERVER_ROUTE("/headers",
+			  HTTP_SERVER_ROUTE_PREFIX | HTTP_SERVER_ROUTE_HEADERS,
+			  http_write_header_fields, NULL),
+	HTTP_SERVER_ROUTE("/", HTTP_SERVER_ROUTE_PREFIX,
+			  http_write_soft_404_not_found, NULL),
+};
+
+static struct http_server server;
+
+void main(void)
+{
+	http_server_init(&server, routes, ARRAY_SIZE(routes));
+
+	network_setup(ZEPHYR_ADDR, ZEPHYR_PORT);
 }
 
 static
-int network_setup(struct net_context **net_ctx, net_tcp_accept_cb_t accept_cb,
-		  const char *addr, uint16_t port)
+int network_setup(const char *addr, uint16_t port)
 {
 	struct sockaddr local_sock;
 	void *ptr;
 	int rc;
 
-	*net_ctx = NULL;
-
 #ifdef CONFIG_NET_IPV6
 	net_sin6(&local_sock)->sin6_port = htons(port);
 	local_sock.family = AF_INET6;
@@ -74,45 +163,16 @@ int network_setup(struct net_context **net_ctx, net_tcp_accept_cb_t accept_cb,
 				   NET_ADDR_MANUAL, 0);
 #endif
 
-#if defined(CONFIG_NET_IPV6)
-	rc = net_context_get(AF_INET6, SOCK_STREAM, IPPROTO_TCP, net_ctx);
-#else
-	rc = net_context_get(AF_INET, SOCK_STREAM, IPPROTO_TCP, net_ctx);
-#endif
+	rc = http_server_start(&server, &local_sock, sizeof(local_sock));
 	if (rc != 0) {
-		printk("net_context_get error\n");
+		printk("http_server_start error\n");
 		return rc;
 	}
 
-	rc = net_context_bind(*net_ctx, (const struct sockaddr *)&local_sock,
-			      sizeof(local_sock));
-	if (rc != 0) {
-		printk("net_context_bind error\n");
-		goto lb_error;
-	}
-
-	rc = net_context_listen(*net_ctx, 0);
-	if (rc != 0) {
-		printk("net_context_listen error\n");
-		goto lb_error;
-	}
-
-	rc = net_context_accept(*net_ctx, accept_cb, 0, NULL);
-	if (rc != 0) {
-		printk("net_context_accept error\n");
-		goto lb_error;
-	}
-
 	print_server_banner(&local_sock);
 
 #if defined(CONFIG_MBEDTLS)
 	https_server_start();
 #endif
 	return 0;
-
-lb_error:
-	net_context_put(*net_ctx);
-	*net_ctx = NULL;
-
-	return rc;
 }
@@ -277,8 +277,9 @@ static void publisher(void)
 
 	/* The connect message will be sent to the MQTT server (broker).
 	 * If clean_session here is 0, the mqtt_ctx clean_session variable
-	 * will be set to 0 also. Please don't do that, set always to 1.
-	 * Clean session = 0 is not yet supported.
+	 * will be set to 0 also and the previous session is resumed. With
+	 * CONFIG_MQTT_INFLIGHT, the QoS 1 and QoS 2 messages not acknowledged
+	 * yet are then sent again, see mqtt_session_save().
 	 */
 	client_ctx.connect_msg.client_id = MQTT_CLIENTID;
 	client_ctx.connect_msg.client_id_len = strlen(MQTT_CLIENTID);
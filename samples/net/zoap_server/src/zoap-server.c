@@ -1073,6 +1073,12 @@ static struct zoap_resource resources[] = {
 	{ },
 };
 
+/* One node per distinct path prefix of the resources, plus the root */
+#define NUM_RESOURCE_NODES 16
+
+static struct zoap_resource_node resource_nodes[NUM_RESOURCE_NODES];
+static struct zoap_resource_tree resource_tree;
+
 static struct zoap_resource *find_resouce_by_observer(
 	struct zoap_resource *resources, struct zoap_observer *o)
 {
@@ -1145,8 +1151,8 @@ static void udp_receive(struct net_context *context,
 	}
 
 not_found:
-	r = zoap_handle_request(&request, resources,
-				(const struct sockaddr *) &from);
+	r = zoap_handle_request_tree(&request, &resource_tree,
+				     (const struct sockaddr *) &from);
 
 	net_nbuf_unref(buf);
 
@@ -1255,6 +1261,13 @@ void main(void)
 		return;
 	}
 
+	r = zoap_resource_tree_init(&resource_tree, resources,
+				    resource_nodes, NUM_RESOURCE_NODES);
+	if (r) {
+		NET_ERR("Could not build the resource tree\n");
+		return;
+	}
+
 	k_delayed_work_init(&retransmit_work, retransmit_request);
 
 	k_delayed_work_init(&observer_work, update_counter);
@@ -97,6 +97,11 @@ extern void zperf_udp_upload(struct net_context *net_context,
 
 extern void zperf_receiver_init(int port);
 
+extern int zperf_udp_loopback(sa_family_t family,
+			      unsigned int duration_in_ms,
+			      unsigned int packet_size);
+extern void zperf_loopback_run(void);
+
 #if defined(CONFIG_NET_TCP)
 extern void zperf_tcp_receiver_init(int port);
 extern void zperf_tcp_uploader_init(struct k_fifo *tx_queue);
@@ -388,6 +388,21 @@ static void shell_udp_upload2_usage(void)
 	       MY_IP4ADDR, DST_IP4ADDR, DEF_PORT);
 #endif
 }
+
+static void shell_udp_loopback_usage(void)
+{
+	/* Print usage */
+	printk("\n%s:\n", CMD_STR_UDP_LOOPBACK);
+	printk("Usage:\t%s v6|v4 <duration> <packet size>[K]\n",
+	       CMD_STR_UDP_LOOPBACK);
+	printk("\t<v6|v4>:\tUse either IPv6 or IPv4\n");
+	printk("\t<duration>:\tDuration of the test in seconds\n");
+	printk("\t<packet size>:\tSize of the packet in byte or kilobyte "
+	       "(with suffix K)\n");
+	printk("\nThe receiver runs in this image: packets are sent to the "
+	       "loopback address\n");
+	printk("\nExample %s v6 10 1K\n", CMD_STR_UDP_LOOPBACK);
+}
 #endif
 
 #if defined(CONFIG_NET_TCP)
@@ -953,6 +968,42 @@ static int shell_cmd_upload2(int argc, char *argv[])
 			      duration_in_ms, packet_size, rate_in_kbps);
 }
 
+#if defined(CONFIG_NET_UDP)
+static int shell_cmd_udp_loopback(int argc, char *argv[])
+{
+	unsigned int duration_in_ms, packet_size;
+	sa_family_t family;
+	int start = 0;
+
+	if (!strcmp(argv[0], "zperf")) {
+		start++;
+		argc--;
+	}
+
+	if (argc == 1) {
+		shell_udp_loopback_usage();
+		return -1;
+	}
+
+	family = !strcmp(argv[start + 1], "v4") ? AF_INET : AF_INET6;
+
+	if (argc > 2) {
+		duration_in_ms = strtoul(argv[start + 2], NULL, 10) *
+			MSEC_PER_SEC;
+	} else {
+		duration_in_ms = 1000;
+	}
+
+	if (argc > 3) {
+		packet_size = parse_number(argv[start + 3], K, K_UNIT);
+	} else {
+		packet_size = 256;
+	}
+
+	return zperf_udp_loopback(family, duration_in_ms, packet_size);
+}
+#endif
+
 static int shell_cmd_connectap(int argc, char *argv[])
 {
 	printk("[%s] Zephyr has not been built with Wi-Fi support.\n",
@@ -1070,6 +1121,8 @@ struct shell_cmd commands[] = {
 	/* Same as upload command but no need to specify the addresses */
 	{ CMD_STR_UDP_UPLOAD2, shell_cmd_upload2 },
 	{ CMD_STR_UDP_DOWNLOAD, shell_cmd_udp_download },
+	/* Uploader and receiver in this image, over the loopback path */
+	{ CMD_STR_UDP_LOOPBACK, shell_cmd_udp_loopback },
 #endif
 #if defined(CONFIG_NET_TCP)
 	{ CMD_STR_TCP_UPLOAD, shell_cmd_upload },
@@ -1097,6 +1150,10 @@ void main(void)
 
 	zperf_init();
 
+#if defined(ZPERF_LOOPBACK)
+	zperf_loopback_run();
+#endif
+
 #if PROFILER
 	while (1) {
 		k_sleep(5 * MSEC_PER_SEC);
@@ -0,0 +1,427 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+
+#include <misc/printk.h>
+
+#include <net/net_core.h>
+#include <net/net_ip.h>
+#include <net/nbuf.h>
+#include <net/net_if.h>
+#include <net/net_context.h>
+
+#include "zperf.h"
+#include "zperf_internal.h"
+#include "shell_utils.h"
+
+#if defined(ZPERF_LOOPBACK)
+#include <tc_util.h>
+#endif
+
+#define TAG CMD_STR_UDP_LOOPBACK" "
+
+/* Kept apart from the ports of the other commands, so that a server
+ * started with udp.download does not get in the way.
+ */
+#define LOOPBACK_RX_PORT 5002
+#define LOOPBACK_TX_PORT 50002
+
+/* Nothing goes out of this interface: the packets sent to the loopback
+ * address are handed back to the RX path by net_send_data(). It only
+ * gives the stack an interface when the image has no network driver.
+ */
+#if defined(CONFIG_NET_L2_DUMMY)
+static int loopback_dev_init(struct device *dev)
+{
+	return 0;
+}
+
+static void loopback_iface_init(struct net_if *iface)
+{
+	static uint8_t mac_addr[6] = { 0x10, 0x00, 0x00, 0x00, 0x00, 0x01 };
+
+	net_if_set_link_addr(iface, mac_addr, sizeof(mac_addr),
+			     NET_LINK_ETHERNET);
+}
+
+static int loopback_send(struct net_if *iface, struct net_buf *buf)
+{
+	net_nbuf_unref(buf);
+
+	return 0;
+}
+
+static struct net_if_api loopback_if_api = {
+	.init = loopback_iface_init,
+	.send = loopback_send,
+};
+
+NET_DEVICE_INIT(zperf_loopback, "zperf_loopback", loopback_dev_init,
+		NULL, NULL, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+		&loopback_if_api, DUMMY_L2, NET_L2_GET_CTX_TYPE(DUMMY_L2),
+		1280);
+#endif
+
+struct loopback_stats {
+	uint32_t nb_packets_rcvd;
+	uint32_t nb_packets_lost;
+	uint32_t nb_packets_outorder;
+	uint32_t nb_bytes_rcvd;
+	uint32_t next_id;
+	int tx_min_free;
+	int rx_min_free;
+	int data_min_free;
+};
+
+static struct loopback_stats stats;
+
+static char sample_packet[PACKET_SIZE_MAX];
+
+static void sample_pools(void)
+{
+	int tx, rx, data;
+
+	net_nbuf_get_info(NULL, NULL, NULL, &tx, &rx, &data);
+
+	stats.tx_min_free = min(stats.tx_min_free, tx);
+	stats.rx_min_free = min(stats.rx_min_free, rx);
+	stats.data_min_free = min(stats.data_min_free, data);
+}
+
+/* The TX and RX pool free counts are only maintained with
+ * CONFIG_NET_DEBUG_NET_BUF, otherwise report them as unknown.
+ */
+static inline int pool_used(int count, int min_free)
+{
+	return min_free == (int)BIT(31) ? -1 : count - min_free;
+}
+
+/* Runs in the sending thread, from within net_context_sendto() */
+static void loopback_received(struct net_context *context,
+			      struct net_buf *buf,
+			      int status,
+			      void *user_data)
+{
+	uint16_t offset, pos;
+	uint32_t id;
+
+	if (!buf) {
+		return;
+	}
+
+	/* The buffer sent is still held, so this is the peak usage */
+	sample_pools();
+
+	if (net_nbuf_appdatalen(buf) < sizeof(struct zperf_udp_datagram)) {
+		net_nbuf_unref(buf);
+		return;
+	}
+
+	offset = net_nbuf_appdata(buf) - net_nbuf_ip_data(buf);
+	net_nbuf_read_be32(buf->frags, offset, &pos, &id);
+
+	if (id == stats.next_id) {
+		stats.next_id++;
+	} else if (id < stats.next_id) {
+		stats.nb_packets_outorder++;
+	} else {
+		stats.nb_packets_lost += id - stats.next_id;
+		stats.next_id = id + 1;
+	}
+
+	stats.nb_packets_rcvd++;
+	stats.nb_bytes_rcvd += net_nbuf_appdatalen(buf);
+
+	net_nbuf_unref(buf);
+}
+
+static int setup_loopback(struct net_context **rx_context,
+			  struct net_context **tx_context,
+			  sa_family_t family, struct sockaddr *dst,
+			  socklen_t *dst_len)
+{
+	struct sockaddr rx_addr, tx_addr;
+	socklen_t addrlen;
+	int ret;
+
+	memset(dst, 0, sizeof(*dst));
+
+#if defined(CONFIG_NET_IPV6)
+	if (family == AF_INET6) {
+		struct in6_addr loopback = IN6ADDR_LOOPBACK_INIT;
+
+		addrlen = sizeof(struct sockaddr_in6);
+		memcpy(&rx_addr, zperf_get_sin6(), addrlen);
+
+		if (net_is_ipv6_addr_unspecified(
+			    &net_sin6(&rx_addr)->sin6_addr)) {
+			printk(TAG "ERROR! Invalid local IPv6 address\n");
+			return -EINVAL;
+		}
+
+		net_sin6(dst)->sin6_family = AF_INET6;
+		net_ipaddr_copy(&net_sin6(dst)->sin6_addr, &loopback);
+		net_sin6(dst)->sin6_port = htons(LOOPBACK_RX_PORT);
+
+		memcpy(&tx_addr, &rx_addr, addrlen);
+		net_sin6(&rx_addr)->sin6_port = htons(LOOPBACK_RX_PORT);
+		net_sin6(&tx_addr)->sin6_port = htons(LOOPBACK_TX_PORT);
+	} else
+#endif
+#if defined(CONFIG_NET_IPV4)
+	if (family == AF_INET) {
+		addrlen = sizeof(struct sockaddr_in);
+		memcpy(&rx_addr, zperf_get_sin(), addrlen);
+
+		if (net_is_ipv4_addr_unspecified(
+			    &net_sin(&rx_addr)->sin_addr)) {
+			printk(TAG "ERROR! Invalid local IPv4 address\n");
+			return -EINVAL;
+		}
+
+		net_sin(dst)->sin_family = AF_INET;
+		net_sin(dst)->sin_addr.s4_addr[0] = 127;
+		net_sin(dst)->sin_addr.s4_addr[3] = 1;
+		net_sin(dst)->sin_port = htons(LOOPBACK_RX_PORT);
+
+		memcpy(&tx_addr, &rx_addr, addrlen);
+		net_sin(&rx_addr)->sin_port = htons(LOOPBACK_RX_PORT);
+		net_sin(&tx_addr)->sin_port = htons(LOOPBACK_TX_PORT);
+	} else
+#endif
+	{
+		printk(TAG "ERROR! Address family not supported\n");
+		return -EAFNOSUPPORT;
+	}
+
+	*dst_len = addrlen;
+
+	ret = net_context_get(family, SOCK_DGRAM, IPPROTO_UDP, rx_context);
+	if (ret < 0) {
+		printk(TAG "ERROR! Cannot get receiver context (%d)\n", ret);
+		return ret;
+	}
+
+	ret = net_context_get(family, SOCK_DGRAM, IPPROTO_UDP, tx_context);
+	if (ret < 0) {
+		printk(TAG "ERROR! Cannot get uploader context (%d)\n", ret);
+		net_context_put(*rx_context);
+		return ret;
+	}
+
+	ret = net_context_bind(*rx_context, &rx_addr, addrlen);
+	if (ret < 0) {
+		printk(TAG "ERROR! Cannot bind receiver context (%d)\n", ret);
+		goto fail;
+	}
+
+	ret = net_context_bind(*tx_context, &tx_addr, addrlen);
+	if (ret < 0) {
+		printk(TAG "ERROR! Cannot bind uploader context (%d)\n", ret);
+		goto fail;
+	}
+
+	ret = net_context_recv(*rx_context, loopback_received, K_NO_WAIT,
+			       NULL);
+	if (ret < 0) {
+		printk(TAG "ERROR! Cannot receive packets (%d)\n", ret);
+		goto fail;
+	}
+
+	return 0;
+
+fail:
+	net_context_put(*tx_context);
+	net_context_put(*rx_context);
+
+	return ret;
+}
+
+static int send_packet(struct net_context *context, struct sockaddr *dst,
+		       socklen_t dst_len, uint32_t id, unsigned int packet_size)
+{
+	struct zperf_udp_datagram datagram = {
+		.id = htonl(id),
+	};
+	struct net_buf *buf, *frag;
+	uint16_t pos;
+	int ret;
+
+	buf = net_nbuf_get_tx(context, K_NO_WAIT);
+	if (!buf) {
+		return -ENOMEM;
+	}
+
+	frag = net_nbuf_get_data(context, K_NO_WAIT);
+	if (!frag) {
+		net_nbuf_unref(buf);
+		return -ENOMEM;
+	}
+
+	net_buf_frag_add(buf, frag);
+
+	if (!net_nbuf_append(buf, sizeof(datagram), (uint8_t *)&datagram,
+			     K_NO_WAIT)) {
+		net_nbuf_unref(buf);
+		return -ENOMEM;
+	}
+
+	if (packet_size > sizeof(datagram)) {
+		frag = net_nbuf_write(buf, net_buf_frag_last(buf),
+				      sizeof(datagram), &pos,
+				      packet_size - sizeof(datagram),
+				      (uint8_t *)sample_packet, K_NO_WAIT);
+		if (!frag) {
+			net_nbuf_unref(buf);
+			return -ENOMEM;
+		}
+	}
+
+	ret = net_context_sendto(buf, dst, dst_len, NULL, K_NO_WAIT, NULL,
+				 NULL);
+	if (ret < 0) {
+		net_nbuf_unref(buf);
+	}
+
+	return ret;
+}
+
+int zperf_udp_loopback(sa_family_t family, unsigned int duration_in_ms,
+		       unsigned int packet_size)
+{
+	uint32_t duration = MSEC_TO_HW_CYCLES(duration_in_ms);
+	uint32_t nb_packets = 0, nb_errors = 0;
+	uint32_t start_time, end_time, cycles, time_in_us;
+	uint32_t pps, kbps;
+	struct net_context *rx_context, *tx_context;
+	struct sockaddr dst;
+	socklen_t dst_len;
+	int tx, rx, data_before, data_after;
+	int ret;
+
+	if (packet_size > PACKET_SIZE_MAX) {
+		printk(TAG "WARNING! packet size too large! max size: %u\n",
+		       PACKET_SIZE_MAX);
+		packet_size = PACKET_SIZE_MAX;
+	} else if (packet_size < sizeof(struct zperf_udp_datagram)) {
+		printk(TAG "WARNING! packet size set to the min size: %zu\n",
+		       sizeof(struct zperf_udp_datagram));
+		packet_size = sizeof(struct zperf_udp_datagram);
+	}
+
+	ret = setup_loopback(&rx_context, &tx_context, family, &dst,
+			     &dst_len);
+	if (ret < 0) {
+		return ret;
+	}
+
+	memset(sample_packet, 'z', sizeof(sample_packet));
+	memset(&stats, 0, sizeof(stats));
+
+	net_nbuf_get_info(NULL, NULL, NULL, &tx, &rx, &data_before);
+	stats.tx_min_free = tx;
+	stats.rx_min_free = rx;
+	stats.data_min_free = data_before;
+
+	printk(TAG "Running for %u ms, packet size %u\n", duration_in_ms,
+	       packet_size);
+
+	start_time = k_cycle_get_32();
+
+	do {
+		ret = send_packet(tx_context, &dst, dst_len, nb_packets,
+				  packet_size);
+		if (ret < 0) {
+			/* Let whoever holds buffers give them back */
+			nb_errors++;
+			k_yield();
+		} else {
+			nb_packets++;
+		}
+
+		end_time = k_cycle_get_32();
+	} while (time_delta(start_time, end_time) < duration);
+
+	cycles = time_delta(start_time, end_time);
+	time_in_us = HW_CYCLES_TO_USEC(cycles);
+
+	net_context_put(tx_context);
+	net_context_put(rx_context);
+
+	net_nbuf_get_info(NULL, NULL, NULL, &tx, &rx, &data_after);
+
+	if (!time_in_us) {
+		time_in_us = 1;
+	}
+
+	pps = ((uint64_t)stats.nb_packets_rcvd * USEC_PER_SEC) / time_in_us;
+	kbps = ((uint64_t)stats.nb_bytes_rcvd * 8 * 1000) / time_in_us;
+
+	printk(TAG "packets sent:\t\t%u\n", nb_packets);
+	printk(TAG "packets received:\t%u\n", stats.nb_packets_rcvd);
+	printk(TAG "send errors:\t\t%u\n", nb_errors);
+	printk(TAG "rate:\t\t\t");
+	print_number(kbps, KBPS, KBPS_UNIT);
+	printk("\n");
+
+	/* One line of key=value pairs, to be compared across runs */
+	printk("zperf-result test=udp-loopback family=%s packet_size=%u "
+	       "duration_us=%u packets_sent=%u packets_rcvd=%u "
+	       "packets_lost=%u packets_outorder=%u send_errors=%u "
+	       "pps=%u mbps=%u.%03u cycles_per_packet=%u "
+	       "nbuf_tx_used=%d/%d nbuf_rx_used=%d/%d "
+	       "nbuf_data_used=%d/%d nbuf_data_leaked=%d\n",
+	       family == AF_INET6 ? "v6" : "v4", packet_size, time_in_us,
+	       nb_packets, stats.nb_packets_rcvd, stats.nb_packets_lost,
+	       stats.nb_packets_outorder, nb_errors, pps,
+	       kbps / 1000, kbps % 1000,
+	       nb_packets ? cycles / nb_packets : 0,
+	       pool_used(CONFIG_NET_NBUF_TX_COUNT, stats.tx_min_free),
+	       CONFIG_NET_NBUF_TX_COUNT,
+	       pool_used(CONFIG_NET_NBUF_RX_COUNT, stats.rx_min_free),
+	       CONFIG_NET_NBUF_RX_COUNT,
+	       data_before - stats.data_min_free, data_before,
+	       data_before - data_after);
+
+	if (!nb_packets || stats.nb_packets_rcvd != nb_packets ||
+	    data_after != data_before) {
+		return -EIO;
+	}
+
+	return 0;
+}
+
+#if defined(ZPERF_LOOPBACK)
+/* Benchmark run at boot when built with LOOPBACK=1, so that it can be
+ * run unattended on qemu_x86.
+ */
+#define LOOPBACK_DURATION (5 * MSEC_PER_SEC)
+#define LOOPBACK_PACKET_SIZE 1024
+
+void zperf_loopback_run(void)
+{
+	int result = TC_PASS;
+
+	TC_START("zperf loopback");
+
+#if defined(CONFIG_NET_IPV6)
+	if (zperf_udp_loopback(AF_INET6, LOOPBACK_DURATION,
+			       LOOPBACK_PACKET_SIZE) < 0) {
+		result = TC_FAIL;
+	}
+#endif
+
+#if defined(CONFIG_NET_IPV4)
+	if (zperf_udp_loopback(AF_INET, LOOPBACK_DURATION,
+			       LOOPBACK_PACKET_SIZE) < 0) {
+		result = TC_FAIL;
+	}
+#endif
+
+	TC_END_REPORT(result);
+}
+#endif
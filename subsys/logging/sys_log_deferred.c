@@ -0,0 +1,246 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Deferred system log backend.
+ *
+ * The logging macros store the format string pointer and the raw arguments
+ * of each message in a ring buffer. Messages are formatted and output later
+ * by a low priority thread, or synchronously by sys_log_flush().
+ */
+
+#include <kernel.h>
+#include <string.h>
+#include <errno.h>
+#include <atomic.h>
+#include <misc/util.h>
+#include <misc/printk.h>
+#include <misc/ring_buffer.h>
+#include <logging/sys_log.h>
+
+#if defined(CONFIG_SYS_LOG_EXT_HOOK)
+extern void (*syslog_hook)(const char *fmt, ...);
+#define LOG_OUTPUT_FN syslog_hook
+#else
+#define LOG_OUTPUT_FN printk
+#endif
+
+/* Format string pointer followed by the arguments */
+#define MSG_MAX_SIZE32 (SYS_LOG_DEFERRED_MAX_ARGS + 1)
+
+struct domain_level {
+	const char *domain;
+	int level;
+};
+
+static uint32_t sys_log_buf_data[CONFIG_SYS_LOG_DEFERRED_BUF_SIZE];
+static struct ring_buf sys_log_buf = {
+	.size = CONFIG_SYS_LOG_DEFERRED_BUF_SIZE,
+	.buf = sys_log_buf_data,
+};
+static K_SEM_DEFINE(log_sem, 0, UINT_MAX);
+
+static atomic_t dropped;
+static uint32_t dropped_reported;
+
+static sys_slist_t modules;
+static struct domain_level domain_levels[CONFIG_SYS_LOG_DEFERRED_DOMAIN_LEVELS];
+static int global_level = -1;
+
+static int module_level(struct sys_log_module *module)
+{
+	int level = global_level;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(domain_levels); i++) {
+		if (domain_levels[i].domain &&
+		    !strcmp(domain_levels[i].domain, module->name)) {
+			level = domain_levels[i].level;
+			break;
+		}
+	}
+
+	if (level < 0 || level > module->max_level) {
+		return module->max_level;
+	}
+
+	return level;
+}
+
+static void module_register(struct sys_log_module *module,
+			    const char *domain)
+{
+	unsigned int key;
+
+	key = irq_lock();
+
+	if (!module->name) {
+		module->name = domain;
+		module->level = module_level(module);
+		sys_slist_append(&modules, &module->node);
+	}
+
+	irq_unlock(key);
+}
+
+void sys_log_deferred_put(struct sys_log_module *module,
+			  const char *domain, int level,
+			  const char *fmt, int nargs, ...)
+{
+	uint32_t data[MSG_MAX_SIZE32];
+	unsigned int key;
+	va_list ap;
+	int ret;
+	int i;
+
+	if (!module->name) {
+		module_register(module, domain);
+
+		if (level > module->level) {
+			return;
+		}
+	}
+
+	/* The logging macros reject longer messages at build time, this
+	 * only guards direct callers.
+	 */
+	if (nargs > SYS_LOG_DEFERRED_MAX_ARGS) {
+		nargs = SYS_LOG_DEFERRED_MAX_ARGS;
+	}
+
+	data[0] = POINTER_TO_UINT(fmt);
+
+	va_start(ap, nargs);
+	for (i = 0; i < nargs; i++) {
+		data[i + 1] = va_arg(ap, uint32_t);
+	}
+	va_end(ap);
+
+	key = irq_lock();
+	ret = sys_ring_buf_put(&sys_log_buf, level, nargs, data, nargs + 1);
+	irq_unlock(key);
+
+	if (ret) {
+		atomic_inc(&dropped);
+		return;
+	}
+
+	k_sem_give(&log_sem);
+}
+
+static bool log_output_one(void)
+{
+	uint32_t data[MSG_MAX_SIZE32] = { 0 };
+	uint8_t size32 = ARRAY_SIZE(data);
+	uint32_t lost;
+	unsigned int key;
+	uint16_t level;
+	uint8_t nargs;
+	int ret;
+
+	key = irq_lock();
+	ret = sys_ring_buf_get(&sys_log_buf, &level, &nargs, data, &size32);
+	irq_unlock(key);
+
+	lost = atomic_get(&dropped);
+	if (lost != dropped_reported) {
+		LOG_OUTPUT_FN("--- %u log messages dropped ---\n",
+			      lost - dropped_reported);
+		dropped_reported = lost;
+	}
+
+	if (ret) {
+		return false;
+	}
+
+	/* Unused trailing arguments are zero and ignored by the formatter */
+	LOG_OUTPUT_FN((const char *)UINT_TO_POINTER(data[0]),
+		      data[1], data[2], data[3], data[4], data[5],
+		      data[6], data[7], data[8], data[9], data[10],
+		      data[11], data[12], data[13], data[14], data[15],
+		      data[16], data[17], data[18], data[19], data[20]);
+
+	return true;
+}
+
+void sys_log_flush(void)
+{
+	while (log_output_one()) {
+	}
+}
+
+int sys_log_level_set(const char *domain, int level)
+{
+	struct sys_log_module *module;
+	struct domain_level *free_slot = NULL;
+	unsigned int key;
+	int i;
+
+	if (level < SYS_LOG_LEVEL_OFF || level > SYS_LOG_LEVEL_DEBUG) {
+		return -EINVAL;
+	}
+
+	key = irq_lock();
+
+	if (!domain) {
+		memset(domain_levels, 0, sizeof(domain_levels));
+		global_level = level;
+	} else {
+		for (i = 0; i < ARRAY_SIZE(domain_levels); i++) {
+			if (!domain_levels[i].domain) {
+				if (!free_slot) {
+					free_slot = &domain_levels[i];
+				}
+				continue;
+			}
+
+			if (!strcmp(domain_levels[i].domain, domain)) {
+				free_slot = &domain_levels[i];
+				break;
+			}
+		}
+
+		if (!free_slot) {
+			irq_unlock(key);
+			return -ENOMEM;
+		}
+
+		free_slot->domain = domain;
+		free_slot->level = level;
+	}
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&modules, module, node) {
+		if (!domain || !strcmp(module->name, domain)) {
+			module->level = module_level(module);
+		}
+	}
+
+	irq_unlock(key);
+
+	return 0;
+}
+
+uint32_t sys_log_dropped_get(void)
+{
+	return atomic_get(&dropped);
+}
+
+static void sys_log_thread(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (1) {
+		k_sem_take(&log_sem, K_FOREVER);
+		log_output_one();
+	}
+}
+
+K_THREAD_DEFINE(sys_log_thread_id, CONFIG_SYS_LOG_DEFERRED_STACK_SIZE,
+		sys_log_thread, NULL, NULL, NULL,
+		CONFIG_SYS_LOG_DEFERRED_THREAD_PRIORITY, 0, K_NO_WAIT);
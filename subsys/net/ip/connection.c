@@ -70,278 +70,108 @@ static inline const char *proto2str(enum net_ip_protocol proto)
 }
 #endif /* CONFIG_NET_DEBUG_CONN */
 
-#if defined(CONFIG_NET_CONN_CACHE)
-
-/* Cache the connection so that we do not have to go
- * through the full list of connections when receiving
- * a network packet. The cache contains an index to
- * corresponding entry in conns array.
+/* Connections are kept in two hash tables so that an incoming packet is
+ * only matched against the few connections sharing its hash bucket.
  *
- * Hash value is constructed like this:
+ * The exact table holds the connections bound to a specific remote address
+ * and port and to a local port, i.e. the accepted TCP connections and the
+ * connected UDP peers. They are hashed on the protocol and on the packet
+ * source address, source port and destination port. Such a match always
+ * wins over a listener.
  *
- *   bit      description
- *   0  - 3   bits from remote port
- *   4  - 7   bits from local port
- *   8  - 18  bits from remote address
- *   19 - 29  bits from local address
- *   30       family
- *   31       protocol
- */
-struct conn_hash {
-	uint32_t value;
-	int32_t idx;
-};
-
-struct conn_hash_neg {
-	uint32_t value;
-};
-
-/** Connection cache */
-static struct conn_hash conn_cache[CONFIG_NET_MAX_CONN];
-
-/** Negative cache, we definitely do not have a connection
- * to these hosts.
+ * The listener table holds the other connections bound to a local port,
+ * hashed on the protocol and the port. The connections without a local
+ * port are kept in a separate list that is checked for every packet.
  */
-static struct conn_hash_neg conn_cache_neg[CONFIG_NET_MAX_CONN];
+#define NET_CONN_EXACT_RANK (NET_RANK_LOCAL_PORT | \
+			     NET_RANK_REMOTE_PORT | \
+			     NET_RANK_REMOTE_SPEC_ADDR)
 
-#define TAKE_BIT(val, bit, max, used)				\
-	(((val & BIT(bit)) >> bit) << (max - used))
+static sys_slist_t conn_exact[CONFIG_NET_CONN_HASH_SIZE];
+static sys_slist_t conn_listen[CONFIG_NET_CONN_HASH_SIZE];
+static sys_slist_t conn_any;
 
-static inline uint8_t ports_to_hash(uint16_t remote_port,
-				    uint16_t local_port)
+static inline uint32_t hash_mix(uint32_t value)
 {
-	/* Note that we do not convert port value to network byte order */
-	return (remote_port & BIT(0)) |
-		((remote_port & BIT(4)) >> 3) |
-		((remote_port & BIT(8)) >> 6) |
-		((remote_port & BIT(15)) >> 12) |
-		(((local_port & BIT(0)) |
-		  ((local_port & BIT(4)) >> 3) |
-		  ((local_port & BIT(8)) >> 6) |
-		  ((local_port & BIT(15)) >> 12)) << 4);
-}
+	value ^= value >> 16;
+	value *= 0x45d9f3b;
+	value ^= value >> 16;
 
-static inline uint16_t ipv6_to_hash(struct in6_addr *addr)
-{
-	/* There is 11 bits available for IPv6 address */
-	/* Use more bits from the lower part of address space */
-	return
-		/* Take 3 bits from higher values */
-		TAKE_BIT(addr->s6_addr32[0], 31, 11, 1) |
-		TAKE_BIT(addr->s6_addr32[0], 15, 11, 2) |
-		TAKE_BIT(addr->s6_addr32[0], 7, 11, 3) |
-
-		/* Take 2 bits from higher middle values */
-		TAKE_BIT(addr->s6_addr32[1], 31, 11, 4) |
-		TAKE_BIT(addr->s6_addr32[1], 15, 11, 5) |
-
-		/* Take 2 bits from lower middle values */
-		TAKE_BIT(addr->s6_addr32[2], 31, 11, 6) |
-		TAKE_BIT(addr->s6_addr32[2], 15, 11, 7) |
-
-		/* Take 4 bits from lower values */
-		TAKE_BIT(addr->s6_addr32[3], 31, 11, 8) |
-		TAKE_BIT(addr->s6_addr32[3], 15, 11, 9) |
-		TAKE_BIT(addr->s6_addr32[3], 7, 11, 10) |
-		TAKE_BIT(addr->s6_addr32[3], 0, 11, 11);
+	return value % CONFIG_NET_CONN_HASH_SIZE;
 }
 
-static inline uint16_t ipv4_to_hash(struct in_addr *addr)
+/* Ports are hashed in network byte order, as found in the packet */
+static inline uint32_t hash_listen(uint8_t proto, uint16_t local_port)
 {
-	/* There is 11 bits available for IPv4 address */
-	/* Use more bits from the lower part of address space */
-	return
-		TAKE_BIT(addr->s_addr[0], 31, 11, 1) |
-		TAKE_BIT(addr->s_addr[0], 27, 11, 2) |
-		TAKE_BIT(addr->s_addr[0], 21, 11, 3) |
-		TAKE_BIT(addr->s_addr[0], 17, 11, 4) |
-		TAKE_BIT(addr->s_addr[0], 14, 11, 5) |
-		TAKE_BIT(addr->s_addr[0], 11, 11, 6) |
-		TAKE_BIT(addr->s_addr[0], 8, 11, 7) |
-		TAKE_BIT(addr->s_addr[0], 5, 11, 8) |
-		TAKE_BIT(addr->s_addr[0], 3, 11, 9) |
-		TAKE_BIT(addr->s_addr[0], 2, 11, 10) |
-		TAKE_BIT(addr->s_addr[0], 0, 11, 11);
+	return hash_mix(proto << 16 | local_port);
 }
 
-/* Return either the first free position in the cache (idx < 0) or
- * the existing cached position (idx >= 0)
- */
-static int32_t check_hash(enum net_ip_protocol proto,
-			  sa_family_t family,
-			  void *remote_addr,
-			  void *local_addr,
-			  uint16_t remote_port,
-			  uint16_t local_port,
-			  uint32_t *cache_value)
+static uint32_t hash_exact(uint8_t proto, sa_family_t family,
+			   const void *remote_addr,
+			   uint16_t remote_port, uint16_t local_port)
 {
-	int i, free_pos = -1;
-	uint32_t value = 0;
-
-	value = ports_to_hash(remote_port, local_port);
-
-#if defined(CONFIG_NET_UDP)
-	if (proto == IPPROTO_UDP) {
-		value |= BIT(31);
-	}
-#endif
-
-#if defined(CONFIG_NET_TCP)
-	if (proto == IPPROTO_TCP) {
-		value &= ~BIT(31);
-	}
-#endif
+	uint32_t value = proto ^ (remote_port << 16 | local_port);
 
 #if defined(CONFIG_NET_IPV6)
 	if (family == AF_INET6) {
-		value |= BIT(30);
-		value |= ipv6_to_hash((struct in6_addr *)remote_addr) << 8;
-		value |= ipv6_to_hash((struct in6_addr *)local_addr) << 19;
-	}
-#endif
+		const struct in6_addr *addr6 = remote_addr;
 
-#if defined(CONFIG_NET_IPV4)
-	if (family == AF_INET) {
-		value &= ~BIT(30);
-		value |= ipv4_to_hash((struct in_addr *)remote_addr) << 8;
-		value |= ipv4_to_hash((struct in_addr *)local_addr) << 19;
+		value ^= UNALIGNED_GET(&addr6->s6_addr32[0]) ^
+			 UNALIGNED_GET(&addr6->s6_addr32[1]) ^
+			 UNALIGNED_GET(&addr6->s6_addr32[2]) ^
+			 UNALIGNED_GET(&addr6->s6_addr32[3]);
 	}
 #endif
 
-	for (i = 0; i < CONFIG_NET_MAX_CONN; i++) {
-		if (conn_cache[i].value == value) {
-			return i;
-		}
-
-		if (conn_cache[i].idx < 0 && free_pos < 0) {
-			free_pos = i;
-		}
-	}
-
-	if (free_pos >= 0) {
-		conn_cache[free_pos].value = value;
-		return free_pos;
-	}
-
-	*cache_value = value;
-
-	return -ENOENT;
-}
-
-static inline int32_t get_conn(enum net_ip_protocol proto,
-			       sa_family_t family,
-			       struct net_buf *buf,
-			       uint32_t *cache_value)
-{
 #if defined(CONFIG_NET_IPV4)
 	if (family == AF_INET) {
-		return check_hash(proto, family,
-				  &NET_IPV4_BUF(buf)->src,
-				  &NET_IPV4_BUF(buf)->dst,
-				  NET_UDP_BUF(buf)->src_port,
-				  NET_UDP_BUF(buf)->dst_port,
-				  cache_value);
-	}
-#endif
+		const struct in_addr *addr4 = remote_addr;
 
-#if defined(CONFIG_NET_IPV6)
-	if (family == AF_INET6) {
-		return check_hash(proto, family,
-				  &NET_IPV6_BUF(buf)->src,
-				  &NET_IPV6_BUF(buf)->dst,
-				  NET_UDP_BUF(buf)->src_port,
-				  NET_UDP_BUF(buf)->dst_port,
-				  cache_value);
+		value ^= UNALIGNED_GET(&addr4->s_addr[0]);
 	}
 #endif
 
-	return -1;
+	return hash_mix(value);
 }
 
-static inline void cache_add_neg(uint32_t cache_value)
+static sys_slist_t *conn_list(struct net_conn *conn)
 {
-	int i;
-
-	for (i = 0; i < CONFIG_NET_MAX_CONN && cache_value > 0; i++) {
-		if (conn_cache_neg[i].value) {
-			continue;
-		}
-
-		NET_DBG("Add to neg cache value 0x%x", cache_value);
-
-		conn_cache_neg[i].value = cache_value;
-		break;
+	uint16_t remote_port = net_sin(&conn->remote_addr)->sin_port;
+	uint16_t local_port = net_sin(&conn->local_addr)->sin_port;
+
+	if ((conn->rank & NET_CONN_EXACT_RANK) == NET_CONN_EXACT_RANK) {
+		/* sin_addr and sin6_addr are at the same offset */
+		return &conn_exact[hash_exact(conn->proto,
+					      conn->remote_addr.family,
+					      &net_sin6(&conn->remote_addr)->
+								sin6_addr,
+					      remote_port, local_port)];
 	}
-}
 
-static inline bool cache_check_neg(uint32_t cache_value)
-{
-	int i;
-
-	for (i = 0; i < CONFIG_NET_MAX_CONN && cache_value > 0; i++) {
-		if (conn_cache_neg[i].value == cache_value) {
-			NET_DBG("Cache neg [%d] value 0x%x found",
-				i, cache_value);
-			return true;
-		}
+	if (local_port) {
+		return &conn_listen[hash_listen(conn->proto, local_port)];
 	}
 
-	return false;
+	return &conn_any;
 }
 
-static void cache_clear(void)
+static inline struct net_conn *conn_get(struct net_conn_handle *handle)
 {
-	int i;
-
-	for (i = 0; i < CONFIG_NET_MAX_CONN; i++) {
-		conn_cache[i].idx = -1;
-		conn_cache_neg[i].value = 0;
-	}
-}
+	struct net_conn *conn = (struct net_conn *)handle;
 
-static inline enum net_verdict cache_check(enum net_ip_protocol proto,
-					   struct net_buf *buf,
-					   uint32_t *cache_value,
-					   int32_t *pos)
-{
-	*pos = get_conn(proto, net_nbuf_family(buf), buf, cache_value);
-	if (*pos >= 0) {
-		if (conn_cache[*pos].idx >= 0) {
-			/* Connection is in the cache */
-			struct net_conn *conn;
-
-			conn = &conns[conn_cache[*pos].idx];
-
-			NET_DBG("Cache %s listener for buf %p src port %u "
-				"dst port %u family %d cache[%d] 0x%x",
-				proto2str(proto), buf,
-				ntohs(NET_CONN_BUF(buf)->src_port),
-				ntohs(NET_CONN_BUF(buf)->dst_port),
-				net_nbuf_family(buf), *pos,
-				conn_cache[*pos].value);
-
-			return conn->cb(conn, buf, conn->user_data);
-		}
-	} else if (*cache_value > 0) {
-		if (cache_check_neg(*cache_value)) {
-			NET_DBG("Drop by cache");
-			return NET_DROP;
-		}
+	if (conn < &conns[0] || conn >= &conns[CONFIG_NET_MAX_CONN]) {
+		return NULL;
 	}
 
-	return NET_CONTINUE;
+	return conn;
 }
-#else
-#define cache_clear(...)
-#define cache_add_neg(...)
-#define cache_check(...) NET_CONTINUE
-#endif /* CONFIG_NET_CONN_CACHE */
 
 int net_conn_unregister(struct net_conn_handle *handle)
 {
-	struct net_conn *conn = (struct net_conn *)handle;
+	struct net_conn *conn = conn_get(handle);
+	unsigned int key;
 
-	if (conn < &conns[0] || conn > &conns[CONFIG_NET_MAX_CONN]) {
+	if (!conn) {
 		return -EINVAL;
 	}
 
@@ -349,10 +179,12 @@ int net_conn_unregister(struct net_conn_handle *handle)
 		return -ENOENT;
 	}
 
-	NET_DBG("[%zu] connection handler %p removed",
-		(conn - conns) / sizeof(*conn), conn);
+	NET_DBG("[%zu] connection handler %p removed", conn - conns, conn);
 
+	key = irq_lock();
+	sys_slist_find_and_remove(conn_list(conn), &conn->node);
 	conn->flags = 0;
+	irq_unlock(key);
 
 	return 0;
 }
@@ -360,9 +192,9 @@ int net_conn_unregister(struct net_conn_handle *handle)
 int net_conn_change_callback(struct net_conn_handle *handle,
 			     net_conn_cb_t cb, void *user_data)
 {
-	struct net_conn *conn = (struct net_conn *)handle;
+	struct net_conn *conn = conn_get(handle);
 
-	if (conn < &conns[0] || conn > &conns[CONFIG_NET_MAX_CONN]) {
+	if (!conn) {
 		return -EINVAL;
 	}
 
@@ -371,7 +203,7 @@ int net_conn_change_callback(struct net_conn_handle *handle,
 	}
 
 	NET_DBG("[%zu] connection handler %p changed callback",
-		(conn - conns) / sizeof(*conn), conn);
+		conn - conns, conn);
 
 	conn->cb = cb;
 	conn->user_data = user_data;
@@ -441,140 +273,141 @@ int net_conn_register(enum net_ip_protocol proto,
 		      void *user_data,
 		      struct net_conn_handle **handle)
 {
-	int i;
+	struct net_conn *conn = NULL;
+	unsigned int key;
 	uint8_t rank = 0;
+	int i;
+
+	if (remote_addr && remote_addr->family != AF_INET &&
+	    remote_addr->family != AF_INET6) {
+		NET_ERR("Remote address family not set.");
+		return -EINVAL;
+	}
+
+	if (local_addr && local_addr->family != AF_INET &&
+	    local_addr->family != AF_INET6) {
+		NET_ERR("Local address family not set.");
+		return -EINVAL;
+	}
+
+	if (remote_addr && local_addr &&
+	    remote_addr->family != local_addr->family) {
+		NET_ERR("Address families different.");
+		return -EINVAL;
+	}
 
 	for (i = 0; i < CONFIG_NET_MAX_CONN; i++) {
-		if (conns[i].flags & NET_CONN_IN_USE) {
-			continue;
+		if (!(conns[i].flags & NET_CONN_IN_USE)) {
+			conn = &conns[i];
+			break;
 		}
+	}
 
-		if (remote_addr) {
-			if (remote_addr->family != AF_INET &&
-			    remote_addr->family != AF_INET6) {
-				NET_ERR("Remote address family not set.");
-				return -EINVAL;
-			}
+	if (!conn) {
+		return -ENOENT;
+	}
 
-			conns[i].flags |= NET_CONN_REMOTE_ADDR_SET;
+	memset(conn, 0, sizeof(*conn));
 
-			memcpy(&conns[i].remote_addr, remote_addr,
-			       sizeof(struct sockaddr));
+	if (remote_addr) {
+		conn->flags |= NET_CONN_REMOTE_ADDR_SET;
+
+		memcpy(&conn->remote_addr, remote_addr,
+		       sizeof(struct sockaddr));
 
 #if defined(CONFIG_NET_IPV6)
-			if (remote_addr->family == AF_INET6) {
-				if (net_is_ipv6_addr_unspecified(
-					    &net_sin6(remote_addr)->
-							sin6_addr)) {
-					rank |= NET_RANK_REMOTE_UNSPEC_ADDR;
-				} else {
-					rank |= NET_RANK_REMOTE_SPEC_ADDR;
-				}
+		if (remote_addr->family == AF_INET6) {
+			if (net_is_ipv6_addr_unspecified(
+				    &net_sin6(remote_addr)->sin6_addr)) {
+				rank |= NET_RANK_REMOTE_UNSPEC_ADDR;
+			} else {
+				rank |= NET_RANK_REMOTE_SPEC_ADDR;
 			}
+		}
 #endif
 
 #if defined(CONFIG_NET_IPV4)
-			if (remote_addr->family == AF_INET) {
-				if (!net_sin(remote_addr)->
-							sin_addr.s_addr[0]) {
-					rank |= NET_RANK_REMOTE_UNSPEC_ADDR;
-				} else {
-					rank |= NET_RANK_REMOTE_SPEC_ADDR;
-				}
+		if (remote_addr->family == AF_INET) {
+			if (!net_sin(remote_addr)->sin_addr.s_addr[0]) {
+				rank |= NET_RANK_REMOTE_UNSPEC_ADDR;
+			} else {
+				rank |= NET_RANK_REMOTE_SPEC_ADDR;
 			}
-#endif
 		}
+#endif
+	}
 
-		if (local_addr) {
-			if (local_addr->family != AF_INET &&
-			    local_addr->family != AF_INET6) {
-				NET_ERR("Local address family not set.");
-				return -EINVAL;
-			}
-
-			conns[i].flags |= NET_CONN_LOCAL_ADDR_SET;
+	if (local_addr) {
+		conn->flags |= NET_CONN_LOCAL_ADDR_SET;
 
-			memcpy(&conns[i].local_addr, local_addr,
-			       sizeof(struct sockaddr));
+		memcpy(&conn->local_addr, local_addr,
+		       sizeof(struct sockaddr));
 
 #if defined(CONFIG_NET_IPV6)
-			if (local_addr->family == AF_INET6) {
-				if (net_is_ipv6_addr_unspecified(
-					    &net_sin6(local_addr)->
-							sin6_addr)) {
-					rank |= NET_RANK_LOCAL_UNSPEC_ADDR;
-				} else {
-					rank |= NET_RANK_LOCAL_SPEC_ADDR;
-				}
+		if (local_addr->family == AF_INET6) {
+			if (net_is_ipv6_addr_unspecified(
+				    &net_sin6(local_addr)->sin6_addr)) {
+				rank |= NET_RANK_LOCAL_UNSPEC_ADDR;
+			} else {
+				rank |= NET_RANK_LOCAL_SPEC_ADDR;
 			}
+		}
 #endif
 
 #if defined(CONFIG_NET_IPV4)
-			if (local_addr->family == AF_INET) {
-				if (!net_sin(local_addr)->sin_addr.s_addr[0]) {
-					rank |= NET_RANK_LOCAL_UNSPEC_ADDR;
-				} else {
-					rank |= NET_RANK_LOCAL_SPEC_ADDR;
-				}
-			}
-#endif
-		}
-
-		if (remote_addr && local_addr) {
-			if (remote_addr->family != local_addr->family) {
-				NET_ERR("Address families different.");
-				return -EINVAL;
+		if (local_addr->family == AF_INET) {
+			if (!net_sin(local_addr)->sin_addr.s_addr[0]) {
+				rank |= NET_RANK_LOCAL_UNSPEC_ADDR;
+			} else {
+				rank |= NET_RANK_LOCAL_SPEC_ADDR;
 			}
 		}
+#endif
+	}
 
-		if (remote_port) {
-			rank |= NET_RANK_REMOTE_PORT;
-			net_sin(&conns[i].remote_addr)->sin_port =
-				htons(remote_port);
-		}
+	if (remote_port) {
+		rank |= NET_RANK_REMOTE_PORT;
+		net_sin(&conn->remote_addr)->sin_port = htons(remote_port);
+	}
 
-		if (local_port) {
-			rank |= NET_RANK_LOCAL_PORT;
-			net_sin(&conns[i].local_addr)->sin_port =
-				htons(local_port);
-		}
+	if (local_port) {
+		rank |= NET_RANK_LOCAL_PORT;
+		net_sin(&conn->local_addr)->sin_port = htons(local_port);
+	}
 
-		conns[i].flags |= NET_CONN_IN_USE;
-		conns[i].cb = cb;
-		conns[i].user_data = user_data;
-		conns[i].rank = rank;
-		conns[i].proto = proto;
+	conn->cb = cb;
+	conn->user_data = user_data;
+	conn->rank = rank;
+	conn->proto = proto;
 
-		/* Cache needs to be cleared if new entries are added. */
-		cache_clear();
+	key = irq_lock();
+	conn->flags |= NET_CONN_IN_USE;
+	sys_slist_append(conn_list(conn), &conn->node);
+	irq_unlock(key);
 
 #if defined(CONFIG_NET_DEBUG_CONN)
-		do {
-			char dst[NET_IPV6_ADDR_LEN];
-			char src[NET_IPV6_ADDR_LEN];
-
-			prepare_register_debug_print(dst, sizeof(dst),
-						     src, sizeof(src),
-						     remote_addr,
-						     local_addr);
-
-			NET_DBG("[%d/%d/%u/0x%02x] remote %p/%s/%u "
-				"local %p/%s/%u cb %p ud %p",
-				i, local_addr->family, proto, rank,
-				remote_addr, dst, remote_port,
-				local_addr, src, local_port,
-				cb, user_data);
-		} while (0);
+	do {
+		char dst[NET_IPV6_ADDR_LEN];
+		char src[NET_IPV6_ADDR_LEN];
+
+		prepare_register_debug_print(dst, sizeof(dst),
+					     src, sizeof(src),
+					     remote_addr,
+					     local_addr);
+
+		NET_DBG("[%d/%d/%u/0x%02x] remote %p/%s/%u "
+			"local %p/%s/%u cb %p ud %p",
+			i, local_addr ? local_addr->family : AF_UNSPEC,
+			proto, rank, remote_addr, dst, remote_port,
+			local_addr, src, local_port, cb, user_data);
+	} while (0);
 #endif /* CONFIG_NET_DEBUG_CONN */
 
-		if (handle) {
-			*handle = (struct net_conn_handle *)&conns[i];
-		}
-
-		return 0;
+	if (handle) {
+		*handle = (struct net_conn_handle *)conn;
 	}
 
-	return -ENOENT;
+	return 0;
 }
 
 static bool check_addr(struct net_buf *buf,
@@ -646,100 +479,137 @@ static inline void send_icmp_error(struct net_buf *buf)
 	}
 }
 
-enum net_verdict net_conn_input(enum net_ip_protocol proto, struct net_buf *buf)
+static bool conn_match(struct net_conn *conn, enum net_ip_protocol proto,
+		       struct net_buf *buf)
 {
-	int i, best_match = -1;
-	int16_t best_rank = -1;
+	if (conn->proto != proto) {
+		return false;
+	}
 
-#if defined(CONFIG_NET_CONN_CACHE)
-	enum net_verdict verdict;
-	uint32_t cache_value = 0;
-	int32_t pos;
+	if (net_sin(&conn->remote_addr)->sin_port) {
+		if (net_sin(&conn->remote_addr)->sin_port !=
+		    NET_CONN_BUF(buf)->src_port) {
+			return false;
+		}
+	}
 
-	verdict = cache_check(proto, buf, &cache_value, &pos);
-	if (verdict != NET_CONTINUE) {
-		return verdict;
+	if (net_sin(&conn->local_addr)->sin_port) {
+		if (net_sin(&conn->local_addr)->sin_port !=
+		    NET_CONN_BUF(buf)->dst_port) {
+			return false;
+		}
 	}
-#endif
 
-	NET_DBG("Check %s listener for buf %p src port %u dst port %u "
-		"family %d", proto2str(proto), buf,
-		ntohs(NET_CONN_BUF(buf)->src_port),
-		ntohs(NET_CONN_BUF(buf)->dst_port),
-		net_nbuf_family(buf));
+	if (conn->flags & NET_CONN_REMOTE_ADDR_SET) {
+		if (!check_addr(buf, &conn->remote_addr, true)) {
+			return false;
+		}
+	}
 
-	for (i = 0; i < CONFIG_NET_MAX_CONN; i++) {
-		if (!(conns[i].flags & NET_CONN_IN_USE)) {
-			continue;
+	if (conn->flags & NET_CONN_LOCAL_ADDR_SET) {
+		if (!check_addr(buf, &conn->local_addr, false)) {
+			return false;
 		}
+	}
+
+	return true;
+}
+
+/* A connection that specifies the remote port is never overridden by one
+ * that does not, otherwise the higher rank wins.
+ */
+static struct net_conn *conn_find_best(sys_slist_t *list,
+				       enum net_ip_protocol proto,
+				       struct net_buf *buf,
+				       struct net_conn *best)
+{
+	struct net_conn *conn;
 
-		if (conns[i].proto != proto) {
+	SYS_SLIST_FOR_EACH_CONTAINER(list, conn, node) {
+		if (!conn_match(conn, proto, buf)) {
 			continue;
 		}
 
-		if (net_sin(&conns[i].remote_addr)->sin_port) {
-			if (net_sin(&conns[i].remote_addr)->sin_port !=
-			    NET_CONN_BUF(buf)->src_port) {
-				continue;
-			}
-		}
+		if (best) {
+			bool port = net_sin(&conn->remote_addr)->sin_port;
+			bool best_port = net_sin(&best->remote_addr)->sin_port;
 
-		if (net_sin(&conns[i].local_addr)->sin_port) {
-			if (net_sin(&conns[i].local_addr)->sin_port !=
-			    NET_CONN_BUF(buf)->dst_port) {
+			if (best_port && !port) {
 				continue;
 			}
-		}
 
-		if (conns[i].flags & NET_CONN_REMOTE_ADDR_SET) {
-			if (!check_addr(buf, &conns[i].remote_addr, true)) {
+			if (best_port == port && best->rank >= conn->rank) {
 				continue;
 			}
 		}
 
-		if (conns[i].flags & NET_CONN_LOCAL_ADDR_SET) {
-			if (!check_addr(buf, &conns[i].local_addr, false)) {
-				continue;
-			}
-		}
+		best = conn;
+	}
 
-		/* If we have an existing best_match, and that one
-		 * specifies a remote port, then we've matched to a
-		 * LISTENING connection that should not override.
-		 */
-		if (best_match >= 0 &&
-		    net_sin(&conns[best_match].remote_addr)->sin_port) {
-			continue;
-		}
+	return best;
+}
 
-		if (best_rank < conns[i].rank) {
-			best_rank = conns[i].rank;
-			best_match = i;
-		}
+static sys_slist_t *exact_list(enum net_ip_protocol proto,
+			       struct net_buf *buf)
+{
+	void *remote_addr = NULL;
+
+#if defined(CONFIG_NET_IPV6)
+	if (net_nbuf_family(buf) == AF_INET6) {
+		remote_addr = &NET_IPV6_BUF(buf)->src;
+	}
+#endif
+
+#if defined(CONFIG_NET_IPV4)
+	if (net_nbuf_family(buf) == AF_INET) {
+		remote_addr = &NET_IPV4_BUF(buf)->src;
 	}
+#endif
 
-	if (best_match >= 0) {
-#if defined(CONFIG_NET_CONN_CACHE)
-		NET_DBG("[%d] match found cb %p ud %p rank 0x%02x cache 0x%x",
-			best_match,
-			conns[best_match].cb,
-			conns[best_match].user_data,
-			conns[best_match].rank,
-			pos < 0 ? 0 : conn_cache[pos].value);
+	if (!remote_addr) {
+		return NULL;
+	}
 
-		if (pos >= 0) {
-			conn_cache[pos].idx = best_match;
-		}
-#else
-		NET_DBG("[%d] match found cb %p ud %p rank 0x%02x",
-			best_match,
-			conns[best_match].cb,
-			conns[best_match].user_data,
-			conns[best_match].rank);
-#endif /* CONFIG_NET_CONN_CACHE */
-
-		if (conns[best_match].cb(&conns[best_match], buf,
-			     conns[best_match].user_data) == NET_DROP) {
+	return &conn_exact[hash_exact(proto, net_nbuf_family(buf),
+				      remote_addr,
+				      NET_CONN_BUF(buf)->src_port,
+				      NET_CONN_BUF(buf)->dst_port)];
+}
+
+enum net_verdict net_conn_input(enum net_ip_protocol proto, struct net_buf *buf)
+{
+	uint32_t start = net_stats_perf_time();
+	struct net_conn *best_match = NULL;
+	sys_slist_t *list;
+
+	NET_DBG("Check %s listener for buf %p src port %u dst port %u "
+		"family %d", proto2str(proto), buf,
+		ntohs(NET_CONN_BUF(buf)->src_port),
+		ntohs(NET_CONN_BUF(buf)->dst_port),
+		net_nbuf_family(buf));
+
+	list = exact_list(proto, buf);
+	if (list) {
+		best_match = conn_find_best(list, proto, buf, NULL);
+	}
+
+	if (!best_match) {
+		list = &conn_listen[hash_listen(proto,
+						NET_CONN_BUF(buf)->dst_port)];
+		best_match = conn_find_best(list, proto, buf, NULL);
+		best_match = conn_find_best(&conn_any, proto, buf,
+					    best_match);
+	}
+
+	if (best_match) {
+		NET_DBG("[%zu] match found cb %p ud %p rank 0x%02x",
+			best_match - conns,
+			best_match->cb,
+			best_match->user_data,
+			best_match->rank);
+
+		if (best_match->cb(best_match, buf,
+				   best_match->user_data) == NET_DROP) {
 			goto drop;
 		}
 
@@ -747,13 +617,13 @@ enum net_verdict net_conn_input(enum net_ip_protocol proto, struct net_buf *buf)
 			net_stats_update_udp_recv();
 		}
 
+		net_stats_update_l4_time(proto, start);
+
 		return NET_OK;
 	}
 
 	NET_DBG("No match found.");
 
-	cache_add_neg(cache_value);
-
 #if defined(CONFIG_NET_IPV6)
 	/* If the destination address is multicast address,
 	 * we do not send ICMP error as that makes no sense.
@@ -778,18 +648,19 @@ drop:
 		net_stats_update_udp_drop();
 	}
 
+	net_stats_update_l4_time(proto, start);
+
 	return NET_DROP;
 }
 
 void net_conn_init(void)
 {
-#if defined(CONFIG_NET_CONN_CACHE)
-	do {
-		int i;
+	int i;
 
-		for (i = 0; i < CONFIG_NET_MAX_CONN; i++) {
-			conn_cache[i].idx = -1;
-		}
-	} while (0);
-#endif /* CONFIG_NET_CONN_CACHE */
+	for (i = 0; i < CONFIG_NET_CONN_HASH_SIZE; i++) {
+		sys_slist_init(&conn_exact[i]);
+		sys_slist_init(&conn_listen[i]);
+	}
+
+	sys_slist_init(&conn_any);
 }
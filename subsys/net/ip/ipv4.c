@@ -84,6 +84,7 @@ struct net_buf *net_ipv4_finalize_raw(struct net_buf *buf,
 {
 	/* Set the length of the IPv4 header */
 	size_t total_len;
+	bool chksum = net_if_need_tx_chksum(net_nbuf_iface(buf));
 
 	net_nbuf_compact(buf);
 
@@ -93,18 +94,24 @@ struct net_buf *net_ipv4_finalize_raw(struct net_buf *buf,
 	NET_IPV4_BUF(buf)->len[1] = total_len - NET_IPV4_BUF(buf)->len[0] * 256;
 
 	NET_IPV4_BUF(buf)->chksum = 0;
-	NET_IPV4_BUF(buf)->chksum = ~net_calc_chksum_ipv4(buf);
+	if (chksum) {
+		NET_IPV4_BUF(buf)->chksum = ~net_calc_chksum_ipv4(buf);
+	}
 
 #if defined(CONFIG_NET_UDP)
 	if (next_header == IPPROTO_UDP) {
 		NET_UDP_BUF(buf)->chksum = 0;
-		NET_UDP_BUF(buf)->chksum = ~net_calc_chksum_udp(buf);
+		if (chksum) {
+			NET_UDP_BUF(buf)->chksum = ~net_calc_chksum_udp(buf);
+		}
 	}
 #endif
 #if defined(CONFIG_NET_TCP)
 	if (next_header == IPPROTO_TCP) {
 		NET_TCP_BUF(buf)->chksum = 0;
-		NET_TCP_BUF(buf)->chksum = ~net_calc_chksum_tcp(buf);
+		if (chksum) {
+			NET_TCP_BUF(buf)->chksum = ~net_calc_chksum_tcp(buf);
+		}
 	}
 #endif
 
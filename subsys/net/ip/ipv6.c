@@ -376,6 +376,7 @@ struct net_buf *net_ipv6_finalize_raw(struct net_buf *buf,
 {
 	/* Set the length of the IPv6 header */
 	size_t total_len;
+	bool chksum = net_if_need_tx_chksum(net_nbuf_iface(buf));
 
 #if defined(CONFIG_NET_UDP) && defined(CONFIG_NET_RPL_INSERT_HBH_OPTION)
 	if (next_header != IPPROTO_TCP && next_header != IPPROTO_ICMPV6) {
@@ -398,14 +399,18 @@ struct net_buf *net_ipv6_finalize_raw(struct net_buf *buf,
 #if defined(CONFIG_NET_UDP)
 	if (next_header == IPPROTO_UDP) {
 		NET_UDP_BUF(buf)->chksum = 0;
-		NET_UDP_BUF(buf)->chksum = ~net_calc_chksum_udp(buf);
+		if (chksum) {
+			NET_UDP_BUF(buf)->chksum = ~net_calc_chksum_udp(buf);
+		}
 	} else
 #endif
 
 #if defined(CONFIG_NET_TCP)
 	if (next_header == IPPROTO_TCP) {
 		NET_TCP_BUF(buf)->chksum = 0;
-		NET_TCP_BUF(buf)->chksum = ~net_calc_chksum_tcp(buf);
+		if (chksum) {
+			NET_TCP_BUF(buf)->chksum = ~net_calc_chksum_tcp(buf);
+		}
 	} else
 #endif
 
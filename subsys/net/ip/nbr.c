@@ -61,17 +61,16 @@ struct net_nbr *net_nbr_ref(struct net_nbr *nbr)
 
 static inline struct net_nbr *get_nbr(struct net_nbr *start, int idx)
 {
-	NET_ASSERT(idx < CONFIG_NET_IPV6_MAX_NEIGHBORS);
-
 	return (struct net_nbr *)((void *)start +
-			((sizeof(struct net_nbr) + start->size) * idx));
+			((sizeof(struct net_nbr) + start->size +
+			  start->extra_data_size) * idx));
 }
 
 struct net_nbr *net_nbr_get(struct net_nbr_table *table)
 {
 	int i;
 
-	for (i = 0; i < CONFIG_NET_IPV6_MAX_NEIGHBORS; i++) {
+	for (i = 0; i < table->nbr_count; i++) {
 		struct net_nbr *nbr = get_nbr(table->nbr, i);
 
 		if (!nbr->ref) {
@@ -44,8 +44,10 @@ struct net_nbr_lladdr {
  * data at the end of the node.
  */
 struct net_nbr {
-	/** Reference count. */
-	uint8_t ref;
+	/** Reference count. A next hop neighbor is referenced by each
+	 * route going through it.
+	 */
+	uint16_t ref;
 
 	/** Link to ll address. This is the index into lladdr array.
 	 * The value NET_NBR_LLADDR_UNKNOWN tells that this neighbor
@@ -92,6 +94,9 @@ struct net_nbr_table {
 	/** Link to a neighbor pool */
 	struct net_nbr *nbr;
 
+	/** Number of neighbors in the pool */
+	const uint16_t nbr_count;
+
 	/** Function to be called when the table is cleared. */
 	void (*const clear)(struct net_nbr_table *table);
 };
@@ -108,6 +113,7 @@ struct net_nbr_table {
 		.table = {						\
 			.clear = _clear,				\
 			.nbr = (struct net_nbr *)_pool,			\
+			.nbr_count = ARRAY_SIZE(_pool),			\
 		}							\
 	}
 
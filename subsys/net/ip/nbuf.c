@@ -18,10 +18,13 @@
 #include <kernel.h>
 #include <toolchain.h>
 #include <string.h>
+#include <errno.h>
 #include <stdint.h>
+#include <limits.h>
 #include <sys/types.h>
 
 #include <misc/util.h>
+#include <misc/byteorder.h>
 
 #include <net/net_core.h>
 #include <net/net_ip.h>
@@ -29,13 +32,24 @@
 #include <net/nbuf.h>
 
 #include "net_private.h"
+#include "net_stats.h"
 
 /* Available (free) buffers queue */
 #define NBUF_RX_COUNT	CONFIG_NET_NBUF_RX_COUNT
 #define NBUF_TX_COUNT	CONFIG_NET_NBUF_TX_COUNT
 #define NBUF_DATA_COUNT	CONFIG_NET_NBUF_DATA_COUNT
 #define NBUF_DATA_LEN	CONFIG_NET_NBUF_DATA_SIZE
+
+#if CONFIG_NET_CONTEXT_NBUF_QUOTA > 0
+/* Data fragments remember the context they are charged to, the pointer
+ * is stored after the user data reserved for the drivers.
+ */
+#define NBUF_OWNER_OFFSET ROUND_UP(CONFIG_NET_NBUF_USER_DATA_SIZE, \
+				   sizeof(struct net_context *))
+#define NBUF_USER_DATA_LEN (NBUF_OWNER_OFFSET + sizeof(struct net_context *))
+#else
 #define NBUF_USER_DATA_LEN CONFIG_NET_NBUF_USER_DATA_SIZE
+#endif
 
 #if defined(CONFIG_NET_TCP)
 #define APP_PROTO_LEN NET_TCPH_LEN
@@ -100,6 +114,41 @@ NET_BUF_POOL_DEFINE(data_buffers, NBUF_DATA_COUNT, NBUF_DATA_LEN,
 #define tx_buffers_pool _net_buf_pool_tx_buffers
 #define data_buffers_pool _net_buf_pool_data_buffers
 
+#if defined(CONFIG_NET_NBUF_VAR_DATA)
+static void free_var_data_func(struct net_buf *buf);
+
+/* Large data fragments are carved from a memory pool. They are not
+ * allocated through net_buf_alloc(), the pool only tells them apart from
+ * other fragments and frees them.
+ */
+K_MEM_POOL_DEFINE(var_data_pool, 128, 2048, CONFIG_NET_NBUF_VAR_DATA_COUNT,
+		  4);
+
+static struct net_buf_pool var_data_buffers = {
+	.user_data_size = NBUF_USER_DATA_LEN,
+	.destroy = free_var_data_func,
+};
+
+struct var_frag {
+	struct k_mem_block block;
+	struct net_buf buf;
+};
+#endif /* CONFIG_NET_NBUF_VAR_DATA */
+
+/* Free data fragments are counted even without buffer debugging, as
+ * contexts must leave CONFIG_NET_NBUF_DATA_RESERVE of them to the stack
+ * and the watermarks are checked against the count.
+ */
+static atomic_t data_free = ATOMIC_INIT(NBUF_DATA_COUNT);
+
+/* Given once per waiting context every time a data fragment is freed, so
+ * that a single free wakes all of them up to recheck their limits.
+ */
+static K_SEM_DEFINE(data_freed, 0, UINT_MAX);
+static atomic_t data_waiters;
+
+static sys_slist_t watermarks;
+
 #if defined(CONFIG_NET_DEBUG_NET_BUF)
 
 #define NET_BUF_CHECK_IF_IN_USE(buf, ref)				\
@@ -239,9 +288,98 @@ static inline int get_frees(struct net_buf_pool *pool)
 
 static inline bool is_from_data_pool(struct net_buf *buf)
 {
+#if defined(CONFIG_NET_NBUF_VAR_DATA)
+	if (buf->pool == &var_data_buffers) {
+		return true;
+	}
+#endif
+
 	return (buf->pool == &data_buffers);
 }
 
+#if CONFIG_NET_CONTEXT_NBUF_QUOTA > 0
+static inline struct net_context **data_owner(struct net_buf *frag)
+{
+	return (struct net_context **)((uint8_t *)net_buf_user_data(frag) +
+				       NBUF_OWNER_OFFSET);
+}
+#endif
+
+/* Fragments are allocated and freed from interrupt context too, so the
+ * list is walked and the callbacks are called with interrupts locked.
+ */
+static void check_watermarks(void)
+{
+	struct net_nbuf_watermark *wm;
+	unsigned int key;
+	int count;
+
+	key = irq_lock();
+
+	count = atomic_get(&data_free);
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&watermarks, wm, node) {
+		if (!wm->is_low && count <= wm->low) {
+			wm->is_low = true;
+		} else if (wm->is_low && count >= wm->high) {
+			wm->is_low = false;
+		} else {
+			continue;
+		}
+
+		wm->cb(wm, wm->is_low);
+	}
+
+	irq_unlock(key);
+}
+
+void net_nbuf_watermark_add(struct net_nbuf_watermark *wm)
+{
+	unsigned int key;
+
+	NET_ASSERT(wm->cb && wm->low < wm->high);
+
+	wm->is_low = false;
+
+	key = irq_lock();
+	sys_slist_append(&watermarks, &wm->node);
+	irq_unlock(key);
+
+	check_watermarks();
+}
+
+void net_nbuf_watermark_remove(struct net_nbuf_watermark *wm)
+{
+	unsigned int key;
+
+	key = irq_lock();
+	sys_slist_find_and_remove(&watermarks, &wm->node);
+	irq_unlock(key);
+}
+
+/* Called for every data fragment that goes back to its pool */
+static void data_released(struct net_buf *buf)
+{
+	int waiters;
+
+#if CONFIG_NET_CONTEXT_NBUF_QUOTA > 0
+	struct net_context *owner = *data_owner(buf);
+
+	if (owner) {
+		atomic_dec(&owner->data_held);
+	}
+#endif
+
+	if (buf->pool == &data_buffers) {
+		atomic_inc(&data_free);
+		check_watermarks();
+	}
+
+	for (waiters = atomic_get(&data_waiters); waiters > 0; waiters--) {
+		k_sem_give(&data_freed);
+	}
+}
+
 static inline void free_rx_bufs_func(struct net_buf *buf)
 {
 	inc_free_rx_bufs(buf);
@@ -260,9 +398,34 @@ static inline void free_data_bufs_func(struct net_buf *buf)
 {
 	inc_free_data_bufs(buf);
 
+	data_released(buf);
+
 	net_buf_destroy(buf);
 }
 
+#if defined(CONFIG_NET_NBUF_VAR_DATA)
+static void free_var_data_func(struct net_buf *buf)
+{
+	struct k_mem_block block;
+
+	data_released(buf);
+
+	block = CONTAINER_OF(buf, struct var_frag, buf)->block;
+	k_mem_pool_free(&block);
+}
+#endif /* CONFIG_NET_NBUF_VAR_DATA */
+
+static inline void alloc_failed(struct net_buf_pool *pool)
+{
+	if (pool == &rx_buffers) {
+		net_stats_update_rx_alloc_fail();
+	} else if (pool == &tx_buffers) {
+		net_stats_update_tx_alloc_fail();
+	} else {
+		net_stats_update_data_alloc_fail();
+	}
+}
+
 #if defined(CONFIG_NET_DEBUG_NET_BUF)
 static inline const char *pool2str(struct net_buf_pool *pool)
 {
@@ -274,6 +437,12 @@ static inline const char *pool2str(struct net_buf_pool *pool)
 		return "DATA";
 	}
 
+#if defined(CONFIG_NET_NBUF_VAR_DATA)
+	if (pool == &var_data_buffers) {
+		return "VAR";
+	}
+#endif
+
 	return "EXTERNAL";
 }
 
@@ -334,6 +503,7 @@ static struct net_buf *net_nbuf_get_reserve(struct net_buf_pool *pool,
 	}
 
 	if (!buf) {
+		alloc_failed(pool);
 		return NULL;
 	}
 
@@ -342,6 +512,14 @@ static struct net_buf *net_nbuf_get_reserve(struct net_buf_pool *pool,
 		 * header (like IPv4 or IPv6 packet header).
 		 */
 		net_buf_reserve(buf, reserve_head);
+
+#if CONFIG_NET_CONTEXT_NBUF_QUOTA > 0
+		*data_owner(buf) = NULL;
+#endif
+
+		atomic_dec(&data_free);
+		net_stats_update_data_free(atomic_get(&data_free));
+		check_watermarks();
 	} else {
 		memset(net_buf_user_data(buf), 0, sizeof(struct net_nbuf));
 	}
@@ -404,6 +582,151 @@ struct net_buf *net_nbuf_get_reserve_data(uint16_t reserve_head,
 
 #endif /* CONFIG_NET_DEBUG_NET_BUF */
 
+#if defined(CONFIG_NET_NBUF_VAR_DATA)
+static struct net_buf *var_data_get(uint16_t size)
+{
+	struct k_mem_block block;
+	struct var_frag *frag;
+	struct net_buf *buf;
+
+	/* The user data follows the data, aligned as net_buf_user_data()
+	 * expects it.
+	 */
+	if (k_mem_pool_alloc(&var_data_pool, &block,
+			     sizeof(struct var_frag) + ROUND_UP(size, 4) +
+			     NBUF_USER_DATA_LEN, K_NO_WAIT)) {
+		return NULL;
+	}
+
+	frag = block.data;
+	frag->block = block;
+
+	buf = &frag->buf;
+	buf->pool = &var_data_buffers;
+	buf->ref = 1;
+	buf->flags = 0;
+	buf->frags = NULL;
+	buf->size = size;
+	buf->len = 0;
+	buf->data = buf->__buf;
+
+#if CONFIG_NET_CONTEXT_NBUF_QUOTA > 0
+	*data_owner(buf) = NULL;
+#endif
+
+	return buf;
+}
+#endif /* CONFIG_NET_NBUF_VAR_DATA */
+
+struct net_buf *net_nbuf_get_reserve_data_len(uint16_t reserve_head,
+					      uint16_t len, int32_t timeout)
+{
+#if defined(CONFIG_NET_NBUF_VAR_DATA)
+	if (len > NBUF_DATA_LEN - reserve_head && !k_is_in_isr()) {
+		struct net_buf *buf;
+
+		buf = var_data_get(reserve_head + len);
+		if (buf) {
+			net_buf_reserve(buf, reserve_head);
+
+			NET_DBG("VAR buf %p reserve %u len %u", buf,
+				reserve_head, len);
+
+			return buf;
+		}
+	}
+#endif /* CONFIG_NET_NBUF_VAR_DATA */
+
+	return net_nbuf_get_reserve_data(reserve_head, timeout);
+}
+
+bool net_nbuf_charge(struct net_buf *buf, struct net_context *context)
+{
+#if CONFIG_NET_CONTEXT_NBUF_QUOTA > 0
+	struct net_buf *frag;
+	int count = 0;
+
+	for (frag = buf->frags; frag; frag = frag->frags) {
+		if (is_from_data_pool(frag) && !*data_owner(frag)) {
+			count++;
+		}
+	}
+
+	if (!count) {
+		return true;
+	}
+
+	if (atomic_get(&context->data_held) + count >
+	    CONFIG_NET_CONTEXT_NBUF_QUOTA) {
+		NET_DBG("Context %p holds %d data fragments, dropping %p",
+			context, (int)atomic_get(&context->data_held), buf);
+		return false;
+	}
+
+	for (frag = buf->frags; frag; frag = frag->frags) {
+		if (is_from_data_pool(frag) && !*data_owner(frag)) {
+			*data_owner(frag) = context;
+		}
+	}
+
+	atomic_add(&context->data_held, count);
+#endif /* CONFIG_NET_CONTEXT_NBUF_QUOTA > 0 */
+
+	return true;
+}
+
+#if CONFIG_NET_NBUF_DATA_RESERVE > 0 || CONFIG_NET_CONTEXT_NBUF_QUOTA > 0
+static inline bool context_data_allowed(struct net_context *context)
+{
+#if CONFIG_NET_CONTEXT_NBUF_QUOTA > 0
+	if (atomic_get(&context->data_held) >= CONFIG_NET_CONTEXT_NBUF_QUOTA) {
+		return false;
+	}
+#endif
+
+	return atomic_get(&data_free) > CONFIG_NET_NBUF_DATA_RESERVE;
+}
+
+/* Wait until the context is allowed to take a data fragment. The limits
+ * are soft: allocations running concurrently may overrun them a little.
+ */
+static bool context_data_wait(struct net_context *context, int32_t timeout)
+{
+	int64_t end = k_uptime_get() + timeout;
+	bool allowed = true;
+
+	if (context_data_allowed(context)) {
+		return true;
+	}
+
+	if (timeout == K_NO_WAIT || k_is_in_isr()) {
+		return false;
+	}
+
+	/* Counted as a waiter before checking again, so that a fragment
+	 * freed in between is not missed.
+	 */
+	atomic_inc(&data_waiters);
+
+	while (!context_data_allowed(context)) {
+		int32_t remaining = K_FOREVER;
+
+		if (timeout != K_FOREVER) {
+			remaining = end - k_uptime_get();
+			if (remaining <= 0) {
+				allowed = false;
+				break;
+			}
+		}
+
+		k_sem_take(&data_freed, remaining);
+	}
+
+	atomic_dec(&data_waiters);
+
+	return allowed;
+}
+#endif
 
 #if defined(CONFIG_NET_DEBUG_NET_BUF)
 static struct net_buf *net_nbuf_get_debug(struct net_buf_pool *pool,
@@ -435,6 +758,14 @@ static struct net_buf *net_nbuf_get(struct net_buf_pool *pool,
 
 	reserve = net_if_get_ll_reserve(iface, addr6);
 
+#if CONFIG_NET_NBUF_DATA_RESERVE > 0 || CONFIG_NET_CONTEXT_NBUF_QUOTA > 0
+	if (pool == &data_buffers && !context_data_wait(context, timeout)) {
+		NET_DBG("Context %p over its data fragment limit", context);
+		alloc_failed(pool);
+		return NULL;
+	}
+#endif
+
 #if defined(CONFIG_NET_DEBUG_NET_BUF)
 	buf = net_nbuf_get_reserve_debug(pool, reserve, timeout, caller, line);
 #else
@@ -444,6 +775,13 @@ static struct net_buf *net_nbuf_get(struct net_buf_pool *pool,
 		return buf;
 	}
 
+#if CONFIG_NET_CONTEXT_NBUF_QUOTA > 0
+	if (pool == &data_buffers) {
+		*data_owner(buf) = context;
+		atomic_inc(&context->data_held);
+	}
+#endif
+
 	if (pool != &data_buffers) {
 		net_nbuf_set_context(buf, context);
 		net_nbuf_set_ll_reserve(buf, reserve);
@@ -1057,6 +1395,84 @@ struct net_buf *net_nbuf_read_be32(struct net_buf *buf, uint16_t offset,
 	return retbuf;
 }
 
+/* Move the cursor to the fragment holding its next byte */
+static inline void cursor_normalize(struct net_nbuf_cursor *cur)
+{
+	while (cur->frag && cur->pos >= cur->frag->len) {
+		cur->pos -= cur->frag->len;
+		cur->frag = cur->frag->frags;
+	}
+}
+
+void net_nbuf_cursor_init(struct net_nbuf_cursor *cur, struct net_buf *frag,
+			  uint16_t offset, uint16_t len)
+{
+	cur->frag = frag;
+	cur->pos = offset;
+	cur->left = 0;
+
+	cursor_normalize(cur);
+	if (!cur->frag) {
+		return;
+	}
+
+	cur->left = min(len, net_buf_frags_len(cur->frag) - cur->pos);
+}
+
+int net_nbuf_cursor_read(struct net_nbuf_cursor *cur, void *data,
+			 uint16_t len)
+{
+	uint8_t *ptr = data;
+
+	if (len > cur->left) {
+		return -ENODATA;
+	}
+
+	cur->left -= len;
+
+	while (len) {
+		uint16_t count = min(len, cur->frag->len - cur->pos);
+
+		if (ptr) {
+			memcpy(ptr, cur->frag->data + cur->pos, count);
+			ptr += count;
+		}
+
+		cur->pos += count;
+		len -= count;
+
+		cursor_normalize(cur);
+	}
+
+	return 0;
+}
+
+int net_nbuf_cursor_read_be16(struct net_nbuf_cursor *cur, uint16_t *value)
+{
+	uint8_t v16[2];
+	int ret;
+
+	ret = net_nbuf_cursor_read(cur, v16, sizeof(v16));
+	if (!ret) {
+		*value = sys_get_be16(v16);
+	}
+
+	return ret;
+}
+
+int net_nbuf_cursor_read_be32(struct net_nbuf_cursor *cur, uint32_t *value)
+{
+	uint8_t v32[4];
+	int ret;
+
+	ret = net_nbuf_cursor_read(cur, v32, sizeof(v32));
+	if (!ret) {
+		*value = sys_get_be32(v32);
+	}
+
+	return ret;
+}
+
 static inline struct net_buf *check_and_create_data(struct net_buf *buf,
 						    struct net_buf *data,
 						    int32_t timeout)
@@ -1371,7 +1787,7 @@ void net_nbuf_get_info(size_t *tx_size, size_t *rx_size, size_t *data_size,
 #else
 	*tx = BIT(31);
 	*rx = BIT(31);
-	*data = BIT(31);
+	*data = atomic_get(&data_free);
 #endif /* CONFIG_NET_DEBUG_NET_BUF */
 }
 
@@ -716,7 +716,7 @@ static inline int send_syn_ack(struct net_context *context,
 }
 
 static inline int send_ack(struct net_context *context,
-			   struct sockaddr *remote)
+			   struct sockaddr *remote, bool force)
 {
 	struct net_buf *buf = NULL;
 	int ret;
@@ -724,7 +724,7 @@ static inline int send_ack(struct net_context *context,
 	/* Something (e.g. a data transmission under the user
 	 * callback) already sent the ACK, no need
 	 */
-	if (context->tcp->send_ack == context->tcp->sent_ack) {
+	if (!force && context->tcp->send_ack == context->tcp->sent_ack) {
 		return 0;
 	}
 
@@ -772,6 +772,43 @@ static int tcp_hdr_len(struct net_buf *buf)
 	return 4 * (hdr->offset >> 4);
 }
 
+/* Hand over an in-order segment to the application */
+static enum net_verdict tcp_deliver(struct net_conn *conn,
+				    struct net_context *context,
+				    struct net_buf *buf)
+{
+	uint8_t tcp_flags = NET_TCP_FLAGS(buf);
+	enum net_verdict ret;
+
+	/* A segment over the context quota is not acknowledged, the peer
+	 * sends it again once the application has consumed its data.
+	 */
+	if (net_nbuf_appdatalen(buf) && !net_nbuf_charge(buf, context)) {
+		return NET_DROP;
+	}
+
+	context->tcp->send_ack += net_nbuf_appdatalen(buf);
+
+	ret = packet_received(conn, buf, context->tcp->recv_user_data);
+
+	if (tcp_flags & NET_TCP_FIN) {
+		/* Sending an ACK in the CLOSE_WAIT state will transition to
+		 * LAST_ACK state
+		 */
+		context->tcp->fin_rcvd = 1;
+		net_tcp_change_state(context->tcp, NET_TCP_CLOSE_WAIT);
+
+		context->tcp->send_ack += 1;
+
+		if (context->recv_cb) {
+			context->recv_cb(context, NULL, 0,
+					 context->tcp->recv_user_data);
+		}
+	}
+
+	return ret;
+}
+
 /* This is called when we receive data after the connection has been
  * established. The core TCP logic is located here.
  */
@@ -793,39 +830,40 @@ NET_CONN_CB(tcp_established)
 
 	tcp_flags = NET_TCP_FLAGS(buf);
 	if (tcp_flags & NET_TCP_ACK) {
-		net_tcp_ack_received(context,
-				     sys_get_be32(NET_TCP_BUF(buf)->ack));
-	}
-
-	if (sys_get_be32(NET_TCP_BUF(buf)->seq) - context->tcp->send_ack) {
-		/* Don't try to reorder packets.  If it doesn't
-		 * match the next segment exactly, drop and wait for
-		 * retransmit
-		 */
-		return NET_DROP;
+		net_tcp_ack_received(context, buf);
 	}
 
 	set_appdata_values(buf, IPPROTO_TCP, net_buf_frags_len(buf));
-	context->tcp->send_ack += net_nbuf_appdatalen(buf);
 
-	ret = packet_received(conn, buf, context->tcp->recv_user_data);
+	if (sys_get_be32(NET_TCP_BUF(buf)->seq) - context->tcp->send_ack) {
+		bool queued = false;
 
-	if (tcp_flags & NET_TCP_FIN) {
-		/* Sending an ACK in the CLOSE_WAIT state will transition to
-		 * LAST_ACK state
+		/* Keep a segment received ahead of a missing one, and
+		 * send a duplicate ACK right away so that the peer can
+		 * retransmit the missing one without waiting for its
+		 * retransmission timeout.
 		 */
-		context->tcp->fin_rcvd = 1;
-		net_tcp_change_state(context->tcp, NET_TCP_CLOSE_WAIT);
+		if (net_nbuf_appdatalen(buf) || (tcp_flags & NET_TCP_FIN)) {
+			queued = net_tcp_queue_ooo(context->tcp, buf);
+			send_ack(context, &conn->remote_addr, true);
+		}
 
-		context->tcp->send_ack += 1;
+		return queued ? NET_OK : NET_DROP;
+	}
 
-		if (context->recv_cb) {
-			context->recv_cb(context, NULL, 0,
-					 context->tcp->recv_user_data);
+	ret = tcp_deliver(conn, context, buf);
+
+	/* The segment may have filled the hole in front of queued ones */
+	while ((buf = net_tcp_dequeue_ooo(context->tcp))) {
+		NET_DBG("Delivering queued seq 0x%x",
+			sys_get_be32(NET_TCP_BUF(buf)->seq));
+
+		if (tcp_deliver(conn, context, buf) == NET_DROP) {
+			net_nbuf_unref(buf);
 		}
 	}
 
-	send_ack(context, &conn->remote_addr);
+	send_ack(context, &conn->remote_addr, false);
 
 	if (sys_slist_is_empty(&context->tcp->sent_list)
 	    && context->tcp->fin_rcvd
@@ -925,6 +963,8 @@ NET_CONN_CB(tcp_synack_received)
 			return NET_DROP;
 		}
 
+		net_tcp_syn_options_parse(context->tcp, buf);
+
 		/* Remove the temporary connection handler and register
 		 * a proper now as we have an established connection.
 		 */
@@ -946,7 +986,7 @@ NET_CONN_CB(tcp_synack_received)
 		net_tcp_change_state(context->tcp, NET_TCP_ESTABLISHED);
 		net_context_set_state(context, NET_CONTEXT_CONNECTED);
 
-		send_ack(context, raddr);
+		send_ack(context, raddr, false);
 
 		k_sem_give(&context->tcp->connect_wait);
 
@@ -1233,6 +1273,8 @@ NET_CONN_CB(tcp_syn_rcvd)
 
 		net_tcp_change_state(tcp, NET_TCP_SYN_RCVD);
 
+		net_tcp_syn_options_parse(tcp, buf);
+
 		remote = create_sockaddr(buf, &peer);
 
 		/* FIXME: Is this the correct place to set tcp->send_ack? */
@@ -1390,6 +1432,8 @@ NET_CONN_CB(tcp_syn_rcvd)
 		 * was used to establish this connection. The new TCP
 		 * must be listening to accept other connections.
 		 */
+		net_tcp_set_send_wnd(tcp, buf);
+
 		tmp_tcp = new_context->tcp;
 		tmp_tcp->accept_cb = tcp->accept_cb;
 		tcp->accept_cb = NULL;
@@ -1538,7 +1582,8 @@ static int send_data(struct net_context *context,
 	context->user_data = user_data;
 	net_nbuf_set_token(buf, token);
 
-	if (!timeout || net_context_get_ip_proto(context) == IPPROTO_UDP) {
+	/* TCP data goes out as the send windows allow */
+	if (net_context_get_ip_proto(context) == IPPROTO_UDP) {
 		return net_send_data(buf);
 	}
 
@@ -1812,6 +1857,10 @@ enum net_verdict packet_received(struct net_conn *conn,
 	if (context->recv_cb) {
 		size_t total_len = net_buf_frags_len(buf);
 
+		if (!net_nbuf_charge(buf, context)) {
+			return NET_DROP;
+		}
+
 		/* TCP packets get appdata earlier in tcp_established() */
 		if (net_context_get_ip_proto(context) != IPPROTO_TCP) {
 			if (net_nbuf_family(buf) == AF_INET6) {
@@ -60,17 +60,27 @@ NET_STACK_DEFINE(RX, rx_stack, CONFIG_NET_RX_STACK_SIZE,
 static struct k_fifo rx_queue;
 static k_tid_t rx_tid;
 
+#if defined(CONFIG_NET_STATISTICS_PERF)
+static atomic_t rx_queue_len;
+#endif
+
 #if defined(CONFIG_NET_IPV6)
 static inline enum net_verdict process_icmpv6_pkt(struct net_buf *buf,
 						  struct net_ipv6_hdr *ipv6)
 {
 	struct net_icmp_hdr *hdr = NET_ICMP_BUF(buf);
 	uint16_t len = (ipv6->len[0] << 8) + ipv6->len[1];
+	uint32_t start = net_stats_perf_time();
+	enum net_verdict verdict;
 
 	NET_DBG("ICMPv6 packet received length %d type %d code %d",
 		len, hdr->type, hdr->code);
 
-	return net_icmpv6_input(buf, len, hdr->type, hdr->code);
+	verdict = net_icmpv6_input(buf, len, hdr->type, hdr->code);
+
+	net_stats_update_icmp_time(start);
+
+	return verdict;
 }
 
 static inline struct net_buf *check_unknown_option(struct net_buf *buf,
@@ -383,11 +393,17 @@ static inline enum net_verdict process_icmpv4_pkt(struct net_buf *buf,
 {
 	struct net_icmp_hdr *hdr = NET_ICMP_BUF(buf);
 	uint16_t len = (ipv4->len[0] << 8) + ipv4->len[1];
+	uint32_t start = net_stats_perf_time();
+	enum net_verdict verdict;
 
 	NET_DBG("ICMPv4 packet received length %d type %d code %d",
 		len, hdr->type, hdr->code);
 
-	return net_icmpv4_input(buf, len, hdr->type, hdr->code);
+	verdict = net_icmpv4_input(buf, len, hdr->type, hdr->code);
+
+	net_stats_update_icmp_time(start);
+
+	return verdict;
 }
 #endif /* CONFIG_NET_IPV4 */
 
@@ -457,6 +473,8 @@ drop:
 static inline enum net_verdict process_data(struct net_buf *buf,
 					    bool is_loopback)
 {
+	enum net_verdict verdict;
+	uint32_t start;
 	int ret;
 
 	/* If there is no data, then drop the packet. Also if
@@ -485,19 +503,25 @@ static inline enum net_verdict process_data(struct net_buf *buf,
 		}
 	}
 
+	start = net_stats_perf_time();
+
 	/* IP version and header length. */
 	switch (NET_IPV6_BUF(buf)->vtc & 0xf0) {
 #if defined(CONFIG_NET_IPV6)
 	case 0x60:
 		net_stats_update_ipv6_recv();
 		net_nbuf_set_family(buf, PF_INET6);
-		return process_ipv6_pkt(buf);
+		verdict = process_ipv6_pkt(buf);
+		net_stats_update_ipv6_time(start);
+		return verdict;
 #endif
 #if defined(CONFIG_NET_IPV4)
 	case 0x40:
 		net_stats_update_ipv4_recv();
 		net_nbuf_set_family(buf, PF_INET);
-		return process_ipv4_pkt(buf);
+		verdict = process_ipv4_pkt(buf);
+		net_stats_update_ipv4_time(start);
+		return verdict;
 #endif
 	}
 
@@ -537,20 +561,35 @@ static void net_rx_thread(void)
 	while (1) {
 #if defined(CONFIG_NET_STATISTICS) || defined(CONFIG_NET_DEBUG_CORE)
 		size_t pkt_len;
+		size_t burst_len = 0;
 #endif
+		uint8_t burst, count = 0;
 
 		buf = net_buf_get(&rx_queue, K_FOREVER);
 
 		net_analyze_stack("RX thread", rx_stack, sizeof(rx_stack));
 
+		/* Drain up to a burst of packets before yielding, the burst
+		 * size is the one of the interface of the first packet.
+		 */
+		burst = net_if_get_rx_burst(net_nbuf_iface(buf));
+
+		do {
+			net_stats_update_rx_dequeued(buf, &rx_queue_len);
+
 #if defined(CONFIG_NET_STATISTICS) || defined(CONFIG_NET_DEBUG_CORE)
-		pkt_len = net_buf_frags_len(buf);
+			pkt_len = net_buf_frags_len(buf);
+			burst_len += pkt_len;
 #endif
-		NET_DBG("Received buf %p len %zu", buf, pkt_len);
+			NET_DBG("Received buf %p len %zu", buf, pkt_len);
+
+			processing_data(buf, false);
+		} while (++count < burst &&
+			 (buf = net_buf_get(&rx_queue, K_NO_WAIT)));
 
-		net_stats_update_bytes_recv(pkt_len);
+		NET_DBG("Processed %u packets in burst", count);
 
-		processing_data(buf, false);
+		net_stats_update_bytes_recv(burst_len);
 
 		net_print_statistics();
 		net_nbuf_print();
@@ -702,6 +741,8 @@ int net_recv_data(struct net_if *iface, struct net_buf *buf)
 
 	net_nbuf_set_iface(buf, iface);
 
+	net_stats_update_rx_queued(buf, &rx_queue_len);
+
 	net_buf_put(&rx_queue, buf);
 
 	return 0;
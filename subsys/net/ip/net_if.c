@@ -67,9 +67,58 @@ static inline void net_context_send_cb(struct net_context *context,
 #endif
 }
 
+/* Packet information needed once the driver owns the packet */
+struct tx_info {
+	struct net_linkaddr *dst;
+	struct net_context *context;
+	void *context_token;
+	int status;
+#if defined(CONFIG_NET_STATISTICS)
+	size_t pkt_len;
+#endif
+};
+
+static void net_if_tx_batch(struct net_if *iface, struct net_buf **bufs,
+			    struct tx_info *info, int count)
+{
+	const struct net_if_api *api = iface->dev->driver_api;
+	int sent = 0;
+	int i;
+
+	if (!atomic_test_bit(iface->flags, NET_IF_UP)) {
+		/* Drop packets if interface is not up */
+		NET_WARN("iface %p is down", iface);
+
+		for (i = 0; i < count; i++) {
+			info[i].status = -ENETDOWN;
+		}
+
+		return;
+	}
+
+	if (api->send_batch && count > 1) {
+		sent = api->send_batch(iface, bufs, count);
+		if (sent < 0) {
+			sent = 0;
+		}
+
+		NET_DBG("Driver accepted %d of %d packets", sent, count);
+	}
+
+	for (i = 0; i < sent; i++) {
+		info[i].status = 0;
+	}
+
+	for (; i < count; i++) {
+		info[i].status = api->send(iface, bufs[i]);
+	}
+}
+
 static void net_if_tx_thread(struct net_if *iface)
 {
 	const struct net_if_api *api = iface->dev->driver_api;
+	struct net_buf *bufs[CONFIG_NET_TX_BATCH_SIZE];
+	struct tx_info info[CONFIG_NET_TX_BATCH_SIZE];
 
 	NET_ASSERT(api && api->init && api->send);
 
@@ -81,48 +130,52 @@ static void net_if_tx_thread(struct net_if *iface)
 	net_if_up(iface);
 
 	while (1) {
-		struct net_linkaddr *dst;
-		struct net_context *context;
-		void *context_token;
 		struct net_buf *buf;
-		int status;
-#if defined(CONFIG_NET_STATISTICS)
-		size_t pkt_len;
-#endif
-		/* Get next packet from application - wait if necessary */
+		int count = 0;
+		int i;
+
+		/* Get next packet from application - wait if necessary, then
+		 * take the packets already queued behind it.
+		 */
 		buf = net_buf_get(&iface->tx_queue, K_FOREVER);
 
-		debug_check_packet(buf);
+		do {
+			net_stats_update_tx_dequeued(buf, &iface->tx_queue_len);
 
-		dst = net_nbuf_ll_dst(buf);
-		context = net_nbuf_context(buf);
-		context_token = net_nbuf_token(buf);
+			debug_check_packet(buf);
 
-		if (atomic_test_bit(iface->flags, NET_IF_UP)) {
+			info[count].dst = net_nbuf_ll_dst(buf);
+			info[count].context = net_nbuf_context(buf);
+			info[count].context_token = net_nbuf_token(buf);
 #if defined(CONFIG_NET_STATISTICS)
-			pkt_len = net_buf_frags_len(buf);
+			info[count].pkt_len = net_buf_frags_len(buf);
 #endif
-			status = api->send(iface, buf);
-		} else {
-			/* Drop packet if interface is not up */
-			NET_WARN("iface %p is down", iface);
-			status = -ENETDOWN;
-		}
+			bufs[count] = buf;
+		} while (++count < CONFIG_NET_TX_BATCH_SIZE &&
+			 (buf = net_buf_get(&iface->tx_queue, K_NO_WAIT)));
 
-		if (status < 0) {
-			net_nbuf_unref(buf);
-		} else {
-			net_stats_update_bytes_sent(pkt_len);
-		}
+		net_if_tx_batch(iface, bufs, info, count);
 
-		if (context) {
-			NET_DBG("Calling context send cb %p token %p status %d",
-				context, context_token, status);
+		for (i = 0; i < count; i++) {
+			if (info[i].status < 0) {
+				net_nbuf_unref(bufs[i]);
+			} else {
+				net_stats_update_bytes_sent(info[i].pkt_len);
+			}
 
-			net_context_send_cb(context, context_token, status);
-		}
+			if (info[i].context) {
+				NET_DBG("Calling context send cb %p token %p "
+					"status %d", info[i].context,
+					info[i].context_token, info[i].status);
 
-		net_if_call_link_cb(iface, dst, status);
+				net_context_send_cb(info[i].context,
+						    info[i].context_token,
+						    info[i].status);
+			}
+
+			net_if_call_link_cb(iface, info[i].dst,
+					    info[i].status);
+		}
 
 		net_analyze_stack("TX thread", iface->tx_stack,
 				  sizeof(iface->tx_stack));
@@ -132,6 +185,13 @@ static void net_if_tx_thread(struct net_if *iface)
 	}
 }
 
+#if defined(CONFIG_NET_STATISTICS_PERF)
+void net_if_tx_queued(struct net_if *iface, struct net_buf *buf)
+{
+	net_stats_update_tx_queued(buf, &iface->tx_queue_len);
+}
+#endif
+
 static inline void init_tx_queue(struct net_if *iface)
 {
 	NET_DBG("On iface %p", iface);
@@ -1450,6 +1510,8 @@ void net_if_init(void)
 	for (iface = __net_if_start; iface != __net_if_end; iface++) {
 		init_tx_queue(iface);
 
+		iface->rx_burst = CONFIG_NET_RX_BURST_SIZE;
+
 #if defined(CONFIG_NET_IPV4)
 		iface->ttl = CONFIG_NET_INITIAL_TTL;
 #endif
@@ -25,6 +25,11 @@ extern char *net_sprint_ll_addr_buf(const uint8_t *ll, uint8_t ll_len,
 				    char *buf, int buflen);
 extern uint16_t net_calc_chksum(struct net_buf *buf, uint8_t proto);
 
+/* Charge the data fragments of a received packet to the context it is
+ * delivered to. Returns false if the context quota would be exceeded.
+ */
+extern bool net_nbuf_charge(struct net_buf *buf, struct net_context *context);
+
 #if defined(CONFIG_NET_IPV4)
 extern uint16_t net_calc_chksum_ipv4(struct net_buf *buf);
 #endif /* CONFIG_NET_IPV4 */
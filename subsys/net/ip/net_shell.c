@@ -517,16 +517,76 @@ static void tcp_cb(struct net_tcp *tcp, void *user_data)
 	int *count = user_data;
 	uint16_t recv_mss = net_tcp_get_recv_mss(tcp);
 
-	printk("%p\t%12s\t%10u%10u%11u%11u%5u\n",
+	printk("%p\t%12s\t%10u%10u%11u%11u%5u%8u%6u%6u%6u\n",
 	       tcp, net_tcp_state_str(net_tcp_get_state(tcp)),
 	       ntohs(net_sin6_ptr(&tcp->context->local)->sin6_port),
 	       ntohs(net_sin6(&tcp->context->remote)->sin6_port),
-	       tcp->send_seq, tcp->send_ack, recv_mss);
+	       tcp->send_seq, tcp->send_ack, recv_mss, tcp->cwnd,
+	       tcp->send_wnd, net_tcp_get_srtt(tcp), tcp->rto);
 
 	(*count)++;
 }
 #endif
 
+#if defined(CONFIG_NET_STATISTICS_PERF)
+static uint32_t cycles_to_us(uint64_t cycles)
+{
+	return cycles * USEC_PER_SEC / sys_clock_hw_cycles_per_sec;
+}
+
+static void print_time(const char *name, struct net_stats_time *time)
+{
+	printk("%s%u\tavg\t%u us\tmax\t%u us\n", name, time->count,
+	       time->count ? cycles_to_us(time->sum / time->count) : 0,
+	       cycles_to_us(time->max));
+}
+
+static inline void net_shell_print_perf(void)
+{
+	printk("RX queue max   %u\tTX queue max\t%u\n",
+	       GET_STAT(perf.rx_queue_max),
+	       GET_STAT(perf.tx_queue_max));
+	print_time("RX queue       ", &GET_STAT(perf.rx_queue));
+	print_time("TX queue       ", &GET_STAT(perf.tx_queue));
+
+	printk("DATA free min  %u\tof\t%d\n",
+	       GET_STAT(perf.data_free_min),
+	       CONFIG_NET_NBUF_DATA_COUNT);
+	printk("Alloc fail RX  %u\tTX\t%u\tDATA\t%u\n",
+	       GET_STAT(perf.rx_alloc_fail),
+	       GET_STAT(perf.tx_alloc_fail),
+	       GET_STAT(perf.data_alloc_fail));
+
+#if defined(CONFIG_NET_IPV6)
+	print_time("IPv6 proc      ", &GET_STAT(perf.ipv6));
+#endif
+#if defined(CONFIG_NET_IPV4)
+	print_time("IPv4 proc      ", &GET_STAT(perf.ipv4));
+#endif
+	print_time("ICMP proc      ", &GET_STAT(perf.icmp));
+#if defined(CONFIG_NET_UDP)
+	print_time("UDP proc       ", &GET_STAT(perf.udp));
+#endif
+#if defined(CONFIG_NET_TCP)
+	print_time("TCP proc       ", &GET_STAT(perf.tcp));
+#endif
+}
+#endif /* CONFIG_NET_STATISTICS_PERF */
+
+#if defined(CONFIG_NET_STATISTICS_TCP)
+static void tcp_rexmit_cb(struct net_tcp *tcp, void *user_data)
+{
+	int *count = user_data;
+
+	printk("%p\t%10u%10u%10u\n", tcp,
+	       ntohs(net_sin6_ptr(&tcp->context->local)->sin6_port),
+	       ntohs(net_sin6(&tcp->context->remote)->sin6_port),
+	       tcp->rexmit);
+
+	(*count)++;
+}
+#endif /* CONFIG_NET_STATISTICS_TCP */
+
 /* Put the actual shell commands after this */
 
 static int shell_cmd_conn(int argc, char *argv[])
@@ -547,7 +607,7 @@ static int shell_cmd_conn(int argc, char *argv[])
 
 #if defined(CONFIG_NET_TCP)
 	printk("\nTCP       \tState    \tSrc port  Dst port  "
-	       "Send-Seq   Send-Ack   MSS\n");
+	       "Send-Seq   Send-Ack   MSS    Cwnd   Wnd  SRTT   RTO\n");
 
 	count = 0;
 
@@ -668,6 +728,35 @@ static int shell_cmd_nbr(int argc, char *argv[])
 #endif /* CONFIG_NET_IPV6 */
 }
 
+static int shell_cmd_perf(int argc, char *argv[])
+{
+#if defined(CONFIG_NET_STATISTICS_TCP)
+	int count = 0;
+#endif
+
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+#if defined(CONFIG_NET_STATISTICS_PERF)
+	net_shell_print_perf();
+#else
+	printk("Network performance statistics not compiled in.\n");
+#endif
+
+#if defined(CONFIG_NET_STATISTICS_TCP)
+	printk("\nTCP rexmit     %u\n", GET_STAT(tcp.rexmit));
+	printk("TCP       \tSrc port  Dst port  Rexmit\n");
+
+	net_tcp_foreach(tcp_rexmit_cb, &count);
+
+	if (count == 0) {
+		printk("No TCP connections\n");
+	}
+#endif
+
+	return 0;
+}
+
 static int shell_cmd_ping(int argc, char *argv[])
 {
 #if defined(CONFIG_NET_IPV6)
@@ -822,6 +911,7 @@ static int shell_cmd_help(int argc, char *argv[])
 	printk("net iface\n\tPrint information about network interfaces\n");
 	printk("net mem\n\tPrint network buffer information\n");
 	printk("net nbr\n\tPrint neighbor information\n");
+	printk("net perf\n\tShow queue, buffer and latency statistics\n");
 	printk("net ping <host>\n\tPing a network host\n");
 	printk("net route\n\tShow network routes\n");
 	printk("net stacks\n\tShow network stacks information\n");
@@ -836,6 +926,7 @@ static struct shell_cmd net_commands[] = {
 	{ "iface", shell_cmd_iface, NULL },
 	{ "mem", shell_cmd_mem, NULL },
 	{ "nbr", shell_cmd_nbr, NULL },
+	{ "perf", shell_cmd_perf, NULL },
 	{ "ping", shell_cmd_ping, NULL },
 	{ "route", shell_cmd_route, NULL },
 	{ "stacks", shell_cmd_stacks, NULL },
@@ -17,7 +17,11 @@
 
 #include "net_stats.h"
 
-struct net_stats net_stats;
+struct net_stats net_stats = {
+#if defined(CONFIG_NET_STATISTICS_PERF)
+	.perf.data_free_min = CONFIG_NET_NBUF_DATA_COUNT,
+#endif
+};
 
 #ifdef CONFIG_NET_STATISTICS_PERIODIC_OUTPUT
 
@@ -199,6 +203,12 @@ static int net_stats_get(uint32_t mgmt_request, struct net_if *iface,
 		len_chk = sizeof(struct net_stats_rpl);
 		src = &net_stats.rpl;
 		break;
+#endif
+#if defined(CONFIG_NET_STATISTICS_PERF)
+	case NET_REQUEST_STATS_CMD_GET_PERF:
+		len_chk = sizeof(struct net_stats_perf);
+		src = &net_stats.perf;
+		break;
 #endif
 	}
 
@@ -206,7 +216,7 @@ static int net_stats_get(uint32_t mgmt_request, struct net_if *iface,
 		return -EINVAL;
 	}
 
-	memcpy(src, data, len);
+	memcpy(data, src, len);
 
 	return 0;
 }
@@ -258,4 +268,9 @@ NET_MGMT_REGISTER_REQUEST_HANDLER(NET_REQUEST_STATS_GET_RPL,
 				  net_stats_get);
 #endif
 
+#if defined(CONFIG_NET_STATISTICS_PERF)
+NET_MGMT_REGISTER_REQUEST_HANDLER(NET_REQUEST_STATS_GET_PERF,
+				  net_stats_get);
+#endif
+
 #endif /* CONFIG_NET_STATISTICS_USER_API */
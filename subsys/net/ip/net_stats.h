@@ -162,6 +162,16 @@ static inline void net_stats_update_udp_drop(void)
 #define net_stats_update_udp_drop()
 #endif /* CONFIG_NET_STATISTICS_UDP */
 
+#if defined(CONFIG_NET_STATISTICS_TCP)
+/* TCP stats */
+static inline void net_stats_update_tcp_rexmit(void)
+{
+	net_stats.tcp.rexmit++;
+}
+#else
+#define net_stats_update_tcp_rexmit()
+#endif /* CONFIG_NET_STATISTICS_TCP */
+
 #if defined(CONFIG_NET_STATISTICS_RPL)
 /* RPL stats */
 static inline void net_stats_update_rpl_resets(void)
@@ -262,6 +272,134 @@ static inline void net_stats_update_rpl_dao_ack_recv(void)
 #define net_stats_update_rpl_dao_ack_recv()
 #endif /* CONFIG_NET_STATISTICS_RPL */
 
+#if defined(CONFIG_NET_STATISTICS_PERF)
+/* Queue, buffer and latency stats, the times are in hardware cycles */
+
+#include <kernel.h>
+#include <net/nbuf.h>
+
+#define net_stats_perf_time() k_cycle_get_32()
+
+static inline void net_stats_update_time(struct net_stats_time *time,
+					 uint32_t start)
+{
+	uint32_t cycles = k_cycle_get_32() - start;
+
+	time->count++;
+	time->sum += cycles;
+
+	if (cycles > time->max) {
+		time->max = cycles;
+	}
+}
+
+static inline void net_stats_update_queued(struct net_buf *buf,
+					   atomic_t *len,
+					   net_stats_t *max)
+{
+	atomic_val_t queued = atomic_inc(len) + 1;
+	unsigned int key;
+
+	/* Packets are queued from interrupt context too */
+	key = irq_lock();
+
+	if (queued > *max) {
+		*max = queued;
+	}
+
+	irq_unlock(key);
+
+	net_nbuf_set_queued(buf, k_cycle_get_32());
+}
+
+static inline void net_stats_update_rx_queued(struct net_buf *buf,
+					      atomic_t *len)
+{
+	net_stats_update_queued(buf, len, &net_stats.perf.rx_queue_max);
+}
+
+static inline void net_stats_update_rx_dequeued(struct net_buf *buf,
+						atomic_t *len)
+{
+	atomic_dec(len);
+	net_stats_update_time(&net_stats.perf.rx_queue, net_nbuf_queued(buf));
+}
+
+static inline void net_stats_update_tx_queued(struct net_buf *buf,
+					      atomic_t *len)
+{
+	net_stats_update_queued(buf, len, &net_stats.perf.tx_queue_max);
+}
+
+static inline void net_stats_update_tx_dequeued(struct net_buf *buf,
+						atomic_t *len)
+{
+	atomic_dec(len);
+	net_stats_update_time(&net_stats.perf.tx_queue, net_nbuf_queued(buf));
+}
+
+static inline void net_stats_update_data_free(net_stats_t count)
+{
+	if (count < net_stats.perf.data_free_min) {
+		net_stats.perf.data_free_min = count;
+	}
+}
+
+static inline void net_stats_update_rx_alloc_fail(void)
+{
+	net_stats.perf.rx_alloc_fail++;
+}
+
+static inline void net_stats_update_tx_alloc_fail(void)
+{
+	net_stats.perf.tx_alloc_fail++;
+}
+
+static inline void net_stats_update_data_alloc_fail(void)
+{
+	net_stats.perf.data_alloc_fail++;
+}
+
+static inline void net_stats_update_ipv6_time(uint32_t start)
+{
+	net_stats_update_time(&net_stats.perf.ipv6, start);
+}
+
+static inline void net_stats_update_ipv4_time(uint32_t start)
+{
+	net_stats_update_time(&net_stats.perf.ipv4, start);
+}
+
+static inline void net_stats_update_icmp_time(uint32_t start)
+{
+	net_stats_update_time(&net_stats.perf.icmp, start);
+}
+
+static inline void net_stats_update_l4_time(enum net_ip_protocol proto,
+					    uint32_t start)
+{
+	if (proto == IPPROTO_UDP) {
+		net_stats_update_time(&net_stats.perf.udp, start);
+	} else if (proto == IPPROTO_TCP) {
+		net_stats_update_time(&net_stats.perf.tcp, start);
+	}
+}
+#else
+#define net_stats_perf_time() 0
+#define net_stats_update_rx_queued(...)
+#define net_stats_update_rx_dequeued(...)
+#define net_stats_update_tx_queued(...)
+#define net_stats_update_tx_dequeued(...)
+#define net_stats_update_data_free(...)
+#define net_stats_update_rx_alloc_fail()
+#define net_stats_update_tx_alloc_fail()
+#define net_stats_update_data_alloc_fail()
+#define net_stats_update_ipv6_time(start) ARG_UNUSED(start)
+#define net_stats_update_ipv4_time(start) ARG_UNUSED(start)
+#define net_stats_update_icmp_time(start) ARG_UNUSED(start)
+#define net_stats_update_l4_time(proto, start) ARG_UNUSED(start)
+#endif /* CONFIG_NET_STATISTICS_PERF */
+
 #if defined(CONFIG_NET_STATISTICS_PERIODIC_OUTPUT)
 /* A simple periodic statistic printer, used only in net core */
 void net_print_statistics(void);
@@ -18,6 +18,7 @@
 #include <limits.h>
 #include <stdint.h>
 #include <misc/slist.h>
+#include <misc/dlist.h>
 
 #include <net/nbuf.h>
 #include <net/net_core.h>
@@ -38,7 +39,41 @@
 /* We keep track of the routes in a separate list so that we can remove
  * the oldest routes (at tail) if needed.
  */
-static sys_slist_t routes;
+static sys_dlist_t routes = SYS_DLIST_STATIC_INIT(&routes);
+
+/*
+ * Routes are indexed by prefix in a path-compressed binary trie. Each
+ * node holds the routes to its prefix, if any, and branches on the first
+ * bit after it. Nodes without routes only join two subtrees, so a trie
+ * of N prefixes never needs more than 2N - 1 nodes.
+ */
+struct route_trie_node {
+	struct route_trie_node *child[2];
+
+	/** Routes to this prefix, one per interface */
+	sys_slist_t routes;
+
+	/** Prefix with the bits after prefix_len cleared */
+	struct in6_addr prefix;
+	uint8_t prefix_len;
+};
+
+#define ROUTE_TRIE_NODES (2 * CONFIG_NET_MAX_ROUTES)
+
+static struct route_trie_node route_trie_pool[ROUTE_TRIE_NODES];
+static struct route_trie_node *route_trie_free;
+static struct route_trie_node *route_trie_root;
+
+#if CONFIG_NET_ROUTE_CACHE_SIZE > 0
+/* Recently looked up destinations, indexed by a hash of the address */
+struct route_cache_entry {
+	struct in6_addr dst;
+	struct net_if *iface;
+	struct net_route_entry *route;
+};
+
+static struct route_cache_entry route_cache[CONFIG_NET_ROUTE_CACHE_SIZE];
+#endif
 
 static void net_route_nexthop_remove(struct net_nbr *nbr)
 {
@@ -255,45 +290,296 @@ static int nbr_nexthop_put(struct net_nbr *nbr)
 /* Route was accessed, so place it in front of the routes list */
 static inline void update_route_access(struct net_route_entry *route)
 {
-	sys_slist_find_and_remove(&routes, &route->node);
-	sys_slist_prepend(&routes, &route->node);
+	sys_dlist_remove(&route->node);
+	sys_dlist_prepend(&routes, &route->node);
 }
 
-struct net_route_entry *net_route_lookup(struct net_if *iface,
-					 struct in6_addr *dst)
+#if CONFIG_NET_ROUTE_CACHE_SIZE > 0
+static inline struct route_cache_entry *route_cache_slot(struct in6_addr *dst)
 {
-	struct net_route_entry *route, *found = NULL;
-	uint8_t longest_match = 0;
+	uint32_t hash = dst->s6_addr32[2] ^ dst->s6_addr32[3];
+
+	hash ^= hash >> 16;
+	hash ^= hash >> 8;
+
+	return &route_cache[hash % CONFIG_NET_ROUTE_CACHE_SIZE];
+}
+
+static struct net_route_entry *route_cache_get(struct net_if *iface,
+					       struct in6_addr *dst)
+{
+	struct route_cache_entry *entry = route_cache_slot(dst);
+
+	if (entry->route && entry->iface == iface &&
+	    net_ipv6_addr_cmp(&entry->dst, dst)) {
+		return entry->route;
+	}
+
+	return NULL;
+}
+
+static void route_cache_put(struct net_if *iface, struct in6_addr *dst,
+			    struct net_route_entry *route)
+{
+	struct route_cache_entry *entry = route_cache_slot(dst);
+
+	net_ipaddr_copy(&entry->dst, dst);
+	entry->iface = iface;
+	entry->route = route;
+}
+
+/* Any change of the routing table may change the longest match */
+static inline void route_cache_flush(void)
+{
+	memset(route_cache, 0, sizeof(route_cache));
+}
+#else
+#define route_cache_get(...) NULL
+#define route_cache_put(...)
+#define route_cache_flush(...)
+#endif /* CONFIG_NET_ROUTE_CACHE_SIZE > 0 */
+
+static inline uint8_t addr_bit(const struct in6_addr *addr, uint8_t bit)
+{
+	return (addr->s6_addr[bit / 8] >> (7 - bit % 8)) & 1;
+}
+
+/* Number of leading bits, up to max, that both addresses share */
+static uint8_t common_prefix_len(const struct in6_addr *addr1,
+				 const struct in6_addr *addr2, uint8_t max)
+{
+	uint8_t len = 0;
+	uint8_t diff;
 	int i;
 
-	for (i = 0; i < CONFIG_NET_MAX_ROUTES && longest_match < 128; i++) {
-		struct net_nbr *nbr = get_nbr(i);
+	for (i = 0; i < sizeof(struct in6_addr) && len < max; i++) {
+		diff = addr1->s6_addr[i] ^ addr2->s6_addr[i];
+		if (diff) {
+			len += __builtin_clz(diff) - 24;
+			break;
+		}
 
-		if (!nbr->ref) {
+		len += 8;
+	}
+
+	return min(len, max);
+}
+
+static struct route_trie_node *trie_node_alloc(const struct in6_addr *prefix,
+					       uint8_t prefix_len)
+{
+	struct route_trie_node *node = route_trie_free;
+	int i;
+
+	if (!node) {
+		return NULL;
+	}
+
+	route_trie_free = node->child[0];
+
+	memset(node, 0, sizeof(*node));
+
+	for (i = 0; i < prefix_len / 8; i++) {
+		node->prefix.s6_addr[i] = prefix->s6_addr[i];
+	}
+
+	if (prefix_len % 8) {
+		node->prefix.s6_addr[i] = prefix->s6_addr[i] &
+					  (0xff << (8 - prefix_len % 8));
+	}
+
+	node->prefix_len = prefix_len;
+
+	return node;
+}
+
+static inline void trie_node_free(struct route_trie_node *node)
+{
+	node->child[0] = route_trie_free;
+	route_trie_free = node;
+}
+
+/* Find the node of a prefix, creating it and the node joining it to the
+ * trie if needed.
+ */
+static struct route_trie_node *trie_insert(const struct in6_addr *prefix,
+					   uint8_t prefix_len)
+{
+	struct route_trie_node **link = &route_trie_root;
+	struct route_trie_node *node, *new, *join;
+	uint8_t common;
+
+	while (*link) {
+		node = *link;
+		common = common_prefix_len(prefix, &node->prefix,
+					   min(prefix_len, node->prefix_len));
+
+		if (common == node->prefix_len) {
+			if (common == prefix_len) {
+				return node;
+			}
+
+			link = &node->child[addr_bit(prefix, common)];
 			continue;
 		}
 
-		if (iface && nbr->iface != iface) {
-			continue;
+		new = trie_node_alloc(prefix, prefix_len);
+		if (!new) {
+			return NULL;
 		}
 
-		route = net_route_data(nbr);
+		if (common == prefix_len) {
+			/* The new prefix covers the node */
+			new->child[addr_bit(&node->prefix, common)] = node;
+			*link = new;
 
-		if (route->prefix_len >= longest_match &&
-		    net_is_ipv6_prefix((uint8_t *)dst,
-				       (uint8_t *)&route->addr,
-				       route->prefix_len)) {
-			found = route;
-			longest_match = route->prefix_len;
+			return new;
 		}
+
+		/* The prefixes diverge after the common bits */
+		join = trie_node_alloc(prefix, common);
+		if (!join) {
+			trie_node_free(new);
+			return NULL;
+		}
+
+		join->child[addr_bit(prefix, common)] = new;
+		join->child[addr_bit(&node->prefix, common)] = node;
+		*link = join;
+
+		return new;
 	}
 
-	if (found) {
-		net_route_info("Found", found, dst);
+	*link = trie_node_alloc(prefix, prefix_len);
 
-		update_route_access(found);
+	return *link;
+}
+
+static void trie_remove(struct net_route_entry *route)
+{
+	struct route_trie_node **parent = NULL;
+	struct route_trie_node **link = &route_trie_root;
+	struct route_trie_node *node, *child;
+
+	while (*link) {
+		node = *link;
+
+		if (node->prefix_len > route->prefix_len ||
+		    common_prefix_len(&route->addr, &node->prefix,
+				      node->prefix_len) < node->prefix_len) {
+			return;
+		}
+
+		if (node->prefix_len == route->prefix_len) {
+			break;
+		}
+
+		parent = link;
+		link = &node->child[addr_bit(&route->addr, node->prefix_len)];
+	}
+
+	if (!*link) {
+		return;
+	}
+
+	node = *link;
+
+	sys_slist_find_and_remove(&node->routes, &route->trie_node);
+
+	if (!sys_slist_is_empty(&node->routes) ||
+	    (node->child[0] && node->child[1])) {
+		return;
+	}
+
+	child = node->child[0] ? node->child[0] : node->child[1];
+	*link = child;
+	trie_node_free(node);
+
+	/* A parent without routes was only joining this node and its
+	 * sibling, which can take its place now.
+	 */
+	if (!child && parent && sys_slist_is_empty(&(*parent)->routes)) {
+		node = *parent;
+		*parent = node->child[0] ? node->child[0] : node->child[1];
+		trie_node_free(node);
+	}
+}
+
+static struct net_route_entry *trie_lookup(struct net_if *iface,
+					   struct in6_addr *dst)
+{
+	struct net_route_entry *route, *found = NULL;
+	struct route_trie_node *node = route_trie_root;
+
+	while (node) {
+		if (common_prefix_len(dst, &node->prefix,
+				      node->prefix_len) < node->prefix_len) {
+			break;
+		}
+
+		SYS_SLIST_FOR_EACH_CONTAINER(&node->routes, route, trie_node) {
+			if (!iface || route->iface == iface) {
+				found = route;
+				break;
+			}
+		}
+
+		if (node->prefix_len == 128) {
+			break;
+		}
+
+		node = node->child[addr_bit(dst, node->prefix_len)];
+	}
+
+	return found;
+}
+
+/* Route to exactly this prefix */
+static struct net_route_entry *route_find(struct net_if *iface,
+					  struct in6_addr *addr,
+					  uint8_t prefix_len)
+{
+	struct route_trie_node *node = route_trie_root;
+	struct net_route_entry *route;
+
+	while (node && node->prefix_len < prefix_len) {
+		node = node->child[addr_bit(addr, node->prefix_len)];
 	}
 
+	if (!node || node->prefix_len != prefix_len ||
+	    common_prefix_len(addr, &node->prefix,
+			      prefix_len) != prefix_len) {
+		return NULL;
+	}
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&node->routes, route, trie_node) {
+		if (route->iface == iface) {
+			return route;
+		}
+	}
+
+	return NULL;
+}
+
+struct net_route_entry *net_route_lookup(struct net_if *iface,
+					 struct in6_addr *dst)
+{
+	struct net_route_entry *found;
+
+	found = route_cache_get(iface, dst);
+	if (!found) {
+		found = trie_lookup(iface, dst);
+		if (!found) {
+			return NULL;
+		}
+
+		route_cache_put(iface, dst, found);
+	}
+
+	net_route_info("Found", found, dst);
+
+	update_route_access(found);
+
 	return found;
 }
 
@@ -305,6 +591,7 @@ struct net_route_entry *net_route_add(struct net_if *iface,
 	struct net_linkaddr_storage *nexthop_lladdr;
 	struct net_nbr *nbr, *nbr_nexthop, *tmp;
 	struct net_route_nexthop *nexthop_route;
+	struct route_trie_node *node;
 	struct net_route_entry *route;
 
 	NET_ASSERT(addr);
@@ -330,7 +617,7 @@ struct net_route_entry *net_route_add(struct net_if *iface,
 	NET_DBG("Nexthop %s lladdr is %s", net_sprint_ipv6_addr(nexthop),
 		net_sprint_ll_addr(nexthop_lladdr->addr, nexthop_lladdr->len));
 
-	route = net_route_lookup(iface, addr);
+	route = route_find(iface, addr, prefix_len);
 	if (route) {
 		/* Update nexthop if not the same */
 		struct in6_addr *nexthop_addr;
@@ -338,6 +625,7 @@ struct net_route_entry *net_route_add(struct net_if *iface,
 		nexthop_addr = net_route_get_nexthop(route);
 		if (nexthop_addr && net_ipv6_addr_cmp(nexthop, nexthop_addr)) {
 			NET_DBG("No changes, return old route %p", route);
+			update_route_access(route);
 			return route;
 		}
 
@@ -350,9 +638,7 @@ struct net_route_entry *net_route_add(struct net_if *iface,
 	nbr = nbr_new(iface, addr, prefix_len);
 	if (!nbr) {
 		/* Remove the oldest route and try again */
-		sys_snode_t *last = sys_slist_peek_tail(&routes);
-
-		sys_slist_find_and_remove(&routes, last);
+		sys_dnode_t *last = sys_dlist_peek_tail(&routes);
 
 		route = CONTAINER_OF(last,
 				     struct net_route_entry,
@@ -389,6 +675,15 @@ struct net_route_entry *net_route_add(struct net_if *iface,
 	tmp = get_nexthop_route();
 	if (!tmp) {
 		NET_ERR("No nexthop route available!");
+		nbr_free(nbr);
+		return NULL;
+	}
+
+	node = trie_insert(addr, prefix_len);
+	if (!node) {
+		NET_ERR("No route trie node available!");
+		nbr_free(tmp);
+		nbr_free(nbr);
 		return NULL;
 	}
 
@@ -397,7 +692,9 @@ struct net_route_entry *net_route_add(struct net_if *iface,
 	route = net_route_data(nbr);
 	route->iface = iface;
 
-	sys_slist_prepend(&routes, &route->node);
+	sys_dlist_prepend(&routes, &route->node);
+	sys_slist_append(&node->routes, &route->trie_node);
+	route_cache_flush();
 
 	tmp = nbr_nexthop_get(iface, nexthop);
 
@@ -424,13 +721,15 @@ int net_route_del(struct net_route_entry *route)
 		return -EINVAL;
 	}
 
-	sys_slist_find_and_remove(&routes, &route->node);
-
 	nbr = net_route_get_nbr(route);
 	if (!nbr) {
 		return -ENOENT;
 	}
 
+	sys_dlist_remove(&route->node);
+	trie_remove(route);
+	route_cache_flush();
+
 	net_route_info("Deleted", route, &route->addr);
 
 	SYS_SLIST_FOR_EACH_CONTAINER(&route->nexthop, nexthop_route, node) {
@@ -673,6 +972,12 @@ net_route_mcast_lookup(struct in6_addr *group)
 
 void net_route_init(void)
 {
+	int i;
+
+	for (i = 0; i < ROUTE_TRIE_NODES; i++) {
+		trie_node_free(&route_trie_pool[i]);
+	}
+
 	NET_DBG("Allocated %d routing entries (%zu bytes)",
 		CONFIG_NET_MAX_ROUTES, sizeof(net_route_entries_pool));
 
@@ -34,6 +34,7 @@
 #include "ipv6.h"
 #include "ipv4.h"
 #include "tcp.h"
+#include "net_stats.h"
 
 /*
  * Each TCP connection needs to be tracked by net_context, so
@@ -42,11 +43,22 @@
 #define NET_MAX_TCP_CONTEXT CONFIG_NET_MAX_CONTEXTS
 static struct net_tcp tcp_context[NET_MAX_TCP_CONTEXT];
 
-#define INIT_RETRY_MS 200
+/* Retransmission timeout bounds, as per RFC 6298 except for a lower
+ * minimum better suited to local networks.
+ */
+#define INIT_RTO_MS 1000
+#define MIN_RTO_MS 200
+#define MAX_RTO_MS 60000
+
+/* Initial congestion window, as per RFC 3390 */
+#define INIT_CWND(mss) min(4 * (mss), max(2 * (mss), 4380))
 
 /* 2MSL timeout, where "MSL" is arbitrarily 2 minutes in the RFC */
 #define TIME_WAIT_MS (2 * 2 * 60 * 1000)
 
+/* Duplicate ACKs telling that a segment was lost, as per RFC 5681 */
+#define FAST_RETRANSMIT_DUP_ACKS 3
+
 struct tcp_segment {
 	uint32_t seq;
 	uint32_t ack;
@@ -105,7 +117,51 @@ static inline uint32_t init_isn(void)
 
 static inline uint32_t retry_timeout(const struct net_tcp *tcp)
 {
-	return ((uint32_t)1 << tcp->retry_timeout_shift) * INIT_RETRY_MS;
+	if (tcp->rto > (MAX_RTO_MS >> tcp->retry_timeout_shift)) {
+		return MAX_RTO_MS;
+	}
+
+	return tcp->rto << tcp->retry_timeout_shift;
+}
+
+static inline uint32_t seg_seq(struct net_buf *buf)
+{
+	return sys_get_be32(NET_TCP_BUF(buf)->seq);
+}
+
+/* Data sent and neither acknowledged nor selectively acknowledged */
+static uint32_t tcp_flight_size(struct net_tcp *tcp)
+{
+	struct net_buf *buf;
+	uint32_t flight = 0;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&tcp->sent_list, buf, sent_list) {
+		if (!net_nbuf_buf_sent(buf)) {
+			break;
+		}
+
+		if (!net_nbuf_sacked(buf)) {
+			flight += net_nbuf_appdatalen(buf);
+		}
+	}
+
+	return flight;
+}
+
+/* Slow start threshold after a loss, as per RFC 5681 */
+static inline uint32_t tcp_loss_ssthresh(struct net_tcp *tcp)
+{
+	return max(tcp_flight_size(tcp) / 2, 2 * (uint32_t)tcp->send_mss);
+}
+
+static inline void tcp_resend(struct net_tcp *tcp, struct net_buf *buf)
+{
+#if defined(CONFIG_NET_STATISTICS_TCP)
+	tcp->rexmit++;
+#endif
+	net_stats_update_tcp_rexmit();
+
+	net_tcp_send_buf(net_nbuf_ref(buf));
 }
 
 static void tcp_retry_expired(struct k_timer *timer)
@@ -120,9 +176,31 @@ static void tcp_retry_expired(struct k_timer *timer)
 		tcp->retry_timeout_shift++;
 		k_timer_start(&tcp->retry_timer, retry_timeout(tcp), 0);
 
+		/* Only one segment is sent until the connection
+		 * recovers, and Karn's algorithm excludes resent data
+		 * from the round-trip time measurements.
+		 */
+		if (!(tcp->flags & NET_TCP_RETRYING)) {
+			tcp->ssthresh = tcp_loss_ssthresh(tcp);
+		}
+
+		tcp->cwnd = tcp->send_mss;
+		tcp->rtt_active = 0;
+
+		tcp->flags |= NET_TCP_RETRYING;
+		tcp->fast_recovery = 0;
+		tcp->dup_acks = 0;
+
+		/* The peer may have discarded the data it selectively
+		 * acknowledged, so it is sent again after a timeout.
+		 */
+		SYS_SLIST_FOR_EACH_CONTAINER(&tcp->sent_list, buf, sent_list) {
+			net_nbuf_set_sacked(buf, false);
+		}
+
 		buf = CONTAINER_OF(sys_slist_peek_head(&tcp->sent_list),
 				   struct net_buf, sent_list);
-		net_tcp_send_buf(net_nbuf_ref(buf));
+		tcp_resend(tcp, buf);
 	} else if (IS_ENABLED(CONFIG_NET_TCP_TIME_WAIT)) {
 		if (tcp->fin_sent && tcp->fin_rcvd) {
 			net_context_unref(tcp->context);
@@ -158,6 +236,11 @@ struct net_tcp *net_tcp_alloc(struct net_context *context)
 
 	tcp_context[i].accept_cb = NULL;
 
+	tcp_context[i].rto = INIT_RTO_MS;
+	tcp_context[i].send_mss = NET_TCP_DEFAULT_MSS;
+	tcp_context[i].cwnd = INIT_CWND(NET_TCP_DEFAULT_MSS);
+	tcp_context[i].ssthresh = UINT32_MAX;
+
 	k_timer_init(&tcp_context[i].retry_timer, tcp_retry_expired, NULL);
 	k_sem_init(&tcp_context[i].connect_wait, 0, UINT_MAX);
 
@@ -180,6 +263,12 @@ int net_tcp_release(struct net_tcp *tcp)
 		net_nbuf_unref(buf);
 	}
 
+	SYS_SLIST_FOR_EACH_CONTAINER_SAFE(&tcp->ooo_list, buf, tmp,
+					  sent_list) {
+		sys_slist_remove(&tcp->ooo_list, NULL, &buf->sent_list);
+		net_nbuf_unref(buf);
+	}
+
 	k_delayed_work_cancel(&tcp->ack_timer);
 	k_timer_stop(&tcp->retry_timer);
 	k_sem_reset(&tcp->connect_wait);
@@ -196,6 +285,7 @@ int net_tcp_release(struct net_tcp *tcp)
 	return 0;
 }
 
+/* Returns the length of the added options, padded to 4-byte words */
 static inline int net_tcp_add_options(struct net_buf *header, size_t len,
 				      void *data)
 {
@@ -210,7 +300,11 @@ static inline int net_tcp_add_options(struct net_buf *header, size_t len,
 		optlen = len;
 	}
 
-	return 0;
+	/* Pad with end of options list */
+	memset(net_buf_add(header, optlen - len), NET_TCP_OPT_EOL,
+	       optlen - len);
+
+	return optlen;
 }
 
 static void finalize_segment(struct net_context *context, struct net_buf *buf)
@@ -281,13 +375,20 @@ static struct net_buf *prepare_segment(struct net_tcp *tcp,
 		return NULL;
 	}
 
-	header = net_nbuf_get_data(context, K_FOREVER);
+	/* The header is taken like the IP one, outside of the context
+	 * quota and from the stack reserve: the acknowledgments of a
+	 * context that holds its quota must still go out.
+	 */
+	header = net_nbuf_get_reserve_data(net_nbuf_ll_reserve(buf),
+					   K_FOREVER);
 	net_buf_frag_add(buf, header);
 
 	tcphdr = (struct net_tcp_hdr *)net_buf_add(header, NET_TCPH_LEN);
 
 	if (segment->options && segment->optlen) {
-		net_tcp_add_options(header, segment->optlen, segment->options);
+		tcphdr->offset = (NET_TCPH_LEN +
+				  net_tcp_add_options(header, segment->optlen,
+						      segment->options)) << 2;
 	} else {
 		tcphdr->offset = NET_TCPH_LEN << 2;
 	}
@@ -334,6 +435,113 @@ static inline bool seq_greater(uint32_t seq1, uint32_t seq2)
 	return d > 0 && d < 0x20000000;
 }
 
+#if defined(CONFIG_NET_TCP_SACK)
+/* Fill in the SACK option describing the out-of-order queue, returns the
+ * option length.
+ */
+static size_t tcp_sack_blocks(struct net_tcp *tcp, uint8_t *options)
+{
+	struct {
+		uint32_t left;
+		uint32_t right;
+	} blocks[CONFIG_NET_TCP_OOO_SEGMENTS];
+	struct net_buf *buf;
+	int recent = 0;
+	int count = 0;
+	int i, n;
+
+	/* Merge the contiguous queued segments into blocks */
+	SYS_SLIST_FOR_EACH_CONTAINER(&tcp->ooo_list, buf, sent_list) {
+		uint32_t seq = seg_seq(buf);
+		uint32_t end = seq + net_nbuf_appdatalen(buf);
+
+		if (count && !seq_greater(seq, blocks[count - 1].right)) {
+			if (seq_greater(end, blocks[count - 1].right)) {
+				blocks[count - 1].right = end;
+			}
+		} else if (seq != end) {
+			blocks[count].left = seq;
+			blocks[count].right = end;
+			count++;
+		}
+
+		if (count && seq == tcp->ooo_last_seq) {
+			recent = count - 1;
+		}
+	}
+
+	if (!count) {
+		return 0;
+	}
+
+	/* The block holding the most recently received segment goes first,
+	 * as required by RFC 2018.
+	 */
+	for (i = 0, n = 0; i < count && n < NET_TCP_SACK_MAX_BLOCKS; i++) {
+		int block = i ? (i <= recent ? i - 1 : i) : recent;
+
+		sys_put_be32(blocks[block].left, options + 4 + n * 8);
+		sys_put_be32(blocks[block].right, options + 8 + n * 8);
+		n++;
+	}
+
+	sys_put_be32(NET_TCP_SACK_HEADER | (2 + n * 8), options);
+
+	return 4 + n * 8;
+}
+
+/* Add the SACK permitted option to SYN segments, and the SACK option to
+ * pure ACKs sent while out-of-order segments are queued. Returns the new
+ * options length.
+ */
+static size_t tcp_sack_options(struct net_tcp *tcp, uint8_t flags,
+			       void *options, size_t optlen, uint8_t *buf)
+{
+	if (flags & NET_TCP_SYN) {
+		/* A SYN-ACK may only offer SACK if the SYN did */
+		if ((flags & NET_TCP_ACK) && !(tcp->flags & NET_TCP_SACK_OK)) {
+			return 0;
+		}
+
+		if (optlen) {
+			memcpy(buf, options, optlen);
+		}
+
+		sys_put_be32(NET_TCP_SACK_PERM_HEADER, buf + optlen);
+
+		return optlen + NET_TCP_SACK_PERM_SIZE;
+	}
+
+	if (flags == NET_TCP_ACK && !optlen &&
+	    (tcp->flags & NET_TCP_SACK_OK)) {
+		return tcp_sack_blocks(tcp, buf);
+	}
+
+	return 0;
+}
+#endif /* CONFIG_NET_TCP_SACK */
+
+/* Offer window scaling in SYN segments, and accept it in a SYN-ACK if the
+ * SYN offered it. Our receive window fits in 16 bits so our own shift is 0,
+ * the option lets the peer scale the windows it advertises. Returns the new
+ * options length.
+ */
+static size_t tcp_wscale_option(struct net_tcp *tcp, uint8_t flags,
+				void *options, size_t optlen, uint8_t *buf)
+{
+	if ((flags & NET_TCP_ACK) && !(tcp->flags & NET_TCP_WSCALE_OK)) {
+		return 0;
+	}
+
+	if (optlen) {
+		memcpy(buf, options, optlen);
+	}
+
+	sys_put_be32(NET_TCP_WSCALE_HEADER, buf + optlen);
+
+	return optlen + NET_TCP_WSCALE_SIZE;
+}
+
 int net_tcp_prepare_segment(struct net_tcp *tcp, uint8_t flags,
 			    void *options, size_t optlen,
 			    const struct sockaddr_ptr *local,
@@ -343,6 +551,12 @@ int net_tcp_prepare_segment(struct net_tcp *tcp, uint8_t flags,
 	uint32_t seq;
 	uint16_t wnd;
 	struct tcp_segment segment = { 0 };
+	uint8_t syn_options[NET_TCP_MAX_OPT_LEN];
+	size_t syn_optlen;
+#if defined(CONFIG_NET_TCP_SACK)
+	uint8_t sack_options[NET_TCP_MAX_OPT_LEN];
+	size_t sack_optlen;
+#endif
 
 	if (!local) {
 		local = &tcp->context->local;
@@ -383,10 +597,26 @@ int net_tcp_prepare_segment(struct net_tcp *tcp, uint8_t flags,
 
 	if (flags & NET_TCP_SYN) {
 		seq++;
+
+		syn_optlen = tcp_wscale_option(tcp, flags, options, optlen,
+					       syn_options);
+		if (syn_optlen) {
+			options = syn_options;
+			optlen = syn_optlen;
+		}
 	}
 
 	wnd = get_recv_wnd(tcp);
 
+#if defined(CONFIG_NET_TCP_SACK)
+	sack_optlen = tcp_sack_options(tcp, flags, options, optlen,
+				       sack_options);
+	if (sack_optlen) {
+		options = sack_options;
+		optlen = sack_optlen;
+	}
+#endif
+
 	segment.src_addr = (struct sockaddr_ptr *)local;
 	segment.dst_addr = remote;
 	segment.seq = tcp->send_seq;
@@ -607,8 +837,13 @@ int net_tcp_queue_data(struct net_context *context, struct net_buf *buf)
 
 	context->tcp->send_seq += data_len;
 
+	/* Acknowledgments are matched against the segment length */
+	net_nbuf_set_appdatalen(buf, data_len);
+
+	/* The list keeps the caller's reference until the data is
+	 * acknowledged, every transmission takes its own.
+	 */
 	sys_slist_append(&context->tcp->sent_list, &buf->sent_list);
-	net_nbuf_ref(buf);
 
 	return 0;
 }
@@ -635,6 +870,12 @@ int net_tcp_send_buf(struct net_buf *buf)
 
 	ctx->tcp->sent_ack = ctx->tcp->send_ack;
 
+	/* The ACK of a retransmitted segment may have changed */
+	tcphdr->chksum = 0;
+	if (net_if_need_tx_chksum(net_nbuf_iface(buf))) {
+		tcphdr->chksum = ~net_calc_chksum_tcp(buf);
+	}
+
 	net_nbuf_set_buf_sent(buf, true);
 
 	return net_send_data(buf);
@@ -643,7 +884,6 @@ int net_tcp_send_buf(struct net_buf *buf)
 static void restart_timer(struct net_tcp *tcp)
 {
 	if (!sys_slist_is_empty(&tcp->sent_list)) {
-		tcp->flags |= NET_TCP_RETRYING;
 		tcp->retry_timeout_shift = 0;
 		k_timer_start(&tcp->retry_timer, retry_timeout(tcp), 0);
 	} else if (IS_ENABLED(CONFIG_NET_TCP_TIME_WAIT)) {
@@ -660,29 +900,299 @@ static void restart_timer(struct net_tcp *tcp)
 	}
 }
 
+/* Update the round-trip time estimators with a new sample, as per
+ * RFC 6298.  As in BSD, srtt is kept scaled by 8 and rttvar by 4 so
+ * the gains of 1/8 and 1/4 are applied with shifts.
+ */
+static void tcp_rtt_sample(struct net_tcp *tcp, uint32_t rtt)
+{
+	int32_t delta;
+
+	if (!tcp->srtt) {
+		tcp->srtt = max(rtt, 1) << 3;
+		tcp->rttvar = rtt << 1;
+	} else {
+		delta = (int32_t)rtt - (int32_t)(tcp->srtt >> 3);
+		tcp->srtt += delta;
+		if (!tcp->srtt) {
+			tcp->srtt = 1;
+		}
+
+		if (delta < 0) {
+			delta = -delta;
+		}
+
+		tcp->rttvar += delta - (tcp->rttvar >> 2);
+	}
+
+	tcp->rto = (tcp->srtt >> 3) +
+		   max((uint32_t)(MSEC_PER_SEC / sys_clock_ticks_per_sec),
+		       tcp->rttvar);
+	tcp->rto = min(max(tcp->rto, MIN_RTO_MS), MAX_RTO_MS);
+
+	NET_DBG("RTT %u ms, SRTT %u ms, RTO %u ms", rtt,
+		net_tcp_get_srtt(tcp), tcp->rto);
+}
+
 int net_tcp_send_data(struct net_context *context)
 {
+	struct net_tcp *tcp = context->tcp;
 	struct net_buf *buf;
+	uint32_t flight = tcp_flight_size(tcp);
+	uint32_t wnd = min(tcp->cwnd, tcp->send_wnd);
+	uint16_t len;
 
-	/* For now, just send all queued data synchronously.  Need to
-	 * add window handling and retry/ACK logic.
-	 */
-	SYS_SLIST_FOR_EACH_CONTAINER(&context->tcp->sent_list, buf, sent_list) {
-		if (!net_nbuf_buf_sent(buf)) {
-			net_tcp_send_buf(buf);
+	SYS_SLIST_FOR_EACH_CONTAINER(&tcp->sent_list, buf, sent_list) {
+		if (net_nbuf_buf_sent(buf)) {
+			continue;
 		}
+
+		/* Send what the congestion and peer windows allow.  A
+		 * segment always goes out when nothing is in flight,
+		 * so that a closed peer window is probed again when
+		 * the retry timer expires.
+		 */
+		len = net_nbuf_appdatalen(buf);
+		if (flight && flight + len > wnd) {
+			break;
+		}
+
+		if (!tcp->rtt_active && !tcp->fast_recovery &&
+		    !(tcp->flags & NET_TCP_RETRYING)) {
+			tcp->rtt_active = 1;
+			tcp->rtt_seq = seg_seq(buf) + len;
+			tcp->rtt_start = k_uptime_get_32();
+		}
+
+		flight += len;
+
+		net_tcp_send_buf(net_nbuf_ref(buf));
+	}
+
+	if (!sys_slist_is_empty(&tcp->sent_list) &&
+	    !k_timer_remaining_get(&tcp->retry_timer)) {
+		k_timer_start(&tcp->retry_timer, retry_timeout(tcp), 0);
 	}
 
 	return 0;
 }
 
-void net_tcp_ack_received(struct net_context *ctx, uint32_t ack)
+static const uint8_t *tcp_opt_find(struct net_buf *buf, uint8_t kind,
+				   uint8_t *len)
+{
+	struct net_tcp_hdr *tcphdr = NET_TCP_BUF(buf);
+	const uint8_t *opts = (const uint8_t *)tcphdr + NET_TCPH_LEN;
+	int optlen = (tcphdr->offset >> 4) * 4 - NET_TCPH_LEN;
+	int i = 0;
+
+	/* The options are expected in the same fragment as the header */
+	if (opts + optlen > buf->frags->data + buf->frags->len) {
+		return NULL;
+	}
+
+	while (i < optlen) {
+		if (opts[i] == NET_TCP_OPT_EOL) {
+			break;
+		}
+
+		if (opts[i] == NET_TCP_OPT_NOP) {
+			i++;
+			continue;
+		}
+
+		if (i + 1 >= optlen || opts[i + 1] < 2 ||
+		    i + opts[i + 1] > optlen) {
+			break;
+		}
+
+		if (opts[i] == kind) {
+			*len = opts[i + 1];
+			return &opts[i];
+		}
+
+		i += opts[i + 1];
+	}
+
+	return NULL;
+}
+
+void net_tcp_syn_options_parse(struct net_tcp *tcp, struct net_buf *buf)
+{
+	const uint8_t *opt;
+	uint8_t len;
+
+	opt = tcp_opt_find(buf, NET_TCP_OPT_MSS, &len);
+	if (opt && len == NET_TCP_MSS_SIZE && sys_get_be16(opt + 2)) {
+		tcp->send_mss = sys_get_be16(opt + 2);
+	} else {
+		tcp->send_mss = NET_TCP_DEFAULT_MSS;
+	}
+
+	tcp->cwnd = INIT_CWND((uint32_t)tcp->send_mss);
+
+	opt = tcp_opt_find(buf, NET_TCP_OPT_WSCALE, &len);
+	if (opt && len == NET_TCP_WINDOW_SIZE) {
+		tcp->flags |= NET_TCP_WSCALE_OK;
+		tcp->send_wscale = min(opt[2], NET_TCP_WSCALE_MAX);
+	} else {
+		tcp->flags &= ~NET_TCP_WSCALE_OK;
+		tcp->send_wscale = 0;
+	}
+
+	net_tcp_set_send_wnd(tcp, buf);
+
+	if (IS_ENABLED(CONFIG_NET_TCP_SACK) &&
+	    tcp_opt_find(buf, NET_TCP_OPT_SACK_PERM, &len)) {
+		tcp->flags |= NET_TCP_SACK_OK;
+	} else {
+		tcp->flags &= ~NET_TCP_SACK_OK;
+	}
+
+	NET_DBG("MSS %u, SACK %s, window shift %u", tcp->send_mss,
+		tcp->flags & NET_TCP_SACK_OK ? "on" : "off",
+		tcp->send_wscale);
+}
+
+void net_tcp_set_send_wnd(struct net_tcp *tcp, struct net_buf *buf)
+{
+	struct net_tcp_hdr *tcphdr = NET_TCP_BUF(buf);
+
+	tcp->send_wnd = sys_get_be16(tcphdr->wnd);
+	if (!(tcphdr->flags & NET_TCP_SYN)) {
+		tcp->send_wnd <<= tcp->send_wscale;
+	}
+
+	tcp->send_wl1 = sys_get_be32(tcphdr->seq);
+	tcp->send_wl2 = sys_get_be32(tcphdr->ack);
+}
+
+void net_tcp_update_send_wnd(struct net_tcp *tcp, struct net_buf *buf)
+{
+	struct net_tcp_hdr *tcphdr = NET_TCP_BUF(buf);
+	uint32_t seq = sys_get_be32(tcphdr->seq);
+	uint32_t ack = sys_get_be32(tcphdr->ack);
+
+	/* SND.WL1 < SEG.SEQ or (SND.WL1 = SEG.SEQ and SND.WL2 =< SEG.ACK) */
+	if (seq_greater(seq, tcp->send_wl1) ||
+	    (seq == tcp->send_wl1 && !seq_greater(tcp->send_wl2, ack))) {
+		net_tcp_set_send_wnd(tcp, buf);
+	}
+}
+
+/* Mark the sent segments covered by the SACK blocks of an ACK */
+static void tcp_sack_received(struct net_tcp *tcp, struct net_buf *pkt)
+{
+	const uint8_t *opt;
+	struct net_buf *buf;
+	uint32_t left, right, seq;
+	uint8_t len;
+	int i;
+
+	opt = tcp_opt_find(pkt, NET_TCP_OPT_SACK, &len);
+	if (!opt) {
+		return;
+	}
+
+	for (i = 2; i + 8 <= len; i += 8) {
+		left = sys_get_be32(opt + i);
+		right = sys_get_be32(opt + i + 4);
+
+		SYS_SLIST_FOR_EACH_CONTAINER(&tcp->sent_list, buf, sent_list) {
+			seq = seg_seq(buf);
+
+			if (!seq_greater(left, seq) &&
+			    !seq_greater(seq + net_nbuf_appdatalen(buf),
+					 right)) {
+				net_nbuf_set_sacked(buf, true);
+			}
+		}
+	}
+}
+
+/* A duplicate ACK acknowledges the start of the first sent segment
+ * again, without carrying data or changing the connection state.
+ */
+static bool tcp_is_dup_ack(struct net_tcp *tcp, struct net_buf *pkt,
+			   uint32_t ack)
+{
+	struct net_buf *head;
+	size_t hdr_len;
+
+	if (sys_slist_is_empty(&tcp->sent_list) ||
+	    NET_TCP_FLAGS(pkt) & (NET_TCP_SYN | NET_TCP_FIN | NET_TCP_RST)) {
+		return false;
+	}
+
+	hdr_len = net_nbuf_ip_hdr_len(pkt) +
+		  (NET_TCP_BUF(pkt)->offset >> 4) * 4;
+	if (net_buf_frags_len(pkt) > hdr_len) {
+		return false;
+	}
+
+	head = CONTAINER_OF(sys_slist_peek_head(&tcp->sent_list),
+			    struct net_buf, sent_list);
+
+	return net_nbuf_buf_sent(head) && ack == seg_seq(head);
+}
+
+/* Resend the first unacknowledged segment and, when the peer selectively
+ * acknowledged later ones, every segment missing before those.
+ */
+static void tcp_retransmit_lost(struct net_tcp *tcp, bool first_only)
+{
+	struct net_buf *last_sacked = NULL;
+	struct net_buf *buf;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&tcp->sent_list, buf, sent_list) {
+		if (net_nbuf_sacked(buf)) {
+			last_sacked = buf;
+		}
+	}
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&tcp->sent_list, buf, sent_list) {
+		if (!net_nbuf_buf_sent(buf)) {
+			break;
+		}
+
+		if (!net_nbuf_sacked(buf)) {
+			NET_DBG("Retransmitting seq 0x%x", seg_seq(buf));
+
+			tcp_resend(tcp, buf);
+
+			if (first_only) {
+				break;
+			}
+		}
+
+		if (!last_sacked || buf == last_sacked) {
+			break;
+		}
+	}
+}
+
+/* Grow the congestion window, as per RFC 5681 */
+static void tcp_cwnd_open(struct net_tcp *tcp, uint32_t acked)
+{
+	uint32_t mss = tcp->send_mss;
+
+	if (tcp->cwnd < tcp->ssthresh) {
+		/* Slow start */
+		tcp->cwnd += min(acked, mss);
+	} else {
+		/* Congestion avoidance, about one segment per RTT */
+		tcp->cwnd += max(mss * mss / tcp->cwnd, 1);
+	}
+}
+
+void net_tcp_ack_received(struct net_context *ctx, struct net_buf *pkt)
 {
 	struct net_tcp *tcp = ctx->tcp;
 	sys_slist_t *list = &ctx->tcp->sent_list;
 	sys_snode_t *head;
 	struct net_buf *buf;
 	struct net_tcp_hdr *tcphdr;
+	uint32_t ack = sys_get_be32(NET_TCP_BUF(pkt)->ack);
+	uint32_t acked = 0;
 	uint32_t seq;
 	bool valid_ack = false;
 
@@ -707,12 +1217,27 @@ void net_tcp_ack_received(struct net_context *ctx, uint32_t ack)
 			}
 		}
 
+		acked += net_nbuf_appdatalen(buf);
+
 		sys_slist_remove(list, NULL, head);
 		net_nbuf_unref(buf);
 		valid_ack = true;
 	}
 
+	net_tcp_update_send_wnd(tcp, pkt);
+
+	if (IS_ENABLED(CONFIG_NET_TCP_SACK) && (tcp->flags & NET_TCP_SACK_OK)) {
+		tcp_sack_received(tcp, pkt);
+	}
+
 	if (valid_ack) {
+		tcp->dup_acks = 0;
+
+		if (tcp->rtt_active && !seq_greater(tcp->rtt_seq, ack)) {
+			tcp->rtt_active = 0;
+			tcp_rtt_sample(tcp, k_uptime_get_32() - tcp->rtt_start);
+		}
+
 		/* Restart the timer on a valid inbound ACK.  This
 		 * isn't quite the same behavior as per-packet retry
 		 * timers, but is close in practice (it starts retries
@@ -722,21 +1247,139 @@ void net_tcp_ack_received(struct net_context *ctx, uint32_t ack)
 		 */
 		restart_timer(ctx->tcp);
 
+		if (tcp->fast_recovery) {
+			if (seq_greater(tcp->recover, ack)) {
+				/* An ACK covering only part of the data
+				 * sent before fast recovery started means
+				 * the next segment was lost too.  The window
+				 * is deflated by the acknowledged data, as
+				 * per RFC 6582.
+				 */
+				tcp->cwnd -= min(acked, tcp->cwnd);
+				tcp->cwnd += tcp->send_mss;
+				tcp_retransmit_lost(tcp, true);
+			} else {
+				tcp->fast_recovery = 0;
+				tcp->cwnd = tcp->ssthresh;
+			}
+		} else {
+			tcp_cwnd_open(tcp, acked);
+		}
+
 		/* And, if we had been retrying, mark all packets
-		 * untransmitted and then resend them.  The stalled
-		 * pipe is uncorked again.
+		 * untransmitted and then resend them as the congestion
+		 * window allows.  The stalled pipe is uncorked again.
 		 */
 		if (ctx->tcp->flags & NET_TCP_RETRYING) {
-			struct net_buf *buf;
-
 			SYS_SLIST_FOR_EACH_CONTAINER(&ctx->tcp->sent_list, buf,
 						     sent_list) {
-				net_nbuf_set_buf_sent(buf, false);
+				if (!net_nbuf_sacked(buf)) {
+					net_nbuf_set_buf_sent(buf, false);
+				}
 			}
+		}
+	} else if (tcp_is_dup_ack(tcp, pkt, ack)) {
+		if (tcp->fast_recovery) {
+			/* Each duplicate ACK tells that a segment left
+			 * the network.
+			 */
+			tcp->cwnd += tcp->send_mss;
+		} else if (++tcp->dup_acks == FAST_RETRANSMIT_DUP_ACKS) {
+			NET_DBG("Fast retransmit after %d duplicate ACKs",
+				tcp->dup_acks);
+
+			tcp->dup_acks = 0;
+			tcp->fast_recovery = 1;
+			tcp->recover = tcp->send_seq;
+			tcp->rtt_active = 0;
+
+			tcp->ssthresh = tcp_loss_ssthresh(tcp);
+			tcp->cwnd = tcp->ssthresh + 3 * tcp->send_mss;
 
-			net_tcp_send_data(ctx);
+			tcp_retransmit_lost(tcp, false);
 		}
 	}
+
+	/* Send the data the updated windows allow */
+	net_tcp_send_data(ctx);
+
+	if (valid_ack) {
+		ctx->tcp->flags &= ~NET_TCP_RETRYING;
+	}
+}
+
+bool net_tcp_queue_ooo(struct net_tcp *tcp, struct net_buf *buf)
+{
+	struct net_buf *prev = NULL;
+	struct net_buf *tmp;
+	uint32_t seq = seg_seq(buf);
+	int count = 0;
+
+	/* Only keep segments starting ahead of the expected one and
+	 * within the receive window.
+	 */
+	if (!seq_greater(seq, tcp->send_ack) ||
+	    seq - tcp->send_ack >= get_recv_wnd(tcp)) {
+		return false;
+	}
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&tcp->ooo_list, tmp, sent_list) {
+		if (seg_seq(tmp) == seq) {
+			/* Retransmission of a segment already queued */
+			tcp->ooo_last_seq = seq;
+			return false;
+		}
+
+		if (seq_greater(seq, seg_seq(tmp))) {
+			prev = tmp;
+		}
+
+		count++;
+	}
+
+	if (count >= CONFIG_NET_TCP_OOO_SEGMENTS) {
+		NET_DBG("Out-of-order queue full, dropping seq 0x%x", seq);
+		return false;
+	}
+
+	/* The list node is only used for sent segments otherwise */
+	sys_slist_insert(&tcp->ooo_list, prev ? &prev->sent_list : NULL,
+			 &buf->sent_list);
+
+	tcp->ooo_last_seq = seq;
+
+	NET_DBG("Queued out-of-order seq 0x%x len %u, expecting 0x%x",
+		seq, net_nbuf_appdatalen(buf), tcp->send_ack);
+
+	return true;
+}
+
+struct net_buf *net_tcp_dequeue_ooo(struct net_tcp *tcp)
+{
+	struct net_buf *buf;
+	uint32_t seq;
+
+	while (!sys_slist_is_empty(&tcp->ooo_list)) {
+		buf = CONTAINER_OF(sys_slist_peek_head(&tcp->ooo_list),
+				   struct net_buf, sent_list);
+		seq = seg_seq(buf);
+
+		if (seq_greater(seq, tcp->send_ack)) {
+			/* There is still data missing before it */
+			return NULL;
+		}
+
+		sys_slist_get_not_empty(&tcp->ooo_list);
+
+		if (seq == tcp->send_ack) {
+			return buf;
+		}
+
+		/* Overlaps data that was already received */
+		net_nbuf_unref(buf);
+	}
+
+	return NULL;
 }
 
 void net_tcp_init(void)
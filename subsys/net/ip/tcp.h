@@ -19,6 +19,7 @@
 #include <net/net_ip.h>
 #include <net/nbuf.h>
 #include <net/net_context.h>
+#include <misc/byteorder.h>
 
 #include "connection.h"
 
@@ -44,6 +45,12 @@ extern "C" {
 /** MSS option has been set already */
 #define NET_TCP_RECV_MSS_SET BIT(5)
 
+/** Selective acknowledgments are used on this connection */
+#define NET_TCP_SACK_OK BIT(6)
+
+/** The peer offered window scaling in its SYN */
+#define NET_TCP_WSCALE_OK BIT(7)
+
 /*
  * TCP connection states
  */
@@ -86,12 +93,35 @@ enum net_tcp_state {
 #define NET_TCP_MSS_SIZE      4          /* MSS option size */
 #define NET_TCP_WINDOW_SIZE   3          /* Window scale option size */
 
+#define NET_TCP_SACK_PERM_HEADER 0x01010402 /* NOP, NOP, SACK permitted */
+#define NET_TCP_SACK_HEADER      0x01010500 /* NOP, NOP, SACK, length */
+
+#define NET_TCP_SACK_PERM_SIZE 4  /* SACK permitted option size */
+
+#define NET_TCP_WSCALE_HEADER 0x01030300 /* NOP, window scale, shift 0 */
+#define NET_TCP_WSCALE_SIZE   4          /* Window scale option size */
+#define NET_TCP_WSCALE_MAX    14         /* Max shift as per RFC 7323 */
+#define NET_TCP_SACK_MAX_BLOCKS 4 /* SACK blocks fitting in the options */
+
+#define NET_TCP_OPT_EOL       0          /* End of options list */
+#define NET_TCP_OPT_NOP       1          /* No operation */
+#define NET_TCP_OPT_MSS       2          /* MSS option kind */
+#define NET_TCP_OPT_WSCALE    3          /* Window scale option kind */
+#define NET_TCP_OPT_SACK_PERM 4          /* SACK permitted option kind */
+#define NET_TCP_OPT_SACK      5          /* SACK option kind */
+
+/* Max length of the options in a TCP header */
+#define NET_TCP_MAX_OPT_LEN   40
+
 /* Max received bytes to buffer internally */
 #define NET_TCP_BUF_MAX_LEN 1280
 
 /* Max segment lifetime, in seconds */
 #define NET_TCP_MAX_SEG_LIFETIME 60
 
+/* Segment size used when the peer does not send the MSS option */
+#define NET_TCP_DEFAULT_MSS 536
+
 struct net_context;
 
 struct net_tcp {
@@ -110,6 +140,50 @@ struct net_tcp {
 	/** List pointer used for TCP retransmit buffering */
 	sys_slist_t sent_list;
 
+	/** Received out-of-order segments, sorted by sequence number */
+	sys_slist_t ooo_list;
+
+	/** Sequence number of the last segment added to ooo_list */
+	uint32_t ooo_last_seq;
+
+	/** Highest sequence number sent when fast recovery started */
+	uint32_t recover;
+
+	/** Congestion window, in bytes */
+	uint32_t cwnd;
+
+	/** Slow start threshold, in bytes */
+	uint32_t ssthresh;
+
+	/** Smoothed round-trip time, in milliseconds scaled by 8 */
+	uint32_t srtt;
+
+	/** Round-trip time variation, in milliseconds scaled by 4 */
+	uint32_t rttvar;
+
+	/** Retransmission timeout, in milliseconds */
+	uint32_t rto;
+
+	/** Sequence number whose ACK ends the round-trip time measurement */
+	uint32_t rtt_seq;
+
+	/** Uptime when the measured segment was sent, in milliseconds */
+	uint32_t rtt_start;
+
+	/** Receive window advertised by the peer, scaled */
+	uint32_t send_wnd;
+
+	/** Sequence number of the segment the send window was taken from */
+	uint32_t send_wl1;
+
+	/** Acknowledgment number of the segment the send window was taken
+	 * from
+	 */
+	uint32_t send_wl2;
+
+	/** Max segment size accepted by the peer */
+	uint16_t send_mss;
+
 	/** Max acknowledgment. */
 	uint32_t recv_max_ack;
 
@@ -134,8 +208,21 @@ struct net_tcp {
 	uint32_t fin_sent : 1;
 	/* An inbound FIN packet has been received */
 	uint32_t fin_rcvd : 1;
+	/* Number of duplicate ACKs received in a row */
+	uint32_t dup_acks : 2;
+	/* Lost segments are being retransmitted after duplicate ACKs */
+	uint32_t fast_recovery : 1;
+	/* The round-trip time of a segment is being measured */
+	uint32_t rtt_active : 1;
+	/* Shift of the windows advertised by the peer */
+	uint32_t send_wscale : 4;
 	/** Remaining bits in this uint32_t */
-	uint32_t _padding : 12;
+	uint32_t _padding : 4;
+
+#if defined(CONFIG_NET_STATISTICS_TCP)
+	/** Number of retransmitted segments */
+	uint32_t rexmit;
+#endif
 
 	/** Accept callback to be called when the connection has been
 	 * established.
@@ -309,10 +396,81 @@ int net_tcp_send_buf(struct net_buf *buf);
 /**
  * @brief Handle a received TCP ACK
  *
+ * @details Releases the acknowledged segments, processes the SACK
+ * option and retransmits the lost segments after duplicate ACKs.
+ *
  * @param cts Context
- * @param seq Received ACK sequence number
+ * @param buf Received packet with the ACK flag set
+ */
+void net_tcp_ack_received(struct net_context *ctx, struct net_buf *buf);
+
+/**
+ * @brief Process the options of a SYN or SYN-ACK
+ *
+ * @details Sets the segment size accepted by the peer, and whether it
+ * allows selective acknowledgments.
+ *
+ * @param tcp TCP context
+ * @param buf Received SYN or SYN-ACK packet
+ */
+void net_tcp_syn_options_parse(struct net_tcp *tcp, struct net_buf *buf);
+
+/**
+ * @brief Set the send window to the one advertised by the peer
+ *
+ * @details Used for the segments of the three-way handshake, the window of
+ * a SYN segment is not scaled.
+ *
+ * @param tcp TCP context
+ * @param buf Received packet
+ */
+void net_tcp_set_send_wnd(struct net_tcp *tcp, struct net_buf *buf);
+
+/**
+ * @brief Update the send window with the one advertised by the peer
+ *
+ * @details As per RFC 793, the window is only updated from a segment that
+ * is not older than the one it was last taken from, so that a reordered
+ * segment does not shrink it.
+ *
+ * @param tcp TCP context
+ * @param buf Received packet
+ */
+void net_tcp_update_send_wnd(struct net_tcp *tcp, struct net_buf *buf);
+
+/**
+ * @brief Obtains the smoothed round-trip time of a TCP context
+ *
+ * @param tcp TCP context
+ *
+ * @return Smoothed round-trip time in milliseconds, 0 if not measured yet
+ */
+static inline uint32_t net_tcp_get_srtt(const struct net_tcp *tcp)
+{
+	return tcp->srtt >> 3;
+}
+
+/**
+ * @brief Keep a segment received ahead of the next expected one
+ *
+ * @details The appdata values of the packet must be set.
+ *
+ * @param tcp TCP context
+ * @param buf Received packet, owned by the TCP context if queued
+ *
+ * @return true if the packet was queued, false if it must be dropped
+ */
+bool net_tcp_queue_ooo(struct net_tcp *tcp, struct net_buf *buf);
+
+/**
+ * @brief Get the next in-order segment from the out-of-order queue
+ *
+ * @param tcp TCP context
+ *
+ * @return Packet starting at the next expected sequence number, NULL if
+ * there is none.
  */
-void net_tcp_ack_received(struct net_context *ctx, uint32_t ack);
+struct net_buf *net_tcp_dequeue_ooo(struct net_tcp *tcp);
 
 /**
  * @brief Calculates and returns the MSS for a given TCP context
@@ -355,31 +355,105 @@ int net_addr_pton(sa_family_t family, const char *src,
 	return 0;
 }
 
-static uint16_t calc_chksum(uint16_t sum, const uint8_t *ptr, uint16_t len)
+/*
+ * The Internet checksum does not depend on byte order (RFC 1071): the data
+ * is summed as native endian words and only the final 16-bit sum is
+ * converted. The carries are accumulated in the upper bits of a wider sum
+ * and folded back once at the end.
+ */
+
+#if defined(CONFIG_NET_CHKSUM_ARCH)
+#define chksum_words _arch_net_chksum_words
+#else
+static uint32_t chksum_words(const uint32_t *words, size_t count)
 {
-	uint16_t tmp;
-	const uint8_t *end;
+	uint64_t sum = 0;
+
+	while (count >= 4) {
+		sum += words[0];
+		sum += words[1];
+		sum += words[2];
+		sum += words[3];
+		words += 4;
+		count -= 4;
+	}
 
-	end = ptr + len - 1;
+	while (count--) {
+		sum += *words++;
+	}
 
-	while (ptr < end) {
-		tmp = (ptr[0] << 8) + ptr[1];
-		sum += tmp;
-		if (sum < tmp) {
-			sum++;
-		}
+	sum = (sum & 0xffffffff) + (sum >> 32);
+	sum = (sum & 0xffffffff) + (sum >> 32);
+
+	return sum;
+}
+#endif /* CONFIG_NET_CHKSUM_ARCH */
+
+static inline uint16_t chksum_fold(uint32_t sum)
+{
+	sum = (sum & 0xffff) + (sum >> 16);
+	sum = (sum & 0xffff) + (sum >> 16);
+
+	return sum;
+}
+
+static inline uint16_t chksum_swap(uint16_t sum)
+{
+	return (sum << 8) | (sum >> 8);
+}
+
+/* Native endian word holding the byte at the lowest address */
+static inline uint16_t chksum_byte(uint8_t byte)
+{
+	return sys_be16_to_cpu((uint16_t)byte << 8);
+}
+
+/* Native endian sum of the data, as if it started on a word boundary */
+static uint16_t chksum_native(const uint8_t *ptr, size_t len)
+{
+	uint32_t sum = 0;
+	size_t count;
+
+	if (!len) {
+		return 0;
+	}
+
+	/* Data at an odd address is summed from the next byte, which
+	 * swaps the bytes of the sum.
+	 */
+	if (POINTER_TO_UINT(ptr) & 1) {
+		sum = chksum_swap(chksum_native(ptr + 1, len - 1));
+
+		return chksum_fold(sum + chksum_byte(*ptr));
+	}
+
+	if ((POINTER_TO_UINT(ptr) & 2) && len >= 2) {
+		sum = *(const uint16_t *)ptr;
 		ptr += 2;
+		len -= 2;
 	}
 
-	if (ptr == end) {
-		tmp = ptr[0] << 8;
-		sum += tmp;
-		if (sum < tmp) {
-			sum++;
-		}
+	count = len / 4;
+	sum += chksum_fold(chksum_words((const uint32_t *)ptr, count));
+	ptr += count * 4;
+	len -= count * 4;
+
+	if (len & 2) {
+		sum += *(const uint16_t *)ptr;
+		ptr += 2;
 	}
 
-	return sum;
+	if (len & 1) {
+		sum += chksum_byte(*ptr);
+	}
+
+	return chksum_fold(sum);
+}
+
+/* Adds the data to a sum of big endian words */
+static uint16_t calc_chksum(uint16_t sum, const uint8_t *ptr, uint16_t len)
+{
+	return chksum_fold((uint32_t)sum + ntohs(chksum_native(ptr, len)));
 }
 
 static inline uint16_t calc_chksum_buf(uint16_t sum, struct net_buf *buf,
@@ -389,6 +463,8 @@ static inline uint16_t calc_chksum_buf(uint16_t sum, struct net_buf *buf,
 	uint16_t proto_len = net_nbuf_ip_hdr_len(buf) + net_nbuf_ext_len(buf);
 	int16_t len = frag->len - proto_len;
 	uint8_t *ptr = frag->data + proto_len;
+	uint32_t native = 0;
+	bool odd = false;
 
 	ARG_UNUSED(upper_layer_len);
 
@@ -398,30 +474,28 @@ static inline uint16_t calc_chksum_buf(uint16_t sum, struct net_buf *buf,
 		return 0;
 	}
 
+	/* A fragment starting at an odd offset of the packet sums to the
+	 * byte swap of its contribution.
+	 */
 	while (frag) {
-		sum = calc_chksum(sum, ptr, len);
+		if (odd) {
+			native += chksum_swap(chksum_native(ptr, len));
+		} else {
+			native += chksum_native(ptr, len);
+		}
+
+		odd ^= len & 1;
+
 		frag = frag->frags;
 		if (!frag) {
 			break;
 		}
 
 		ptr = frag->data;
-
-		/* Do we need to take first byte from next fragment */
-		if (len % 2) {
-			uint16_t tmp = *ptr;
-			sum += tmp;
-			if (sum < tmp) {
-				sum++;
-			}
-			len = frag->len - 1;
-			ptr++;
-		} else {
-			len = frag->len;
-		}
+		len = frag->len;
 	}
 
-	return sum;
+	return chksum_fold((uint32_t)sum + ntohs(chksum_fold(native)));
 }
 
 uint16_t net_calc_chksum(struct net_buf *buf, uint8_t proto)
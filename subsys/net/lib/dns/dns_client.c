@@ -31,6 +31,12 @@
 				 CONFIG_DNS_RESOLVER_ADDITIONAL_BUF_CTR)
 #define DNS_RESOLVER_QUERIES	(1 + CONFIG_DNS_RESOLVER_ADDITIONAL_QUERIES)
 
+/* A CNAME query that could not be sent from the RX thread is tried again
+ * by the timer of the query, every DNS_RESOLVER_RESEND_DELAY ms.
+ */
+#define DNS_RESOLVER_RESEND_DELAY	100
+#define DNS_RESOLVER_RESENDS		10
+
 /* Compressed RR uses a pointer to another RR. So, min size is 12 bytes without
  * considering RR payload.
  * See https://tools.ietf.org/html/rfc1035#section-4.1.4
@@ -51,6 +57,186 @@ NET_BUF_POOL_DEFINE(dns_msg_pool, DNS_RESOLVER_BUF_CTR,
 NET_BUF_POOL_DEFINE(dns_qname_pool, DNS_RESOLVER_BUF_CTR, DNS_MAX_NAME_LEN,
 		    0, NULL);
 
+static inline int dns_address_size(uint16_t query_type)
+{
+	if (query_type == DNS_QUERY_TYPE_A) {
+		return DNS_IPV4_LEN;
+	}
+
+	return DNS_IPV6_LEN;
+}
+
+/* RFC 2308: the name does not exist (NXDOMAIN) or it has no RR of the type
+ * requested (NODATA). The header is assumed to be complete.
+ */
+static bool dns_negative_answer(uint8_t *header)
+{
+	if (dns_header_qr(header) != DNS_RESPONSE) {
+		return false;
+	}
+
+	switch (dns_header_rcode(header)) {
+	case DNS_HEADER_NAMEERROR:
+		return true;
+	case DNS_HEADER_NOERROR:
+		return dns_header_ancount(header) == 0;
+	default:
+		return false;
+	}
+}
+
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+/* Longer names are not cached */
+#define DNS_CACHE_NAME_LEN	64
+
+/* One day, so the expiry time in ms does not wrap */
+#define DNS_CACHE_MAX_TTL	86400
+
+#define DNS_CACHE_ADDRESSES	CONFIG_DNS_RESOLVER_MAX_ADDRESSES
+
+struct dns_cache_entry {
+	/* Uptime, in ms, when the entry expires */
+	uint32_t expiry;
+	/* Query type, 0 if the entry is not used */
+	uint16_t query_type;
+	/* Number of addresses, 0 if the name has no address */
+	uint8_t items;
+	char name[DNS_CACHE_NAME_LEN];
+	uint8_t addresses[DNS_CACHE_ADDRESSES * DNS_IPV6_LEN];
+};
+
+static struct dns_cache_entry dns_cache[CONFIG_DNS_RESOLVER_CACHE_SIZE];
+static K_SEM_DEFINE(dns_cache_lock, 1, 1);
+
+/* Must be called with the cache locked, expired entries are released */
+static struct dns_cache_entry *dns_cache_find(const char *name,
+					      uint16_t query_type)
+{
+	uint32_t now = k_uptime_get_32();
+	struct dns_cache_entry *entry;
+	int i;
+
+	for (i = 0; i < CONFIG_DNS_RESOLVER_CACHE_SIZE; i++) {
+		entry = &dns_cache[i];
+
+		if (entry->query_type != query_type ||
+		    strcmp(entry->name, name) != 0) {
+			continue;
+		}
+
+		if ((int32_t)(entry->expiry - now) <= 0) {
+			entry->query_type = 0;
+			return NULL;
+		}
+
+		return entry;
+	}
+
+	return NULL;
+}
+
+/*
+ * Copies the cached addresses of a name. Returns 0 if addresses are found,
+ * -ENOENT if the name is cached without address and -EAGAIN if the name is
+ * not cached.
+ */
+static int dns_cache_lookup(const char *name, uint16_t query_type,
+			    uint8_t *addresses, uint8_t elements,
+			    uint8_t *items, uint32_t *ttl)
+{
+	struct dns_cache_entry *entry;
+	int rc;
+
+	k_sem_take(&dns_cache_lock, K_FOREVER);
+
+	entry = dns_cache_find(name, query_type);
+	if (entry == NULL) {
+		rc = -EAGAIN;
+	} else if (entry->items == 0) {
+		rc = -ENOENT;
+	} else {
+		*items = min(entry->items, elements);
+		*ttl = (entry->expiry - k_uptime_get_32()) / MSEC_PER_SEC;
+		memcpy(addresses, entry->addresses,
+		       *items * dns_address_size(query_type));
+		rc = 0;
+	}
+
+	k_sem_give(&dns_cache_lock);
+
+	return rc;
+}
+
+/*
+ * Stores the addresses of a name, items is 0 if the name has no address.
+ * When the cache is full, the entry closest to expiry is replaced.
+ */
+static void dns_cache_add(const char *name, uint16_t query_type,
+			  const uint8_t *addresses, uint8_t items, uint32_t ttl)
+{
+	struct dns_cache_entry *entry;
+	int i;
+
+	if (strlen(name) >= DNS_CACHE_NAME_LEN) {
+		return;
+	}
+
+	if (items == 0) {
+		ttl = CONFIG_DNS_RESOLVER_NEGATIVE_TTL;
+	}
+
+	/* RFC 1035, 3.2.1: zero values are interpreted to mean that the RR
+	 * can only be used for the transaction in progress.
+	 */
+	if (ttl == 0) {
+		return;
+	}
+
+	k_sem_take(&dns_cache_lock, K_FOREVER);
+
+	entry = dns_cache_find(name, query_type);
+	if (entry == NULL) {
+		entry = &dns_cache[0];
+
+		for (i = 0; i < CONFIG_DNS_RESOLVER_CACHE_SIZE; i++) {
+			struct dns_cache_entry *other = &dns_cache[i];
+
+			if (other->query_type == 0) {
+				entry = other;
+				break;
+			}
+
+			if ((int32_t)(other->expiry - entry->expiry) < 0) {
+				entry = other;
+			}
+		}
+	}
+
+	strcpy(entry->name, name);
+	entry->query_type = query_type;
+	entry->items = min(items, DNS_CACHE_ADDRESSES);
+	entry->expiry = k_uptime_get_32() +
+			min(ttl, DNS_CACHE_MAX_TTL) * MSEC_PER_SEC;
+	memcpy(entry->addresses, addresses,
+	       entry->items * dns_address_size(query_type));
+
+	k_sem_give(&dns_cache_lock);
+}
+
+void dns_cache_flush(void)
+{
+	int i;
+
+	k_sem_take(&dns_cache_lock, K_FOREVER);
+
+	for (i = 0; i < CONFIG_DNS_RESOLVER_CACHE_SIZE; i++) {
+		dns_cache[i].query_type = 0;
+	}
+
+	k_sem_give(&dns_cache_lock);
+}
+#endif
+
 int dns_init(struct dns_context *ctx)
 {
 	k_sem_init(&ctx->rx_sem, 0, UINT_MAX);
@@ -64,7 +250,16 @@ int dns_write(struct dns_context *ctx, struct net_buf *dns_data,
 
 static
 int dns_read(struct dns_context *ctx, struct net_buf *dns_data, uint16_t dns_id,
-	     struct net_buf *cname);
+	     struct net_buf *cname, uint32_t *ttl);
+
+static
+int dns_read_answer(struct dns_msg_t *dns_msg, uint16_t query_type,
+		    uint8_t *addresses, uint8_t elements, uint8_t *items,
+		    uint32_t *ttl);
+
+static
+int dns_send(struct net_context *net_ctx, struct sockaddr *dns_server,
+	     int32_t timeout, struct net_buf *dns_data);
 
 /* net_context_recv callback */
 static
@@ -83,9 +278,21 @@ int dns_resolve(struct dns_context *ctx)
 	struct net_buf *dns_data = NULL;
 	struct net_buf *dns_qname = NULL;
 	uint16_t dns_id;
+	uint32_t ttl = 0;
 	int rc;
 	int i;
 
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	if (ctx->elements > 0) {
+		rc = dns_cache_lookup(ctx->name, ctx->query_type,
+				      (uint8_t *)ctx->address.ipv4,
+				      ctx->elements, &ctx->items, &ttl);
+		if (rc != -EAGAIN) {
+			return rc == 0 ? 0 : -EINVAL;
+		}
+	}
+#endif
+
 	k_sem_reset(&ctx->rx_sem);
 
 	dns_id = sys_rand32_get();
@@ -118,7 +325,7 @@ int dns_resolve(struct dns_context *ctx)
 			goto exit_resolve;
 		}
 
-		rc = dns_read(ctx, dns_data, dns_id, dns_qname);
+		rc = dns_read(ctx, dns_data, dns_id, dns_qname, &ttl);
 		if (rc != 0) {
 			goto exit_resolve;
 		}
@@ -135,7 +342,23 @@ int dns_resolve(struct dns_context *ctx)
 		rc = -EINVAL;
 	}
 
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	if (ctx->items > 0) {
+		dns_cache_add(ctx->name, ctx->query_type,
+			      (uint8_t *)ctx->address.ipv4, ctx->items, ttl);
+	}
+#endif
+
 exit_resolve:
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	if (rc == -ENOENT) {
+		dns_cache_add(ctx->name, ctx->query_type, NULL, 0, 0);
+	}
+#endif
+	if (rc == -ENOENT) {
+		rc = -EINVAL;
+	}
+
 	/* dns_data may be NULL, however net_nbuf_unref supports that */
 	net_nbuf_unref(dns_data);
 	net_nbuf_unref(dns_qname);
@@ -150,47 +373,57 @@ static
 int dns_write(struct dns_context *ctx, struct net_buf *dns_data,
 	      uint16_t dns_id, struct net_buf *dns_qname)
 {
-	struct net_buf *tx;
-	int server_addr_len;
 	int rc;
 
 	rc = dns_msg_pack_query(dns_data->data, &dns_data->len, dns_data->size,
 				dns_qname->data, dns_qname->len, dns_id,
 				(enum dns_rr_type)ctx->query_type);
 	if (rc != 0) {
-		rc = -EINVAL;
-		goto exit_write;
+		return -EINVAL;
 	}
 
-	tx = net_nbuf_get_tx(ctx->net_ctx, K_FOREVER);
+	return dns_send(ctx->net_ctx, ctx->dns_server, ctx->timeout, dns_data);
+}
+
+static
+int dns_send(struct net_context *net_ctx, struct sockaddr *dns_server,
+	     int32_t timeout, struct net_buf *dns_data)
+{
+	struct net_buf *tx;
+	int server_addr_len;
+	int rc;
+
+	tx = net_nbuf_get_tx(net_ctx, timeout);
 	if (tx == NULL) {
 		rc = -ENOMEM;
-		goto exit_write;
+		goto exit_send;
 	}
 
-	rc = net_nbuf_append(tx, dns_data->len, dns_data->data, K_FOREVER);
+	rc = net_nbuf_append(tx, dns_data->len, dns_data->data, timeout);
 	if (rc != true) {
+		net_nbuf_unref(tx);
 		rc = -ENOMEM;
-		goto exit_write;
+		goto exit_send;
 	}
 
-	if (ctx->dns_server->family == AF_INET) {
+	if (dns_server->family == AF_INET) {
 		server_addr_len = sizeof(struct sockaddr_in);
 	} else {
 		server_addr_len = sizeof(struct sockaddr_in6);
 	}
 
-	/* tx and dns_data buffers will be dereferenced after this call */
-	rc = net_context_sendto(tx, ctx->dns_server, server_addr_len, NULL,
-				ctx->timeout, NULL, NULL);
+	/* tx will be dereferenced after this call */
+	rc = net_context_sendto(tx, dns_server, server_addr_len, NULL,
+				timeout, NULL, NULL);
 	if (rc != 0) {
+		net_nbuf_unref(tx);
 		rc = -EIO;
-		goto exit_write;
+		goto exit_send;
 	}
 
 	rc = 0;
 
-exit_write:
+exit_send:
 	return rc;
 }
 
@@ -212,27 +445,13 @@ void cb_recv(struct net_context *net_ctx, struct net_buf *buf, int status,
 
 static
 int dns_read(struct dns_context *ctx, struct net_buf *dns_data, uint16_t dns_id,
-	     struct net_buf *cname)
+	     struct net_buf *cname, uint32_t *ttl)
 {
 	/* helper struct to track the dns msg received from the server */
 	struct dns_msg_t dns_msg;
-	uint8_t *addresses;
-	/* RR ttl, so far it is not passed to caller */
-	uint32_t ttl;
-	uint8_t *src;
-	uint8_t *dst;
-	int address_size;
-	/* index that points to the current answer being analyzed */
-	int answer_ptr;
 	int data_len;
 	int offset;
 	int rc;
-	int i;
-
-	/* The cast is applied on address.ipv4, however we can also apply it on
-	 * address.ipv6 and we will get the same result.
-	 */
-	addresses = (uint8_t *)ctx->address.ipv4;
 
 	if (ctx->elements <= 0) {
 		rc = -EINVAL;
@@ -269,7 +488,15 @@ int dns_read(struct dns_context *ctx, struct net_buf *dns_data, uint16_t dns_id,
 
 	rc = dns_unpack_response_header(&dns_msg, dns_id);
 	if (rc != 0) {
-		rc = -EINVAL;
+		/* -ENOENT lets dns_resolve cache the name as non-existent */
+		if (rc != -ENOMEM &&
+		    dns_unpack_header_id(dns_msg.msg) == dns_id &&
+		    dns_negative_answer(dns_msg.msg)) {
+			rc = -ENOENT;
+		} else {
+			rc = -EINVAL;
+		}
+
 		goto exit_error;
 	}
 
@@ -284,41 +511,91 @@ int dns_read(struct dns_context *ctx, struct net_buf *dns_data, uint16_t dns_id,
 		goto exit_error;
 	}
 
-	if (ctx->query_type == DNS_QUERY_TYPE_A) {
-		address_size = DNS_IPV4_LEN;
-	} else {
-		address_size = DNS_IPV6_LEN;
+	/* The cast is applied on address.ipv4, however we can also apply it on
+	 * address.ipv6 and we will get the same result.
+	 */
+	rc = dns_read_answer(&dns_msg, ctx->query_type,
+			     (uint8_t *)ctx->address.ipv4, ctx->elements,
+			     &ctx->items, ttl);
+	if (rc != 0) {
+		goto exit_error;
+	}
+
+	/* No IP addresses were found, so we take the last CNAME to generate
+	 * another query. Number of additional queries is controlled via Kconfig
+	 */
+	if (ctx->items == 0) {
+		if (dns_msg.response_type == DNS_RESPONSE_CNAME_NO_IP) {
+			uint16_t pos = dns_msg.response_position;
+
+			rc = dns_copy_qname(cname->data, &cname->len,
+					    cname->size, &dns_msg, pos);
+			if (rc != 0) {
+				goto exit_error;
+			}
+
+		}
 	}
 
+	rc = 0;
+
+exit_error:
+	net_nbuf_unref(ctx->rx_buf);
+
+	return rc;
+}
+
+/*
+ * Traverses the answer section and copies up to 'elements' addresses. ttl is
+ * set to the lowest TTL of the RRs read. When no address is found, the last
+ * CNAME is left in dns_msg->response_position.
+ */
+static
+int dns_read_answer(struct dns_msg_t *dns_msg, uint16_t query_type,
+		    uint8_t *addresses, uint8_t elements, uint8_t *items,
+		    uint32_t *ttl)
+{
+	uint32_t rr_ttl;
+	uint8_t *src;
+	uint8_t *dst;
+	int address_size;
+	/* index that points to the current answer being analyzed */
+	int answer_ptr;
+	int rc;
+	int i;
+
+	address_size = dns_address_size(query_type);
+
 	/* while loop to traverse the response */
 	answer_ptr = DNS_QUERY_POS;
-	ctx->items = 0;
+	*items = 0;
+	*ttl = UINT32_MAX;
 	i = 0;
-	while (i < dns_header_ancount(dns_msg.msg)) {
-		rc = dns_unpack_answer(&dns_msg, answer_ptr, &ttl);
+	while (i < dns_header_ancount(dns_msg->msg)) {
+		rc = dns_unpack_answer(dns_msg, answer_ptr, &rr_ttl);
 		if (rc != 0) {
-			rc = -EINVAL;
-			goto exit_error;
+			return -EINVAL;
 		}
 
-		switch (dns_msg.response_type) {
+		*ttl = min(*ttl, rr_ttl);
+
+		switch (dns_msg->response_type) {
 		case DNS_RESPONSE_IP:
-			if (dns_msg.response_length < address_size) {
+			if (dns_msg->response_length < address_size) {
 				/* it seems this is a malformed message */
-				rc = -EINVAL;
-				goto exit_error;
+				return -EINVAL;
 			}
 
-			src = dns_msg.msg + dns_msg.response_position;
-			dst = addresses + ctx->items * address_size;
+			src = dns_msg->msg + dns_msg->response_position;
+			dst = addresses + *items * address_size;
 			memcpy(dst, src, address_size);
 
-			ctx->items += 1;
-			if (ctx->items >= ctx->elements) {
+			*items += 1;
+			if (*items >= elements) {
 				/* elements is always >= 1, so it is assumed
 				 * that at least one address was returned.
 				 */
-				goto exit_ok;
+				return 0;
 			}
 
 			break;
@@ -327,42 +604,553 @@ int dns_read(struct dns_context *ctx, struct net_buf *dns_data, uint16_t dns_id,
 			/* Instead of using the QNAME at DNS_QUERY_POS,
 			 * we will use this CNAME
 			 */
-			answer_ptr = dns_msg.response_position;
+			answer_ptr = dns_msg->response_position;
 			break;
 
 		default:
-			rc = -EINVAL;
-			goto exit_error;
+			return -EINVAL;
 		}
 
 		/* Update the answer offset to point to the next RR (answer) */
-		dns_msg.answer_offset += DNS_ANSWER_PTR_LEN;
-		dns_msg.answer_offset += dns_msg.response_length;
+		dns_msg->answer_offset += DNS_ANSWER_PTR_LEN;
+		dns_msg->answer_offset += dns_msg->response_length;
 
 		++i;
 	}
 
-	/* No IP addresses were found, so we take the last CNAME to generate
-	 * another query. Number of additional queries is controlled via Kconfig
+	return 0;
+}
+
+#if defined(CONFIG_DNS_RESOLVER_ASYNC)
+/* Queries of the outstanding asynchronous queries, kept for retransmission
+ * of the CNAME queries.
+ */
+NET_BUF_POOL_DEFINE(dns_query_pool, CONFIG_DNS_RESOLVER_MAX_QUERIES,
+		    DNS_QUERY_MAX_SIZE, 0, NULL);
+
+/* Answers are handled one at a time, in the RX thread */
+NET_BUF_POOL_DEFINE(dns_answer_pool, 1, DNS_RESOLVER_MAX_BUF_SIZE, 0, NULL);
+
+/* Must be called with the resolver locked */
+static struct dns_pending_query *dns_pending_find(struct dns_resolver *resolver,
+						  uint16_t id)
+{
+	int i;
+
+	for (i = 0; i < CONFIG_DNS_RESOLVER_MAX_QUERIES; i++) {
+		if (resolver->pending[i].cb && resolver->pending[i].id == id) {
+			return &resolver->pending[i];
+		}
+	}
+
+	return NULL;
+}
+
+/* Must be called with the resolver locked */
+static struct dns_pending_query *dns_pending_get(struct dns_resolver *resolver)
+{
+	int i;
+
+	for (i = 0; i < CONFIG_DNS_RESOLVER_MAX_QUERIES; i++) {
+		if (!resolver->pending[i].cb && !resolver->pending[i].query) {
+			return &resolver->pending[i];
+		}
+	}
+
+	return NULL;
+}
+
+/* Must be called with the resolver locked */
+static void dns_pending_release(struct dns_pending_query *pending)
+{
+	/* A timeout already queued to the workqueue cannot be cancelled,
+	 * it must not complete the next query using this entry.
 	 */
-	if (ctx->items == 0) {
-		if (dns_msg.response_type == DNS_RESPONSE_CNAME_NO_IP) {
-			uint16_t pos = dns_msg.response_position;
+	pending->stale_timeout =
+		k_delayed_work_cancel(&pending->timer) == -EINPROGRESS;
 
-			rc = dns_copy_qname(cname->data, &cname->len,
-					    cname->size, &dns_msg, pos);
-			if (rc != 0) {
-				goto exit_error;
+	net_buf_unref(pending->query);
+	pending->query = NULL;
+	pending->cb = NULL;
+}
+
+/*
+ * Packs the query of 'pending', with a transaction identifier not used by
+ * the other outstanding queries. Must be called with the resolver locked.
+ */
+static int dns_pending_pack(struct dns_pending_query *pending,
+			    struct net_buf *qname)
+{
+	struct dns_resolver *resolver = pending->resolver;
+	int rc;
+
+	do {
+		pending->id = sys_rand32_get();
+	} while (dns_pending_find(resolver, pending->id));
+
+	rc = dns_msg_pack_query(pending->query->data, &pending->query->len,
+				pending->query->size, qname->data, qname->len,
+				pending->id,
+				(enum dns_rr_type)pending->query_type);
+
+	return rc != 0 ? -EINVAL : 0;
+}
+
+/*
+ * Packs and sends the query of 'pending'. If the query is packed but cannot
+ * be sent, pending->unsent is set. Must be called with the resolver locked,
+ * so the send must not wait.
+ */
+static int dns_pending_send(struct dns_pending_query *pending,
+			    struct net_buf *qname)
+{
+	struct dns_resolver *resolver = pending->resolver;
+	int rc;
+
+	rc = dns_pending_pack(pending, qname);
+	if (rc != 0) {
+		return rc;
+	}
+
+	rc = dns_send(resolver->net_ctx, resolver->dns_server, K_NO_WAIT,
+		      pending->query);
+	if (rc != 0) {
+		pending->unsent = true;
+		return rc;
+	}
+
+	pending->unsent = false;
+	pending->queries++;
+	k_delayed_work_submit(&pending->timer, resolver->timeout);
+
+	return 0;
+}
+
+static void dns_pending_timeout(struct k_work *work)
+{
+	struct dns_pending_query *pending =
+		CONTAINER_OF(work, struct dns_pending_query, timer);
+	struct dns_resolver *resolver = pending->resolver;
+	struct dns_addrinfo info;
+	dns_resolve_cb_t cb;
+	void *user_data;
+	int status = -ETIMEDOUT;
+
+	k_sem_take(&resolver->lock, K_FOREVER);
+
+	/* The timeout belongs to a released query. If the entry has been
+	 * reused since, the new query could not arm the timer.
+	 */
+	if (pending->stale_timeout) {
+		pending->stale_timeout = false;
+
+		if (pending->query) {
+			k_delayed_work_submit(&pending->timer,
+					      resolver->timeout);
+		}
+
+		k_sem_give(&resolver->lock);
+		return;
+	}
+
+	/* The answer may have been handled in the meantime */
+	cb = pending->cb;
+	if (!cb) {
+		k_sem_give(&resolver->lock);
+		return;
+	}
+
+	/* This runs in the system workqueue, which must not block */
+	if (pending->unsent) {
+		if (!dns_send(resolver->net_ctx, resolver->dns_server,
+			      K_NO_WAIT, pending->query)) {
+			pending->unsent = false;
+			pending->queries++;
+			k_delayed_work_submit(&pending->timer,
+					      resolver->timeout);
+			k_sem_give(&resolver->lock);
+			return;
+		}
+
+		if (++pending->resends < DNS_RESOLVER_RESENDS) {
+			k_delayed_work_submit(&pending->timer,
+					      DNS_RESOLVER_RESEND_DELAY);
+			k_sem_give(&resolver->lock);
+			return;
+		}
+
+		status = -ENOMEM;
+	}
+
+	user_data = pending->user_data;
+	info.name = pending->name;
+	info.query_type = pending->query_type;
+	info.items = 0;
+	info.ttl = 0;
+
+	dns_pending_release(pending);
+
+	k_sem_give(&resolver->lock);
+
+	cb(resolver, status, &info, user_data);
+}
+
+/*
+ * Parses the answer to an outstanding query. When the answer only holds a
+ * CNAME, a query for that name is sent, or left to the timer if there is
+ * no buffer for it right now, and -EAGAIN is returned. Must be called with
+ * the resolver locked.
+ */
+static int dns_pending_answer(struct dns_pending_query *pending,
+			      uint8_t *data, uint16_t data_len,
+			      struct dns_addrinfo *info)
+{
+	struct dns_msg_t dns_msg = DNS_MSG_INIT(data, data_len);
+	struct net_buf *cname;
+	int rc;
+
+	info->items = 0;
+	info->ttl = 0;
+
+	rc = dns_unpack_response_header(&dns_msg, pending->id);
+	if (rc != 0) {
+		if (rc != -ENOMEM && dns_negative_answer(data)) {
+			return -ENOENT;
+		}
+
+		return rc > 0 ? -EIO : -EINVAL;
+	}
+
+	if (dns_header_qdcount(data) != 1 ||
+	    dns_unpack_response_query(&dns_msg) != 0) {
+		return -EINVAL;
+	}
+
+	rc = dns_read_answer(&dns_msg, pending->query_type,
+			     (uint8_t *)info->address.ipv4,
+			     CONFIG_DNS_RESOLVER_MAX_ADDRESSES,
+			     &info->items, &info->ttl);
+	if (rc != 0) {
+		return rc;
+	}
+
+	if (info->items > 0) {
+		return 0;
+	}
+
+	if (dns_msg.response_type != DNS_RESPONSE_CNAME_NO_IP ||
+	    pending->queries >= DNS_RESOLVER_QUERIES) {
+		return -ENOENT;
+	}
+
+	/* Query the CNAME, the RX thread must not block */
+	cname = net_buf_alloc(&dns_qname_pool, K_NO_WAIT);
+	if (!cname) {
+		return -ENOMEM;
+	}
+
+	rc = dns_copy_qname(cname->data, &cname->len, cname->size, &dns_msg,
+			    dns_msg.response_position);
+	if (rc == 0) {
+		rc = dns_pending_send(pending, cname);
+	} else {
+		rc = -EINVAL;
+	}
+
+	net_buf_unref(cname);
+
+	if (rc != 0 && pending->unsent) {
+		pending->resends = 0;
+		k_delayed_work_submit(&pending->timer,
+				      DNS_RESOLVER_RESEND_DELAY);
+		rc = 0;
+	}
+
+	return rc == 0 ? -EAGAIN : rc;
+}
+
+/* net_context_recv callback of the asynchronous resolver */
+static void dns_resolver_recv(struct net_context *net_ctx,
+			      struct net_buf *buf, int status, void *user_data)
+{
+	struct dns_resolver *resolver = user_data;
+	struct dns_pending_query *pending;
+	struct dns_addrinfo info;
+	struct net_buf *answer;
+	dns_resolve_cb_t cb = NULL;
+	void *cb_data = NULL;
+	uint16_t data_len;
+	int rc = -EINVAL;
+
+	ARG_UNUSED(net_ctx);
+
+	if (status != 0 || !buf) {
+		return;
+	}
+
+	answer = net_buf_alloc(&dns_answer_pool, K_NO_WAIT);
+	if (!answer) {
+		goto exit_recv;
+	}
+
+	data_len = min(net_nbuf_appdatalen(buf), DNS_RESOLVER_MAX_BUF_SIZE);
+	if (data_len < DNS_MSG_HEADER_SIZE ||
+	    net_nbuf_linear_copy(answer, buf, net_buf_frags_len(buf) - data_len,
+				 data_len) != 0) {
+		goto exit_recv;
+	}
+
+	k_sem_take(&resolver->lock, K_FOREVER);
+
+	/* Answers that match no outstanding query are dropped */
+	pending = dns_pending_find(resolver,
+				   dns_unpack_header_id(answer->data));
+	if (pending) {
+		info.name = pending->name;
+		info.query_type = pending->query_type;
+
+		rc = dns_pending_answer(pending, answer->data, data_len, &info);
+		if (rc != -EAGAIN) {
+			cb = pending->cb;
+			cb_data = pending->user_data;
+
+			dns_pending_release(pending);
+		}
+	}
+
+	k_sem_give(&resolver->lock);
+
+	if (!cb) {
+		goto exit_recv;
+	}
+
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	if (rc == 0 || rc == -ENOENT) {
+		dns_cache_add(info.name, info.query_type,
+			      (uint8_t *)info.address.ipv4, info.items,
+			      info.ttl);
+	}
+#endif
+
+	cb(resolver, rc, &info, cb_data);
+
+exit_recv:
+	if (answer) {
+		net_buf_unref(answer);
+	}
+
+	net_nbuf_unref(buf);
+}
+
+int dns_resolver_init(struct dns_resolver *resolver)
+{
+	struct dns_pending_query *pending;
+	int i;
+
+	if (!resolver || !resolver->net_ctx || !resolver->dns_server) {
+		return -EINVAL;
+	}
+
+	k_sem_init(&resolver->lock, 1, 1);
+
+	for (i = 0; i < CONFIG_DNS_RESOLVER_MAX_QUERIES; i++) {
+		pending = &resolver->pending[i];
+
+		pending->resolver = resolver;
+		pending->query = NULL;
+		pending->cb = NULL;
+		pending->stale_timeout = false;
+		k_delayed_work_init(&pending->timer, dns_pending_timeout);
+	}
+
+	return net_context_recv(resolver->net_ctx, dns_resolver_recv,
+				K_NO_WAIT, resolver);
+}
+
+int dns_resolve_async(struct dns_resolver *resolver, const char *name,
+		      sa_family_t family, dns_resolve_cb_t cb,
+		      void *user_data)
+{
+	struct dns_pending_query *pending[2] = { NULL, NULL };
+	struct net_buf *query[2] = { NULL, NULL };
+	uint16_t query_types[2];
+	struct net_buf *qname;
+	int queries = 0;
+	int rc = 0;
+	int i;
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	struct dns_addrinfo cached[2];
+	int cached_items = 0;
+#endif
+
+	if (!resolver || !name || !cb) {
+		return -EINVAL;
+	}
+
+	if (family == AF_INET || family == AF_UNSPEC) {
+		query_types[queries++] = DNS_QUERY_TYPE_A;
+	}
+
+	if (family == AF_INET6 || family == AF_UNSPEC) {
+		query_types[queries++] = DNS_QUERY_TYPE_AAAA;
+	}
+
+	if (queries == 0) {
+		return -EINVAL;
+	}
+
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	/* The query types answered from the cache are not sent */
+	for (i = 0; i < queries; ) {
+		struct dns_addrinfo *info = &cached[cached_items];
+
+		info->name = name;
+		info->query_type = query_types[i];
+		info->items = 0;
+		info->ttl = 0;
+
+		if (dns_cache_lookup(name, query_types[i],
+				     (uint8_t *)info->address.ipv4,
+				     CONFIG_DNS_RESOLVER_MAX_ADDRESSES,
+				     &info->items, &info->ttl) == -EAGAIN) {
+			i++;
+			continue;
+		}
+
+		cached_items++;
+		query_types[i] = query_types[--queries];
+	}
+
+	if (queries == 0) {
+		goto exit_cached;
+	}
+#endif
+
+	qname = net_buf_alloc(&dns_qname_pool, resolver->timeout);
+	if (!qname) {
+		return -ENOMEM;
+	}
+
+	rc = dns_msg_pack_qname(&qname->len, qname->data, DNS_MAX_NAME_LEN,
+				name);
+	if (rc != 0) {
+		net_buf_unref(qname);
+		return -EINVAL;
+	}
+
+	k_sem_take(&resolver->lock, K_FOREVER);
+
+	/* Reserve and pack all the queries first, so either all or none are
+	 * sent. There is a query buffer for each entry, so the allocation
+	 * only fails while a released entry is still being sent.
+	 */
+	for (i = 0; i < queries; i++) {
+		pending[i] = dns_pending_get(resolver);
+		if (!pending[i]) {
+			rc = -EAGAIN;
+			break;
+		}
+
+		pending[i]->query = net_buf_alloc(&dns_query_pool, K_NO_WAIT);
+		if (!pending[i]->query) {
+			rc = -ENOMEM;
+			break;
+		}
+
+		pending[i]->name = name;
+		pending[i]->query_type = query_types[i];
+		pending[i]->user_data = user_data;
+		pending[i]->queries = 0;
+		pending[i]->resends = 0;
+		pending[i]->unsent = true;
+
+		rc = dns_pending_pack(pending[i], qname);
+		if (rc != 0) {
+			break;
+		}
+
+		/* From now on, answers are matched with this query */
+		pending[i]->cb = cb;
+		query[i] = net_buf_ref(pending[i]->query);
+	}
+
+	if (rc != 0) {
+		for (i = 0; i < queries; i++) {
+			if (pending[i] && pending[i]->query) {
+				dns_pending_release(pending[i]);
 			}
 
+			if (query[i]) {
+				net_buf_unref(query[i]);
+			}
 		}
 	}
 
-exit_ok:
-	rc = 0;
+	k_sem_give(&resolver->lock);
 
-exit_error:
-	net_nbuf_unref(ctx->rx_buf);
+	net_buf_unref(qname);
 
-	return rc;
+	if (rc != 0) {
+		return rc;
+	}
+
+	/* The queries are sent unlocked, as sending may wait for buffers
+	 * while the RX thread needs the lock to handle answers. The entries
+	 * hold a reference to their query buffer, so an entry still holding
+	 * query[i] has not been released in the meantime.
+	 */
+	for (i = 0; i < queries; i++) {
+		rc = dns_send(resolver->net_ctx, resolver->dns_server,
+			      resolver->timeout, query[i]);
+
+		k_sem_take(&resolver->lock, K_FOREVER);
+
+		if (rc != 0 && i == 0) {
+			break;
+		}
+
+		/* The entry has let go of the query if the answer came in
+		 * the meantime.
+		 */
+		if (pending[i]->query == query[i] && rc == 0) {
+			pending[i]->unsent = false;
+			pending[i]->queries++;
+			k_delayed_work_submit(&pending[i]->timer,
+					      resolver->timeout);
+		} else if (pending[i]->query == query[i]) {
+			/* The first query is out, so this one is sent again
+			 * by the timer instead of failing the resolution.
+			 */
+			k_delayed_work_submit(&pending[i]->timer,
+					      DNS_RESOLVER_RESEND_DELAY);
+		}
+
+		k_sem_give(&resolver->lock);
+
+		net_buf_unref(query[i]);
+		query[i] = NULL;
+	}
+
+	if (i < queries) {
+		/* Nothing has been sent */
+		for (i = 0; i < queries; i++) {
+			dns_pending_release(pending[i]);
+			net_buf_unref(query[i]);
+		}
+
+		k_sem_give(&resolver->lock);
+
+		return rc;
+	}
+
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+exit_cached:
+	for (i = 0; i < cached_items; i++) {
+		cb(resolver, cached[i].items > 0 ? 0 : -ENOENT, &cached[i],
+		   user_data);
+	}
+#endif
+
+	return 0;
 }
+#endif
@@ -15,8 +15,6 @@
 
 #define DNS_HEADER_ID_LEN	2
 #define DNS_HEADER_FLAGS_LEN	2
-#define DNS_QTYPE_LEN		2
-#define DNS_QCLASS_LEN		2
 #define DNS_QDCOUNT_LEN		2
 #define DNS_ANCOUNT_LEN		2
 #define DNS_NSCOUNT_LEN		2
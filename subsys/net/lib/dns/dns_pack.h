@@ -18,6 +18,10 @@
  */
 #define DNS_MSG_HEADER_SIZE	12
 
+/* See RFC 1035, 4.1.2 Question section format */
+#define DNS_QTYPE_LEN		2
+#define DNS_QCLASS_LEN		2
+
 /**
  * DNS message structure for DNS responses
  *
@@ -0,0 +1,926 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <zephyr.h>
+#include <atomic.h>
+#include <misc/util.h>
+#include <net/buf.h>
+#include <net/nbuf.h>
+#include <net/net_context.h>
+#include <net/http_server.h>
+
+/* Allocation timeout of the responses copied by http_server_send(), the
+ * other buffers are never waited for.
+ */
+#define TX_TIMEOUT		K_MSEC(100)
+
+/* How often the connections with output pending are retried when the
+ * network buffers run out.
+ */
+#define RETRY_PERIOD		K_MSEC(10)
+
+#define IDLE_TIMEOUT		(CONFIG_HTTP_SERVER_IDLE_TIMEOUT * MSEC_PER_SEC)
+
+#define HEADER_LINE_LEN		48
+
+/* Bits of http_server_conn.flags */
+enum {
+	/* The slot is taken, set by the accept callback */
+	CONN_USED,
+	/* The connection is set up, the server thread may serve it */
+	CONN_ACTIVE,
+	/* The client closed the connection or it failed, nothing more is
+	 * received on it.
+	 */
+	CONN_CLOSED,
+	/* The server has been stopped, the connection is closed by the
+	 * server thread without serving it any further.
+	 */
+	CONN_STOP,
+};
+
+/* Last header callback, tells where a new field starts */
+enum {
+	HEADER_NONE,
+	HEADER_FIELD,
+	HEADER_VALUE,
+};
+
+struct http_server_conn {
+	struct http_server *server;
+	struct net_context *net_ctx;
+	atomic_t flags;
+
+	/* Buffers received and not parsed yet */
+	struct k_fifo rx_queue;
+	/* Buffer being parsed, and where the parser is in it */
+	struct net_buf *rx;
+	struct net_nbuf_cursor cursor;
+
+	struct http_parser parser;
+	struct http_server_request req;
+
+	/* Response sent in place, header first */
+	const char *content_type;
+	const uint8_t *body;
+	size_t body_left;
+	size_t content_len;
+	uint16_t status;
+	bool header_pending;
+
+	/* The request has been answered, its response may still be
+	 * pending, the parser is paused until it has been sent.
+	 */
+	bool answered;
+	bool keep_alive;
+	/* Status of the error the request is answered with, if any */
+	uint16_t error;
+
+	uint32_t last_rx;
+
+	uint16_t url_len;
+	char url[CONFIG_HTTP_SERVER_URL_LEN];
+
+#if CONFIG_HTTP_SERVER_HEADERS_LEN > 0
+	uint8_t header_state;
+	uint16_t headers_len;
+	char headers[CONFIG_HTTP_SERVER_HEADERS_LEN];
+#endif
+};
+
+static struct http_server_conn conns[CONFIG_HTTP_SERVER_CONNECTIONS];
+
+static char __noinit __stack
+	http_server_stack[CONFIG_HTTP_SERVER_STACK_SIZE];
+static bool thread_started;
+
+/* Given whenever a connection has something for the server thread */
+static struct k_sem wake;
+
+static const char *status_reason(int status)
+{
+	switch (status) {
+	case 200:
+		return "OK";
+	case 201:
+		return "Created";
+	case 204:
+		return "No Content";
+	case 301:
+		return "Moved Permanently";
+	case 304:
+		return "Not Modified";
+	case 400:
+		return "Bad Request";
+	case 403:
+		return "Forbidden";
+	case 404:
+		return "Not Found";
+	case 405:
+		return "Method Not Allowed";
+	case 413:
+		return "Payload Too Large";
+	case 414:
+		return "URI Too Long";
+	case 500:
+		return "Internal Server Error";
+	case 503:
+		return "Service Unavailable";
+	default:
+		return "";
+	}
+}
+
+static bool append_str(struct net_buf *buf, const char *str, int32_t timeout)
+{
+	return net_nbuf_append(buf, strlen(str), (const uint8_t *)str,
+			       timeout);
+}
+
+/* Appends the status line and header fields of the response */
+static bool append_header(struct http_server_conn *conn, struct net_buf *buf,
+			  int32_t timeout)
+{
+	char line[HEADER_LINE_LEN];
+
+	snprintf(line, sizeof(line), "HTTP/1.1 %u %s\r\n",
+		 (unsigned int)conn->status, status_reason(conn->status));
+	if (!append_str(buf, line, timeout)) {
+		return false;
+	}
+
+	if (conn->content_type &&
+	    (!append_str(buf, "Content-Type: ", timeout) ||
+	     !append_str(buf, conn->content_type, timeout) ||
+	     !append_str(buf, "\r\n", timeout))) {
+		return false;
+	}
+
+	snprintf(line, sizeof(line), "Content-Length: %u\r\n",
+		 (unsigned int)conn->content_len);
+	if (!append_str(buf, line, timeout)) {
+		return false;
+	}
+
+	/* HTTP/1.0 connections are only persistent when asked for */
+	if (!conn->keep_alive) {
+		if (!append_str(buf, "Connection: close\r\n", timeout)) {
+			return false;
+		}
+	} else if (conn->parser.http_major == 1 &&
+		   conn->parser.http_minor == 0) {
+		if (!append_str(buf, "Connection: keep-alive\r\n", timeout)) {
+			return false;
+		}
+	}
+
+	return append_str(buf, "\r\n", timeout);
+}
+
+static int set_response(struct http_server_conn *conn, int status,
+			const char *content_type, const void *body,
+			size_t len)
+{
+	if (conn->answered) {
+		return -EALREADY;
+	}
+
+	conn->status = status;
+	conn->content_type = content_type;
+	conn->content_len = len;
+	conn->body = body;
+	conn->body_left = conn->req.method == HTTP_HEAD ? 0 : len;
+
+	return 0;
+}
+
+int http_server_send(struct http_server_conn *conn, int status,
+		     const char *content_type, const void *body, size_t len)
+{
+	bool header = true;
+	struct net_buf *buf;
+	size_t room;
+	int ret;
+
+	ret = set_response(conn, status, content_type, body, len);
+	if (ret < 0) {
+		return ret;
+	}
+
+	/* The previous responses have all been sent, so the segments can
+	 * be handed over to TCP right away.
+	 */
+	do {
+		buf = net_nbuf_get_tx(conn->net_ctx, TX_TIMEOUT);
+		if (!buf) {
+			goto nomem;
+		}
+
+		room = CONFIG_HTTP_SERVER_SEGMENT_SIZE;
+
+		if (header) {
+			if (!append_header(conn, buf, TX_TIMEOUT)) {
+				net_nbuf_unref(buf);
+				goto nomem;
+			}
+
+			room -= min(room, net_buf_frags_len(buf->frags));
+		}
+
+		len = min(room, conn->body_left);
+		if (len && !net_nbuf_append(buf, len, conn->body,
+					    TX_TIMEOUT)) {
+			net_nbuf_unref(buf);
+			goto nomem;
+		}
+
+		ret = net_context_send(buf, NULL, K_NO_WAIT, NULL, conn);
+		if (ret < 0) {
+			net_nbuf_unref(buf);
+			goto error;
+		}
+
+		header = false;
+		conn->body += len;
+		conn->body_left -= len;
+	} while (conn->body_left);
+
+	conn->answered = true;
+
+	return 0;
+
+nomem:
+	ret = -ENOMEM;
+
+error:
+	/* Once the header is sent, the response cannot be replaced by an
+	 * error and the client can only see it truncated.
+	 */
+	if (!header) {
+		conn->body_left = 0;
+		conn->answered = true;
+		conn->keep_alive = false;
+	}
+
+	return ret;
+}
+
+int http_server_send_static(struct http_server_conn *conn, int status,
+			    const char *content_type, const void *body,
+			    size_t len)
+{
+	int ret;
+
+	ret = set_response(conn, status, content_type, body, len);
+	if (ret < 0) {
+		return ret;
+	}
+
+	/* Sent by the server thread, see conn_flush() */
+	conn->header_pending = true;
+	conn->answered = true;
+
+	return 0;
+}
+
+static void send_error(struct http_server_conn *conn, int status)
+{
+	conn->answered = false;
+	http_server_send_static(conn, status, NULL, NULL, 0);
+}
+
+/* Sends the pending response, at most *budget segments of it. Returns 0
+ * once it has been sent, 1 if the rest has to wait, or a negative error.
+ */
+static int conn_flush(struct http_server_conn *conn, int *budget)
+{
+	struct net_buf *buf;
+	size_t room, len;
+	int ret;
+
+	while (conn->header_pending || conn->body_left) {
+		if (!*budget) {
+			return 1;
+		}
+
+		buf = net_nbuf_get_tx(conn->net_ctx, K_NO_WAIT);
+		if (!buf) {
+			return 1;
+		}
+
+		room = CONFIG_HTTP_SERVER_SEGMENT_SIZE;
+
+		if (conn->header_pending) {
+			if (!append_header(conn, buf, K_NO_WAIT)) {
+				net_nbuf_unref(buf);
+				return 1;
+			}
+
+			room -= min(room, net_buf_frags_len(buf->frags));
+		}
+
+		/* The body is appended straight from where it lives */
+		len = min(room, conn->body_left);
+		if (len && !net_nbuf_append(buf, len, conn->body, K_NO_WAIT)) {
+			net_nbuf_unref(buf);
+			return 1;
+		}
+
+		ret = net_context_send(buf, NULL, K_NO_WAIT, NULL, conn);
+		if (ret < 0) {
+			net_nbuf_unref(buf);
+			return ret;
+		}
+
+		conn->header_pending = false;
+		conn->body += len;
+		conn->body_left -= len;
+		(*budget)--;
+	}
+
+	return 0;
+}
+
+static void request_route(struct http_server_conn *conn)
+{
+	struct http_server_request *req = &conn->req;
+	const char *query;
+
+	if (req->url || conn->error) {
+		return;
+	}
+
+	if (conn->url_len > sizeof(conn->url)) {
+		conn->error = 414;
+		return;
+	}
+
+	req->url = conn->url;
+	req->url_len = conn->url_len;
+
+	query = memchr(conn->url, '?', conn->url_len);
+	if (query) {
+		req->url_len = query - conn->url;
+		req->query = query + 1;
+		req->query_len = conn->url_len - req->url_len - 1;
+	}
+
+	req->route = http_server_route_find(conn->server, req->url,
+					    req->url_len);
+}
+
+#if CONFIG_HTTP_SERVER_HEADERS_LEN > 0
+static void headers_append(struct http_server_conn *conn, uint8_t state,
+			   const char *at, size_t length)
+{
+	const struct http_server_route *route = conn->req.route;
+	const char *sep = NULL;
+	size_t len;
+
+	if (!route || !(route->flags & HTTP_SERVER_ROUTE_HEADERS)) {
+		return;
+	}
+
+	if (state != conn->header_state) {
+		if (state == HEADER_VALUE) {
+			sep = ": ";
+		} else if (conn->header_state == HEADER_VALUE) {
+			sep = "\r\n";
+		}
+
+		conn->header_state = state;
+	}
+
+	if (sep) {
+		headers_append(conn, state, sep, 2);
+	}
+
+	len = min(length, sizeof(conn->headers) - conn->headers_len);
+	if (len) {
+		memcpy(conn->headers + conn->headers_len, at, len);
+		conn->headers_len += len;
+	}
+}
+#else
+static inline void headers_append(struct http_server_conn *conn,
+				  uint8_t state, const char *at, size_t length)
+{
+}
+#endif
+
+static int on_message_begin(struct http_parser *parser)
+{
+	struct http_server_conn *conn = parser->data;
+
+	memset(&conn->req, 0, sizeof(conn->req));
+	conn->url_len = 0;
+	conn->error = 0;
+	conn->answered = false;
+
+#if CONFIG_HTTP_SERVER_HEADERS_LEN > 0
+	conn->header_state = HEADER_NONE;
+	conn->headers_len = 0;
+#endif
+
+	return 0;
+}
+
+/* The URL, header fields and body may come in several pieces when they
+ * span network buffers.
+ */
+static int on_url(struct http_parser *parser, const char *at, size_t length)
+{
+	struct http_server_conn *conn = parser->data;
+
+	if (conn->url_len + length > sizeof(conn->url)) {
+		/* Only remember that it does not fit */
+		conn->url_len = sizeof(conn->url) + 1;
+		return 0;
+	}
+
+	memcpy(conn->url + conn->url_len, at, length);
+	conn->url_len += length;
+
+	return 0;
+}
+
+static int on_header_field(struct http_parser *parser, const char *at,
+			   size_t length)
+{
+	struct http_server_conn *conn = parser->data;
+
+	/* The URL is complete once the header fields start */
+	request_route(conn);
+	headers_append(conn, HEADER_FIELD, at, length);
+
+	return 0;
+}
+
+static int on_header_value(struct http_parser *parser, const char *at,
+			   size_t length)
+{
+	struct http_server_conn *conn = parser->data;
+
+	headers_append(conn, HEADER_VALUE, at, length);
+
+	return 0;
+}
+
+static int on_headers_complete(struct http_parser *parser)
+{
+	struct http_server_conn *conn = parser->data;
+
+	request_route(conn);
+	headers_append(conn, HEADER_NONE, NULL, 0);
+
+	conn->req.method = parser->method;
+
+#if CONFIG_HTTP_SERVER_HEADERS_LEN > 0
+	conn->req.headers = conn->headers;
+	conn->req.headers_len = conn->headers_len;
+#endif
+
+	return 0;
+}
+
+static int on_body(struct http_parser *parser, const char *at, size_t length)
+{
+	struct http_server_conn *conn = parser->data;
+	const struct http_server_route *route = conn->req.route;
+	int ret;
+
+	if (conn->error || !route || !route->body) {
+		return 0;
+	}
+
+	ret = route->body(conn, &conn->req, at, length);
+	if (ret == -EFBIG) {
+		conn->error = 413;
+	} else if (ret < 0) {
+		conn->error = 400;
+	}
+
+	return 0;
+}
+
+static void request_dispatch(struct http_server_conn *conn)
+{
+	const struct http_server_route *route = conn->req.route;
+
+	if (conn->error) {
+		send_error(conn, conn->error);
+		return;
+	}
+
+	if (!route) {
+		send_error(conn, 404);
+		return;
+	}
+
+	if (!route->handler) {
+		http_server_send_static(conn, 200, route->content_type,
+					route->content, route->content_len);
+		return;
+	}
+
+	if (route->handler(conn, &conn->req) < 0 && !conn->answered) {
+		send_error(conn, 500);
+	} else if (!conn->answered) {
+		send_error(conn, 204);
+	}
+}
+
+static int on_message_complete(struct http_parser *parser)
+{
+	struct http_server_conn *conn = parser->data;
+
+	conn->keep_alive = http_should_keep_alive(parser);
+
+	request_dispatch(conn);
+
+	/* The next pipelined request waits for this response to be sent */
+	http_parser_pause(parser, 1);
+
+	return 0;
+}
+
+static const struct http_parser_settings parser_settings = {
+	.on_message_begin = on_message_begin,
+	.on_url = on_url,
+	.on_header_field = on_header_field,
+	.on_header_value = on_header_value,
+	.on_headers_complete = on_headers_complete,
+	.on_body = on_body,
+	.on_message_complete = on_message_complete,
+};
+
+/* Feeds the received data to the parser, in place, until a request has
+ * been answered. Returns true if one has, false if more data is needed.
+ */
+static bool conn_parse(struct http_server_conn *conn)
+{
+	enum http_errno err;
+	uint16_t len;
+	size_t parsed;
+	char *data;
+
+	for (;;) {
+		if (!conn->rx) {
+			conn->rx = net_buf_get(&conn->rx_queue, K_NO_WAIT);
+			if (!conn->rx) {
+				return false;
+			}
+
+			net_nbuf_cursor_init_appdata(&conn->cursor, conn->rx);
+			conn->last_rx = k_uptime_get_32();
+		}
+
+		data = (char *)net_nbuf_cursor_data(&conn->cursor, &len);
+		if (!len) {
+			net_nbuf_unref(conn->rx);
+			conn->rx = NULL;
+			continue;
+		}
+
+		parsed = http_parser_execute(&conn->parser, &parser_settings,
+					     data, len);
+		net_nbuf_cursor_skip(&conn->cursor, parsed);
+
+		err = HTTP_PARSER_ERRNO(&conn->parser);
+		if (err == HPE_PAUSED) {
+			return true;
+		}
+
+		if (err != HPE_OK) {
+			conn->keep_alive = false;
+			send_error(conn, 400);
+			return true;
+		}
+	}
+}
+
+static void conn_close(struct http_server_conn *conn)
+{
+	struct net_buf *buf;
+
+	if (conn->rx) {
+		net_nbuf_unref(conn->rx);
+		conn->rx = NULL;
+	}
+
+	while ((buf = net_buf_get(&conn->rx_queue, K_NO_WAIT))) {
+		net_nbuf_unref(buf);
+	}
+
+	net_context_put(conn->net_ctx);
+
+	/* The slot may be taken again from now on */
+	atomic_clear(&conn->flags);
+}
+
+/* Returns true if the connection has work left for the next round */
+static bool conn_service(struct http_server_conn *conn)
+{
+	int budget = CONFIG_HTTP_SERVER_TX_BURST;
+	bool closed;
+	int ret;
+
+	for (;;) {
+		ret = conn_flush(conn, &budget);
+		if (ret < 0) {
+			conn_close(conn);
+			return false;
+		}
+
+		if (ret) {
+			return true;
+		}
+
+		if (conn->answered) {
+			if (!conn->keep_alive) {
+				conn_close(conn);
+				return false;
+			}
+
+			conn->answered = false;
+			http_parser_pause(&conn->parser, 0);
+		}
+
+		/* The requests received before the client closed its side
+		 * of the connection are still answered.
+		 */
+		closed = atomic_test_bit(&conn->flags, CONN_CLOSED);
+
+		if (!conn_parse(conn)) {
+			if (closed) {
+				conn_close(conn);
+			}
+
+			return false;
+		}
+
+		if (!budget) {
+			return true;
+		}
+	}
+}
+
+static bool conn_idle(struct http_server_conn *conn)
+{
+	if (!IDLE_TIMEOUT || conn->rx || !k_fifo_is_empty(&conn->rx_queue)) {
+		return false;
+	}
+
+	return k_uptime_get_32() - conn->last_rx >= IDLE_TIMEOUT;
+}
+
+static void server_thread(void)
+{
+	int32_t timeout = K_FOREVER;
+	bool pending;
+	int i;
+
+	for (;;) {
+		k_sem_take(&wake, timeout);
+
+		timeout = K_FOREVER;
+
+		for (i = 0; i < ARRAY_SIZE(conns); i++) {
+			if (!atomic_test_bit(&conns[i].flags, CONN_ACTIVE)) {
+				continue;
+			}
+
+			if (atomic_test_bit(&conns[i].flags, CONN_STOP)) {
+				conn_close(&conns[i]);
+				continue;
+			}
+
+			pending = conn_service(&conns[i]);
+			if (pending) {
+				timeout = RETRY_PERIOD;
+				continue;
+			}
+
+			if (!atomic_test_bit(&conns[i].flags, CONN_ACTIVE)) {
+				continue;
+			}
+
+			if (conn_idle(&conns[i])) {
+				conn_close(&conns[i]);
+			} else if (IDLE_TIMEOUT && timeout == K_FOREVER) {
+				timeout = K_SECONDS(1);
+			}
+		}
+	}
+}
+
+static void recv_cb(struct net_context *net_ctx, struct net_buf *buf,
+		    int status, void *user_data)
+{
+	struct http_server_conn *conn = user_data;
+
+	if (buf && !status) {
+		net_buf_put(&conn->rx_queue, buf);
+	} else {
+		if (buf) {
+			net_nbuf_unref(buf);
+		}
+
+		atomic_set_bit(&conn->flags, CONN_CLOSED);
+	}
+
+	k_sem_give(&wake);
+}
+
+static void accept_cb(struct net_context *net_ctx, struct sockaddr *addr,
+		      socklen_t addrlen, int status, void *user_data)
+{
+	struct http_server *server = user_data;
+	struct http_server_conn *conn = NULL;
+	int i;
+
+	if (status) {
+		if (net_ctx != server->net_ctx) {
+			net_context_put(net_ctx);
+		}
+
+		return;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(conns); i++) {
+		if (!atomic_test_and_set_bit(&conns[i].flags, CONN_USED)) {
+			conn = &conns[i];
+			break;
+		}
+	}
+
+	if (!conn) {
+		net_context_put(net_ctx);
+		return;
+	}
+
+	conn->server = server;
+	conn->net_ctx = net_ctx;
+	conn->rx = NULL;
+	conn->answered = false;
+	conn->header_pending = false;
+	conn->body_left = 0;
+	conn->last_rx = k_uptime_get_32();
+	k_fifo_init(&conn->rx_queue);
+
+	http_parser_init(&conn->parser, HTTP_REQUEST);
+	conn->parser.data = conn;
+
+	atomic_set_bit(&conn->flags, CONN_ACTIVE);
+
+	if (net_context_recv(net_ctx, recv_cb, K_NO_WAIT, conn) < 0) {
+		atomic_set_bit(&conn->flags, CONN_CLOSED);
+	}
+
+	k_sem_give(&wake);
+}
+
+static bool route_match(const struct http_server_route *route,
+			const char *url, uint16_t url_len)
+{
+	if (url_len < route->url_len ||
+	    memcmp(url, route->url, route->url_len)) {
+		return false;
+	}
+
+	if (url_len == route->url_len) {
+		return true;
+	}
+
+	if (!(route->flags & HTTP_SERVER_ROUTE_PREFIX) || !route->url_len) {
+		return false;
+	}
+
+	/* route = /images, url = /images/ -> match
+	 * route = /images/, url = /images/img.png -> match
+	 * route = /images, url = /images_and_docs -> no match
+	 */
+	return route->url[route->url_len - 1] == '/' ||
+	       url[route->url_len] == '/';
+}
+
+const struct http_server_route *
+http_server_route_find(const struct http_server *server, const char *url,
+		       uint16_t url_len)
+{
+	const char *query;
+	size_t i;
+
+	query = memchr(url, '?', url_len);
+	if (query) {
+		url_len = query - url;
+	}
+
+	for (i = 0; i < server->routes_len; i++) {
+		if (route_match(&server->routes[i], url, url_len)) {
+			return &server->routes[i];
+		}
+	}
+
+	return NULL;
+}
+
+int http_server_init(struct http_server *server,
+		     const struct http_server_route *routes,
+		     size_t routes_len)
+{
+	if (!server || (!routes && routes_len)) {
+		return -EINVAL;
+	}
+
+	server->routes = routes;
+	server->routes_len = routes_len;
+	server->net_ctx = NULL;
+
+	return 0;
+}
+
+int http_server_start(struct http_server *server, const struct sockaddr *addr,
+		      socklen_t addrlen)
+{
+	struct net_context *net_ctx;
+	int ret;
+
+	if (server->net_ctx) {
+		return -EALREADY;
+	}
+
+	if (!thread_started) {
+		k_sem_init(&wake, 0, UINT_MAX);
+		k_thread_spawn(http_server_stack, sizeof(http_server_stack),
+			       (k_thread_entry_t)server_thread,
+			       NULL, NULL, NULL,
+			       K_PRIO_COOP(CONFIG_HTTP_SERVER_THREAD_PRIO),
+			       0, 0);
+		thread_started = true;
+	}
+
+	ret = net_context_get(addr->family, SOCK_STREAM, IPPROTO_TCP, &net_ctx);
+	if (ret < 0) {
+		return ret;
+	}
+
+	ret = net_context_bind(net_ctx, addr, addrlen);
+	if (ret < 0) {
+		goto error;
+	}
+
+	ret = net_context_listen(net_ctx, 0);
+	if (ret < 0) {
+		goto error;
+	}
+
+	server->net_ctx = net_ctx;
+
+	ret = net_context_accept(net_ctx, accept_cb, K_NO_WAIT, server);
+	if (ret < 0) {
+		server->net_ctx = NULL;
+		goto error;
+	}
+
+	return 0;
+
+error:
+	net_context_put(net_ctx);
+
+	return ret;
+}
+
+int http_server_stop(struct http_server *server)
+{
+	int i;
+
+	if (!server->net_ctx) {
+		return -EALREADY;
+	}
+
+	net_context_put(server->net_ctx);
+	server->net_ctx = NULL;
+
+	/* The connections belong to the server thread, which may be the
+	 * caller, so it closes them on its next round.
+	 */
+	for (i = 0; i < ARRAY_SIZE(conns); i++) {
+		if (atomic_test_bit(&conns[i].flags, CONN_ACTIVE) &&
+		    conns[i].server == server) {
+			atomic_set_bit(&conns[i].flags, CONN_STOP);
+		}
+	}
+
+	k_sem_give(&wake);
+
+	return 0;
+}
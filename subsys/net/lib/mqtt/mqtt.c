@@ -10,7 +10,9 @@
 #include <net/net_ip.h>
 #include <net/nbuf.h>
 #include <net/buf.h>
+#include <misc/byteorder.h>
 #include <errno.h>
+#include <string.h>
 
 #define MSG_SIZE	CONFIG_MQTT_MSG_MAX_SIZE
 #define MQTT_BUF_CTR	(1 + CONFIG_MQTT_ADDITIONAL_BUFFER_CTR)
@@ -23,6 +25,375 @@ NET_BUF_POOL_DEFINE(mqtt_msg_pool, MQTT_BUF_CTR, MSG_SIZE, 0, NULL);
 
 #define MQTT_PUBLISHER_MIN_MSG_SIZE	2
 
+/* Sizes of the received messages parsed from a copy of their first bytes */
+#define MQTT_CONNACK_SIZE		4
+#define MQTT_PKTID_MSG_SIZE		4
+#define MQTT_PINGRESP_SIZE		2
+#define MQTT_SUBACK_MAX_SIZE		(1 + 4 + 2 + \
+					 CONFIG_MQTT_SUBSCRIBE_MAX_TOPICS)
+
+#define MQTT_RLEN_MAX_SIZE		4
+
+#if defined(CONFIG_MQTT_INFLIGHT)
+#define INFLIGHT_WINDOW			CONFIG_MQTT_INFLIGHT_WINDOW
+#define INFLIGHT_TIMEOUT		CONFIG_MQTT_INFLIGHT_TIMEOUT
+
+/* Saved state of a message in flight: ack, packet id and length */
+#define INFLIGHT_STATE_HDR_SIZE		5
+
+/**
+ * Sends a copy of a packed MQTT message
+ *
+ * @param [in] ctx MQTT context
+ * @param [in] data Packed message
+ * @param [in] len Message length
+ * @param [in] timeout Time to wait for the tx buffers, in ms
+ *
+ * @retval 0 on success
+ * @retval -ENOMEM if a tx buffer is not available
+ * @retval -EIO on network error
+ */
+static
+int mqtt_tx_copy(struct mqtt_ctx *ctx, const uint8_t *data, uint16_t len,
+		 int32_t timeout)
+{
+	struct net_buf *tx;
+
+	tx = net_nbuf_get_tx(ctx->net_ctx, timeout);
+	if (tx == NULL) {
+		return -ENOMEM;
+	}
+
+	if (!net_nbuf_append(tx, len, data, timeout)) {
+		net_nbuf_unref(tx);
+		return -ENOMEM;
+	}
+
+	if (net_context_send(tx, NULL, timeout, NULL, NULL) < 0) {
+		net_nbuf_unref(tx);
+		return -EIO;
+	}
+
+	return 0;
+}
+
+/**
+ * Drops all the messages in flight
+ *
+ * @param ctx MQTT context
+ */
+static
+void mqtt_inflight_clear(struct mqtt_ctx *ctx)
+{
+	int i;
+
+	k_delayed_work_cancel(&ctx->inflight_timer);
+
+	k_sem_take(&ctx->inflight_lock, K_FOREVER);
+
+	for (i = 0; i < INFLIGHT_WINDOW; i++) {
+		if (ctx->inflight[i].ack != MQTT_INVALID) {
+			ctx->inflight[i].ack = MQTT_INVALID;
+			k_sem_give(&ctx->inflight_free);
+		}
+	}
+
+	k_sem_give(&ctx->inflight_lock);
+}
+
+/**
+ * Sends again the messages in flight
+ *
+ * @details PUBLISH messages are sent with the DUP flag set, and PUBREL
+ * messages are sent for the QoS 2 messages already received by the server.
+ * The messages are sent without waiting for tx buffers, as this runs on
+ * the system work queue and in the RX path. Transmission errors are not
+ * reported, the message is sent again by the retransmission timer.
+ *
+ * @param ctx MQTT context
+ * @param all Send all the messages, not only the ones whose timer expired
+ *
+ * @retval Time left until the next retransmission, in ms
+ * @retval 0 if there is no message in flight
+ */
+static
+int32_t mqtt_inflight_resend(struct mqtt_ctx *ctx, bool all)
+{
+	struct mqtt_inflight *entry;
+	uint8_t pubrel[MQTT_PKTID_MSG_SIZE];
+	uint16_t pubrel_len;
+	int32_t next = 0;
+	int32_t elapsed;
+	int i;
+
+	k_sem_take(&ctx->inflight_lock, K_FOREVER);
+
+	for (i = 0; i < INFLIGHT_WINDOW; i++) {
+		entry = &ctx->inflight[i];
+		if (entry->ack == MQTT_INVALID) {
+			continue;
+		}
+
+		elapsed = k_uptime_get_32() - entry->sent;
+
+		if (all || elapsed >= INFLIGHT_TIMEOUT) {
+			if (entry->len) {
+				/* DUP flag, see MQTT 3.3.1.1 */
+				entry->data[0] |= 0x08;
+				mqtt_tx_copy(ctx, entry->data, entry->len,
+					     K_NO_WAIT);
+			} else if (!mqtt_pack_pubrel(pubrel, &pubrel_len,
+						     sizeof(pubrel),
+						     entry->pkt_id)) {
+				mqtt_tx_copy(ctx, pubrel, pubrel_len,
+					     K_NO_WAIT);
+			}
+
+			entry->sent = k_uptime_get_32();
+			elapsed = 0;
+		}
+
+		if (!next || INFLIGHT_TIMEOUT - elapsed < next) {
+			next = INFLIGHT_TIMEOUT - elapsed;
+		}
+	}
+
+	k_sem_give(&ctx->inflight_lock);
+
+	return next;
+}
+
+static
+void mqtt_inflight_timeout(struct k_work *work)
+{
+	struct mqtt_ctx *ctx = CONTAINER_OF(work, struct mqtt_ctx,
+					    inflight_timer);
+	int32_t next;
+
+	/* The messages are sent again once the session is resumed */
+	if (!ctx->connected) {
+		return;
+	}
+
+	next = mqtt_inflight_resend(ctx, false);
+	if (next) {
+		k_delayed_work_submit(&ctx->inflight_timer, next);
+	}
+}
+
+/**
+ * Sends a QoS 1 or QoS 2 PUBLISH message and keeps it in flight
+ *
+ * @details The message is added to the in-flight table before it is sent,
+ * and the table is not locked while sending. A message that cannot be
+ * sent right away stays in flight and is sent by the retransmission timer.
+ *
+ * @param [in] ctx MQTT context
+ * @param [in] msg MQTT PUBLISH msg
+ *
+ * @retval 0 on success
+ * @retval -EAGAIN if the in-flight table is full
+ * @retval -EINVAL
+ * @retval -ENOMEM
+ */
+static
+int mqtt_inflight_publish(struct mqtt_ctx *ctx, struct mqtt_publish_msg *msg)
+{
+	struct mqtt_inflight *entry = NULL;
+	struct net_buf *data;
+	int rc = 0;
+	int i;
+
+	data = net_buf_alloc(&mqtt_msg_pool, ctx->net_timeout);
+	if (data == NULL) {
+		return -ENOMEM;
+	}
+
+	rc = mqtt_pack_publish(data->data, &data->len, data->size, msg);
+	if (rc != 0) {
+		rc = -EINVAL;
+		goto exit_publish;
+	}
+
+	if (k_sem_take(&ctx->inflight_free, ctx->net_timeout)) {
+		rc = -EAGAIN;
+		goto exit_publish;
+	}
+
+	k_sem_take(&ctx->inflight_lock, K_FOREVER);
+
+	for (i = 0; i < INFLIGHT_WINDOW; i++) {
+		if (ctx->inflight[i].ack == MQTT_INVALID) {
+			entry = &ctx->inflight[i];
+		} else if (ctx->inflight[i].pkt_id == msg->pkt_id) {
+			/* Packet Identifier already in use */
+			rc = -EINVAL;
+			break;
+		}
+	}
+
+	if (rc == 0) {
+		memcpy(entry->data, data->data, data->len);
+		entry->len = data->len;
+		entry->pkt_id = msg->pkt_id;
+		entry->ack = msg->qos == MQTT_QoS1 ? MQTT_PUBACK : MQTT_PUBREC;
+		entry->sent = k_uptime_get_32();
+
+		if (!k_delayed_work_remaining_get(&ctx->inflight_timer)) {
+			k_delayed_work_submit(&ctx->inflight_timer,
+					      INFLIGHT_TIMEOUT);
+		}
+	}
+
+	k_sem_give(&ctx->inflight_lock);
+
+	if (rc != 0) {
+		k_sem_give(&ctx->inflight_free);
+		goto exit_publish;
+	}
+
+	mqtt_tx_copy(ctx, data->data, data->len, ctx->net_timeout);
+
+exit_publish:
+	net_nbuf_unref(data);
+
+	return rc;
+}
+
+/**
+ * Updates the message in flight acknowledged by a PUBxxxx message
+ *
+ * @param ctx MQTT context
+ * @param pkt_id Packet Identifier
+ * @param type MQTT_PUBACK, MQTT_PUBREC or MQTT_PUBCOMP
+ */
+static
+void mqtt_inflight_ack(struct mqtt_ctx *ctx, uint16_t pkt_id,
+		       enum mqtt_packet type)
+{
+	struct mqtt_inflight *entry;
+	int i;
+
+	k_sem_take(&ctx->inflight_lock, K_FOREVER);
+
+	for (i = 0; i < INFLIGHT_WINDOW; i++) {
+		entry = &ctx->inflight[i];
+		if (entry->ack != type || entry->pkt_id != pkt_id) {
+			continue;
+		}
+
+		if (type == MQTT_PUBREC) {
+			/* PUBREL is sent until PUBCOMP is received */
+			entry->ack = MQTT_PUBCOMP;
+			entry->len = 0;
+			entry->sent = k_uptime_get_32();
+		} else {
+			entry->ack = MQTT_INVALID;
+			k_sem_give(&ctx->inflight_free);
+		}
+
+		break;
+	}
+
+	k_sem_give(&ctx->inflight_lock);
+}
+
+int mqtt_session_save(struct mqtt_ctx *ctx, uint8_t *buf, uint16_t size)
+{
+	struct mqtt_inflight *entry;
+	uint16_t len = 0;
+	int rc = 0;
+	int i;
+
+	k_sem_take(&ctx->inflight_lock, K_FOREVER);
+
+	for (i = 0; i < INFLIGHT_WINDOW; i++) {
+		entry = &ctx->inflight[i];
+		if (entry->ack == MQTT_INVALID) {
+			continue;
+		}
+
+		if (INFLIGHT_STATE_HDR_SIZE + entry->len > size - len) {
+			rc = -ENOMEM;
+			break;
+		}
+
+		buf[len] = entry->ack;
+		sys_put_be16(entry->pkt_id, buf + len + 1);
+		sys_put_be16(entry->len, buf + len + 3);
+		len += INFLIGHT_STATE_HDR_SIZE;
+
+		memcpy(buf + len, entry->data, entry->len);
+		len += entry->len;
+	}
+
+	k_sem_give(&ctx->inflight_lock);
+
+	return rc ? rc : len;
+}
+
+int mqtt_session_load(struct mqtt_ctx *ctx, const uint8_t *buf, uint16_t len)
+{
+	struct mqtt_inflight *entry;
+	uint16_t data_len;
+	uint16_t pos = 0;
+	uint8_t ack;
+	int rc = 0;
+	int i;
+
+	k_sem_take(&ctx->inflight_lock, K_FOREVER);
+
+	while (pos < len) {
+		if (len - pos < INFLIGHT_STATE_HDR_SIZE) {
+			rc = -EINVAL;
+			break;
+		}
+
+		ack = buf[pos];
+		data_len = sys_get_be16(buf + pos + 3);
+
+		/* A message is kept until PUBREC is received */
+		if ((ack != MQTT_PUBACK && ack != MQTT_PUBREC &&
+		     ack != MQTT_PUBCOMP) ||
+		    (ack == MQTT_PUBCOMP) != (data_len == 0) ||
+		    data_len > MSG_SIZE ||
+		    data_len > len - pos - INFLIGHT_STATE_HDR_SIZE) {
+			rc = -EINVAL;
+			break;
+		}
+
+		if (k_sem_take(&ctx->inflight_free, K_NO_WAIT)) {
+			rc = -ENOMEM;
+			break;
+		}
+
+		for (i = 0; i < INFLIGHT_WINDOW; i++) {
+			entry = &ctx->inflight[i];
+			if (entry->ack == MQTT_INVALID) {
+				break;
+			}
+		}
+
+		entry->ack = ack;
+		entry->pkt_id = sys_get_be16(buf + pos + 1);
+		entry->len = data_len;
+		entry->sent = k_uptime_get_32();
+		pos += INFLIGHT_STATE_HDR_SIZE;
+
+		memcpy(entry->data, buf + pos, data_len);
+		pos += data_len;
+	}
+
+	k_sem_give(&ctx->inflight_lock);
+
+	if (rc != 0) {
+		mqtt_inflight_clear(ctx);
+	}
+
+	return rc;
+}
+#endif
+
 int mqtt_tx_connect(struct mqtt_ctx *ctx, struct mqtt_connect_msg *msg)
 {
 	struct net_buf *data = NULL;
@@ -37,6 +408,12 @@ int mqtt_tx_connect(struct mqtt_ctx *ctx, struct mqtt_connect_msg *msg)
 
 	ctx->clean_session = msg->clean_session ? 1 : 0;
 
+#if defined(CONFIG_MQTT_INFLIGHT)
+	if (ctx->clean_session) {
+		mqtt_inflight_clear(ctx);
+	}
+#endif
+
 	rc = mqtt_pack_connect(data->data, &data->len, MSG_SIZE, msg);
 	if (rc != 0) {
 		rc = -EINVAL;
@@ -102,6 +479,11 @@ int mqtt_tx_disconnect(struct mqtt_ctx *ctx)
 	ctx->connected = 0;
 	tx = NULL;
 
+#if defined(CONFIG_MQTT_INFLIGHT)
+	/* The messages in flight are kept for the next session */
+	k_delayed_work_cancel(&ctx->inflight_timer);
+#endif
+
 	if (ctx->disconnect) {
 		ctx->disconnect(ctx);
 	}
@@ -206,6 +588,12 @@ int mqtt_tx_publish(struct mqtt_ctx *ctx, struct mqtt_publish_msg *msg)
 	struct net_buf *tx = NULL;
 	int rc;
 
+#if defined(CONFIG_MQTT_INFLIGHT)
+	if (msg->qos == MQTT_QoS1 || msg->qos == MQTT_QoS2) {
+		return mqtt_inflight_publish(ctx, msg);
+	}
+#endif
+
 	data = net_buf_alloc(&mqtt_msg_pool, ctx->net_timeout);
 	if (data == NULL) {
 		rc = -ENOMEM;
@@ -370,16 +758,44 @@ exit_unsub:
 	return rc;
 }
 
-int mqtt_rx_connack(struct mqtt_ctx *ctx, struct net_buf *rx, int clean_session)
+/**
+ * Copies the first bytes of a received MQTT message
+ *
+ * @details Short messages are unpacked from a copy of their first bytes, so
+ * they are never linearized.
+ *
+ * @param [in] msg Cursor over the message, it is not moved
+ * @param [out] data Buffer where the bytes are copied
+ * @param [in] size Buffer size
+ *
+ * @retval Number of bytes copied
+ */
+static
+uint16_t mqtt_rx_head(struct net_nbuf_cursor *msg, uint8_t *data,
+		      uint16_t size)
+{
+	uint16_t len;
+
+	len = min(size, net_nbuf_cursor_left(msg));
+	net_nbuf_cursor_peek(msg, data, len);
+
+	return len;
+}
+
+static
+int mqtt_parse_connack(struct mqtt_ctx *ctx, struct net_nbuf_cursor *msg,
+		       int clean_session)
 {
+	uint8_t data[MQTT_CONNACK_SIZE];
 	uint16_t len;
 	uint8_t connect_rc;
 	uint8_t session;
-	uint8_t *data;
+#if defined(CONFIG_MQTT_INFLIGHT)
+	int32_t next;
+#endif
 	int rc;
 
-	data = rx->data;
-	len = rx->len;
+	len = mqtt_rx_head(msg, data, sizeof(data));
 
 	/* CONNACK is 4 bytes len */
 	rc = mqtt_unpack_connack(data, len, &session, &connect_rc);
@@ -403,8 +819,21 @@ int mqtt_rx_connack(struct mqtt_ctx *ctx, struct net_buf *rx, int clean_session)
 		break;
 	/* previous session */
 	case 0:
-		/* TODO */
-		/* FALLTHROUGH */
+		if (connect_rc != 0) {
+			rc = -EINVAL;
+			goto exit_connect;
+		}
+
+#if defined(CONFIG_MQTT_INFLIGHT)
+		/* The server has no state for this session, so the client
+		 * state is discarded. See MQTT 3.2.2.2 Session Present
+		 */
+		if (session == 0) {
+			mqtt_inflight_clear(ctx);
+		}
+#endif
+		rc = 0;
+		break;
 	default:
 		rc = -EINVAL;
 		goto exit_connect;
@@ -416,10 +845,29 @@ int mqtt_rx_connack(struct mqtt_ctx *ctx, struct net_buf *rx, int clean_session)
 		ctx->connect(ctx);
 	}
 
+#if defined(CONFIG_MQTT_INFLIGHT)
+	/* The messages in flight are sent again when a session is resumed,
+	 * see MQTT 4.4 Message delivery retry
+	 */
+	next = mqtt_inflight_resend(ctx, true);
+	if (next) {
+		k_delayed_work_submit(&ctx->inflight_timer, next);
+	}
+#endif
+
 exit_connect:
 	return rc;
 }
 
+int mqtt_rx_connack(struct mqtt_ctx *ctx, struct net_buf *rx, int clean_session)
+{
+	struct net_nbuf_cursor msg;
+
+	net_nbuf_cursor_init_appdata(&msg, rx);
+
+	return mqtt_parse_connack(ctx, &msg, clean_session);
+}
+
 /**
  * Parses and validates the MQTT PUBxxxx message contained in the rx buffer.
  *
@@ -429,21 +877,21 @@ exit_connect:
  * corresponding MQTT PUB msg.
  *
  * @param ctx MQTT context
- * @param rx RX buffer
+ * @param msg Cursor over the message
  * @param type MQTT Packet type
  *
  * @retval 0 on success
  * @retval -EINVAL on error
  */
 static
-int mqtt_rx_pub_msgs(struct mqtt_ctx *ctx, struct net_buf *rx,
+int mqtt_rx_pub_msgs(struct mqtt_ctx *ctx, struct net_nbuf_cursor *msg,
 		     enum mqtt_packet type)
 {
 	int (*unpack)(uint8_t *, uint16_t, uint16_t *) = NULL;
 	int (*response)(struct mqtt_ctx *, uint16_t) = NULL;
+	uint8_t data[MQTT_PKTID_MSG_SIZE];
 	uint16_t pkt_id;
 	uint16_t len;
-	uint8_t *data;
 	int rc;
 
 	switch (type) {
@@ -465,8 +913,7 @@ int mqtt_rx_pub_msgs(struct mqtt_ctx *ctx, struct net_buf *rx,
 		return -EINVAL;
 	}
 
-	data = rx->data;
-	len = rx->len;
+	len = mqtt_rx_head(msg, data, sizeof(data));
 
 	/* 4 bytes message */
 	rc = unpack(data, len, &pkt_id);
@@ -474,6 +921,12 @@ int mqtt_rx_pub_msgs(struct mqtt_ctx *ctx, struct net_buf *rx,
 		return -EINVAL;
 	}
 
+#if defined(CONFIG_MQTT_INFLIGHT)
+	if (type != MQTT_PUBREL) {
+		mqtt_inflight_ack(ctx, pkt_id, type);
+	}
+#endif
+
 	/* Only MQTT_APP_SUBSCRIBER, MQTT_APP_PUBLISHER_SUBSCRIBER and
 	 * MQTT_APP_SERVER apps must receive the MQTT_PUBREL msg.
 	 */
@@ -505,32 +958,53 @@ int mqtt_rx_pub_msgs(struct mqtt_ctx *ctx, struct net_buf *rx,
 
 int mqtt_rx_puback(struct mqtt_ctx *ctx, struct net_buf *rx)
 {
-	return mqtt_rx_pub_msgs(ctx, rx, MQTT_PUBACK);
+	struct net_nbuf_cursor msg;
+
+	net_nbuf_cursor_init_appdata(&msg, rx);
+
+	return mqtt_rx_pub_msgs(ctx, &msg, MQTT_PUBACK);
 }
 
 int mqtt_rx_pubcomp(struct mqtt_ctx *ctx, struct net_buf *rx)
 {
-	return mqtt_rx_pub_msgs(ctx, rx, MQTT_PUBCOMP);
+	struct net_nbuf_cursor msg;
+
+	net_nbuf_cursor_init_appdata(&msg, rx);
+
+	return mqtt_rx_pub_msgs(ctx, &msg, MQTT_PUBCOMP);
 }
 
 int mqtt_rx_pubrec(struct mqtt_ctx *ctx, struct net_buf *rx)
 {
-	return mqtt_rx_pub_msgs(ctx, rx, MQTT_PUBREC);
+	struct net_nbuf_cursor msg;
+
+	net_nbuf_cursor_init_appdata(&msg, rx);
+
+	return mqtt_rx_pub_msgs(ctx, &msg, MQTT_PUBREC);
 }
 
 int mqtt_rx_pubrel(struct mqtt_ctx *ctx, struct net_buf *rx)
 {
-	return mqtt_rx_pub_msgs(ctx, rx, MQTT_PUBREL);
+	struct net_nbuf_cursor msg;
+
+	net_nbuf_cursor_init_appdata(&msg, rx);
+
+	return mqtt_rx_pub_msgs(ctx, &msg, MQTT_PUBREL);
 }
 
-int mqtt_rx_pingresp(struct mqtt_ctx *ctx, struct net_buf *rx)
+static
+int mqtt_parse_pingresp(struct mqtt_ctx *ctx, struct net_nbuf_cursor *msg)
 {
+	uint8_t data[MQTT_PINGRESP_SIZE];
+	uint16_t len;
 	int rc;
 
 	ARG_UNUSED(ctx);
 
+	len = mqtt_rx_head(msg, data, sizeof(data));
+
 	/* 2 bytes message */
-	rc = mqtt_unpack_pingresp(rx->data, rx->len);
+	rc = mqtt_unpack_pingresp(data, len);
 
 	if (rc != 0) {
 		return -EINVAL;
@@ -539,17 +1013,26 @@ int mqtt_rx_pingresp(struct mqtt_ctx *ctx, struct net_buf *rx)
 	return 0;
 }
 
-int mqtt_rx_suback(struct mqtt_ctx *ctx, struct net_buf *rx)
+int mqtt_rx_pingresp(struct mqtt_ctx *ctx, struct net_buf *rx)
+{
+	struct net_nbuf_cursor msg;
+
+	net_nbuf_cursor_init_appdata(&msg, rx);
+
+	return mqtt_parse_pingresp(ctx, &msg);
+}
+
+static
+int mqtt_parse_suback(struct mqtt_ctx *ctx, struct net_nbuf_cursor *msg)
 {
 	enum mqtt_qos suback_qos[CONFIG_MQTT_SUBSCRIBE_MAX_TOPICS];
+	uint8_t data[MQTT_SUBACK_MAX_SIZE];
 	uint16_t pkt_id;
 	uint16_t len;
 	uint8_t items;
-	uint8_t *data;
 	int rc;
 
-	data = rx->data;
-	len = rx->len;
+	len = mqtt_rx_head(msg, data, sizeof(data));
 
 	rc = mqtt_unpack_suback(data, len, &pkt_id, &items,
 				CONFIG_MQTT_SUBSCRIBE_MAX_TOPICS, suback_qos);
@@ -569,15 +1052,24 @@ int mqtt_rx_suback(struct mqtt_ctx *ctx, struct net_buf *rx)
 	return 0;
 }
 
-int mqtt_rx_unsuback(struct mqtt_ctx *ctx, struct net_buf *rx)
+int mqtt_rx_suback(struct mqtt_ctx *ctx, struct net_buf *rx)
 {
+	struct net_nbuf_cursor msg;
+
+	net_nbuf_cursor_init_appdata(&msg, rx);
+
+	return mqtt_parse_suback(ctx, &msg);
+}
+
+static
+int mqtt_parse_unsuback(struct mqtt_ctx *ctx, struct net_nbuf_cursor *msg)
+{
+	uint8_t data[MQTT_PKTID_MSG_SIZE];
 	uint16_t pkt_id;
 	uint16_t len;
-	uint8_t *data;
 	int rc;
 
-	data = rx->data;
-	len = rx->len;
+	len = mqtt_rx_head(msg, data, sizeof(data));
 
 	/* 4 bytes message */
 	rc = mqtt_unpack_unsuback(data, len, &pkt_id);
@@ -597,19 +1089,178 @@ int mqtt_rx_unsuback(struct mqtt_ctx *ctx, struct net_buf *rx)
 	return 0;
 }
 
-int mqtt_rx_publish(struct mqtt_ctx *ctx, struct net_buf *rx)
+int mqtt_rx_unsuback(struct mqtt_ctx *ctx, struct net_buf *rx)
+{
+	struct net_nbuf_cursor msg;
+
+	net_nbuf_cursor_init_appdata(&msg, rx);
+
+	return mqtt_parse_unsuback(ctx, &msg);
+}
+
+/**
+ * Gets a pointer to data lying in a single fragment
+ *
+ * @param [in] cur Cursor, moved past the data on success
+ * @param [in] len Data length
+ * @param [out] ptr Pointer to the data
+ *
+ * @retval true if the data is contiguous
+ * @retval false otherwise, the cursor is not moved
+ */
+static
+bool mqtt_rx_in_place(struct net_nbuf_cursor *cur, uint16_t len, uint8_t **ptr)
+{
+	uint16_t avail;
+
+	*ptr = net_nbuf_cursor_data(cur, &avail);
+	if (avail < len) {
+		return false;
+	}
+
+	net_nbuf_cursor_skip(cur, len);
+
+	return true;
+}
+
+/**
+ * Decodes the Remaining Length field. See MQTT 2.2.3 Remaining Length
+ *
+ * @param [in] cur Cursor, moved past the field
+ * @param [out] rlen Remaining Length
+ *
+ * @retval 0 on success
+ * @retval -EAGAIN if the field is not complete
+ * @retval -EINVAL
+ */
+static
+int mqtt_rx_rlen(struct net_nbuf_cursor *cur, uint32_t *rlen)
+{
+	uint32_t mult = 1;
+	uint8_t encoded;
+	int i;
+
+	*rlen = 0;
+
+	for (i = 0; i < MQTT_RLEN_MAX_SIZE; i++) {
+		if (net_nbuf_cursor_read_u8(cur, &encoded)) {
+			return -EAGAIN;
+		}
+
+		*rlen += (encoded & 127) * mult;
+		mult *= 128;
+
+		if (!(encoded & 128)) {
+			return 0;
+		}
+	}
+
+	return -EINVAL;
+}
+
+/**
+ * Parses the variable header and payload of a MQTT PUBLISH message
+ *
+ * @param [in] cur Cursor over the message, after the fixed header
+ * @param [out] msg Topic, packet identifier and payload
+ *
+ * @retval 0 on success
+ * @retval -EAGAIN if the topic or the payload spans several fragments
+ * @retval -EINVAL
+ */
+static
+int mqtt_rx_publish_body(struct net_nbuf_cursor *cur,
+			 struct mqtt_publish_msg *msg)
+{
+	if (net_nbuf_cursor_read_be16(cur, &msg->topic_len)) {
+		return -EINVAL;
+	}
+
+	if (msg->topic_len > net_nbuf_cursor_left(cur)) {
+		return -EINVAL;
+	}
+
+	if (!mqtt_rx_in_place(cur, msg->topic_len, (uint8_t **)&msg->topic)) {
+		return -EAGAIN;
+	}
+
+	msg->pkt_id = 0;
+	if (msg->qos == MQTT_QoS1 || msg->qos == MQTT_QoS2) {
+		if (net_nbuf_cursor_read_be16(cur, &msg->pkt_id)) {
+			return -EINVAL;
+		}
+	}
+
+	msg->msg_len = net_nbuf_cursor_left(cur);
+	if (!mqtt_rx_in_place(cur, msg->msg_len, &msg->msg)) {
+		return -EAGAIN;
+	}
+
+	return 0;
+}
+
+static
+int mqtt_parse_publish(struct mqtt_ctx *ctx, struct net_nbuf_cursor *rx)
 {
 	struct mqtt_publish_msg msg;
+	struct net_nbuf_cursor body;
+	struct net_nbuf_cursor cur = *rx;
+	struct net_buf *data = NULL;
+	uint8_t header;
+	uint32_t rlen;
+	uint16_t len;
 	int rc;
 
-	rc = mqtt_unpack_publish(rx->data, rx->len, &msg);
-	if (rc != 0) {
+	if (net_nbuf_cursor_read_u8(&cur, &header) ||
+	    header >> 4 != MQTT_PUBLISH) {
+		return -EINVAL;
+	}
+
+	msg.dup = (header & 0x08) >> 3;
+	msg.qos = (header & 0x06) >> 1;
+	msg.retain = header & 0x01;
+
+	rc = mqtt_rx_rlen(&cur, &rlen);
+	if (rc != 0 || rlen > net_nbuf_cursor_left(&cur)) {
 		return -EINVAL;
 	}
 
+	/* Do not parse past the end of this message */
+	cur.left = rlen;
+	body = cur;
+
+	/* The topic and the payload are handed to the application in place
+	 * when each one lies in a single fragment. Otherwise the message body
+	 * is copied to a linear buffer.
+	 */
+	rc = mqtt_rx_publish_body(&cur, &msg);
+	if (rc == -EAGAIN) {
+		data = net_buf_alloc(&mqtt_msg_pool, ctx->net_timeout);
+		if (data == NULL) {
+			return -ENOMEM;
+		}
+
+		len = net_nbuf_cursor_left(&body);
+		if (len > net_buf_tailroom(data)) {
+			rc = -ENOMEM;
+			goto exit_publish;
+		}
+
+		net_nbuf_cursor_read(&body, net_buf_add(data, len), len);
+		net_nbuf_cursor_init(&cur, data, 0, len);
+
+		rc = mqtt_rx_publish_body(&cur, &msg);
+	}
+
+	if (rc != 0) {
+		rc = -EINVAL;
+		goto exit_publish;
+	}
+
 	rc = ctx->publish_rx(ctx, &msg, msg.pkt_id, MQTT_PUBLISH);
 	if (rc != 0) {
-		return -EINVAL;
+		rc = -EINVAL;
+		goto exit_publish;
 	}
 
 	switch (msg.qos) {
@@ -625,106 +1276,93 @@ int mqtt_rx_publish(struct mqtt_ctx *ctx, struct net_buf *rx)
 		rc = -EINVAL;
 	}
 
+exit_publish:
+	if (data) {
+		net_buf_unref(data);
+	}
+
 	return rc;
 }
 
+int mqtt_rx_publish(struct mqtt_ctx *ctx, struct net_buf *rx)
+{
+	struct net_nbuf_cursor msg;
+
+	net_nbuf_cursor_init_appdata(&msg, rx);
+
+	return mqtt_parse_publish(ctx, &msg);
+}
+
 /**
- * Linearizes an IP fragmented buffer
+ * Gets the type of a received MQTT message
  *
- * @param [in] ctx MQTT context structure
- * @param [in] rx RX IP stack buffer
- * @param [in] min_size Min message size allowed. This allows us to exit if the
- * rx buffer is shorter than the expected msg size
+ * @param [in] msg Cursor over the message, it is not moved
+ * @param [in] min_size Min message size allowed
+ * @param [out] pkt_type MQTT Control Packet type
  *
- * @retval Data buffer
- * @retval NULL on error
+ * @retval 0 on success
+ * @retval -EINVAL
  */
 static
-struct net_buf *mqtt_linearize_buffer(struct mqtt_ctx *ctx, struct net_buf *rx,
-				      uint16_t min_size)
+int mqtt_rx_type(struct net_nbuf_cursor *msg, uint16_t min_size,
+		 uint16_t *pkt_type)
 {
-	struct net_buf *data = NULL;
-	uint16_t data_len;
-	uint16_t offset;
-	int rc;
-
-	/* CONFIG_MQTT_MSG_MAX_SIZE is defined via Kconfig. So here it's
-	 * determined if the input buffer could fit our data buffer or if
-	 * it has the expected size.
-	 */
-	data_len = net_nbuf_appdatalen(rx);
-	if (data_len < min_size || data_len > CONFIG_MQTT_MSG_MAX_SIZE) {
-		return NULL;
-	}
-
-	data = net_buf_alloc(&mqtt_msg_pool, ctx->net_timeout);
-	if (data == NULL) {
-		return NULL;
-	}
+	uint8_t header;
 
-	offset = net_buf_frags_len(rx) - data_len;
-	rc = net_nbuf_linear_copy(data, rx, offset, data_len);
-	if (rc != 0) {
-		goto exit_error;
+	if (net_nbuf_cursor_left(msg) < min_size ||
+	    net_nbuf_cursor_peek(msg, &header, sizeof(header))) {
+		return -EINVAL;
 	}
 
-	return data;
-
-exit_error:
-	net_nbuf_unref(data);
+	*pkt_type = MQTT_PACKET_TYPE(header);
 
-	return NULL;
+	return 0;
 }
 
 /**
- * Calls the appropriate rx routine for the MQTT message contained in rx
+ * Calls the appropriate rx routine for the MQTT message under the cursor
  *
  * @details On error, this routine will execute the 'ctx->malformed' callback
  * (if defined)
  *
  * @param ctx MQTT context
- * @param rx RX buffer
+ * @param rx Cursor over a single message
  *
  * @retval 0 on success
  * @retval -EINVAL if an unknown message is received
- * @retval -ENOMEM if no data buffer is available
  * @retval mqtt_rx_connack, mqtt_rx_puback, mqtt_rx_pubrec, mqtt_rx_pubcomp
  *         and mqtt_rx_pingresp return codes
  */
 static
-int mqtt_publisher_parser(struct mqtt_ctx *ctx, struct net_buf *rx)
+int mqtt_publisher_parser(struct mqtt_ctx *ctx, struct net_nbuf_cursor *rx)
 {
 	uint16_t pkt_type = MQTT_INVALID;
-	struct net_buf *data = NULL;
-	int rc = -EINVAL;
+	int rc;
 
-	data = mqtt_linearize_buffer(ctx, rx, MQTT_PUBLISHER_MIN_MSG_SIZE);
-	if (!data) {
-		rc = -ENOMEM;
+	rc = mqtt_rx_type(rx, MQTT_PUBLISHER_MIN_MSG_SIZE, &pkt_type);
+	if (rc != 0) {
 		goto exit_parser;
 	}
 
-	pkt_type = MQTT_PACKET_TYPE(data->data[0]);
-
 	switch (pkt_type) {
 	case MQTT_CONNACK:
 		if (!ctx->connected) {
-			rc = mqtt_rx_connack(ctx, data, ctx->clean_session);
+			rc = mqtt_parse_connack(ctx, rx, ctx->clean_session);
 		} else {
 			rc = -EINVAL;
 		}
 		break;
 	case MQTT_PUBACK:
-		rc = mqtt_rx_puback(ctx, data);
+		rc = mqtt_rx_pub_msgs(ctx, rx, MQTT_PUBACK);
 		break;
 	case MQTT_PUBREC:
-		rc = mqtt_rx_pubrec(ctx, data);
+		rc = mqtt_rx_pub_msgs(ctx, rx, MQTT_PUBREC);
 		break;
 	case MQTT_PUBCOMP:
-		rc = mqtt_rx_pubcomp(ctx, data);
+		rc = mqtt_rx_pub_msgs(ctx, rx, MQTT_PUBCOMP);
 		break;
 	case MQTT_PINGRESP:
-		rc = mqtt_rx_pingresp(ctx, data);
+		rc = mqtt_parse_pingresp(ctx, rx);
 		break;
 	default:
 		rc = -EINVAL;
@@ -736,62 +1374,55 @@ exit_parser:
 		ctx->malformed(ctx, pkt_type);
 	}
 
-	net_nbuf_unref(data);
-
 	return rc;
 }
 
 
 /**
- * Calls the appropriate rx routine for the MQTT message contained in rx
+ * Calls the appropriate rx routine for the MQTT message under the cursor
  *
  * @details On error, this routine will execute the 'ctx->malformed' callback
  * (if defined)
  *
  * @param ctx MQTT context
- * @param rx RX buffer
+ * @param rx Cursor over a single message
  *
  * @retval 0 on success
  * @retval -EINVAL if an unknown message is received
- * @retval -ENOMEM if no data buffer is available
  * @retval mqtt_rx_publish, mqtt_rx_pubrel, mqtt_rx_pubrel and mqtt_rx_suback
  *         return codes
  */
 static
-int mqtt_subscriber_parser(struct mqtt_ctx *ctx, struct net_buf *rx)
+int mqtt_subscriber_parser(struct mqtt_ctx *ctx, struct net_nbuf_cursor *rx)
 {
 	uint16_t pkt_type = MQTT_INVALID;
-	struct net_buf *data = NULL;
-	int rc = 0;
+	int rc;
 
-	data = mqtt_linearize_buffer(ctx, rx, MQTT_PUBLISHER_MIN_MSG_SIZE);
-	if (!data) {
-		rc = -EINVAL;
+	rc = mqtt_rx_type(rx, MQTT_PUBLISHER_MIN_MSG_SIZE, &pkt_type);
+	if (rc != 0) {
 		goto exit_parser;
 	}
 
-	pkt_type = MQTT_PACKET_TYPE(data->data[0]);
-
 	switch (pkt_type) {
 	case MQTT_CONNACK:
 		if (!ctx->connected) {
-			rc = mqtt_rx_connack(ctx, data, ctx->clean_session);
+			rc = mqtt_parse_connack(ctx, rx, ctx->clean_session);
 		} else {
 			rc = -EINVAL;
 		}
 
 		break;
 	case MQTT_PUBLISH:
-		rc = mqtt_rx_publish(ctx, data);
+		rc = mqtt_parse_publish(ctx, rx);
 		break;
 	case MQTT_PUBREL:
-		rc = mqtt_rx_pubrel(ctx, data);
+		rc = mqtt_rx_pub_msgs(ctx, rx, MQTT_PUBREL);
 		break;
 	case MQTT_PINGRESP:
-		rc = mqtt_rx_pubrel(ctx, data);
+		rc = mqtt_parse_pingresp(ctx, rx);
 		break;
 	case MQTT_SUBACK:
-		rc = mqtt_rx_suback(ctx, data);
+		rc = mqtt_parse_suback(ctx, rx);
 		break;
 	default:
 		rc = -EINVAL;
@@ -803,32 +1434,163 @@ exit_parser:
 		ctx->malformed(ctx, pkt_type);
 	}
 
-	net_nbuf_unref(data);
-
 	return rc;
 }
 
+/**
+ * Drops the received data not parsed yet
+ *
+ * @param ctx MQTT context
+ */
+static
+void mqtt_rx_reset(struct mqtt_ctx *ctx)
+{
+	while (ctx->rx_frags) {
+		ctx->rx_frags = net_buf_frag_del(NULL, ctx->rx_frags);
+	}
+
+	ctx->rx_skip = 0;
+}
+
+/**
+ * Splits the received data into MQTT messages
+ *
+ * @details Every complete message is handed to 'ctx->rcv' in place, through
+ * a cursor that covers that message only. A message split over several
+ * segments is kept in 'ctx->rx_frags' until its last byte is received, the
+ * Remaining Length field itself may be split. Messages that cannot be held
+ * because they are longer than CONFIG_MQTT_MSG_MAX_SIZE are reported to the
+ * 'ctx->malformed' callback and skipped.
+ *
+ * @param ctx MQTT context
+ */
+static
+void mqtt_rx_frames(struct mqtt_ctx *ctx)
+{
+	struct net_nbuf_cursor cur;
+	struct net_nbuf_cursor msg;
+	uint32_t rlen;
+	uint32_t len;
+	uint8_t header;
+	int rc;
+
+	net_nbuf_cursor_init(&cur, ctx->rx_frags, 0,
+			     min(net_buf_frags_len(ctx->rx_frags), UINT16_MAX));
+
+	if (ctx->rx_skip) {
+		len = min(ctx->rx_skip, net_nbuf_cursor_left(&cur));
+		net_nbuf_cursor_skip(&cur, len);
+		ctx->rx_skip -= len;
+	}
+
+	while (net_nbuf_cursor_left(&cur)) {
+		msg = cur;
+		net_nbuf_cursor_read_u8(&msg, &header);
+
+		rc = mqtt_rx_rlen(&msg, &rlen);
+		if (rc == -EAGAIN) {
+			break;
+		}
+
+		if (rc != 0) {
+			/* The stream cannot be framed anymore */
+			if (ctx->malformed) {
+				ctx->malformed(ctx, MQTT_PACKET_TYPE(header));
+			}
+
+			net_nbuf_cursor_skip(&cur, net_nbuf_cursor_left(&cur));
+			break;
+		}
+
+		/* Fixed header and Remaining Length */
+		len = net_nbuf_cursor_left(&cur) - net_nbuf_cursor_left(&msg) +
+		      rlen;
+
+		if (len > net_nbuf_cursor_left(&cur) && len > MSG_SIZE) {
+			/* Too long to be held until it is complete */
+			if (ctx->malformed) {
+				ctx->malformed(ctx, MQTT_PACKET_TYPE(header));
+			}
+
+			ctx->rx_skip = len - net_nbuf_cursor_left(&cur);
+			net_nbuf_cursor_skip(&cur, net_nbuf_cursor_left(&cur));
+			break;
+		}
+
+		if (len > net_nbuf_cursor_left(&cur)) {
+			break;
+		}
+
+		msg = cur;
+		msg.left = len;
+		net_nbuf_cursor_skip(&cur, len);
+
+		ctx->rcv(ctx, &msg);
+	}
+
+	/* Release the fragments already parsed */
+	while (ctx->rx_frags && ctx->rx_frags != cur.frag) {
+		ctx->rx_frags = net_buf_frag_del(NULL, ctx->rx_frags);
+	}
+
+	if (ctx->rx_frags) {
+		net_buf_pull(ctx->rx_frags, cur.pos);
+	}
+}
+
 static
 void mqtt_recv(struct net_context *net_ctx, struct net_buf *buf, int status,
 	       void *data)
 {
 	struct mqtt_ctx *mqtt = (struct mqtt_ctx *)data;
+	struct net_buf *frags;
+	uint16_t offset;
+	uint16_t len;
 
 	/* net_ctx is already referenced to by the mqtt_ctx struct */
 	ARG_UNUSED(net_ctx);
 
 	if (status || !buf) {
+		/* The connection is gone, a pending message is never
+		 * completed.
+		 */
+		mqtt_rx_reset(mqtt);
+
+#if defined(CONFIG_MQTT_INFLIGHT)
+		/* The messages in flight are kept for the next session */
+		k_delayed_work_cancel(&mqtt->inflight_timer);
+#endif
 		return;
 	}
 
-	if (net_nbuf_appdatalen(buf) == 0) {
-		goto lb_exit;
+	len = net_nbuf_appdatalen(buf);
+	if (len == 0) {
+		net_nbuf_unref(buf);
+		return;
 	}
 
-	mqtt->rcv(mqtt, buf);
-
-lb_exit:
+	/* Keep the fragments holding the application data only, so they are
+	 * parsed with the data still pending from the previous segments.
+	 */
+	frags = buf->frags;
+	buf->frags = NULL;
 	net_nbuf_unref(buf);
+
+	offset = net_buf_frags_len(frags) - len;
+	while (offset >= frags->len) {
+		offset -= frags->len;
+		frags = net_buf_frag_del(NULL, frags);
+	}
+
+	net_buf_pull(frags, offset);
+
+	if (mqtt->rx_frags) {
+		net_buf_frag_add(mqtt->rx_frags, frags);
+	} else {
+		mqtt->rx_frags = frags;
+	}
+
+	mqtt_rx_frames(mqtt);
 }
 
 int mqtt_init(struct mqtt_ctx *ctx, enum mqtt_app app_type)
@@ -837,6 +1599,16 @@ int mqtt_init(struct mqtt_ctx *ctx, enum mqtt_app app_type)
 	ctx->clean_session = 1;
 	ctx->connected = 0;
 
+	ctx->rx_frags = NULL;
+	ctx->rx_skip = 0;
+
+#if defined(CONFIG_MQTT_INFLIGHT)
+	memset(ctx->inflight, 0, sizeof(ctx->inflight));
+	k_sem_init(&ctx->inflight_free, INFLIGHT_WINDOW, INFLIGHT_WINDOW);
+	k_sem_init(&ctx->inflight_lock, 1, 1);
+	k_delayed_work_init(&ctx->inflight_timer, mqtt_inflight_timeout);
+#endif
+
 	/* Install the receiver callback, timeout is set to K_NO_WAIT.
 	 * In this case, no return code is evaluated.
 	 */
@@ -493,19 +493,28 @@ void zoap_pending_clear(struct zoap_pending *pending)
 	pending->buf = NULL;
 }
 
-static bool uri_path_eq(const struct zoap_packet *pkt,
-			const char * const *path)
+/* Resources with a deeper path are never matched */
+#define MAX_PATH_SEGMENTS 16
+
+/* Parses all the URI-Path options of the request in a single pass */
+static int uri_path_get(const struct zoap_packet *pkt,
+			struct zoap_option *options)
 {
-	struct zoap_option options[16];
-	uint16_t count = 16;
-	int i, r;
+	int r;
 
-	r = zoap_find_options(pkt, ZOAP_OPTION_URI_PATH, options, count);
-	if (r < 0) {
-		return false;
+	r = zoap_find_options(pkt, ZOAP_OPTION_URI_PATH, options,
+			      MAX_PATH_SEGMENTS + 1);
+	if (r > MAX_PATH_SEGMENTS) {
+		return -EINVAL;
 	}
 
-	count = r;
+	return r;
+}
+
+static bool uri_path_eq(const struct zoap_option *options, uint16_t count,
+			const char * const *path)
+{
+	int i;
 
 	for (i = 0; i < count && path[i]; i++) {
 		size_t len;
@@ -548,36 +557,156 @@ static bool is_request(const struct zoap_packet *pkt)
 	return !(code & ~ZOAP_REQUEST_MASK);
 }
 
+static int resource_method_call(struct zoap_resource *resource,
+				struct zoap_packet *pkt,
+				const struct sockaddr *from)
+{
+	zoap_method_t method;
+	uint8_t code;
+
+	code = zoap_header_get_code(pkt);
+	method = method_from_code(resource, code);
+
+	if (!method) {
+		return 0;
+	}
+
+	return method(resource, pkt, from);
+}
+
 int zoap_handle_request(struct zoap_packet *pkt,
 			struct zoap_resource *resources,
 			const struct sockaddr *from)
 {
+	struct zoap_option options[MAX_PATH_SEGMENTS + 1];
 	struct zoap_resource *resource;
+	int count;
 
 	if (!is_request(pkt)) {
 		return 0;
 	}
 
-	for (resource = resources; resource && resource->path; resource++) {
-		zoap_method_t method;
-		uint8_t code;
+	count = uri_path_get(pkt, options);
+	if (count < 0) {
+		return -ENOENT;
+	}
 
-		/* FIXME: deal with hierarchical resources */
-		if (!uri_path_eq(pkt, resource->path)) {
+	for (resource = resources; resource && resource->path; resource++) {
+		if (!uri_path_eq(options, count, resource->path)) {
 			continue;
 		}
 
-		code = zoap_header_get_code(pkt);
-		method = method_from_code(resource, code);
+		return resource_method_call(resource, pkt, from);
+	}
+
+	return -ENOENT;
+}
+
+/* Returns the child of @a parent for @a segment, adding it if needed */
+static struct zoap_resource_node *resource_node_get(
+	struct zoap_resource_tree *tree, struct zoap_resource_node *parent,
+	const char *segment, uint16_t len)
+{
+	struct zoap_resource_node *node, *last = NULL;
 
-		if (!method) {
-			return 0;
+	for (node = parent->child; node; node = node->next) {
+		if (node->len == len && !memcmp(node->segment, segment, len)) {
+			return node;
 		}
 
-		return method(resource, pkt, from);
+		last = node;
 	}
 
-	return -ENOENT;
+	if (tree->used >= tree->len) {
+		return NULL;
+	}
+
+	node = &tree->nodes[tree->used++];
+	memset(node, 0, sizeof(*node));
+	node->segment = segment;
+	node->len = len;
+
+	if (last) {
+		last->next = node;
+	} else {
+		parent->child = node;
+	}
+
+	return node;
+}
+
+int zoap_resource_tree_init(struct zoap_resource_tree *tree,
+			    struct zoap_resource *resources,
+			    struct zoap_resource_node *nodes, size_t len)
+{
+	struct zoap_resource *resource;
+	struct zoap_resource_node *node;
+	int i;
+
+	if (!len) {
+		return -ENOMEM;
+	}
+
+	/* The first node is the root, it matches requests without path */
+	memset(nodes, 0, sizeof(*nodes));
+	tree->nodes = nodes;
+	tree->len = len;
+	tree->used = 1;
+
+	for (resource = resources; resource && resource->path; resource++) {
+		node = nodes;
+
+		for (i = 0; resource->path[i]; i++) {
+			node = resource_node_get(tree, node, resource->path[i],
+						 strlen(resource->path[i]));
+			if (!node) {
+				return -ENOMEM;
+			}
+		}
+
+		/* As with the array, the first resource of a path is used */
+		if (!node->resource) {
+			node->resource = resource;
+		}
+	}
+
+	return 0;
+}
+
+int zoap_handle_request_tree(struct zoap_packet *pkt,
+			     struct zoap_resource_tree *tree,
+			     const struct sockaddr *from)
+{
+	struct zoap_option options[MAX_PATH_SEGMENTS + 1];
+	struct zoap_resource_node *node;
+	int count, i;
+
+	if (!is_request(pkt)) {
+		return 0;
+	}
+
+	count = uri_path_get(pkt, options);
+	if (count < 0) {
+		return -ENOENT;
+	}
+
+	node = tree->nodes;
+
+	for (i = 0; i < count && node; i++) {
+		for (node = node->child; node; node = node->next) {
+			if (node->len == options[i].len &&
+			    !memcmp(node->segment, options[i].value,
+				    node->len)) {
+				break;
+			}
+		}
+	}
+
+	if (!node || !node->resource) {
+		return -ENOENT;
+	}
+
+	return resource_method_call(node->resource, pkt, from);
 }
 
 unsigned int zoap_option_value_to_int(const struct zoap_option *option)
@@ -805,6 +934,115 @@ struct zoap_observer *zoap_find_observer_by_addr(
 	return NULL;
 }
 
+/* RFC 7252, 4.8.2: time a message ID stays in use */
+#define EXCHANGE_LIFETIME (247 * MSEC_PER_SEC)
+
+static bool dedup_expired(const struct zoap_dedup *dedup, uint32_t now)
+{
+	return (int32_t)(now - dedup->timestamp) >= EXCHANGE_LIFETIME;
+}
+
+int zoap_dedup_init(struct zoap_dedup *dedup,
+		    const struct zoap_packet *request,
+		    const struct zoap_packet *response,
+		    const struct sockaddr *addr)
+{
+	struct net_buf *frag;
+
+	memset(dedup, 0, sizeof(*dedup));
+	dedup->id = zoap_header_get_id(request);
+	dedup->timestamp = k_uptime_get_32();
+	memcpy(&dedup->addr, addr, sizeof(*addr));
+
+	if (!response) {
+		return 0;
+	}
+
+	/* A copy is kept rather than the buffer, which would be held
+	 * for the whole EXCHANGE_LIFETIME. Without it, a retransmission
+	 * caused by a lost response could never be answered, so it is
+	 * better processed again.
+	 */
+	frag = response->buf->frags;
+	if (frag->len > sizeof(dedup->data)) {
+		zoap_dedup_clear(dedup);
+		return -EMSGSIZE;
+	}
+
+	memcpy(dedup->data, frag->data, frag->len);
+	dedup->len = frag->len;
+
+	return 0;
+}
+
+struct zoap_dedup *zoap_dedup_next_unused(
+	struct zoap_dedup *dedups, size_t len)
+{
+	struct zoap_dedup *d, *oldest = NULL;
+	uint32_t now = k_uptime_get_32();
+	size_t i;
+
+	for (i = 0, d = dedups; i < len; i++, d++) {
+		if (is_addr_unspecified(&d->addr) || dedup_expired(d, now)) {
+			zoap_dedup_clear(d);
+			return d;
+		}
+
+		if (!oldest ||
+		    (int32_t)(d->timestamp - oldest->timestamp) < 0) {
+			oldest = d;
+		}
+	}
+
+	/* The window is full, the oldest exchange is forgotten */
+	if (oldest) {
+		zoap_dedup_clear(oldest);
+	}
+
+	return oldest;
+}
+
+struct zoap_dedup *zoap_dedup_received(
+	const struct zoap_packet *request,
+	const struct sockaddr *from,
+	struct zoap_dedup *dedups, size_t len)
+{
+	struct zoap_dedup *d;
+	uint32_t now = k_uptime_get_32();
+	uint8_t type;
+	uint16_t id;
+	size_t i;
+
+	type = zoap_header_get_type(request);
+	if (type != ZOAP_TYPE_CON && type != ZOAP_TYPE_NON_CON) {
+		return NULL;
+	}
+
+	id = zoap_header_get_id(request);
+
+	for (i = 0, d = dedups; i < len; i++, d++) {
+		if (is_addr_unspecified(&d->addr)) {
+			continue;
+		}
+
+		if (dedup_expired(d, now)) {
+			zoap_dedup_clear(d);
+			continue;
+		}
+
+		if (d->id == id && sockaddr_equal(&d->addr, from)) {
+			return d;
+		}
+	}
+
+	return NULL;
+}
+
+void zoap_dedup_clear(struct zoap_dedup *dedup)
+{
+	memset(dedup, 0, sizeof(*dedup));
+}
+
 uint8_t *zoap_packet_get_payload(struct zoap_packet *pkt, uint16_t *len)
 {
 	struct net_buf *frag = pkt->buf->frags;
@@ -1336,6 +1574,314 @@ size_t zoap_next_block(struct zoap_block_context *ctx)
 	return ctx->current;
 }
 
+/* Block option of a single block, regardless of the transfer context */
+static int get_block(const struct zoap_packet *pkt, uint16_t code,
+		     size_t *offset, enum zoap_block_size *block_size,
+		     bool *more)
+{
+	int block;
+
+	block = get_block_option(pkt, code);
+	if (block < 0) {
+		return block;
+	}
+
+	/* SZX 7 is reserved (BERT) */
+	if (GET_BLOCK_SIZE(block) > ZOAP_BLOCK_1024) {
+		return -EINVAL;
+	}
+
+	*block_size = GET_BLOCK_SIZE(block);
+	*offset = GET_NUM(block) * zoap_block_size_to_bytes(*block_size);
+	*more = GET_MORE(block);
+
+	return 0;
+}
+
+static int add_block(struct zoap_packet *pkt, uint16_t code, size_t offset,
+		     enum zoap_block_size block_size, bool more)
+{
+	unsigned int val = 0;
+
+	SET_BLOCK_SIZE(val, block_size);
+	SET_MORE(val, more);
+	SET_NUM(val, offset / zoap_block_size_to_bytes(block_size));
+
+	return zoap_add_option_int(pkt, code, val);
+}
+
+/* Fills the payload with the block of the body at ctx->current */
+static int fill_block(struct zoap_packet *pkt, struct zoap_block_context *ctx,
+		      zoap_block_read_t read, void *user_data)
+{
+	uint16_t bytes = zoap_block_size_to_bytes(ctx->block_size);
+	uint8_t *payload;
+	uint16_t len;
+	int r;
+
+	bytes = min(bytes, ctx->total_size - ctx->current);
+	if (!bytes) {
+		return 0;
+	}
+
+	payload = zoap_packet_get_payload(pkt, &len);
+	if (!payload || len < bytes) {
+		return -ENOMEM;
+	}
+
+	r = read(ctx, payload, bytes, user_data);
+	if (r < 0) {
+		return r;
+	}
+
+	if (r != bytes) {
+		return -EIO;
+	}
+
+	return zoap_packet_set_used(pkt, bytes);
+}
+
+int zoap_block2_response_fill(const struct zoap_packet *request,
+			      struct zoap_packet *response,
+			      struct zoap_block_context *ctx,
+			      zoap_block_read_t read, void *user_data)
+{
+	enum zoap_block_size block_size;
+	size_t offset;
+	bool more;
+	int r;
+
+	r = get_block(request, ZOAP_OPTION_BLOCK2, &offset, &block_size,
+		      &more);
+	if (r == -ENOENT) {
+		offset = 0;
+		block_size = ctx->block_size;
+	} else if (r < 0) {
+		return r;
+	}
+
+	if (offset && offset >= ctx->total_size) {
+		return -EINVAL;
+	}
+
+	/* The block size of the request is an upper bound, the offset is
+	 * a multiple of any smaller block size.
+	 */
+	ctx->block_size = min(block_size, ctx->block_size);
+	ctx->current = offset;
+
+	r = zoap_add_block2_option(response, ctx);
+	if (r < 0) {
+		return r;
+	}
+
+	if (!offset) {
+		r = zoap_add_size2_option(response, ctx);
+		if (r < 0) {
+			return r;
+		}
+	}
+
+	return fill_block(response, ctx, read, user_data);
+}
+
+int zoap_block2_response_received(const struct zoap_packet *response,
+				  struct zoap_block_context *ctx,
+				  zoap_block_write_t write, void *user_data)
+{
+	struct zoap_packet *pkt = (struct zoap_packet *)response;
+	enum zoap_block_size block_size;
+	uint8_t *payload;
+	size_t offset;
+	uint16_t len;
+	bool more;
+	int r, size;
+
+	payload = zoap_packet_get_payload(pkt, &len);
+
+	r = get_block(response, ZOAP_OPTION_BLOCK2, &offset, &block_size,
+		      &more);
+	if (r == -ENOENT) {
+		/* The whole body fits in the response */
+		if (ctx->current) {
+			return -EINVAL;
+		}
+
+		r = write(ctx, payload, len, true, user_data);
+		if (r < 0) {
+			return r;
+		}
+
+		ctx->current = len;
+		ctx->total_size = len;
+
+		return 0;
+	} else if (r < 0) {
+		return r;
+	}
+
+	if (offset != ctx->current || block_size > ctx->block_size) {
+		return -EINVAL;
+	}
+
+	if (more && len != zoap_block_size_to_bytes(block_size)) {
+		return -EINVAL;
+	}
+
+	size = get_block_option(response, ZOAP_OPTION_SIZE2);
+	if (size > 0) {
+		ctx->total_size = size;
+	}
+
+	ctx->block_size = block_size;
+
+	r = write(ctx, payload, len, !more, user_data);
+	if (r < 0) {
+		return r;
+	}
+
+	ctx->current += len;
+
+	if (!more) {
+		ctx->total_size = ctx->current;
+		return 0;
+	}
+
+	return 1;
+}
+
+int zoap_block1_request_fill(struct zoap_packet *request,
+			     struct zoap_block_context *ctx,
+			     zoap_block_read_t read, void *user_data)
+{
+	int r;
+
+	r = zoap_add_block1_option(request, ctx);
+	if (r < 0) {
+		return r;
+	}
+
+	if (!ctx->current) {
+		r = zoap_add_size1_option(request, ctx);
+		if (r < 0) {
+			return r;
+		}
+	}
+
+	return fill_block(request, ctx, read, user_data);
+}
+
+int zoap_block1_request_received(const struct zoap_packet *request,
+				 struct zoap_packet *response,
+				 struct zoap_block_context *ctx,
+				 zoap_block_write_t write, void *user_data)
+{
+	struct zoap_packet *pkt = (struct zoap_packet *)request;
+	enum zoap_block_size block_size;
+	uint8_t *payload;
+	size_t offset;
+	uint16_t len;
+	bool block = true;
+	bool more;
+	int r;
+
+	payload = zoap_packet_get_payload(pkt, &len);
+
+	r = get_block(request, ZOAP_OPTION_BLOCK1, &offset, &block_size,
+		      &more);
+	if (r == -ENOENT) {
+		/* The whole body fits in the request */
+		block = false;
+		offset = 0;
+		more = false;
+	} else if (r < 0) {
+		return r;
+	} else if (more && len != zoap_block_size_to_bytes(block_size)) {
+		return -EINVAL;
+	}
+
+	/* Only the first part of a block larger than ours is kept, the
+	 * client goes on with the smaller block size.
+	 */
+	if (more && block_size > ctx->block_size) {
+		block_size = ctx->block_size;
+		len = zoap_block_size_to_bytes(block_size);
+	}
+
+	/* A block is missing */
+	if (offset > ctx->current) {
+		return -EINVAL;
+	}
+
+	/* Retransmitted blocks are only acknowledged again */
+	if (offset == ctx->current) {
+		r = write(ctx, payload, len, !more, user_data);
+		if (r < 0) {
+			return r;
+		}
+
+		ctx->current += len;
+		if (!more) {
+			ctx->total_size = ctx->current;
+		}
+	}
+
+	if (!block) {
+		return 0;
+	}
+
+	if (more) {
+		zoap_header_set_code(response, ZOAP_RESPONSE_CODE_CONTINUE);
+	}
+
+	r = add_block(response, ZOAP_OPTION_BLOCK1, offset, block_size, more);
+	if (r < 0) {
+		return r;
+	}
+
+	return more ? 1 : 0;
+}
+
+int zoap_block1_response_received(const struct zoap_packet *response,
+				  struct zoap_block_context *ctx)
+{
+	enum zoap_block_size block_size;
+	size_t offset;
+	bool more;
+	int r;
+
+	r = get_block(response, ZOAP_OPTION_BLOCK1, &offset, &block_size,
+		      &more);
+	if (r == -ENOENT) {
+		/* The server took the whole body at once */
+		if (zoap_header_get_code(response) ==
+		    ZOAP_RESPONSE_CODE_CONTINUE) {
+			return -EINVAL;
+		}
+
+		return 0;
+	} else if (r < 0) {
+		return r;
+	}
+
+	if (offset != ctx->current || block_size > ctx->block_size) {
+		return -EINVAL;
+	}
+
+	if (zoap_header_get_code(response) != ZOAP_RESPONSE_CODE_CONTINUE) {
+		return 0;
+	}
+
+	ctx->block_size = block_size;
+	ctx->current += zoap_block_size_to_bytes(block_size);
+
+	if (ctx->current >= ctx->total_size) {
+		return -EINVAL;
+	}
+
+	return 1;
+}
+
 uint8_t *zoap_next_token(void)
 {
 	static uint32_t rand[2];
@@ -68,6 +68,56 @@ static int shell_cmd_tasks(int argc, char *argv[])
 #endif
 
 
+#if defined(CONFIG_THREAD_MONITOR) && defined(CONFIG_THREAD_STATS)
+static void thread_cycles_sum(k_tid_t thread, void *user_data)
+{
+	struct k_thread_stats stats;
+
+	k_thread_stats_get(thread, &stats);
+	*(uint64_t *)user_data += stats.execution_cycles;
+}
+
+static void thread_stats_print(k_tid_t thread, void *user_data)
+{
+	uint64_t total = *(uint64_t *)user_data;
+	struct k_thread_stats stats;
+	uint32_t permille = 0;
+
+	k_thread_stats_get(thread, &stats);
+
+	if (total) {
+		permille = (uint32_t)(stats.execution_cycles * 1000 / total);
+	}
+
+	printk("%s%p: prio %d cpu %u.%u%% switches %u/%u ready %u us "
+	       "stack %zu/%zu\n",
+	       (thread == k_current_get()) ? "*" : " ",
+	       thread, k_thread_priority_get(thread),
+	       permille / 10, permille % 10,
+	       stats.switches_in, stats.switches_out,
+	       (uint32_t)(SYS_CLOCK_HW_CYCLES_TO_NS64(stats.ready_cycles) /
+			  NSEC_PER_USEC),
+	       stats.stack_used, stats.stack_size);
+}
+
+static int shell_cmd_threads(int argc, char *argv[])
+{
+	uint64_t total = 0;
+
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	k_thread_foreach(thread_cycles_sum, &total);
+
+	printk("threads (cpu share, switches in/out, time ready, stack "
+	       "used/size):\n");
+
+	k_thread_foreach(thread_stats_print, &total);
+
+	return 0;
+}
+#endif
+
 #if defined(CONFIG_INIT_STACKS)
 static int shell_cmd_stack(int argc, char *argv[])
 {
@@ -83,6 +133,9 @@ struct shell_cmd kernel_commands[] = {
 #if defined(CONFIG_OBJECT_TRACING) && defined(CONFIG_THREAD_MONITOR)
 	{ "tasks", shell_cmd_tasks, "show running tasks" },
 #endif
+#if defined(CONFIG_THREAD_MONITOR) && defined(CONFIG_THREAD_STATS)
+	{ "threads", shell_cmd_threads, "show thread runtime statistics" },
+#endif
 #if defined(CONFIG_INIT_STACKS)
 	{ "stacks", shell_cmd_stack, "show system stacks" },
 #endif
@@ -0,0 +1,66 @@
+/* context.c */
+
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "syskernel.h"
+
+static uint32_t switch_stamp;
+static int switches_left;
+
+/**
+ *
+ * @brief Context switch test thread
+ *
+ * Two instances of this thread yield to each other. Each one records the
+ * time between the yield of its peer and its own resumption.
+ *
+ * @return N/A
+ */
+void context_thread(void *par1, void *par2, void *par3)
+{
+	ARG_UNUSED(par1);
+	ARG_UNUSED(par2);
+	ARG_UNUSED(par3);
+
+	while (switches_left-- > 0) {
+		switch_stamp = OS_GET_TIME();
+		k_yield();
+		bench_stats_add(TIME_STAMP_DELTA_GET(switch_stamp));
+	}
+}
+
+/**
+ *
+ * @brief The main test entry
+ *
+ * @return 1 if success and 0 on failure
+ */
+int context_test(void)
+{
+	fprintf(output_file, sz_test_case_fmt,
+			"Context switch #1");
+	fprintf(output_file, sz_description,
+			"\n\tk_yield"
+			"\n\tswitch between two cooperative threads");
+	printf(sz_test_start_fmt);
+
+	switches_left = BENCH_MAX_SAMPLES;
+
+	BENCH_START();
+
+	/* both threads must be ready before the first yield */
+	k_sched_lock();
+	k_thread_spawn(thread_stack1, STACK_SIZE, context_thread,
+			 NULL, NULL, NULL,
+			 K_PRIO_COOP(3), 0, K_NO_WAIT);
+	k_thread_spawn(thread_stack2, STACK_SIZE, context_thread,
+			 NULL, NULL, NULL,
+			 K_PRIO_COOP(3), 0, K_NO_WAIT);
+	k_sched_unlock();
+
+	return check_stats("context_1");
+}
@@ -92,6 +92,7 @@ void lifo_thread2(void *par1, void *par2, void *par3)
 			break;
 		}
 		(*pcounter)++;
+		bench_stats_sample();
 	}
 	/* wait till it is safe to end: */
 	k_fifo_get(&sync_fifo, K_FOREVER);
@@ -125,6 +126,7 @@ void lifo_thread3(void *par1, void *par2, void *par3)
 			break;
 		}
 		(*pcounter)++;
+		bench_stats_sample();
 	}
 	/* wait till it is safe to end: */
 	k_fifo_get(&sync_fifo, K_FOREVER);
@@ -169,7 +171,7 @@ int lifo_test(void)
 
 	t = TIME_STAMP_DELTA_GET(t);
 
-	return_value += check_result(i, t);
+	return_value += check_result("lifo_1", i, t);
 
 	/* threads have done their job, they can stop now safely: */
 	for (j = 0; j < 2; j++) {
@@ -203,7 +205,7 @@ int lifo_test(void)
 
 	t = TIME_STAMP_DELTA_GET(t);
 
-	return_value += check_result(i, t);
+	return_value += check_result("lifo_2", i, t);
 
 	/* threads have done their job, they can stop now safely: */
 	for (j = 0; j < 2; j++) {
@@ -247,11 +249,12 @@ int lifo_test(void)
 		if (pelement[1] != 2 * i) {
 			break;
 		}
+		bench_stats_sample();
 	}
 
 	t = TIME_STAMP_DELTA_GET(t);
 
-	return_value += check_result(i * 2, t);
+	return_value += check_result("lifo_3", i * 2, t);
 
 	/* threads have done their job, they can stop now safely: */
 	for (j = 0; j < 2; j++) {
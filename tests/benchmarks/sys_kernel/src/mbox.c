@@ -0,0 +1,85 @@
+/* mbox.c */
+
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "syskernel.h"
+
+#include <string.h>
+
+#define MBOX_DATA_SIZE 16
+
+K_MBOX_DEFINE(mbox1);
+
+/**
+ *
+ * @brief Mailbox test thread
+ *
+ * @param par1   Ignored parameter.
+ * @param par2   Number of test loops.
+ *
+ * @return N/A
+ */
+void mbox_thread1(void *par1, void *par2, void *par3)
+{
+	int i;
+	struct k_mbox_msg msg;
+	char data[MBOX_DATA_SIZE];
+	int num_loops = (int) par2;
+
+	ARG_UNUSED(par1);
+	ARG_UNUSED(par3);
+
+	for (i = 0; i < num_loops; i++) {
+		msg.size = sizeof(data);
+		msg.rx_source_thread = K_ANY;
+		k_mbox_get(&mbox1, &msg, data, K_FOREVER);
+	}
+}
+
+/**
+ *
+ * @brief The main test entry
+ *
+ * @return 1 if success and 0 on failure
+ */
+int mbox_test(void)
+{
+	uint32_t t;
+	struct k_mbox_msg msg;
+	char data[MBOX_DATA_SIZE];
+	int i;
+
+	memset(data, 0xa5, sizeof(data));
+
+	fprintf(output_file, sz_test_case_fmt,
+			"Mailbox #1");
+	fprintf(output_file, sz_description,
+			"\n\tk_mbox_put(K_FOREVER)"
+			"\n\tk_mbox_get(K_FOREVER)"
+			"\n\tsynchronous 16 byte message to a cooperative thread");
+	printf(sz_test_start_fmt);
+
+	BENCH_START();
+
+	k_thread_spawn(thread_stack1, STACK_SIZE, mbox_thread1,
+			 NULL, (void *) BENCH_MAX_SAMPLES, NULL,
+			 K_PRIO_COOP(3), 0, K_NO_WAIT);
+
+	for (i = 0; i < BENCH_MAX_SAMPLES; i++) {
+		msg.info = i;
+		msg.size = sizeof(data);
+		msg.tx_data = data;
+		msg.tx_block.pool_id = NULL;
+		msg.tx_target_thread = K_ANY;
+
+		t = OS_GET_TIME();
+		k_mbox_put(&mbox1, &msg, K_FOREVER);
+		bench_stats_add(TIME_STAMP_DELTA_GET(t));
+	}
+
+	return check_stats("mbox_1");
+}
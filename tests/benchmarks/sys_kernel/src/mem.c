@@ -0,0 +1,76 @@
+/* mem.c */
+
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "syskernel.h"
+
+#define BLOCK_SIZE 64
+/* must be a plain number, it is passed to the assembler */
+#define POOL_MAX_SIZE 256
+
+K_MEM_SLAB_DEFINE(slab1, BLOCK_SIZE, 4, 4);
+K_MEM_POOL_DEFINE(pool1, BLOCK_SIZE, POOL_MAX_SIZE, 1, 4);
+
+/**
+ *
+ * @brief The main test entry
+ *
+ * @return 1 if success and 0 on failure
+ */
+int mem_test(void)
+{
+	uint32_t t;
+	void *ptr;
+	struct k_mem_block block;
+	int i;
+	int return_value = 0;
+
+	fprintf(output_file, sz_test_case_fmt,
+			"Memory slab #1");
+	fprintf(output_file, sz_description,
+			"\n\tk_mem_slab_alloc(K_NO_WAIT)"
+			"\n\tk_mem_slab_free");
+	printf(sz_test_start_fmt);
+
+	BENCH_START();
+
+	for (i = 0; i < BENCH_MAX_SAMPLES; i++) {
+		t = OS_GET_TIME();
+		if (k_mem_slab_alloc(&slab1, &ptr, K_NO_WAIT) != 0) {
+			break;
+		}
+		k_mem_slab_free(&slab1, &ptr);
+		bench_stats_add(TIME_STAMP_DELTA_GET(t));
+	}
+
+	return_value += check_stats("mem_slab_1");
+
+	fprintf(output_file, sz_test_case_fmt,
+			"Memory pool #1");
+	fprintf(output_file, sz_description,
+			"\n\tk_mem_pool_alloc(K_NO_WAIT)"
+			"\n\tk_mem_pool_free"
+			"\n\tsmallest block, split from and merged into "
+			"the largest one");
+	printf(sz_test_start_fmt);
+
+	BENCH_START();
+
+	for (i = 0; i < BENCH_MAX_SAMPLES; i++) {
+		t = OS_GET_TIME();
+		if (k_mem_pool_alloc(&pool1, &block, BLOCK_SIZE,
+				     K_NO_WAIT) != 0) {
+			break;
+		}
+		k_mem_pool_free(&block);
+		bench_stats_add(TIME_STAMP_DELTA_GET(t));
+	}
+
+	return_value += check_stats("mem_pool_1");
+
+	return return_value;
+}
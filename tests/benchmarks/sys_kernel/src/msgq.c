@@ -0,0 +1,100 @@
+/* msgq.c */
+
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "syskernel.h"
+
+#define MSGQ_LEN 4
+
+K_MSGQ_DEFINE(msgq1, sizeof(uint32_t), MSGQ_LEN, 4);
+K_MSGQ_DEFINE(msgq2, sizeof(uint32_t), MSGQ_LEN, 4);
+
+/**
+ *
+ * @brief Message queue test thread
+ *
+ * @param par1   Ignored parameter.
+ * @param par2   Number of test loops.
+ *
+ * @return N/A
+ */
+void msgq_thread1(void *par1, void *par2, void *par3)
+{
+	int i;
+	uint32_t data;
+	int num_loops = (int) par2;
+
+	ARG_UNUSED(par1);
+	ARG_UNUSED(par3);
+
+	for (i = 0; i < num_loops; i++) {
+		k_msgq_get(&msgq1, &data, K_FOREVER);
+		k_msgq_put(&msgq2, &data, K_FOREVER);
+	}
+}
+
+/**
+ *
+ * @brief The main test entry
+ *
+ * @return 1 if success and 0 on failure
+ */
+int msgq_test(void)
+{
+	uint32_t t;
+	uint32_t data;
+	int i;
+	int return_value = 0;
+
+	fprintf(output_file, sz_test_case_fmt,
+			"Message queue #1");
+	fprintf(output_file, sz_description,
+			"\n\tk_msgq_put(K_FOREVER)"
+			"\n\tk_msgq_get(K_FOREVER)"
+			"\n\tround trip with a cooperative thread");
+	printf(sz_test_start_fmt);
+
+	k_msgq_purge(&msgq1);
+	k_msgq_purge(&msgq2);
+
+	BENCH_START();
+
+	k_thread_spawn(thread_stack1, STACK_SIZE, msgq_thread1,
+			 NULL, (void *) BENCH_MAX_SAMPLES, NULL,
+			 K_PRIO_COOP(3), 0, K_NO_WAIT);
+
+	for (i = 0; i < BENCH_MAX_SAMPLES; i++) {
+		t = OS_GET_TIME();
+		data = i;
+		k_msgq_put(&msgq1, &data, K_FOREVER);
+		k_msgq_get(&msgq2, &data, K_FOREVER);
+		bench_stats_add(TIME_STAMP_DELTA_GET(t));
+	}
+
+	return_value += check_stats("msgq_1");
+
+	fprintf(output_file, sz_test_case_fmt,
+			"Message queue #2");
+	fprintf(output_file, sz_description,
+			"\n\tk_msgq_put(K_NO_WAIT)"
+			"\n\tk_msgq_get(K_NO_WAIT)");
+	printf(sz_test_start_fmt);
+
+	BENCH_START();
+
+	for (i = 0; i < BENCH_MAX_SAMPLES; i++) {
+		t = OS_GET_TIME();
+		data = i;
+		k_msgq_put(&msgq1, &data, K_NO_WAIT);
+		k_msgq_get(&msgq1, &data, K_NO_WAIT);
+		bench_stats_add(TIME_STAMP_DELTA_GET(t));
+	}
+
+	return_value += check_stats("msgq_2");
+
+	return return_value;
+}
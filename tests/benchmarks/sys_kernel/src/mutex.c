@@ -0,0 +1,102 @@
+/* mutex.c */
+
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "syskernel.h"
+
+K_MUTEX_DEFINE(mutex1);
+K_SEM_DEFINE(mutex_sem, 0, 1);
+
+static uint32_t unlock_stamp;
+
+/**
+ *
+ * @brief Mutex contention test thread
+ *
+ * Waits for the main thread to own the mutex, then blocks on it. The time
+ * from the unlock by the owner to the acquisition by this thread is
+ * recorded.
+ *
+ * @param par1   Ignored parameter.
+ * @param par2   Number of test loops.
+ *
+ * @return N/A
+ */
+void mutex_thread1(void *par1, void *par2, void *par3)
+{
+	int i;
+	int num_loops = (int) par2;
+
+	ARG_UNUSED(par1);
+	ARG_UNUSED(par3);
+
+	for (i = 0; i < num_loops; i++) {
+		k_sem_take(&mutex_sem, K_FOREVER);
+		k_mutex_lock(&mutex1, K_FOREVER);
+		bench_stats_add(TIME_STAMP_DELTA_GET(unlock_stamp));
+		k_mutex_unlock(&mutex1);
+	}
+}
+
+/**
+ *
+ * @brief The main test entry
+ *
+ * @return 1 if success and 0 on failure
+ */
+int mutex_test(void)
+{
+	uint32_t t;
+	int i;
+	int return_value = 0;
+
+	fprintf(output_file, sz_test_case_fmt,
+			"Mutex #1");
+	fprintf(output_file, sz_description,
+			"\n\tk_mutex_lock(K_FOREVER)"
+			"\n\tk_mutex_unlock"
+			"\n\tno contention");
+	printf(sz_test_start_fmt);
+
+	BENCH_START();
+
+	for (i = 0; i < BENCH_MAX_SAMPLES; i++) {
+		t = OS_GET_TIME();
+		k_mutex_lock(&mutex1, K_FOREVER);
+		k_mutex_unlock(&mutex1);
+		bench_stats_add(TIME_STAMP_DELTA_GET(t));
+	}
+
+	return_value += check_stats("mutex_1");
+
+	fprintf(output_file, sz_test_case_fmt,
+			"Mutex #2");
+	fprintf(output_file, sz_description,
+			"\n\tk_mutex_lock(K_FOREVER)"
+			"\n\tk_mutex_unlock"
+			"\n\thandoff to a higher priority waiter, with priority "
+			"inheritance");
+	printf(sz_test_start_fmt);
+
+	BENCH_START();
+
+	k_thread_spawn(thread_stack1, STACK_SIZE, mutex_thread1,
+			 NULL, (void *) BENCH_MAX_SAMPLES, NULL,
+			 K_PRIO_COOP(3), 0, K_NO_WAIT);
+
+	for (i = 0; i < BENCH_MAX_SAMPLES; i++) {
+		k_mutex_lock(&mutex1, K_FOREVER);
+		/* the waiter preempts us and blocks on the mutex */
+		k_sem_give(&mutex_sem);
+		unlock_stamp = OS_GET_TIME();
+		k_mutex_unlock(&mutex1);
+	}
+
+	return_value += check_stats("mutex_2");
+
+	return return_value;
+}
@@ -88,6 +88,7 @@ void fifo_thread2(void *par1, void *par2, void *par3)
 			break;
 		}
 		(*pcounter)++;
+		bench_stats_sample();
 	}
 	/* wait till it is safe to end: */
 	k_fifo_get(&sync_fifo, K_FOREVER);
@@ -124,6 +125,7 @@ void fifo_thread3(void *par1, void *par2, void *par3)
 			break;
 		}
 		(*pcounter)++;
+		bench_stats_sample();
 	}
 	/* wait till it is safe to end: */
 	k_fifo_get(&sync_fifo, K_FOREVER);
@@ -168,7 +170,7 @@ int fifo_test(void)
 
 	t = TIME_STAMP_DELTA_GET(t);
 
-	return_value += check_result(i, t);
+	return_value += check_result("fifo_1", i, t);
 
 	/* threads have done their job, they can stop now safely: */
 	for (j = 0; j < 2; j++) {
@@ -200,7 +202,7 @@ int fifo_test(void)
 
 	t = TIME_STAMP_DELTA_GET(t);
 
-	return_value += check_result(i, t);
+	return_value += check_result("fifo_2", i, t);
 
 	/* threads have done their job, they can stop now safely: */
 	for (j = 0; j < 2; j++) {
@@ -247,10 +249,11 @@ int fifo_test(void)
 		if (pelement[1] != i) {
 			break;
 		}
+		bench_stats_sample();
 	}
 	t = TIME_STAMP_DELTA_GET(t);
 
-	return_value += check_result(i * 2, t);
+	return_value += check_result("fifo_3", i * 2, t);
 
 	/* threads have done their job, they can stop now safely: */
 	for (j = 0; j < 2; j++) {
@@ -0,0 +1,109 @@
+/* pipe.c */
+
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "syskernel.h"
+
+#include <string.h>
+
+#define PIPE_SIZE 64
+#define PIPE_XFER_SIZE 16
+
+K_PIPE_DEFINE(pipe1, PIPE_SIZE, 4);
+K_PIPE_DEFINE(pipe2, PIPE_SIZE, 4);
+
+/**
+ *
+ * @brief Pipe test thread
+ *
+ * @param par1   Ignored parameter.
+ * @param par2   Number of test loops.
+ *
+ * @return N/A
+ */
+void pipe_thread1(void *par1, void *par2, void *par3)
+{
+	int i;
+	size_t bytes;
+	char data[PIPE_XFER_SIZE];
+	int num_loops = (int) par2;
+
+	ARG_UNUSED(par1);
+	ARG_UNUSED(par3);
+
+	for (i = 0; i < num_loops; i++) {
+		k_pipe_get(&pipe1, data, sizeof(data), &bytes, sizeof(data),
+			   K_FOREVER);
+		k_pipe_put(&pipe2, data, sizeof(data), &bytes, sizeof(data),
+			   K_FOREVER);
+	}
+}
+
+/**
+ *
+ * @brief The main test entry
+ *
+ * @return 1 if success and 0 on failure
+ */
+int pipe_test(void)
+{
+	uint32_t t;
+	size_t bytes;
+	char data[PIPE_XFER_SIZE];
+	int i;
+	int return_value = 0;
+
+	memset(data, 0xa5, sizeof(data));
+
+	fprintf(output_file, sz_test_case_fmt,
+			"Pipe #1");
+	fprintf(output_file, sz_description,
+			"\n\tk_pipe_put(K_FOREVER)"
+			"\n\tk_pipe_get(K_FOREVER)"
+			"\n\tround trip of 16 bytes with a cooperative thread");
+	printf(sz_test_start_fmt);
+
+	BENCH_START();
+
+	k_thread_spawn(thread_stack1, STACK_SIZE, pipe_thread1,
+			 NULL, (void *) BENCH_MAX_SAMPLES, NULL,
+			 K_PRIO_COOP(3), 0, K_NO_WAIT);
+
+	for (i = 0; i < BENCH_MAX_SAMPLES; i++) {
+		t = OS_GET_TIME();
+		k_pipe_put(&pipe1, data, sizeof(data), &bytes, sizeof(data),
+			   K_FOREVER);
+		k_pipe_get(&pipe2, data, sizeof(data), &bytes, sizeof(data),
+			   K_FOREVER);
+		bench_stats_add(TIME_STAMP_DELTA_GET(t));
+	}
+
+	return_value += check_stats("pipe_1");
+
+	fprintf(output_file, sz_test_case_fmt,
+			"Pipe #2");
+	fprintf(output_file, sz_description,
+			"\n\tk_pipe_put(K_NO_WAIT)"
+			"\n\tk_pipe_get(K_NO_WAIT)"
+			"\n\t16 bytes through the pipe buffer");
+	printf(sz_test_start_fmt);
+
+	BENCH_START();
+
+	for (i = 0; i < BENCH_MAX_SAMPLES; i++) {
+		t = OS_GET_TIME();
+		k_pipe_put(&pipe1, data, sizeof(data), &bytes, sizeof(data),
+			   K_NO_WAIT);
+		k_pipe_get(&pipe1, data, sizeof(data), &bytes, sizeof(data),
+			   K_NO_WAIT);
+		bench_stats_add(TIME_STAMP_DELTA_GET(t));
+	}
+
+	return_value += check_stats("pipe_2");
+
+	return return_value;
+}
@@ -0,0 +1,79 @@
+/* poll.c */
+
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "syskernel.h"
+
+static struct k_sem poll_sem1;
+static struct k_sem poll_sem2;
+
+/**
+ *
+ * @brief Poll test thread
+ *
+ * @param par1   Ignored parameter.
+ * @param par2   Number of test loops.
+ *
+ * @return N/A
+ */
+void poll_thread1(void *par1, void *par2, void *par3)
+{
+	int i;
+	struct k_poll_event event;
+	int num_loops = (int) par2;
+
+	ARG_UNUSED(par1);
+	ARG_UNUSED(par3);
+
+	k_poll_event_init(&event, K_POLL_TYPE_SEM_AVAILABLE,
+			  K_POLL_MODE_NOTIFY_ONLY, &poll_sem1);
+
+	for (i = 0; i < num_loops; i++) {
+		k_poll(&event, 1, K_FOREVER);
+		event.state = K_POLL_STATE_NOT_READY;
+		k_sem_take(&poll_sem1, K_NO_WAIT);
+		k_sem_give(&poll_sem2);
+	}
+}
+
+/**
+ *
+ * @brief The main test entry
+ *
+ * @return 1 if success and 0 on failure
+ */
+int poll_test(void)
+{
+	uint32_t t;
+	int i;
+
+	fprintf(output_file, sz_test_case_fmt,
+			"Poll #1");
+	fprintf(output_file, sz_description,
+			"\n\tk_poll(K_POLL_TYPE_SEM_AVAILABLE, K_FOREVER)"
+			"\n\tk_sem_give"
+			"\n\tk_sem_take(K_FOREVER)");
+	printf(sz_test_start_fmt);
+
+	k_sem_init(&poll_sem1, 0, 1);
+	k_sem_init(&poll_sem2, 0, 1);
+
+	BENCH_START();
+
+	k_thread_spawn(thread_stack1, STACK_SIZE, poll_thread1,
+			 NULL, (void *) BENCH_MAX_SAMPLES, NULL,
+			 K_PRIO_COOP(3), 0, K_NO_WAIT);
+
+	for (i = 0; i < BENCH_MAX_SAMPLES; i++) {
+		t = OS_GET_TIME();
+		k_sem_give(&poll_sem1);
+		k_sem_take(&poll_sem2, K_FOREVER);
+		bench_stats_add(TIME_STAMP_DELTA_GET(t));
+	}
+
+	return check_stats("poll_1");
+}
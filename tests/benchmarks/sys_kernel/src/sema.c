@@ -69,6 +69,7 @@ void sema_thread2(void *par1, void *par2, void *par3)
 		k_sem_give(&sem1);
 		k_sem_take(&sem2, K_FOREVER);
 		(*pcounter)++;
+		bench_stats_sample();
 	}
 }
 
@@ -95,6 +96,7 @@ void sema_thread3(void *par1, void *par2, void *par3)
 			k_yield();
 		}
 		(*pcounter)++;
+		bench_stats_sample();
 	}
 }
 
@@ -132,7 +134,7 @@ int sema_test(void)
 
 	t = TIME_STAMP_DELTA_GET(t);
 
-	return_value += check_result(i, t);
+	return_value += check_result("sema_1", i, t);
 
 	fprintf(output_file, sz_test_case_fmt,
 			"Semaphore #2");
@@ -157,7 +159,7 @@ int sema_test(void)
 
 	t = TIME_STAMP_DELTA_GET(t);
 
-	return_value += check_result(i, t);
+	return_value += check_result("sema_2", i, t);
 
 	fprintf(output_file, sz_test_case_fmt,
 			"Semaphore #3");
@@ -179,11 +181,12 @@ int sema_test(void)
 	for (i = 0; i < NUMBER_OF_LOOPS; i++) {
 		k_sem_give(&sem1);
 		k_sem_take(&sem2, K_FOREVER);
+		bench_stats_sample();
 	}
 
 	t = TIME_STAMP_DELTA_GET(t);
 
-	return_value += check_result(i, t);
+	return_value += check_result("sema_3", i, t);
 
 	return return_value;
 }
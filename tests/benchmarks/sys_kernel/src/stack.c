@@ -91,6 +91,7 @@ void stack_thread2(void *par1, void *par2, void *par3)
 			break;
 		}
 		(*pcounter)++;
+		bench_stats_sample();
 	}
 }
 
@@ -127,6 +128,7 @@ void stack_thread3(void *par1, void *par2, void *par3)
 			break;
 		}
 		(*pcounter)++;
+		bench_stats_sample();
 	}
 }
 
@@ -166,7 +168,7 @@ int stack_test(void)
 
 	t = TIME_STAMP_DELTA_GET(t);
 
-	return_value += check_result(i, t);
+	return_value += check_result("stack_1", i, t);
 
 	/* test get/yield & put stack functions between co-op threads */
 	fprintf(output_file, sz_test_case_fmt,
@@ -193,7 +195,7 @@ int stack_test(void)
 
 	t = TIME_STAMP_DELTA_GET(t);
 
-	return_value += check_result(i, t);
+	return_value += check_result("stack_2", i, t);
 
 	/* test get wait & put stack functions across co-op and premptive
 	 * threads
@@ -232,11 +234,12 @@ int stack_test(void)
 		if (data != 2 * i) {
 			break;
 		}
+		bench_stats_sample();
 	}
 
 	t = TIME_STAMP_DELTA_GET(t);
 
-	return_value += check_result(i * 2, t);
+	return_value += check_result("stack_3", i * 2, t);
 
 	return return_value;
 }
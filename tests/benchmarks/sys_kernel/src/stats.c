@@ -0,0 +1,116 @@
+/* stats.c */
+
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "syskernel.h"
+
+static uint32_t samples[BENCH_MAX_SAMPLES];
+static int sample_count;
+static uint32_t last_stamp;
+
+/**
+ *
+ * @brief Forget all samples and restart the sample clock
+ *
+ * @return N/A
+ */
+void bench_stats_reset(void)
+{
+	sample_count = 0;
+	last_stamp = OS_GET_TIME();
+}
+
+/**
+ *
+ * @brief Record one latency sample
+ *
+ * Samples beyond BENCH_MAX_SAMPLES are ignored.
+ *
+ * @param cycles   Duration of the measured operation in cycles.
+ *
+ * @return N/A
+ */
+void bench_stats_add(uint32_t cycles)
+{
+	if (sample_count < BENCH_MAX_SAMPLES) {
+		samples[sample_count++] = cycles;
+	}
+}
+
+/**
+ *
+ * @brief Record the time elapsed since the previous sample
+ *
+ * Used by loops where one iteration is a full round trip between threads.
+ *
+ * @return N/A
+ */
+void bench_stats_sample(void)
+{
+	uint32_t now = OS_GET_TIME();
+
+	bench_stats_add(now - last_stamp);
+	last_stamp = now;
+}
+
+static void sort_samples(void)
+{
+	int gap, i, j;
+	uint32_t tmp;
+
+	for (gap = sample_count / 2; gap > 0; gap /= 2) {
+		for (i = gap; i < sample_count; i++) {
+			tmp = samples[i];
+			for (j = i; j >= gap && samples[j - gap] > tmp;
+			     j -= gap) {
+				samples[j] = samples[j - gap];
+			}
+			samples[j] = tmp;
+		}
+	}
+}
+
+/**
+ *
+ * @brief Print min/avg/p99/max of the recorded samples
+ *
+ * Prints a human readable line, followed by one machine readable summary
+ * line that can be extracted from the console output with
+ * "grep BENCH_SUMMARY" and compared between runs.
+ *
+ * @param name   Short identifier of the test case.
+ *
+ * @return 1 if samples were recorded and 0 otherwise
+ */
+int bench_stats_report(const char *name)
+{
+	uint64_t sum = 0;
+	uint32_t p99;
+	uint32_t avg;
+	int i;
+
+	if (sample_count == 0) {
+		fprintf(output_file, sz_case_details_fmt, "no samples recorded");
+		return 0;
+	}
+
+	sort_samples();
+
+	for (i = 0; i < sample_count; i++) {
+		sum += samples[i];
+	}
+
+	avg = (uint32_t)(sum / sample_count);
+	p99 = samples[(sample_count * 99 - 1) / 100];
+
+	fprintf(output_file, sz_case_stats_fmt, samples[0], avg, p99,
+		samples[sample_count - 1], sample_count);
+	fprintf(output_file, sz_case_summary_fmt, name, samples[0], avg, p99,
+		samples[sample_count - 1], sample_count);
+
+	return 1;
+}
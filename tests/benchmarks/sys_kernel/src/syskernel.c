@@ -38,6 +38,11 @@ const char sz_case_result_fmt[] = "\nTEST RESULT: %s";
 const char sz_case_details_fmt[] = "\nDETAILS: %s";
 const char sz_case_end_fmt[] = "\nEND TEST CASE";
 const char sz_case_timing_fmt[] = "%ld nSec";
+const char sz_case_stats_fmt[] =
+	"\nCYCLES: min %u avg %u p99 %u max %u (%d samples)";
+const char sz_case_summary_fmt[] =
+	"\nBENCH_SUMMARY: test=%s min=%u avg=%u p99=%u max=%u samples=%d "
+	"unit=cycles";
 
 /* time necessary to read the time */
 uint32_t tm_off;
@@ -57,6 +62,7 @@ void begin_test(void)
 	 * tCheck static variable.
 	 */
 	bench_test_start();
+	bench_stats_reset();
 }
 
 /**
@@ -65,10 +71,11 @@ void begin_test(void)
  *
  * @return 1 if success and 0 on failure
  *
- * @param i   Number of tests.
- * @param t   Time in ticks for the whole test.
+ * @param name   Short identifier of the test case for the summary line.
+ * @param i      Number of tests.
+ * @param t      Time in ticks for the whole test.
  */
-int check_result(int i, uint32_t t)
+int check_result(const char *name, int i, uint32_t t)
 {
 	/*
 	 * bench_test_end checks tCheck static variable.
@@ -93,11 +100,39 @@ int check_result(int i, uint32_t t)
 			"Average time for 1 iteration: ");
 	fprintf(output_file, sz_case_timing_fmt,
 			SYS_CLOCK_HW_CYCLES_TO_NS_AVG(t, NUMBER_OF_LOOPS));
+	bench_stats_report(name);
 
 	fprintf(output_file, sz_case_end_fmt);
 	return 1;
 }
 
+/**
+ *
+ * @brief Checks the test timing and reports the latency samples
+ *
+ * @return 1 if success and 0 on failure
+ *
+ * @param name   Short identifier of the test case for the summary line.
+ */
+int check_stats(const char *name)
+{
+	int result;
+
+	if (bench_test_end() != 0) {
+		fprintf(output_file, sz_case_result_fmt, sz_fail);
+		fprintf(output_file, sz_case_details_fmt,
+				"timer tick happened. Results are inaccurate");
+		fprintf(output_file, sz_case_end_fmt);
+		return 0;
+	}
+
+	fprintf(output_file, sz_case_result_fmt, sz_success);
+	result = bench_stats_report(name);
+	fprintf(output_file, sz_case_end_fmt);
+
+	return result;
+}
+
 
 /**
  *
@@ -162,8 +197,10 @@ void main(void)
 			sys_kernel_version_get());
 		fprintf(output_file,
 			"\n\nEach test below is repeated %d times;\n"
-			"average time for one iteration is displayed.",
-			NUMBER_OF_LOOPS);
+			"average time for one iteration is displayed.\n"
+			"Latency of up to %d iterations is also displayed "
+			"in cycles.",
+			NUMBER_OF_LOOPS, BENCH_MAX_SAMPLES);
 
 		test_result = 0;
 
@@ -171,10 +208,21 @@ void main(void)
 		test_result += lifo_test();
 		test_result += fifo_test();
 		test_result += stack_test();
+		test_result += msgq_test();
+		test_result += pipe_test();
+		test_result += mbox_test();
+		test_result += poll_test();
+		test_result += mutex_test();
+		test_result += timer_test();
+		test_result += mem_test();
+		test_result += context_test();
 
 		if (test_result) {
-			/* sema/lifo/fifo/stack account for 12 tests in total */
-			if (test_result == 12) {
+			/*
+			 * sema/lifo/fifo/stack account for 12 tests, the
+			 * other kernel objects for 12 more
+			 */
+			if (test_result == 24) {
 				fprintf(output_file, sz_module_result_fmt,
 					sz_success);
 			} else {
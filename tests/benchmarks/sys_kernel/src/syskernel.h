@@ -17,6 +17,9 @@
 #define STACK_SIZE 2048
 #define NUMBER_OF_LOOPS 5000
 
+/* Number of per iteration latency samples kept for min/p99/max */
+#define BENCH_MAX_SAMPLES 1000
+
 extern char thread_stack1[STACK_SIZE];
 extern char thread_stack2[STACK_SIZE];
 
@@ -40,13 +43,29 @@ extern const char sz_case_result_fmt[];
 extern const char sz_case_details_fmt[];
 extern const char sz_case_end_fmt[];
 extern const char sz_case_timing_fmt[];
+extern const char sz_case_stats_fmt[];
+extern const char sz_case_summary_fmt[];
+
+int check_result(const char *name, int i, uint32_t ticks);
+int check_stats(const char *name);
 
-int check_result(int i, uint32_t ticks);
+void bench_stats_reset(void);
+void bench_stats_add(uint32_t cycles);
+void bench_stats_sample(void);
+int bench_stats_report(const char *name);
 
 int sema_test(void);
 int lifo_test(void);
 int fifo_test(void);
 int stack_test(void);
+int msgq_test(void);
+int pipe_test(void);
+int mbox_test(void);
+int poll_test(void);
+int mutex_test(void);
+int timer_test(void);
+int mem_test(void);
+int context_test(void);
 void begin_test(void);
 
 static inline uint32_t BENCH_START(void)
@@ -0,0 +1,78 @@
+/* timer.c */
+
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "syskernel.h"
+
+/*
+ * The benchmark runs with one tick per second to keep tick interrupts out of
+ * the other measurements, so only a few timer periods are sampled.
+ */
+#define TIMER_SAMPLES 10
+#define TIMER_PERIOD_TICKS 1
+
+static struct k_timer timer1;
+static uint32_t expiry_stamp;
+
+static void timer_expiry(struct k_timer *timer)
+{
+	ARG_UNUSED(timer);
+
+	expiry_stamp = OS_GET_TIME();
+}
+
+/**
+ *
+ * @brief The main test entry
+ *
+ * Each sample is the absolute difference, in cycles, between the measured
+ * interval of two consecutive timer expiries and the nominal timer period.
+ *
+ * @return 1 if success and 0 on failure
+ */
+int timer_test(void)
+{
+	uint32_t period = TIMER_PERIOD_TICKS * sys_clock_hw_cycles_per_tick;
+	uint32_t last;
+	uint32_t delta;
+	int i;
+	int return_value;
+
+	fprintf(output_file, sz_test_case_fmt,
+			"Timer #1");
+	fprintf(output_file, sz_description,
+			"\n\tk_timer_start(periodic)"
+			"\n\tk_timer_status_sync"
+			"\n\texpiry jitter in cycles");
+	printf(sz_test_start_fmt);
+
+	k_timer_init(&timer1, timer_expiry, NULL);
+
+	bench_stats_reset();
+
+	k_timer_start(&timer1, __ticks_to_ms(TIMER_PERIOD_TICKS),
+		      __ticks_to_ms(TIMER_PERIOD_TICKS));
+	k_timer_status_sync(&timer1);
+	last = expiry_stamp;
+
+	for (i = 0; i < TIMER_SAMPLES; i++) {
+		k_timer_status_sync(&timer1);
+		delta = expiry_stamp - last;
+		last = expiry_stamp;
+		bench_stats_add(delta > period ? delta - period
+					       : period - delta);
+	}
+
+	k_timer_stop(&timer1);
+
+	/* the test spans several ticks by design, skip the tick check */
+	fprintf(output_file, sz_case_result_fmt, sz_success);
+	return_value = bench_stats_report("timer_1");
+	fprintf(output_file, sz_case_end_fmt);
+
+	return return_value;
+}
@@ -15,6 +15,11 @@
 extern void test_pipe_thread2thread(void);
 extern void test_pipe_put_fail(void);
 extern void test_pipe_get_fail(void);
+extern void test_pipe_claim_wrap(void);
+extern void test_pipe_claim_thread2thread(void);
+extern void test_pipe_claim_pended_writer(void);
+extern void test_pipe_claim_pended_reader(void);
+extern void test_pipe_claim_wait_retry(void);
 
 /*test case main entry*/
 void test_main(void *p1, void *p2, void *p3)
@@ -22,6 +27,11 @@ void test_main(void *p1, void *p2, void *p3)
 	ztest_test_suite(test_pipe_api,
 		ztest_unit_test(test_pipe_thread2thread),
 		ztest_unit_test(test_pipe_put_fail),
-		ztest_unit_test(test_pipe_get_fail));
+		ztest_unit_test(test_pipe_get_fail),
+		ztest_unit_test(test_pipe_claim_wrap),
+		ztest_unit_test(test_pipe_claim_thread2thread),
+		ztest_unit_test(test_pipe_claim_pended_writer),
+		ztest_unit_test(test_pipe_claim_pended_reader),
+		ztest_unit_test(test_pipe_claim_wait_retry));
 	ztest_run_test_suite(test_pipe_api);
 }
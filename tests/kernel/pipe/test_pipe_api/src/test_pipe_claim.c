@@ -0,0 +1,307 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @addtogroup t_pipe_api
+ * @{
+ * @defgroup t_pipe_claim test_pipe_claim
+ * @brief TestPurpose: verify zero-copy access to the pipe buffer
+ * - API coverage
+ *   -# k_pipe_put_claim
+ *   -# k_pipe_put_commit
+ *   -# k_pipe_get_claim
+ *   -# k_pipe_get_finish
+ * @}
+ */
+
+#include <ztest.h>
+#include <string.h>
+
+#define STACK_SIZE 512
+#define PIPE_LEN 8
+#define STREAM_LEN 64
+#define TIMEOUT 200
+
+static unsigned char __aligned(4) claim_buf[PIPE_LEN];
+static struct k_pipe claim_pipe;
+
+static char __noinit __stack tstack[STACK_SIZE];
+static struct k_sem end_sema;
+
+static unsigned char thread_data[4];
+static size_t thread_size;
+static int thread_ret;
+
+/*test cases*/
+void test_pipe_claim_wrap(void)
+{
+	void *wr, *rd;
+	size_t size;
+
+	k_pipe_init(&claim_pipe, claim_buf, PIPE_LEN);
+
+	/**TESTPOINT: nothing to read in an empty pipe */
+	size = PIPE_LEN;
+	assert_equal(k_pipe_get_claim(&claim_pipe, &rd, &size, K_NO_WAIT),
+		     -EIO, NULL);
+
+	/**TESTPOINT: claim is bounded by the requested size */
+	size = 6;
+	assert_false(k_pipe_put_claim(&claim_pipe, &wr, &size, K_NO_WAIT),
+		     NULL);
+	assert_equal(size, 6, NULL);
+	memcpy(wr, "abcdef", 6);
+
+	/**TESTPOINT: one claim per direction */
+	size = 1;
+	assert_equal(k_pipe_put_claim(&claim_pipe, &wr, &size, K_NO_WAIT),
+		     -EBUSY, NULL);
+	assert_equal(k_pipe_put_commit(&claim_pipe, 7), -EINVAL, NULL);
+	assert_false(k_pipe_put_commit(&claim_pipe, 6), NULL);
+	assert_equal(k_pipe_put_commit(&claim_pipe, 0), -EINVAL, NULL);
+
+	/**TESTPOINT: partial release keeps the rest in the pipe */
+	size = PIPE_LEN;
+	assert_false(k_pipe_get_claim(&claim_pipe, &rd, &size, K_NO_WAIT),
+		     NULL);
+	assert_equal(size, 6, NULL);
+	assert_false(memcmp(rd, "abcdef", 6), NULL);
+	assert_false(k_pipe_get_finish(&claim_pipe, 4), NULL);
+
+	/**TESTPOINT: claimed space stops at the end of the buffer */
+	size = PIPE_LEN;
+	assert_false(k_pipe_put_claim(&claim_pipe, &wr, &size, K_NO_WAIT),
+		     NULL);
+	assert_equal(size, 2, NULL);
+	memcpy(wr, "gh", 2);
+	assert_false(k_pipe_put_commit(&claim_pipe, 2), NULL);
+
+	size = PIPE_LEN;
+	assert_false(k_pipe_put_claim(&claim_pipe, &wr, &size, K_NO_WAIT),
+		     NULL);
+	assert_equal(size, 4, NULL);
+	assert_equal_ptr(wr, claim_buf, NULL);
+	memcpy(wr, "ijkl", 4);
+	/**TESTPOINT: partial commit */
+	assert_false(k_pipe_put_commit(&claim_pipe, 3), NULL);
+
+	/**TESTPOINT: claimed data stops at the end of the buffer */
+	size = PIPE_LEN;
+	assert_false(k_pipe_get_claim(&claim_pipe, &rd, &size, K_NO_WAIT),
+		     NULL);
+	assert_equal(size, 4, NULL);
+	assert_false(memcmp(rd, "efgh", 4), NULL);
+	assert_false(k_pipe_get_finish(&claim_pipe, 4), NULL);
+
+	size = PIPE_LEN;
+	assert_false(k_pipe_get_claim(&claim_pipe, &rd, &size, K_NO_WAIT),
+		     NULL);
+	assert_equal(size, 3, NULL);
+	assert_false(memcmp(rd, "ijk", 3), NULL);
+	assert_false(k_pipe_get_finish(&claim_pipe, 3), NULL);
+}
+
+static void tclaim_producer(void *p1, void *p2, void *p3)
+{
+	unsigned char *wr;
+	size_t size;
+	int i = 0;
+
+	while (i < STREAM_LEN) {
+		size = STREAM_LEN - i;
+		assert_false(k_pipe_put_claim(&claim_pipe, (void **)&wr,
+					      &size, K_FOREVER), NULL);
+		for (int j = 0; j < size; j++) {
+			wr[j] = i + j;
+		}
+		assert_false(k_pipe_put_commit(&claim_pipe, size), NULL);
+		i += size;
+	}
+
+	k_sem_give(&end_sema);
+}
+
+void test_pipe_claim_thread2thread(void)
+{
+	unsigned char *rd;
+	unsigned char rx_data[STREAM_LEN];
+	size_t size;
+	int i = 0;
+
+	k_pipe_init(&claim_pipe, claim_buf, PIPE_LEN);
+	k_sem_init(&end_sema, 0, 1);
+
+	/**TESTPOINT: zero-copy streaming between threads*/
+	k_thread_spawn(tstack, STACK_SIZE, tclaim_producer,
+		       NULL, NULL, NULL, K_PRIO_PREEMPT(0), 0, 0);
+
+	while (i < STREAM_LEN / 2) {
+		size = 3;
+		assert_false(k_pipe_get_claim(&claim_pipe, (void **)&rd,
+					      &size, K_FOREVER), NULL);
+		for (int j = 0; j < size; j++) {
+			assert_equal(rd[j], i + j, NULL);
+		}
+		assert_false(k_pipe_get_finish(&claim_pipe, size), NULL);
+		i += size;
+	}
+
+	/**TESTPOINT: regular reader of a zero-copy writer*/
+	assert_false(k_pipe_get(&claim_pipe, rx_data, STREAM_LEN - i, &size,
+				STREAM_LEN - i, K_FOREVER), NULL);
+	for (int j = 0; j < STREAM_LEN - i; j++) {
+		assert_equal(rx_data[j], i + j, NULL);
+	}
+
+	k_sem_take(&end_sema, K_FOREVER);
+}
+
+static void tpended_writer(void *p1, void *p2, void *p3)
+{
+	size_t written;
+
+	thread_ret = k_pipe_put(&claim_pipe, "WXYZ", 4, &written, 4,
+				K_FOREVER);
+	k_sem_give(&end_sema);
+}
+
+void test_pipe_claim_pended_writer(void)
+{
+	unsigned char rx_data[PIPE_LEN];
+	void *wr, *rd;
+	size_t size;
+
+	k_pipe_init(&claim_pipe, claim_buf, PIPE_LEN);
+	k_sem_init(&end_sema, 0, 1);
+
+	assert_false(k_pipe_put(&claim_pipe, "abcdef", 6, &size, 6,
+				K_NO_WAIT), NULL);
+
+	size = PIPE_LEN;
+	assert_false(k_pipe_put_claim(&claim_pipe, &wr, &size, K_NO_WAIT),
+		     NULL);
+	assert_equal(size, 2, NULL);
+
+	/**TESTPOINT: a writer does not write into the claimed region */
+	k_thread_spawn(tstack, STACK_SIZE, tpended_writer,
+		       NULL, NULL, NULL, K_PRIO_PREEMPT(0), 0, 0);
+	k_sleep(20);
+	assert_equal(k_sem_count_get(&end_sema), 0, "writer not pended");
+
+	memcpy(wr, "gh", 2);
+
+	/**TESTPOINT: releasing data does not drain into the claimed region */
+	size = 4;
+	assert_false(k_pipe_get_claim(&claim_pipe, &rd, &size, K_NO_WAIT),
+		     NULL);
+	assert_false(memcmp(rd, "abcd", 4), NULL);
+	assert_false(k_pipe_get_finish(&claim_pipe, 4), NULL);
+	assert_false(memcmp(wr, "gh", 2), "claimed region overwritten");
+	assert_equal(k_sem_count_get(&end_sema), 0, "writer overtook claim");
+
+	/**TESTPOINT: the pended writer is served once committed */
+	assert_false(k_pipe_put_commit(&claim_pipe, 2), NULL);
+	assert_false(k_sem_take(&end_sema, TIMEOUT), NULL);
+	assert_false(thread_ret, NULL);
+
+	assert_false(k_pipe_get(&claim_pipe, rx_data, PIPE_LEN, &size,
+				PIPE_LEN, K_NO_WAIT), NULL);
+	assert_false(memcmp(rx_data, "efghWXYZ", PIPE_LEN), NULL);
+}
+
+static void tpended_reader(void *p1, void *p2, void *p3)
+{
+	thread_ret = k_pipe_get(&claim_pipe, thread_data, 4, &thread_size, 4,
+				K_FOREVER);
+	k_sem_give(&end_sema);
+}
+
+void test_pipe_claim_pended_reader(void)
+{
+	unsigned char rx_data[PIPE_LEN];
+	void *rd;
+	size_t size;
+
+	k_pipe_init(&claim_pipe, claim_buf, PIPE_LEN);
+	k_sem_init(&end_sema, 0, 1);
+
+	assert_false(k_pipe_put(&claim_pipe, "abcd", 4, &size, 4,
+				K_NO_WAIT), NULL);
+
+	size = PIPE_LEN;
+	assert_false(k_pipe_get_claim(&claim_pipe, &rd, &size, K_NO_WAIT),
+		     NULL);
+	assert_equal(size, 4, NULL);
+
+	/**TESTPOINT: a reader does not consume the claimed region */
+	k_thread_spawn(tstack, STACK_SIZE, tpended_reader,
+		       NULL, NULL, NULL, K_PRIO_PREEMPT(0), 0, 0);
+	k_sleep(20);
+	assert_equal(k_sem_count_get(&end_sema), 0, "reader not pended");
+
+	/**TESTPOINT: data put is not handed over ahead of the claim */
+	assert_false(k_pipe_put(&claim_pipe, "efgh", 4, &size, 4,
+				K_NO_WAIT), NULL);
+	k_sleep(20);
+	assert_equal(k_sem_count_get(&end_sema), 0, "reader overtook claim");
+	assert_false(memcmp(rd, "abcd", 4), "claimed region consumed");
+
+	/**TESTPOINT: the pended reader is fed once released */
+	assert_false(k_pipe_get_finish(&claim_pipe, 2), NULL);
+	assert_false(k_sem_take(&end_sema, TIMEOUT), NULL);
+	assert_false(thread_ret, NULL);
+	assert_equal(thread_size, 4, NULL);
+	assert_false(memcmp(thread_data, "cdef", 4), NULL);
+
+	assert_false(k_pipe_get(&claim_pipe, rx_data, 2, &size, 2,
+				K_NO_WAIT), NULL);
+	assert_false(memcmp(rx_data, "gh", 2), NULL);
+}
+
+static void tclaim_waiter(void *p1, void *p2, void *p3)
+{
+	void *wr;
+
+	thread_size = PIPE_LEN;
+	thread_ret = k_pipe_put_claim(&claim_pipe, &wr, &thread_size,
+				      TIMEOUT);
+	if (!thread_ret) {
+		k_pipe_put_commit(&claim_pipe, 0);
+	}
+	k_sem_give(&end_sema);
+}
+
+void test_pipe_claim_wait_retry(void)
+{
+	void *rd;
+	size_t size;
+
+	k_pipe_init(&claim_pipe, claim_buf, PIPE_LEN);
+	k_sem_init(&end_sema, 0, 1);
+
+	assert_false(k_pipe_put(&claim_pipe, "abcdefgh", PIPE_LEN, &size,
+				PIPE_LEN, K_NO_WAIT), NULL);
+
+	k_thread_spawn(tstack, STACK_SIZE, tclaim_waiter,
+		       NULL, NULL, NULL, K_PRIO_PREEMPT(0), 0, 0);
+	k_sleep(20);
+
+	/**TESTPOINT: a wakeup without space does not end the wait */
+	size = PIPE_LEN;
+	assert_false(k_pipe_get_claim(&claim_pipe, &rd, &size, K_NO_WAIT),
+		     NULL);
+	assert_false(k_pipe_get_finish(&claim_pipe, 0), NULL);
+	k_sleep(20);
+	assert_equal(k_sem_count_get(&end_sema), 0, "claim wait ended early");
+
+	size = PIPE_LEN;
+	assert_false(k_pipe_get_claim(&claim_pipe, &rd, &size, K_NO_WAIT),
+		     NULL);
+	assert_false(k_pipe_get_finish(&claim_pipe, 4), NULL);
+	assert_false(k_sem_take(&end_sema, TIMEOUT), NULL);
+	assert_false(thread_ret, NULL);
+	assert_equal(thread_size, 4, NULL);
+}
@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+#include "test_stats.h"
+
+/**
+ * @addtogroup t_threads_stats
+ * @{
+ * @defgroup t_threads_stats_api test_threads_stats_api
+ * @}
+ */
+
+/*test case main entry*/
+void test_main(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	ztest_test_suite(test_stats_api,
+		ztest_unit_test(test_stats_switches),
+		ztest_unit_test(test_stats_yield_alone),
+		ztest_unit_test(test_stats_ready_time),
+		ztest_unit_test(test_stats_stack),
+		ztest_unit_test(test_stats_foreach));
+	ztest_run_test_suite(test_stats_api);
+}
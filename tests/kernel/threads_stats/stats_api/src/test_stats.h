@@ -0,0 +1,16 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __TEST_STATS_H__
+#define __TEST_STATS_H__
+
+void test_stats_switches(void);
+void test_stats_yield_alone(void);
+void test_stats_ready_time(void);
+void test_stats_stack(void);
+void test_stats_foreach(void);
+
+#endif /* __TEST_STATS_H__ */
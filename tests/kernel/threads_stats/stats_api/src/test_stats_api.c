@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+#include <string.h>
+
+/*macro definition*/
+
+#define STACK_SIZE (512 + CONFIG_TEST_EXTRA_STACKSIZE)
+#define SLEEP_COUNT 5
+#define BUSY_WAIT_US 10000
+/* half of the busy wait, in hardware cycles */
+#define MIN_READY_CYCLES \
+	(sys_clock_hw_cycles_per_sec / (2 * USEC_PER_SEC / BUSY_WAIT_US))
+#define STACK_FILL_SIZE 128
+#define YIELD_COUNT 5
+
+/*local variables*/
+static char __stack tstack[STACK_SIZE];
+
+static void sleeper_entry(void *p1, void *p2, void *p3)
+{
+	for (int i = 0; i < SLEEP_COUNT; i++) {
+		k_sleep(1);
+	}
+}
+
+static void empty_entry(void *p1, void *p2, void *p3)
+{
+}
+
+static void yielder_entry(void *p1, void *p2, void *p3)
+{
+	for (int i = 0; i < YIELD_COUNT; i++) {
+		k_yield();
+	}
+}
+
+static void stack_entry(void *p1, void *p2, void *p3)
+{
+	volatile char buf[STACK_FILL_SIZE];
+
+	memset((char *)buf, 0, sizeof(buf));
+}
+
+static void foreach_cb(k_tid_t thread, void *user_data)
+{
+	int *found = user_data;
+
+	if (thread == k_current_get()) {
+		*found = 1;
+	}
+}
+
+/* test cases */
+/**
+ * @ingroup t_threads_stats_api
+ * @brief test that context switches and execution time are accounted
+ */
+void test_stats_switches(void)
+{
+	struct k_thread_stats stats;
+	k_tid_t tid = k_thread_spawn(tstack, STACK_SIZE,
+		sleeper_entry, NULL, NULL, NULL,
+		K_PRIO_PREEMPT(0), 0, 0);
+
+	k_sleep(100);
+
+	/** TESTPOINT: switches in and out, execution time */
+	k_thread_stats_get(tid, &stats);
+	assert_true(stats.switches_in >= SLEEP_COUNT, NULL);
+	assert_true(stats.switches_out >= SLEEP_COUNT, NULL);
+	assert_true(stats.execution_cycles > 0, NULL);
+
+	k_thread_abort(tid);
+}
+
+/**
+ * @ingroup t_threads_stats_api
+ * @brief test that returning to the running thread is not a switch
+ */
+void test_stats_yield_alone(void)
+{
+	struct k_thread_stats stats;
+	k_tid_t tid = k_thread_spawn(tstack, STACK_SIZE,
+		yielder_entry, NULL, NULL, NULL,
+		K_PRIO_PREEMPT(0), 0, 0);
+
+	/* the yielder is the only ready thread while the test thread sleeps */
+	k_sleep(10);
+
+	/** TESTPOINT: yielding with no other ready thread is not counted */
+	k_thread_stats_get(tid, &stats);
+	assert_equal(stats.switches_in, 1, NULL);
+	assert_true(stats.switches_out <= 1, NULL);
+}
+
+/**
+ * @ingroup t_threads_stats_api
+ * @brief test that the time spent ready but not running is accounted
+ */
+void test_stats_ready_time(void)
+{
+	struct k_thread_stats stats;
+	k_tid_t tid = k_thread_spawn(tstack, STACK_SIZE,
+		empty_entry, NULL, NULL, NULL,
+		K_PRIO_PREEMPT(0), 0, 0);
+
+	/* the cooperative test thread keeps the new thread waiting */
+	k_busy_wait(BUSY_WAIT_US);
+	k_sleep(10);
+
+	/** TESTPOINT: ready time covers at least half the busy wait */
+	k_thread_stats_get(tid, &stats);
+	assert_equal(stats.switches_in, 1, NULL);
+	assert_true(stats.ready_cycles >= MIN_READY_CYCLES, NULL);
+}
+
+/**
+ * @ingroup t_threads_stats_api
+ * @brief test the stack high-water mark
+ */
+void test_stats_stack(void)
+{
+	struct k_thread_stats stats;
+	k_tid_t tid = k_thread_spawn(tstack, STACK_SIZE,
+		stack_entry, NULL, NULL, NULL,
+		K_PRIO_PREEMPT(0), 0, 0);
+
+	k_sleep(10);
+
+	/** TESTPOINT: stack usage covers the thread's local buffer */
+	k_thread_stats_get(tid, &stats);
+	assert_true(stats.stack_size < STACK_SIZE, NULL);
+	assert_true(stats.stack_used >= STACK_FILL_SIZE, NULL);
+	assert_true(stats.stack_used <= stats.stack_size, NULL);
+}
+
+/**
+ * @ingroup t_threads_stats_api
+ * @brief test iterating over the threads in the system
+ */
+void test_stats_foreach(void)
+{
+	int found = 0;
+
+	/** TESTPOINT: the current thread is part of the iteration */
+	k_thread_foreach(foreach_cb, &found);
+	assert_true(found, NULL);
+}
@@ -0,0 +1,381 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+
+#include <ztest.h>
+
+#include <net/buf.h>
+#include <json.h>
+
+struct position {
+	int32_t lat;
+	int32_t lon;
+};
+
+struct reading {
+	char *sensor;
+	double value;
+};
+
+struct telemetry {
+	char *device;
+	int64_t uptime;
+	bool online;
+	struct position position;
+	int32_t samples[4];
+	size_t samples_len;
+	struct reading readings[2];
+	size_t readings_len;
+};
+
+static const struct json_obj_descr position_descr[] = {
+	JSON_OBJ_DESCR_PRIM(struct position, lat, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct position, lon, JSON_TOK_NUMBER),
+};
+
+static const struct json_obj_descr reading_descr[] = {
+	JSON_OBJ_DESCR_PRIM(struct reading, sensor, JSON_TOK_STRING),
+	JSON_OBJ_DESCR_PRIM(struct reading, value, JSON_TOK_NUMBER_FLOAT),
+};
+
+static const struct json_obj_descr telemetry_descr[] = {
+	JSON_OBJ_DESCR_PRIM(struct telemetry, device, JSON_TOK_STRING),
+	JSON_OBJ_DESCR_PRIM(struct telemetry, uptime, JSON_TOK_NUMBER_INT64),
+	JSON_OBJ_DESCR_PRIM(struct telemetry, online, JSON_TOK_TRUE),
+	JSON_OBJ_DESCR_OBJECT(struct telemetry, position, position_descr),
+	JSON_OBJ_DESCR_ARRAY(struct telemetry, samples, samples_len,
+			     JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_OBJ_ARRAY(struct telemetry, readings, readings_len,
+				 reading_descr),
+};
+
+static const char encoded[] = "{\"device\":\"node \\\"1\\\"\","
+	"\"uptime\":8589934592,\"online\":false,"
+	"\"position\":{\"lat\":-33,\"lon\":151},"
+	"\"samples\":[1,-2,3],"
+	"\"readings\":[{\"sensor\":\"temp\",\"value\":21.5},"
+	"{\"sensor\":\"bias\",\"value\":-0.25}]}";
+
+static char json[256];
+
+NET_BUF_POOL_DEFINE(json_pool, 8, 64, 0, NULL);
+
+static void test_json_decode(void)
+{
+	static const char input[] = "{\"samples\":[ 7, 8 ],"
+		"\"ignored\":{\"a\":[1,{\"b\":[]}],\"c\":\"}\"},"
+		"\"position\":{\"lon\":2,\"lat\":1},\"online\":false,"
+		"\"readings\":[{\"value\":1.5e2,\"sensor\":\"a\"}],"
+		"\"uptime\":-9223372036854775808,\"device\":\"dev\"}";
+	struct telemetry t;
+	int ret;
+
+	memset(&t, 0xff, sizeof(t));
+	strcpy(json, input);
+
+	ret = json_obj_parse(json, strlen(json), telemetry_descr,
+			     ARRAY_SIZE(telemetry_descr), &t);
+
+	/** TESTPOINT: nested objects and arrays are decoded */
+	assert_equal(ret, (1 << ARRAY_SIZE(telemetry_descr)) - 1,
+		     "Not all fields decoded");
+	assert_equal(strcmp(t.device, "dev"), 0, "Wrong string");
+	assert_true(t.uptime == INT64_MIN, "Wrong 64-bit number");
+	assert_false(t.online, "Wrong boolean");
+	assert_equal(t.position.lat, 1, "Wrong nested field");
+	assert_equal(t.position.lon, 2, "Wrong nested field");
+	assert_equal(t.samples_len, 2, "Wrong array length");
+	assert_equal(t.samples[0], 7, "Wrong array element");
+	assert_equal(t.samples[1], 8, "Wrong array element");
+	assert_equal(t.readings_len, 1, "Wrong array length");
+	assert_equal(strcmp(t.readings[0].sensor, "a"), 0,
+		     "Wrong object in array");
+	assert_true(t.readings[0].value == 150.0, "Wrong float");
+}
+
+static const struct json_obj_descr many_descr[31];
+
+static void test_json_decode_errors(void)
+{
+	struct telemetry t;
+
+	/** TESTPOINT: arrays longer than the field are rejected */
+	strcpy(json, "{\"samples\":[1,2,3,4,5]}");
+	assert_equal(json_obj_parse(json, strlen(json), telemetry_descr,
+				    ARRAY_SIZE(telemetry_descr), &t),
+		     -ENOSPC, "Array overflow not detected");
+
+	/** TESTPOINT: values of the wrong type are rejected */
+	strcpy(json, "{\"position\":[1,2]}");
+	assert_equal(json_obj_parse(json, strlen(json), telemetry_descr,
+				    ARRAY_SIZE(telemetry_descr), &t),
+		     -EINVAL, "Type mismatch not detected");
+
+	/** TESTPOINT: out of range numbers are rejected */
+	strcpy(json, "{\"uptime\":9223372036854775808}");
+	assert_equal(json_obj_parse(json, strlen(json), telemetry_descr,
+				    ARRAY_SIZE(telemetry_descr), &t),
+		     -EINVAL, "Overflow not detected");
+
+	/** TESTPOINT: descriptors with too many fields are rejected */
+	strcpy(json, "{}");
+	assert_equal(json_obj_parse(json, strlen(json), many_descr,
+				    ARRAY_SIZE(many_descr), &t),
+		     -EINVAL, "Too many fields accepted");
+}
+
+static const struct reading control = {
+	.sensor = "a\x01\n\x1f\x7f",
+	.value = 1.5,
+};
+
+static const char control_encoded[] = "{\"sensor\":"
+	"\"a\\u0001\\n\\u001f\x7f\",\"value\":1.5}";
+
+static void test_json_encode(void)
+{
+	struct telemetry t = {
+		.device = "node \"1\"",
+		.uptime = 8589934592LL,
+		.online = false,
+		.position = { .lat = -33, .lon = 151 },
+		.samples = { 1, -2, 3 },
+		.samples_len = 3,
+		.readings = {
+			{ .sensor = "temp", .value = 21.5 },
+			{ .sensor = "bias", .value = -0.25 },
+		},
+		.readings_len = 2,
+	};
+	struct telemetry decoded;
+	int ret;
+
+	ret = json_obj_encode_buf(telemetry_descr,
+				  ARRAY_SIZE(telemetry_descr), &t,
+				  json, sizeof(json));
+
+	/** TESTPOINT: the encoding matches */
+	assert_equal(ret, 0, "Cannot encode");
+	assert_equal(strcmp(json, encoded), 0, "Wrong encoding");
+	assert_equal(json_calc_encoded_len(telemetry_descr,
+					   ARRAY_SIZE(telemetry_descr),
+					   &t),
+		     sizeof(encoded) - 1, "Wrong encoded length");
+
+	/** TESTPOINT: the encoding is decoded back */
+	ret = json_obj_parse(json, strlen(json), telemetry_descr,
+			     ARRAY_SIZE(telemetry_descr), &decoded);
+	assert_true(ret > 0, "Cannot decode");
+	assert_true(decoded.uptime == t.uptime, "Wrong 64-bit number");
+	assert_equal(decoded.readings_len, 2, "Wrong array length");
+	assert_true(decoded.readings[1].value == -0.25, "Wrong float");
+
+	/** TESTPOINT: a buffer too small is reported */
+	ret = json_obj_encode_buf(telemetry_descr,
+				  ARRAY_SIZE(telemetry_descr), &t,
+				  json, sizeof(encoded) - 1);
+	assert_equal(ret, -ENOMEM, "Overflow not detected");
+
+	/** TESTPOINT: control characters are escaped */
+	ret = json_obj_encode_buf(reading_descr, ARRAY_SIZE(reading_descr),
+				  &control, json, sizeof(json));
+	assert_equal(ret, 0, "Cannot encode");
+	assert_equal(strcmp(json, control_encoded), 0, "Wrong escaping");
+	assert_equal(json_calc_encoded_len(reading_descr,
+					   ARRAY_SIZE(reading_descr),
+					   &control),
+		     sizeof(control_encoded) - 1, "Wrong encoded length");
+}
+
+static void test_json_encode_net_buf(void)
+{
+	struct telemetry t = {
+		.device = "node \"1\"",
+		.uptime = 8589934592LL,
+		.position = { .lat = -33, .lon = 151 },
+		.samples = { 1, -2, 3 },
+		.samples_len = 3,
+		.readings = {
+			{ .sensor = "temp", .value = 21.5 },
+			{ .sensor = "bias", .value = -0.25 },
+		},
+		.readings_len = 2,
+	};
+	struct net_buf *buf, *frag;
+	size_t len = 0;
+	int i;
+
+	buf = net_buf_alloc(&json_pool, K_NO_WAIT);
+	net_buf_add_mem(buf, "PUB ", 4);
+
+	for (i = 0; i < 3; i++) {
+		net_buf_frag_add(buf, net_buf_alloc(&json_pool, K_NO_WAIT));
+	}
+
+	/** TESTPOINT: the chain is filled in order without allocating */
+	assert_equal(json_obj_encode_net_buf(telemetry_descr,
+					     ARRAY_SIZE(telemetry_descr),
+					     &t, buf), 0, "Cannot encode");
+
+	for (frag = buf; frag; frag = frag->frags) {
+		memcpy(json + len, frag->data, frag->len);
+		len += frag->len;
+	}
+
+	assert_equal(len, 4 + sizeof(encoded) - 1, "Wrong length");
+	assert_equal(memcmp(json, "PUB ", 4), 0, "Data overwritten");
+	assert_equal(memcmp(json + 4, encoded, sizeof(encoded) - 1), 0,
+		     "Wrong encoding");
+
+	/** TESTPOINT: a chain too small is reported */
+	net_buf_unref(buf->frags);
+	buf->frags = NULL;
+	assert_equal(json_obj_encode_net_buf(telemetry_descr,
+					     ARRAY_SIZE(telemetry_descr),
+					     &t, buf), -ENOMEM,
+		     "Overflow not detected");
+
+	net_buf_unref(buf);
+}
+
+static char events[512];
+static size_t events_len;
+static bool in_string;
+
+static void events_append(const char *data, size_t len)
+{
+	assert_true(events_len + len < sizeof(events), "Too many events");
+
+	memcpy(events + events_len, data, len);
+	events_len += len;
+	events[events_len] = '\0';
+}
+
+/* Logs events as "<depth><type>[key=]value|", string pieces joined */
+static int stream_event(struct json_stream *stream,
+			const struct json_stream_event *event,
+			void *user_data)
+{
+	char header[2] = { '0' + event->depth, event->type };
+
+	if (!in_string) {
+		events_append(header, sizeof(header));
+
+		if (event->key) {
+			events_append(event->key, event->key_len);
+			events_append("=", 1);
+		}
+	}
+
+	if (event->value) {
+		events_append(event->value, event->value_len);
+	}
+
+	in_string = event->partial;
+	if (!in_string) {
+		events_append("|", 1);
+	}
+
+	return 0;
+}
+
+static void test_json_stream(void)
+{
+	static const char * const bad_numbers[] = {
+		"[-]", "[1-2]", "[1e]", "[1.2.3]", "[01]", "[1.]", "[-.5]",
+		"[1e+]", "[1e2.5]", "[2E-3e1]", "[-x]",
+	};
+	static const char expected[] = "0{|1\"device=node \\\"1\\\"|"
+		"10uptime=8589934592|1tonline=true|1[samples=|20-1.5e3|"
+		"2nnull|2{|3\"k=\\u00e9|2}|1]|1{position=|"
+		"20lat=-33|1}|0}|";
+	static const char input[] = " {\"device\":\"node \\\"1\\\"\","
+		"\"uptime\" : 8589934592, \"online\":true,"
+		"\"samples\":[-1.5e3,null,{\"k\":\"\\u00e9\"}],"
+		"\"position\":{\"lat\":-33}} \r\n";
+	struct json_stream stream;
+	struct net_buf *buf, *frag;
+	size_t split, len, i;
+	int ret;
+
+	/** TESTPOINT: events do not depend on where the document is split */
+	for (split = 1; split < sizeof(input) - 1; split++) {
+		events_len = 0;
+		json_stream_init(&stream, stream_event, NULL);
+
+		for (i = 0; i < sizeof(input) - 1; i += split) {
+			len = min(split, sizeof(input) - 1 - i);
+			ret = json_stream_feed(&stream, input + i, len);
+			assert_true(ret >= 0, "Cannot parse");
+		}
+
+		assert_equal(ret, 1, "Document not complete");
+		assert_equal(strcmp(events, expected), 0, "Wrong events");
+	}
+
+	/** TESTPOINT: a net_buf chain is parsed in place */
+	buf = net_buf_alloc(&json_pool, K_NO_WAIT);
+	net_buf_add_mem(buf, "MSG ", 4);
+
+	for (i = 0; i < sizeof(input) - 1; i += 50) {
+		frag = net_buf_alloc(&json_pool, K_NO_WAIT);
+		net_buf_add_mem(frag, input + i,
+				min(50, sizeof(input) - 1 - i));
+		net_buf_frag_add(buf, frag);
+	}
+
+	events_len = 0;
+	json_stream_init(&stream, stream_event, NULL);
+	assert_equal(json_stream_feed_net_buf(&stream, buf, 4), 1,
+		     "Cannot parse");
+	assert_equal(strcmp(events, expected), 0, "Wrong events");
+
+	net_buf_unref(buf);
+
+	/** TESTPOINT: malformed documents are reported */
+	json_stream_init(&stream, stream_event, NULL);
+	assert_equal(json_stream_feed(&stream, "{\"a\":[1}", 9), -EINVAL,
+		     "Mismatched bracket not detected");
+	assert_equal(json_stream_feed(&stream, "]}", 2), -EINVAL,
+		     "Error not kept");
+
+	json_stream_init(&stream, stream_event, NULL);
+	assert_equal(json_stream_feed(&stream, "{} x", 4), -EINVAL,
+		     "Trailing data not detected");
+
+	/** TESTPOINT: numbers follow the JSON grammar */
+	for (i = 0; i < ARRAY_SIZE(bad_numbers); i++) {
+		json_stream_init(&stream, stream_event, NULL);
+		assert_equal(json_stream_feed(&stream, bad_numbers[i],
+					      strlen(bad_numbers[i])),
+			     -EINVAL, "Malformed number not detected");
+	}
+
+	events_len = 0;
+	json_stream_init(&stream, stream_event, NULL);
+	assert_equal(json_stream_feed(&stream, "[0,-0.5E+10,10e-2]", 18), 1,
+		     "Valid numbers rejected");
+	assert_equal(strcmp(events, "0[|10|10-0.5E+10|1010e-2|0]|"), 0,
+		     "Wrong number events");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(lib_json_test,
+			 ztest_unit_test(test_json_decode),
+			 ztest_unit_test(test_json_decode_errors),
+			 ztest_unit_test(test_json_encode),
+			 ztest_unit_test(test_json_encode_net_buf),
+			 ztest_unit_test(test_json_stream)
+			 );
+
+	ztest_run_test_suite(lib_json_test);
+}
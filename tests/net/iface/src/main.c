@@ -136,11 +136,35 @@ struct net_if_test net_iface1_data;
 struct net_if_test net_iface2_data;
 struct net_if_test net_iface3_data;
 
+static int max_batch;
+
+static int sender_iface_batch(struct net_if *iface, struct net_buf **bufs,
+			      int count)
+{
+	int i;
+
+	if (count > max_batch) {
+		max_batch = count;
+	}
+
+	for (i = 0; i < count; i++) {
+		sender_iface(iface, bufs[i]);
+	}
+
+	return count;
+}
+
 static struct net_if_api net_iface_api = {
 	.init = net_iface_init,
 	.send = sender_iface,
 };
 
+static struct net_if_api net_iface_batch_api = {
+	.init = net_iface_init,
+	.send = sender_iface,
+	.send_batch = sender_iface_batch,
+};
+
 #define _ETH_L2_LAYER DUMMY_L2
 #define _ETH_L2_CTX_TYPE NET_L2_GET_CTX_TYPE(DUMMY_L2)
 
@@ -175,7 +199,7 @@ NET_DEVICE_INIT_INSTANCE(net_iface3_test,
 			 &net_iface3_data,
 			 NULL,
 			 CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
-			 &net_iface_api,
+			 &net_iface_batch_api,
 			 _ETH_L2_LAYER,
 			 _ETH_L2_CTX_TYPE,
 			 127);
@@ -336,6 +360,37 @@ static void send_iface3(void)
 	assert_true(ret, "iface 3");
 }
 
+#define BATCH_COUNT 4
+
+static void send_iface3_batch(void)
+{
+	static uint8_t data[] = { 't', 'e', 's', 't', '\0' };
+	struct net_buf *buf;
+	int i;
+
+	DBG("Sending %d packets to iface 3 %p\n", BATCH_COUNT, iface3);
+
+	max_batch = 0;
+
+	/* The TX thread only runs once all the packets are queued */
+	for (i = 0; i < BATCH_COUNT; i++) {
+		buf = net_nbuf_get_reserve_tx(0, K_FOREVER);
+		net_nbuf_set_iface(buf, iface3);
+
+		net_nbuf_append(buf, sizeof(data), data, K_FOREVER);
+
+		assert_true(net_send_data(buf) >= 0, "send iface 3");
+	}
+
+	for (i = 0; i < BATCH_COUNT; i++) {
+		assert_equal(k_sem_take(&wait_data, WAIT_TIME), 0,
+			     "iface 3 batch timeout");
+	}
+
+	assert_equal(max_batch, min(BATCH_COUNT, CONFIG_NET_TX_BATCH_SIZE),
+		     "iface 3 batch size");
+}
+
 static void send_iface1_down(void)
 {
 	bool ret;
@@ -369,6 +424,7 @@ void test_main(void)
 			 ztest_unit_test(send_iface1),
 			 ztest_unit_test(send_iface2),
 			 ztest_unit_test(send_iface3),
+			 ztest_unit_test(send_iface3_batch),
 			 ztest_unit_test(send_iface1_down),
 			 ztest_unit_test(send_iface1_up)
 			 );
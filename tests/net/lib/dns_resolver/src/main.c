@@ -0,0 +1,449 @@
+/* main.c - Application main entry point */
+
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <misc/printk.h>
+#include <sections.h>
+
+#include <ztest.h>
+
+#include <net/ethernet.h>
+#include <net/buf.h>
+#include <net/nbuf.h>
+#include <net/net_ip.h>
+#include <net/net_if.h>
+#include <net/net_context.h>
+#include <net/dns_client.h>
+
+#include "udp.h"
+#include "net_private.h"
+
+#define MY_PORT 4242
+#define DNS_PORT 53
+
+#define NAME "www.example.com"
+#define NX_NAME "nx.example.com"
+#define OTHER_NAME "other.example.com"
+
+#define ANSWER_TTL 300
+#define MAX_SENT 8
+#define MAX_RESULTS 4
+#define MSG_SIZE 128
+
+#define TIMEOUT 300
+#define WAIT_TIME 50
+
+static struct in6_addr my_addr = { { { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0,
+				       0, 0, 0, 0, 0, 0, 0, 0x1 } } };
+static struct in6_addr peer_addr = { { { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0,
+					 0, 0, 0, 0, 0, 0, 0, 0x2 } } };
+
+static const uint8_t ipv4_addr[] = { 192, 0, 2, 10 };
+static const uint8_t ipv6_addr[] = { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0,
+				     0, 0, 0, 0, 0, 0, 0, 0x10 };
+
+static struct net_if *iface;
+static struct sockaddr_in6 server = {
+	.sin6_family = AF_INET6,
+};
+static struct dns_resolver resolver;
+
+/* Transaction identifier and query type of the queries sent */
+static uint16_t sent_id[MAX_SENT];
+static uint16_t sent_type[MAX_SENT];
+static int sent;
+
+struct result {
+	int status;
+	uint16_t query_type;
+	uint8_t items;
+	uint8_t addr[sizeof(struct in6_addr)];
+};
+
+static struct result results[MAX_RESULTS];
+static int callbacks;
+
+static uint8_t msg[MSG_SIZE];
+
+struct dummy_context {
+	uint8_t mac_addr[sizeof(struct net_eth_addr)];
+};
+
+static struct dummy_context dummy_context_data;
+
+static int dummy_dev_init(struct device *dev)
+{
+	return 0;
+}
+
+static void dummy_iface_init(struct net_if *iface)
+{
+	struct dummy_context *context =
+		net_if_get_device(iface)->driver_data;
+
+	/* 10-00-00-00-00 to 10-00-00-00-FF Documentation RFC7042 */
+	context->mac_addr[0] = 0x10;
+	context->mac_addr[5] = 0x01;
+
+	net_if_set_link_addr(iface, context->mac_addr,
+			     sizeof(context->mac_addr), NET_LINK_ETHERNET);
+}
+
+static int dummy_send(struct net_if *iface, struct net_buf *buf)
+{
+	struct net_nbuf_cursor cur;
+	uint8_t label = 0;
+	uint16_t id = 0;
+	uint16_t type = 0;
+
+	net_nbuf_cursor_init(&cur, buf->frags, sizeof(struct net_ipv6_hdr) +
+			     sizeof(struct net_udp_hdr), UINT16_MAX);
+
+	/* Skip the rest of the header and the QNAME */
+	net_nbuf_cursor_read_be16(&cur, &id);
+	net_nbuf_cursor_skip(&cur, 10);
+
+	do {
+		if (net_nbuf_cursor_read_u8(&cur, &label) < 0) {
+			break;
+		}
+
+		net_nbuf_cursor_skip(&cur, label);
+	} while (label);
+
+	net_nbuf_cursor_read_be16(&cur, &type);
+
+	if (sent < MAX_SENT) {
+		sent_id[sent] = id;
+		sent_type[sent] = type;
+		sent++;
+	}
+
+	net_nbuf_unref(buf);
+
+	return 0;
+}
+
+static struct net_if_api dummy_if_api = {
+	.init = dummy_iface_init,
+	.send = dummy_send,
+};
+
+#define _ETH_L2_LAYER DUMMY_L2
+#define _ETH_L2_CTX_TYPE NET_L2_GET_CTX_TYPE(DUMMY_L2)
+
+NET_DEVICE_INIT(dns_resolver_test, "dns_resolver_test",
+		dummy_dev_init, &dummy_context_data, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+		&dummy_if_api, _ETH_L2_LAYER, _ETH_L2_CTX_TYPE, 127);
+
+static void resolve_cb(struct dns_resolver *resolver, int status,
+		       struct dns_addrinfo *info, void *user_data)
+{
+	struct result *result;
+
+	if (callbacks >= MAX_RESULTS) {
+		return;
+	}
+
+	result = &results[callbacks++];
+	result->status = status;
+	result->query_type = info->query_type;
+	result->items = info->items;
+
+	if (info->items > 0) {
+		memcpy(result->addr, &info->address,
+		       info->query_type == DNS_QUERY_TYPE_A ?
+		       sizeof(ipv4_addr) : sizeof(ipv6_addr));
+	}
+}
+
+static void datagram_send(const uint8_t *data, uint16_t len)
+{
+	struct net_buf *buf;
+	struct net_buf *frag;
+
+	buf = net_nbuf_get_reserve_rx(0, K_FOREVER);
+	frag = net_nbuf_get_reserve_data(0, K_FOREVER);
+	net_buf_frag_add(buf, frag);
+
+	net_nbuf_set_iface(buf, iface);
+	net_nbuf_set_family(buf, AF_INET6);
+	net_nbuf_set_ll_reserve(buf, net_buf_headroom(frag));
+
+	NET_IPV6_BUF(buf)->vtc = 0x60;
+	NET_IPV6_BUF(buf)->tcflow = 0;
+	NET_IPV6_BUF(buf)->flow = 0;
+	NET_IPV6_BUF(buf)->len[0] = (NET_UDPH_LEN + len) >> 8;
+	NET_IPV6_BUF(buf)->len[1] = (NET_UDPH_LEN + len) & 0xff;
+
+	NET_IPV6_BUF(buf)->nexthdr = IPPROTO_UDP;
+	NET_IPV6_BUF(buf)->hop_limit = 255;
+
+	net_ipaddr_copy(&NET_IPV6_BUF(buf)->src, &peer_addr);
+	net_ipaddr_copy(&NET_IPV6_BUF(buf)->dst, &my_addr);
+
+	net_nbuf_set_ip_hdr_len(buf, sizeof(struct net_ipv6_hdr));
+	net_nbuf_set_ext_len(buf, 0);
+
+	NET_UDP_BUF(buf)->src_port = htons(DNS_PORT);
+	NET_UDP_BUF(buf)->dst_port = htons(MY_PORT);
+	NET_UDP_BUF(buf)->len = htons(NET_UDPH_LEN + len);
+	NET_UDP_BUF(buf)->chksum = 0;
+
+	net_buf_add(frag, net_nbuf_ip_hdr_len(buf) +
+			  sizeof(struct net_udp_hdr));
+
+	assert_true(net_nbuf_append(buf, len, data, K_FOREVER),
+		    "Cannot append data");
+
+	assert_equal(net_recv_data(iface, buf), 0, "Cannot queue packet");
+
+	k_sleep(WAIT_TIME);
+}
+
+/* Sends the answer to a query, without address when addr is NULL */
+static void answer_send(uint16_t id, uint8_t rcode, const char *name,
+			uint16_t type, const uint8_t *addr)
+{
+	uint16_t addr_len = type == DNS_QUERY_TYPE_A ? sizeof(ipv4_addr) :
+			    sizeof(ipv6_addr);
+	const char *label = name;
+	uint16_t len = 0;
+	const char *dot;
+
+	msg[len++] = id >> 8;
+	msg[len++] = id & 0xff;
+	/* QR and RD, RA and RCODE */
+	msg[len++] = 0x81;
+	msg[len++] = 0x80 | rcode;
+	/* QDCOUNT, ANCOUNT, NSCOUNT and ARCOUNT */
+	msg[len++] = 0;
+	msg[len++] = 1;
+	msg[len++] = 0;
+	msg[len++] = addr ? 1 : 0;
+	memset(msg + len, 0, 4);
+	len += 4;
+
+	do {
+		dot = strchr(label, '.');
+		if (!dot) {
+			dot = label + strlen(label);
+		}
+
+		msg[len++] = dot - label;
+		memcpy(msg + len, label, dot - label);
+		len += dot - label;
+		label = dot + 1;
+	} while (*dot);
+
+	msg[len++] = 0;
+	msg[len++] = type >> 8;
+	msg[len++] = type & 0xff;
+	msg[len++] = 0;
+	msg[len++] = 1;
+
+	if (addr) {
+		/* Pointer to the QNAME, type, class, TTL and RDLENGTH */
+		msg[len++] = 0xc0;
+		msg[len++] = 0x0c;
+		msg[len++] = type >> 8;
+		msg[len++] = type & 0xff;
+		msg[len++] = 0;
+		msg[len++] = 1;
+		msg[len++] = 0;
+		msg[len++] = 0;
+		msg[len++] = ANSWER_TTL >> 8;
+		msg[len++] = ANSWER_TTL & 0xff;
+		msg[len++] = 0;
+		msg[len++] = addr_len;
+		memcpy(msg + len, addr, addr_len);
+		len += addr_len;
+	}
+
+	datagram_send(msg, len);
+}
+
+static void dns_resolver_setup(void)
+{
+	struct sockaddr_in6 addr = {
+		.sin6_family = AF_INET6,
+		.sin6_port = htons(MY_PORT),
+	};
+	int ret;
+
+	iface = net_if_get_default();
+
+	assert_not_null(net_if_ipv6_addr_add(iface, &my_addr, NET_ADDR_MANUAL,
+					     0), "Cannot add IPv6 address");
+
+	ret = net_context_get(AF_INET6, SOCK_DGRAM, IPPROTO_UDP,
+			      &resolver.net_ctx);
+	assert_equal(ret, 0, "Cannot get context");
+
+	net_ipaddr_copy(&addr.sin6_addr, &my_addr);
+
+	ret = net_context_bind(resolver.net_ctx, (struct sockaddr *)&addr,
+			       sizeof(addr));
+	assert_equal(ret, 0, "Cannot bind context");
+
+	net_ipaddr_copy(&server.sin6_addr, &peer_addr);
+	server.sin6_port = htons(DNS_PORT);
+
+	resolver.dns_server = (struct sockaddr *)&server;
+	resolver.timeout = TIMEOUT;
+
+	ret = dns_resolver_init(&resolver);
+	assert_equal(ret, 0, "Cannot init resolver");
+}
+
+static void dns_resolver_parallel(void)
+{
+	int ret;
+
+	/** TESTPOINT: the A and AAAA queries are sent at the same time */
+	ret = dns_resolve_async(&resolver, NAME, AF_UNSPEC, resolve_cb, NULL);
+	assert_equal(ret, 0, "Cannot resolve");
+
+	k_sleep(WAIT_TIME);
+
+	assert_equal(sent, 2, "Queries not sent");
+	assert_not_equal(sent_type[0], sent_type[1], "Same query type sent");
+	assert_not_equal(sent_id[0], sent_id[1], "Same identifier sent");
+
+	/** TESTPOINT: an answer that matches no query is dropped */
+	answer_send(sent_id[0] ^ sent_id[1] ^ 0x5a5a, 0, NAME,
+		    DNS_QUERY_TYPE_A, ipv4_addr);
+	assert_equal(callbacks, 0, "Unknown answer reported");
+
+	/** TESTPOINT: answers are matched by identifier, in any order */
+	if (sent_type[0] == DNS_QUERY_TYPE_A) {
+		answer_send(sent_id[1], 0, NAME, DNS_QUERY_TYPE_AAAA,
+			    ipv6_addr);
+		answer_send(sent_id[0], 0, NAME, DNS_QUERY_TYPE_A, ipv4_addr);
+	} else {
+		answer_send(sent_id[0], 0, NAME, DNS_QUERY_TYPE_AAAA,
+			    ipv6_addr);
+		answer_send(sent_id[1], 0, NAME, DNS_QUERY_TYPE_A, ipv4_addr);
+	}
+
+	assert_equal(callbacks, 2, "Answers not reported");
+
+	assert_equal(results[0].status, 0, "AAAA query failed");
+	assert_equal(results[0].query_type, DNS_QUERY_TYPE_AAAA, "Wrong type");
+	assert_equal(results[0].items, 1, "Wrong number of addresses");
+	assert_equal(memcmp(results[0].addr, ipv6_addr, sizeof(ipv6_addr)), 0,
+		     "Wrong IPv6 address");
+
+	assert_equal(results[1].status, 0, "A query failed");
+	assert_equal(results[1].query_type, DNS_QUERY_TYPE_A, "Wrong type");
+	assert_equal(results[1].items, 1, "Wrong number of addresses");
+	assert_equal(memcmp(results[1].addr, ipv4_addr, sizeof(ipv4_addr)), 0,
+		     "Wrong IPv4 address");
+}
+
+static void dns_resolver_cached(void)
+{
+	int ret;
+
+	sent = 0;
+	callbacks = 0;
+
+	/** TESTPOINT: cached answers are reported without query */
+	ret = dns_resolve_async(&resolver, NAME, AF_INET, resolve_cb, NULL);
+	assert_equal(ret, 0, "Cannot resolve");
+	assert_equal(callbacks, 1, "Cached answer not reported");
+
+	k_sleep(WAIT_TIME);
+	assert_equal(sent, 0, "Query sent for a cached name");
+
+	assert_equal(results[0].status, 0, "Cached query failed");
+	assert_equal(results[0].items, 1, "Wrong number of addresses");
+	assert_equal(memcmp(results[0].addr, ipv4_addr, sizeof(ipv4_addr)), 0,
+		     "Wrong IPv4 address");
+}
+
+static void dns_resolver_negative(void)
+{
+	int ret;
+
+	sent = 0;
+	callbacks = 0;
+
+	ret = dns_resolve_async(&resolver, NX_NAME, AF_INET6, resolve_cb,
+				NULL);
+	assert_equal(ret, 0, "Cannot resolve");
+
+	k_sleep(WAIT_TIME);
+	assert_equal(sent, 1, "Query not sent");
+
+	/** TESTPOINT: a name that does not exist is reported */
+	answer_send(sent_id[0], 3, NX_NAME, DNS_QUERY_TYPE_AAAA, NULL);
+	assert_equal(callbacks, 1, "Answer not reported");
+	assert_equal(results[0].status, -ENOENT, "Wrong status");
+
+	/** TESTPOINT: the name is cached as non-existent */
+	ret = dns_resolve_async(&resolver, NX_NAME, AF_INET6, resolve_cb,
+				NULL);
+	assert_equal(ret, 0, "Cannot resolve");
+	assert_equal(callbacks, 2, "Cached answer not reported");
+	assert_equal(results[1].status, -ENOENT, "Wrong cached status");
+
+	k_sleep(WAIT_TIME);
+	assert_equal(sent, 1, "Query sent for a cached name");
+}
+
+static void dns_resolver_timeout(void)
+{
+	int ret;
+
+	sent = 0;
+	callbacks = 0;
+
+	dns_cache_flush();
+
+	/** TESTPOINT: the queries are sent again after a cache flush */
+	ret = dns_resolve_async(&resolver, NAME, AF_UNSPEC, resolve_cb, NULL);
+	assert_equal(ret, 0, "Cannot resolve");
+
+	k_sleep(WAIT_TIME);
+	assert_equal(sent, 2, "Queries not sent");
+
+	/** TESTPOINT: the number of outstanding queries is bounded */
+	ret = dns_resolve_async(&resolver, OTHER_NAME, AF_INET, resolve_cb,
+				NULL);
+	assert_equal(ret, -EAGAIN, "Too many queries accepted");
+
+	/** TESTPOINT: the queries without answer time out */
+	k_sleep(TIMEOUT);
+	assert_equal(callbacks, 2, "Timeouts not reported");
+	assert_equal(results[0].status, -ETIMEDOUT, "Wrong status");
+	assert_equal(results[1].status, -ETIMEDOUT, "Wrong status");
+
+	/** TESTPOINT: the late answer is dropped */
+	answer_send(sent_id[0], 0, NAME, sent_type[0],
+		    sent_type[0] == DNS_QUERY_TYPE_A ? ipv4_addr : ipv6_addr);
+	assert_equal(callbacks, 2, "Late answer reported");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_dns_resolver_test,
+			 ztest_unit_test(dns_resolver_setup),
+			 ztest_unit_test(dns_resolver_parallel),
+			 ztest_unit_test(dns_resolver_cached),
+			 ztest_unit_test(dns_resolver_negative),
+			 ztest_unit_test(dns_resolver_timeout)
+			 );
+
+	ztest_run_test_suite(net_dns_resolver_test);
+}
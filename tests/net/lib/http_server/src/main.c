@@ -0,0 +1,483 @@
+/* main.c - Application main entry point */
+
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <misc/printk.h>
+#include <misc/byteorder.h>
+#include <sections.h>
+
+#include <ztest.h>
+
+#include <net/ethernet.h>
+#include <net/buf.h>
+#include <net/nbuf.h>
+#include <net/net_ip.h>
+#include <net/net_if.h>
+#include <net/http_server.h>
+
+#include "tcp.h"
+
+#define MY_PORT 8080
+
+/* Time given to the stack and the server thread to handle a segment */
+#define WAIT_TIME K_MSEC(100)
+
+#define UPLOAD_MAX 8
+
+static const char index_html[] = "<html></html>";
+
+static int handler(struct http_server_conn *conn,
+		   const struct http_server_request *req)
+{
+	return 0;
+}
+
+static int upload_body(struct http_server_conn *conn,
+		       const struct http_server_request *req,
+		       const char *data, size_t len)
+{
+	return len > UPLOAD_MAX ? -EFBIG : 0;
+}
+
+static const struct http_server_route routes[] = {
+	HTTP_SERVER_ROUTE_STATIC("/index.html", "text/html", index_html,
+				 sizeof(index_html) - 1),
+	HTTP_SERVER_ROUTE("/images", HTTP_SERVER_ROUTE_PREFIX, handler, NULL),
+	HTTP_SERVER_ROUTE("/docs/", HTTP_SERVER_ROUTE_PREFIX, handler, NULL),
+	HTTP_SERVER_ROUTE("/metrics", 0, handler, NULL),
+	HTTP_SERVER_ROUTE("/upload", 0, handler, upload_body),
+	HTTP_SERVER_ROUTE("/", HTTP_SERVER_ROUTE_PREFIX, handler, NULL),
+};
+
+static const struct {
+	const char *url;
+	int route;
+} matches[] = {
+	{ "/index.html", 0 },
+	{ "/index.html?lang=en", 0 },
+	{ "/images", 1 },
+	{ "/images/", 1 },
+	{ "/images/img.png", 1 },
+	{ "/images?size=2", 1 },
+	{ "/docs/", 2 },
+	{ "/docs/api/index.html", 2 },
+	{ "/metrics", 3 },
+	{ "/metrics?format=text", 3 },
+	{ "/upload", 4 },
+	/* Left to the catch-all route */
+	{ "/index.htmlx", 5 },
+	{ "/index.html/", 5 },
+	{ "/images_and_docs", 5 },
+	{ "/docs", 5 },
+	{ "/metrics/cpu", 5 },
+	{ "/", 5 },
+};
+
+#define INDEX_RSP "HTTP/1.1 200 OK\r\n"				\
+		  "Content-Type: text/html\r\n"			\
+		  "Content-Length: 13\r\n\r\n"			\
+		  "<html></html>"
+#define NO_CONTENT_RSP "HTTP/1.1 204 No Content\r\n"			\
+		       "Content-Length: 0\r\n\r\n"
+
+static struct in6_addr my_addr = { { { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0,
+				       0, 0, 0, 0, 0, 0, 0, 0x1 } } };
+static struct in6_addr peer_addr = { { { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0,
+					 0, 0, 0, 0, 0, 0, 0, 0x2 } } };
+
+/* Client side of the connections, played by the test */
+static struct {
+	uint16_t port;
+	/* Sequence number of the next segment sent */
+	uint32_t seq;
+	/* Initial sequence number of the server */
+	uint32_t isn;
+	bool syn_ack;
+	bool fin;
+	/* Data received from the server, and how much has been checked */
+	size_t rsp_len;
+	size_t rsp_read;
+	char rsp[512];
+} peer = {
+	.port = 40000,
+};
+
+static struct http_server server;
+
+struct dummy_context {
+	uint8_t mac_addr[sizeof(struct net_eth_addr)];
+};
+
+static struct dummy_context dummy_context_data;
+
+static int dummy_dev_init(struct device *dev)
+{
+	return 0;
+}
+
+static void dummy_iface_init(struct net_if *iface)
+{
+	struct dummy_context *context =
+		net_if_get_device(iface)->driver_data;
+
+	/* 10-00-00-00-00 to 10-00-00-00-FF Documentation RFC7042 */
+	context->mac_addr[0] = 0x10;
+	context->mac_addr[5] = 0x01;
+
+	net_if_set_link_addr(iface, context->mac_addr,
+			     sizeof(context->mac_addr), NET_LINK_ETHERNET);
+}
+
+/* Collects what the server sends to the test client */
+static int dummy_send(struct net_if *iface, struct net_buf *buf)
+{
+	struct net_tcp_hdr *tcp = NET_TCP_BUF(buf);
+	uint16_t hdr_len, pos;
+	uint32_t offset;
+	size_t len;
+
+	if (NET_IPV6_BUF(buf)->nexthdr != IPPROTO_TCP ||
+	    tcp->dst_port != htons(peer.port)) {
+		goto out;
+	}
+
+	if (tcp->flags & NET_TCP_SYN) {
+		peer.isn = sys_get_be32(tcp->seq);
+		peer.syn_ack = true;
+		goto out;
+	}
+
+	hdr_len = net_nbuf_ip_hdr_len(buf) + 4 * (tcp->offset >> 4);
+	len = net_buf_frags_len(buf->frags) - hdr_len;
+	offset = sys_get_be32(tcp->seq) - peer.isn - 1;
+
+	/* A retransmitted segment lands where the original one did */
+	if (len && offset + len <= sizeof(peer.rsp)) {
+		net_nbuf_read(buf->frags, hdr_len, &pos, len,
+			      (uint8_t *)peer.rsp + offset);
+		peer.rsp_len = max(peer.rsp_len, offset + len);
+	}
+
+	if (tcp->flags & NET_TCP_FIN) {
+		peer.fin = true;
+	}
+
+out:
+	net_nbuf_unref(buf);
+
+	return 0;
+}
+
+static struct net_if_api dummy_if_api = {
+	.init = dummy_iface_init,
+	.send = dummy_send,
+};
+
+#define _ETH_L2_LAYER DUMMY_L2
+#define _ETH_L2_CTX_TYPE NET_L2_GET_CTX_TYPE(DUMMY_L2)
+
+NET_DEVICE_INIT(http_server_test, "http_server_test",
+		dummy_dev_init, &dummy_context_data, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+		&dummy_if_api, _ETH_L2_LAYER, _ETH_L2_CTX_TYPE, 127);
+
+static void http_server_init_params(void)
+{
+	assert_equal(http_server_init(NULL, routes, ARRAY_SIZE(routes)),
+		     -EINVAL, "NULL server accepted");
+	assert_equal(http_server_init(&server, NULL, 1), -EINVAL,
+		     "NULL routes accepted");
+
+	assert_equal(http_server_init(&server, NULL, 0), 0,
+		     "Server without routes rejected");
+	assert_is_null(http_server_route_find(&server, "/", 1),
+		       "Route found in an empty table");
+
+	assert_equal(http_server_init(&server, routes, ARRAY_SIZE(routes)),
+		     0, "Cannot init server");
+}
+
+static void http_server_routes(void)
+{
+	const struct http_server_route *route;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(matches); i++) {
+		route = http_server_route_find(&server, matches[i].url,
+					       strlen(matches[i].url));
+
+		TC_PRINT("%s -> %s\n", matches[i].url,
+			 route ? route->url : "(none)");
+
+		assert_equal_ptr(route, &routes[matches[i].route],
+				 "Wrong route");
+	}
+
+	/* Without the catch-all route */
+	server.routes_len--;
+
+	route = http_server_route_find(&server, "/images_and_docs",
+				       strlen("/images_and_docs"));
+	assert_is_null(route, "Route found for an unknown URL");
+
+	server.routes_len++;
+}
+
+static void http_server_start_stop(void)
+{
+	struct sockaddr_in6 addr = { 0 };
+
+	addr.sin6_family = AF_INET6;
+	addr.sin6_port = htons(MY_PORT);
+
+	assert_equal(http_server_start(&server, (struct sockaddr *)&addr,
+				       sizeof(addr)), 0, "Cannot start server");
+	assert_equal(http_server_start(&server, (struct sockaddr *)&addr,
+				       sizeof(addr)), -EALREADY,
+		     "Server started twice");
+
+	assert_equal(http_server_stop(&server), 0, "Cannot stop server");
+	assert_equal(http_server_stop(&server), -EALREADY,
+		     "Server stopped twice");
+
+	/* The port is free again */
+	assert_equal(http_server_start(&server, (struct sockaddr *)&addr,
+				       sizeof(addr)), 0,
+		     "Cannot restart server");
+	assert_equal(http_server_stop(&server), 0, "Cannot stop server");
+}
+
+/* Sends a segment from the test client, its data split in fragments of
+ * frag_len bytes, and lets the server handle it.
+ */
+static void peer_send(uint8_t flags, const char *data, size_t frag_len)
+{
+	struct net_if *iface = net_if_get_default();
+	size_t len = data ? strlen(data) : 0;
+	struct net_buf *buf, *frag;
+	struct net_tcp_hdr *tcp;
+	size_t chunk;
+
+	buf = net_nbuf_get_reserve_rx(0, K_FOREVER);
+	frag = net_nbuf_get_reserve_data(0, K_FOREVER);
+	net_buf_frag_add(buf, frag);
+
+	net_nbuf_set_iface(buf, iface);
+	net_nbuf_set_ll_reserve(buf, net_buf_headroom(frag));
+	net_nbuf_set_ip_hdr_len(buf, sizeof(struct net_ipv6_hdr));
+	net_nbuf_set_ext_len(buf, 0);
+
+	net_buf_add(frag, sizeof(struct net_ipv6_hdr) + NET_TCPH_LEN);
+	memset(frag->data, 0, frag->len);
+
+	NET_IPV6_BUF(buf)->vtc = 0x60;
+	NET_IPV6_BUF(buf)->len[0] = (NET_TCPH_LEN + len) >> 8;
+	NET_IPV6_BUF(buf)->len[1] = (NET_TCPH_LEN + len) & 0xff;
+	NET_IPV6_BUF(buf)->nexthdr = IPPROTO_TCP;
+	NET_IPV6_BUF(buf)->hop_limit = 255;
+	net_ipaddr_copy(&NET_IPV6_BUF(buf)->src, &peer_addr);
+	net_ipaddr_copy(&NET_IPV6_BUF(buf)->dst, &my_addr);
+
+	/* Everything received so far is acknowledged */
+	tcp = NET_TCP_BUF(buf);
+	tcp->src_port = htons(peer.port);
+	tcp->dst_port = htons(MY_PORT);
+	sys_put_be32(peer.seq, tcp->seq);
+	sys_put_be32(peer.isn + 1 + peer.rsp_len + peer.fin, tcp->ack);
+	tcp->offset = NET_TCPH_LEN << 2;
+	tcp->flags = flags;
+	tcp->wnd[0] = 0xff;
+	tcp->wnd[1] = 0xff;
+
+	peer.seq += len + !!(flags & (NET_TCP_SYN | NET_TCP_FIN));
+
+	while (len) {
+		frag = net_nbuf_get_reserve_data(0, K_FOREVER);
+		chunk = min(len, min(frag_len, net_buf_tailroom(frag)));
+
+		net_buf_add_mem(frag, data, chunk);
+		net_buf_frag_add(buf, frag);
+
+		data += chunk;
+		len -= chunk;
+	}
+
+	assert_equal(net_recv_data(iface, buf), 0, "Cannot receive segment");
+
+	k_sleep(WAIT_TIME);
+}
+
+static void peer_connect(void)
+{
+	peer.port++;
+	peer.seq = 1000;
+	peer.syn_ack = false;
+	peer.fin = false;
+	peer.rsp_len = 0;
+	peer.rsp_read = 0;
+
+	peer_send(NET_TCP_SYN, NULL, 0);
+	assert_true(peer.syn_ack, "No SYN-ACK from the server");
+
+	peer_send(NET_TCP_ACK, NULL, 0);
+}
+
+static void peer_request(const char *req, size_t frag_len)
+{
+	peer_send(NET_TCP_PSH | NET_TCP_ACK, req, frag_len);
+}
+
+/* Checks the response received since the previous one */
+static void peer_expect(const char *rsp)
+{
+	size_t len = strlen(rsp);
+
+	TC_PRINT("%.*s\n", (int)(peer.rsp_len - peer.rsp_read),
+		 peer.rsp + peer.rsp_read);
+
+	assert_equal(peer.rsp_len - peer.rsp_read, len,
+		     "Wrong response length");
+	assert_false(memcmp(peer.rsp + peer.rsp_read, rsp, len),
+		     "Wrong response");
+
+	peer.rsp_read += len;
+}
+
+/* Closes the client side, acknowledging the FIN of the server if any */
+static void peer_close(void)
+{
+	peer_send(NET_TCP_FIN | NET_TCP_ACK, NULL, 0);
+}
+
+static void http_server_split(void)
+{
+	struct sockaddr_in6 addr = { 0 };
+
+	assert_not_null(net_if_ipv6_addr_add(net_if_get_default(), &my_addr,
+					     NET_ADDR_MANUAL, 0),
+			"Cannot add IPv6 address");
+
+	addr.sin6_family = AF_INET6;
+	addr.sin6_port = htons(MY_PORT);
+
+	/* Stopped by http_server_stop_conns() */
+	assert_equal(http_server_start(&server, (struct sockaddr *)&addr,
+				       sizeof(addr)), 0, "Cannot start server");
+
+	peer_connect();
+
+	/* Split across the fragments of a segment */
+	peer_request("GET /index.html HTTP/1.1\r\nHost: test\r\n\r\n", 5);
+	peer_expect(INDEX_RSP);
+
+	/* Split across segments */
+	peer_request("GET /index.ht", 128);
+	peer_expect("");
+	peer_request("ml HTTP/1.1\r\nHost: test\r\n\r\n", 128);
+	peer_expect(INDEX_RSP);
+
+	peer_close();
+}
+
+static void http_server_pipelining(void)
+{
+	peer_connect();
+
+	/* Answered in order */
+	peer_request("GET /index.html HTTP/1.1\r\n\r\n"
+		     "GET /metrics HTTP/1.1\r\n\r\n"
+		     "GET /index.html HTTP/1.1\r\n\r\n", 128);
+	peer_expect(INDEX_RSP NO_CONTENT_RSP INDEX_RSP);
+
+	peer_close();
+}
+
+static void http_server_keep_alive(void)
+{
+	peer_connect();
+
+	peer_request("GET /metrics HTTP/1.1\r\n\r\n", 128);
+	peer_expect(NO_CONTENT_RSP);
+	assert_false(peer.fin, "Persistent connection closed");
+
+	peer_request("GET /metrics HTTP/1.1\r\nConnection: close\r\n\r\n",
+		     128);
+	peer_expect("HTTP/1.1 204 No Content\r\n"
+		    "Content-Length: 0\r\n"
+		    "Connection: close\r\n\r\n");
+	assert_true(peer.fin, "Connection not closed");
+
+	peer_close();
+}
+
+static void http_server_errors(void)
+{
+	peer_connect();
+
+	/* Without the catch-all route */
+	server.routes_len--;
+	peer_request("GET /images_and_docs HTTP/1.1\r\n\r\n", 128);
+	server.routes_len++;
+	peer_expect("HTTP/1.1 404 Not Found\r\n"
+		    "Content-Length: 0\r\n\r\n");
+
+	/* Rejected by the body callback, the connection is kept */
+	peer_request("POST /upload HTTP/1.1\r\n"
+		     "Content-Length: 16\r\n\r\n"
+		     "0123456789abcdef", 128);
+	peer_expect("HTTP/1.1 413 Payload Too Large\r\n"
+		    "Content-Length: 0\r\n\r\n");
+
+	peer_request("POST /upload HTTP/1.1\r\n"
+		     "Content-Length: 4\r\n\r\n"
+		     "0123", 128);
+	peer_expect(NO_CONTENT_RSP);
+	assert_false(peer.fin, "Connection closed after an error");
+
+	/* The parser cannot recover, the connection is closed */
+	peer_request("GARBAGE\r\n\r\n", 128);
+	peer_expect("HTTP/1.1 400 Bad Request\r\n"
+		    "Content-Length: 0\r\n"
+		    "Connection: close\r\n\r\n");
+	assert_true(peer.fin, "Connection not closed");
+
+	peer_close();
+}
+
+static void http_server_stop_conns(void)
+{
+	peer_connect();
+
+	peer_request("GET /metrics HTTP/1.1\r\n\r\n", 128);
+	peer_expect(NO_CONTENT_RSP);
+
+	assert_equal(http_server_stop(&server), 0, "Cannot stop server");
+	k_sleep(WAIT_TIME);
+	assert_true(peer.fin, "Connection not closed by the stop");
+
+	peer_close();
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_http_server_test,
+			 ztest_unit_test(http_server_init_params),
+			 ztest_unit_test(http_server_routes),
+			 ztest_unit_test(http_server_start_stop),
+			 ztest_unit_test(http_server_split),
+			 ztest_unit_test(http_server_pipelining),
+			 ztest_unit_test(http_server_keep_alive),
+			 ztest_unit_test(http_server_errors),
+			 ztest_unit_test(http_server_stop_conns));
+
+	ztest_run_test_suite(net_http_server_test);
+}
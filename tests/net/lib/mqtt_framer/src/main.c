@@ -0,0 +1,325 @@
+/* main.c - Application main entry point */
+
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <misc/printk.h>
+#include <sections.h>
+
+#include <ztest.h>
+
+#include <net/ethernet.h>
+#include <net/buf.h>
+#include <net/nbuf.h>
+#include <net/net_ip.h>
+#include <net/net_if.h>
+#include <net/net_context.h>
+#include <net/mqtt.h>
+
+#include "udp.h"
+#include "net_private.h"
+
+/* The MQTT stream is carried over UDP, every datagram stands for a segment */
+#define MY_PORT 1883
+#define PEER_PORT 4242
+
+#define TOPIC "sensors"
+#define TOPIC_LEN (sizeof(TOPIC) - 1)
+
+#define SMALL_LEN 20
+#define SPLIT_LEN 200
+#define LARGE_LEN 300
+
+#define WAIT_TIME 100
+
+static struct in6_addr my_addr = { { { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0,
+				       0, 0, 0, 0, 0, 0, 0, 0x1 } } };
+static struct in6_addr peer_addr = { { { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0,
+					 0, 0, 0, 0, 0, 0, 0, 0x2 } } };
+
+static const uint8_t pingresp[] = { 0xd0, 0x00 };
+static const uint8_t suback[] = { 0x90, 0x03, 0x00, 0x01, 0x00 };
+
+static struct net_if *iface;
+static struct mqtt_ctx mqtt;
+
+static uint8_t stream[2 * LARGE_LEN];
+
+static int published;
+static int subscribed;
+static int malformed;
+static uint16_t last_pkt_type;
+
+struct dummy_context {
+	uint8_t mac_addr[sizeof(struct net_eth_addr)];
+};
+
+static struct dummy_context dummy_context_data;
+
+static int dummy_dev_init(struct device *dev)
+{
+	return 0;
+}
+
+static void dummy_iface_init(struct net_if *iface)
+{
+	struct dummy_context *context =
+		net_if_get_device(iface)->driver_data;
+
+	/* 10-00-00-00-00 to 10-00-00-00-FF Documentation RFC7042 */
+	context->mac_addr[0] = 0x10;
+	context->mac_addr[5] = 0x01;
+
+	net_if_set_link_addr(iface, context->mac_addr,
+			     sizeof(context->mac_addr), NET_LINK_ETHERNET);
+}
+
+static int dummy_send(struct net_if *iface, struct net_buf *buf)
+{
+	net_nbuf_unref(buf);
+
+	return 0;
+}
+
+static struct net_if_api dummy_if_api = {
+	.init = dummy_iface_init,
+	.send = dummy_send,
+};
+
+#define _ETH_L2_LAYER DUMMY_L2
+#define _ETH_L2_CTX_TYPE NET_L2_GET_CTX_TYPE(DUMMY_L2)
+
+NET_DEVICE_INIT(mqtt_framer_test, "mqtt_framer_test",
+		dummy_dev_init, &dummy_context_data, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+		&dummy_if_api, _ETH_L2_LAYER, _ETH_L2_CTX_TYPE, 127);
+
+static int publish_rx(struct mqtt_ctx *ctx, struct mqtt_publish_msg *msg,
+		      uint16_t pkt_id, enum mqtt_packet type)
+{
+	uint16_t i;
+
+	if (msg->topic_len != TOPIC_LEN ||
+	    memcmp(msg->topic, TOPIC, TOPIC_LEN)) {
+		return -EINVAL;
+	}
+
+	for (i = 0; i < msg->msg_len; i++) {
+		if (msg->msg[i] != (uint8_t)i) {
+			return -EINVAL;
+		}
+	}
+
+	published++;
+
+	return 0;
+}
+
+static int subscribe(struct mqtt_ctx *ctx, uint16_t pkt_id, uint8_t items,
+		     enum mqtt_qos qos[])
+{
+	subscribed++;
+
+	return 0;
+}
+
+static void malformed_cb(struct mqtt_ctx *ctx, uint16_t pkt_type)
+{
+	last_pkt_type = pkt_type;
+	malformed++;
+}
+
+/* Builds a QoS 0 PUBLISH message, returns its length */
+static uint16_t publish_build(uint8_t *data, uint16_t payload_len)
+{
+	uint32_t rlen = 2 + TOPIC_LEN + payload_len;
+	uint16_t len = 0;
+	uint16_t i;
+
+	data[len++] = MQTT_PUBLISH << 4;
+
+	do {
+		data[len] = rlen % 128;
+		rlen /= 128;
+		if (rlen) {
+			data[len] |= 128;
+		}
+
+		len++;
+	} while (rlen);
+
+	data[len++] = 0;
+	data[len++] = TOPIC_LEN;
+	memcpy(data + len, TOPIC, TOPIC_LEN);
+	len += TOPIC_LEN;
+
+	for (i = 0; i < payload_len; i++) {
+		data[len++] = i;
+	}
+
+	return len;
+}
+
+static void segment_send(const uint8_t *data, uint16_t len)
+{
+	struct net_buf *buf;
+	struct net_buf *frag;
+
+	buf = net_nbuf_get_reserve_rx(0, K_FOREVER);
+	frag = net_nbuf_get_reserve_data(0, K_FOREVER);
+	net_buf_frag_add(buf, frag);
+
+	net_nbuf_set_iface(buf, iface);
+	net_nbuf_set_family(buf, AF_INET6);
+	net_nbuf_set_ll_reserve(buf, net_buf_headroom(frag));
+
+	NET_IPV6_BUF(buf)->vtc = 0x60;
+	NET_IPV6_BUF(buf)->tcflow = 0;
+	NET_IPV6_BUF(buf)->flow = 0;
+	NET_IPV6_BUF(buf)->len[0] = (NET_UDPH_LEN + len) >> 8;
+	NET_IPV6_BUF(buf)->len[1] = (NET_UDPH_LEN + len) & 0xff;
+
+	NET_IPV6_BUF(buf)->nexthdr = IPPROTO_UDP;
+	NET_IPV6_BUF(buf)->hop_limit = 255;
+
+	net_ipaddr_copy(&NET_IPV6_BUF(buf)->src, &peer_addr);
+	net_ipaddr_copy(&NET_IPV6_BUF(buf)->dst, &my_addr);
+
+	net_nbuf_set_ip_hdr_len(buf, sizeof(struct net_ipv6_hdr));
+	net_nbuf_set_ext_len(buf, 0);
+
+	NET_UDP_BUF(buf)->src_port = htons(PEER_PORT);
+	NET_UDP_BUF(buf)->dst_port = htons(MY_PORT);
+	NET_UDP_BUF(buf)->len = htons(NET_UDPH_LEN + len);
+	NET_UDP_BUF(buf)->chksum = 0;
+
+	net_buf_add(frag, net_nbuf_ip_hdr_len(buf) +
+			  sizeof(struct net_udp_hdr));
+
+	assert_true(net_nbuf_append(buf, len, data, K_FOREVER),
+		    "Cannot append data");
+
+	assert_equal(net_recv_data(iface, buf), 0, "Cannot queue packet");
+
+	k_sleep(WAIT_TIME);
+}
+
+static void mqtt_framer_setup(void)
+{
+	struct sockaddr_in6 addr = {
+		.sin6_family = AF_INET6,
+		.sin6_port = htons(MY_PORT),
+	};
+	int ret;
+
+	iface = net_if_get_default();
+
+	assert_not_null(net_if_ipv6_addr_add(iface, &my_addr, NET_ADDR_MANUAL,
+					     0), "Cannot add IPv6 address");
+
+	ret = net_context_get(AF_INET6, SOCK_DGRAM, IPPROTO_UDP,
+			      &mqtt.net_ctx);
+	assert_equal(ret, 0, "Cannot get context");
+
+	net_ipaddr_copy(&addr.sin6_addr, &my_addr);
+
+	ret = net_context_bind(mqtt.net_ctx, (struct sockaddr *)&addr,
+			       sizeof(addr));
+	assert_equal(ret, 0, "Cannot bind context");
+
+	mqtt.net_timeout = WAIT_TIME;
+	mqtt.publish_rx = publish_rx;
+	mqtt.subscribe = subscribe;
+	mqtt.malformed = malformed_cb;
+
+	ret = mqtt_init(&mqtt, MQTT_APP_SUBSCRIBER);
+	assert_equal(ret, 0, "Cannot init MQTT context");
+}
+
+static void mqtt_framer_coalesced(void)
+{
+	uint16_t len = 0;
+
+	memcpy(stream, pingresp, sizeof(pingresp));
+	len += sizeof(pingresp);
+	memcpy(stream + len, suback, sizeof(suback));
+	len += sizeof(suback);
+	len += publish_build(stream + len, SMALL_LEN);
+	len += publish_build(stream + len, SMALL_LEN);
+
+	segment_send(stream, len);
+
+	/** TESTPOINT: every message of the segment is parsed */
+	assert_equal(subscribed, 1, "SUBACK not parsed");
+	assert_equal(published, 2, "PUBLISH not parsed");
+	assert_equal(malformed, 0, "Message reported as malformed");
+	assert_is_null(mqtt.rx_frags, "Data left after parsing");
+}
+
+static void mqtt_framer_split(void)
+{
+	uint16_t len;
+
+	published = 0;
+
+	len = publish_build(stream, SPLIT_LEN);
+
+	/** TESTPOINT: the Remaining Length field is split */
+	segment_send(stream, 2);
+	assert_equal(published, 0, "Incomplete PUBLISH parsed");
+
+	segment_send(stream + 2, len / 2);
+	assert_equal(published, 0, "Incomplete PUBLISH parsed");
+
+	/** TESTPOINT: the message is parsed with its last byte */
+	memcpy(stream + len, pingresp, sizeof(pingresp));
+	segment_send(stream + 2 + len / 2, len - 2 - len / 2 +
+		     sizeof(pingresp));
+
+	assert_equal(published, 1, "PUBLISH not parsed");
+	assert_equal(malformed, 0, "Message reported as malformed");
+	assert_is_null(mqtt.rx_frags, "Data left after parsing");
+}
+
+static void mqtt_framer_oversize(void)
+{
+	uint16_t len;
+
+	published = 0;
+	subscribed = 0;
+
+	len = publish_build(stream, LARGE_LEN);
+	memcpy(stream + len, suback, sizeof(suback));
+
+	/** TESTPOINT: a message that cannot be held is reported */
+	segment_send(stream, len / 2);
+	assert_equal(malformed, 1, "PUBLISH not reported");
+	assert_equal(last_pkt_type, MQTT_PUBLISH, "Wrong packet type");
+	assert_is_null(mqtt.rx_frags, "Data kept for a discarded message");
+
+	/** TESTPOINT: the messages following it are parsed */
+	segment_send(stream + len / 2, len - len / 2 + sizeof(suback));
+	assert_equal(published, 0, "Discarded PUBLISH parsed");
+	assert_equal(subscribed, 1, "SUBACK not parsed");
+	assert_equal(malformed, 1, "Message reported as malformed");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_mqtt_framer_test,
+			 ztest_unit_test(mqtt_framer_setup),
+			 ztest_unit_test(mqtt_framer_coalesced),
+			 ztest_unit_test(mqtt_framer_split),
+			 ztest_unit_test(mqtt_framer_oversize)
+			 );
+
+	ztest_run_test_suite(net_mqtt_framer_test);
+}
@@ -0,0 +1,413 @@
+/* main.c - Application main entry point */
+
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <misc/printk.h>
+#include <sections.h>
+
+#include <ztest.h>
+
+#include <net/ethernet.h>
+#include <net/buf.h>
+#include <net/nbuf.h>
+#include <net/net_ip.h>
+#include <net/net_if.h>
+#include <net/net_context.h>
+#include <net/mqtt.h>
+
+#include "udp.h"
+#include "net_private.h"
+
+/* The MQTT stream is carried over UDP, every datagram stands for a segment */
+#define MY_PORT 4242
+#define PEER_PORT 1883
+
+#define WINDOW CONFIG_MQTT_INFLIGHT_WINDOW
+#define TIMEOUT CONFIG_MQTT_INFLIGHT_TIMEOUT
+
+#define QOS1_ID 100
+#define QOS2_ID 200
+
+/* First byte of the messages sent by the library */
+#define PUBLISH_QOS1_DUP 0x3a
+#define PUBREL 0x62
+
+#define MAX_SENT 16
+#define STATE_SIZE 128
+
+#define WAIT_TIME 50
+
+static struct in6_addr my_addr = { { { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0,
+				       0, 0, 0, 0, 0, 0, 0, 0x1 } } };
+static struct in6_addr peer_addr = { { { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0,
+					 0, 0, 0, 0, 0, 0, 0, 0x2 } } };
+
+static struct net_if *iface;
+static struct mqtt_ctx mqtt;
+
+/* First byte and packet identifier of the messages sent */
+static uint8_t sent_type[MAX_SENT];
+static uint16_t sent_id[MAX_SENT];
+static int sent;
+
+static uint8_t state[STATE_SIZE];
+static int state_len;
+
+struct dummy_context {
+	uint8_t mac_addr[sizeof(struct net_eth_addr)];
+};
+
+static struct dummy_context dummy_context_data;
+
+static int dummy_dev_init(struct device *dev)
+{
+	return 0;
+}
+
+static void dummy_iface_init(struct net_if *iface)
+{
+	struct dummy_context *context =
+		net_if_get_device(iface)->driver_data;
+
+	/* 10-00-00-00-00 to 10-00-00-00-FF Documentation RFC7042 */
+	context->mac_addr[0] = 0x10;
+	context->mac_addr[5] = 0x01;
+
+	net_if_set_link_addr(iface, context->mac_addr,
+			     sizeof(context->mac_addr), NET_LINK_ETHERNET);
+}
+
+static int dummy_send(struct net_if *iface, struct net_buf *buf)
+{
+	struct net_nbuf_cursor cur;
+	uint8_t type;
+	uint16_t id = 0;
+
+	net_nbuf_cursor_init(&cur, buf->frags, sizeof(struct net_ipv6_hdr) +
+			     sizeof(struct net_udp_hdr), UINT16_MAX);
+
+	net_nbuf_cursor_read_u8(&cur, &type);
+
+	/* PUBLISH: skip the Remaining Length and the topic. PUBREL: skip the
+	 * Remaining Length.
+	 */
+	if ((type >> 4) == MQTT_PUBLISH) {
+		net_nbuf_cursor_skip(&cur, 1);
+		net_nbuf_cursor_read_be16(&cur, &id);
+		net_nbuf_cursor_skip(&cur, id);
+		net_nbuf_cursor_read_be16(&cur, &id);
+	} else if ((type >> 4) == MQTT_PUBREL) {
+		net_nbuf_cursor_skip(&cur, 1);
+		net_nbuf_cursor_read_be16(&cur, &id);
+	}
+
+	if (sent < MAX_SENT) {
+		sent_type[sent] = type;
+		sent_id[sent] = id;
+		sent++;
+	}
+
+	net_nbuf_unref(buf);
+
+	return 0;
+}
+
+static struct net_if_api dummy_if_api = {
+	.init = dummy_iface_init,
+	.send = dummy_send,
+};
+
+#define _ETH_L2_LAYER DUMMY_L2
+#define _ETH_L2_CTX_TYPE NET_L2_GET_CTX_TYPE(DUMMY_L2)
+
+NET_DEVICE_INIT(mqtt_inflight_test, "mqtt_inflight_test",
+		dummy_dev_init, &dummy_context_data, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+		&dummy_if_api, _ETH_L2_LAYER, _ETH_L2_CTX_TYPE, 127);
+
+static int publish_tx(struct mqtt_ctx *ctx, uint16_t pkt_id,
+		      enum mqtt_packet type)
+{
+	return 0;
+}
+
+static void segment_send(const uint8_t *data, uint16_t len)
+{
+	struct net_buf *buf;
+	struct net_buf *frag;
+
+	buf = net_nbuf_get_reserve_rx(0, K_FOREVER);
+	frag = net_nbuf_get_reserve_data(0, K_FOREVER);
+	net_buf_frag_add(buf, frag);
+
+	net_nbuf_set_iface(buf, iface);
+	net_nbuf_set_family(buf, AF_INET6);
+	net_nbuf_set_ll_reserve(buf, net_buf_headroom(frag));
+
+	NET_IPV6_BUF(buf)->vtc = 0x60;
+	NET_IPV6_BUF(buf)->tcflow = 0;
+	NET_IPV6_BUF(buf)->flow = 0;
+	NET_IPV6_BUF(buf)->len[0] = 0;
+	NET_IPV6_BUF(buf)->len[1] = NET_UDPH_LEN + len;
+
+	NET_IPV6_BUF(buf)->nexthdr = IPPROTO_UDP;
+	NET_IPV6_BUF(buf)->hop_limit = 255;
+
+	net_ipaddr_copy(&NET_IPV6_BUF(buf)->src, &peer_addr);
+	net_ipaddr_copy(&NET_IPV6_BUF(buf)->dst, &my_addr);
+
+	net_nbuf_set_ip_hdr_len(buf, sizeof(struct net_ipv6_hdr));
+	net_nbuf_set_ext_len(buf, 0);
+
+	NET_UDP_BUF(buf)->src_port = htons(PEER_PORT);
+	NET_UDP_BUF(buf)->dst_port = htons(MY_PORT);
+	NET_UDP_BUF(buf)->len = htons(NET_UDPH_LEN + len);
+	NET_UDP_BUF(buf)->chksum = 0;
+
+	net_buf_add(frag, net_nbuf_ip_hdr_len(buf) +
+			  sizeof(struct net_udp_hdr));
+
+	assert_true(net_nbuf_append(buf, len, data, K_FOREVER),
+		    "Cannot append data");
+
+	assert_equal(net_recv_data(iface, buf), 0, "Cannot queue packet");
+
+	k_sleep(WAIT_TIME);
+}
+
+static void ack_send(enum mqtt_packet type, uint16_t pkt_id)
+{
+	uint8_t ack[] = { type << 4, 0x02, pkt_id >> 8, pkt_id & 0xff };
+
+	segment_send(ack, sizeof(ack));
+}
+
+static void connect(bool clean_session, bool session_present)
+{
+	struct mqtt_connect_msg msg = {
+		.client_id = "zephyr",
+		.client_id_len = 6,
+		.clean_session = clean_session,
+	};
+	uint8_t connack[] = { 0x20, 0x02, session_present, 0x00 };
+
+	assert_equal(mqtt_tx_connect(&mqtt, &msg), 0, "Cannot send CONNECT");
+	k_sleep(WAIT_TIME);
+
+	sent = 0;
+
+	segment_send(connack, sizeof(connack));
+	assert_true(mqtt.connected, "Not connected");
+}
+
+static int publish(enum mqtt_qos qos, uint16_t pkt_id)
+{
+	struct mqtt_publish_msg msg = {
+		.qos = qos,
+		.pkt_id = pkt_id,
+		.topic = "sensors",
+		.topic_len = 7,
+		.msg = "OPEN",
+		.msg_len = 4,
+	};
+	int rc;
+
+	rc = mqtt_tx_publish(&mqtt, &msg);
+	k_sleep(WAIT_TIME);
+
+	return rc;
+}
+
+static void init(void)
+{
+	int ret;
+
+	mqtt.net_timeout = WAIT_TIME;
+	mqtt.publish_tx = publish_tx;
+
+	ret = mqtt_init(&mqtt, MQTT_APP_PUBLISHER);
+	assert_equal(ret, 0, "Cannot init MQTT context");
+}
+
+static void mqtt_inflight_setup(void)
+{
+	struct sockaddr_in6 local_addr = {
+		.sin6_family = AF_INET6,
+		.sin6_port = htons(MY_PORT),
+	};
+	struct sockaddr_in6 peer = {
+		.sin6_family = AF_INET6,
+		.sin6_port = htons(PEER_PORT),
+	};
+	int ret;
+
+	iface = net_if_get_default();
+
+	assert_not_null(net_if_ipv6_addr_add(iface, &my_addr, NET_ADDR_MANUAL,
+					     0), "Cannot add IPv6 address");
+
+	ret = net_context_get(AF_INET6, SOCK_DGRAM, IPPROTO_UDP,
+			      &mqtt.net_ctx);
+	assert_equal(ret, 0, "Cannot get context");
+
+	net_ipaddr_copy(&local_addr.sin6_addr, &my_addr);
+	net_ipaddr_copy(&peer.sin6_addr, &peer_addr);
+
+	ret = net_context_bind(mqtt.net_ctx, (struct sockaddr *)&local_addr,
+			       sizeof(local_addr));
+	assert_equal(ret, 0, "Cannot bind context");
+
+	ret = net_context_connect(mqtt.net_ctx, (struct sockaddr *)&peer,
+				  sizeof(peer), NULL, 0, NULL);
+	assert_equal(ret, 0, "Cannot connect context");
+
+	init();
+	connect(true, false);
+}
+
+static void mqtt_inflight_window(void)
+{
+	int i;
+
+	sent = 0;
+
+	/** TESTPOINT: a full window is sent without waiting for acks */
+	for (i = 0; i < WINDOW; i++) {
+		assert_equal(publish(MQTT_QoS1, QOS1_ID + i), 0,
+			     "Cannot publish");
+	}
+
+	assert_equal(sent, WINDOW, "Messages not sent");
+
+	/** TESTPOINT: the window is full */
+	assert_equal(publish(MQTT_QoS1, QOS1_ID + WINDOW), -EAGAIN,
+		     "Window overflow");
+
+	/** TESTPOINT: an ack opens the window again */
+	ack_send(MQTT_PUBACK, QOS1_ID);
+	assert_equal(publish(MQTT_QoS1, QOS1_ID + WINDOW), 0,
+		     "Cannot publish");
+
+	for (i = 1; i <= WINDOW; i++) {
+		ack_send(MQTT_PUBACK, QOS1_ID + i);
+	}
+
+	/** TESTPOINT: QoS 0 messages are not kept */
+	assert_equal(mqtt_session_save(&mqtt, state, sizeof(state)), 0,
+		     "Messages left in flight");
+	assert_equal(publish(MQTT_QoS0, 0), 0, "Cannot publish");
+	assert_equal(mqtt_session_save(&mqtt, state, sizeof(state)), 0,
+		     "QoS 0 message kept");
+}
+
+static void mqtt_inflight_qos2(void)
+{
+	sent = 0;
+
+	assert_equal(publish(MQTT_QoS2, QOS2_ID), 0, "Cannot publish");
+
+	/** TESTPOINT: PUBREC is answered and PUBCOMP is waited for */
+	ack_send(MQTT_PUBREC, QOS2_ID);
+	assert_equal(sent, 2, "PUBREL not sent");
+	assert_equal(sent_type[1], PUBREL, "PUBREL not sent");
+	assert_equal(sent_id[1], QOS2_ID, "Wrong PUBREL packet id");
+
+	assert_equal(publish(MQTT_QoS1, QOS1_ID), 0, "Cannot publish");
+
+	/** TESTPOINT: the state of both messages is saved */
+	state_len = mqtt_session_save(&mqtt, state, sizeof(state));
+	assert_true(state_len > 0, "Cannot save session");
+
+	assert_equal(mqtt_session_save(&mqtt, state, 4), -ENOMEM,
+		     "State overflow");
+}
+
+static void mqtt_inflight_retransmit(void)
+{
+	int i;
+
+	sent = 0;
+
+	/** TESTPOINT: both messages are sent again on timeout */
+	k_sleep(TIMEOUT + WAIT_TIME);
+	assert_equal(sent, 2, "Messages not sent again");
+
+	for (i = 0; i < sent; i++) {
+		if (sent_id[i] == QOS1_ID) {
+			assert_equal(sent_type[i], PUBLISH_QOS1_DUP,
+				     "DUP flag not set");
+		} else {
+			assert_equal(sent_type[i], PUBREL, "PUBREL not sent");
+		}
+	}
+}
+
+static void mqtt_inflight_resume(void)
+{
+	int i;
+
+	assert_equal(mqtt_tx_disconnect(&mqtt), 0, "Cannot disconnect");
+
+	/** TESTPOINT: the session is restored on a new context */
+	init();
+	assert_equal(mqtt_session_load(&mqtt, state, state_len), 0,
+		     "Cannot load session");
+
+	/** TESTPOINT: resumed messages are sent again after CONNACK */
+	connect(false, true);
+	assert_equal(sent, 2, "Messages not sent again");
+
+	for (i = 0; i < sent; i++) {
+		if (sent_id[i] == QOS1_ID) {
+			assert_equal(sent_type[i], PUBLISH_QOS1_DUP,
+				     "DUP flag not set");
+		} else {
+			assert_equal(sent_type[i], PUBREL, "PUBREL not sent");
+		}
+	}
+
+	ack_send(MQTT_PUBACK, QOS1_ID);
+	ack_send(MQTT_PUBCOMP, QOS2_ID);
+
+	assert_equal(mqtt_session_save(&mqtt, state, sizeof(state)), 0,
+		     "Messages left in flight");
+
+	/** TESTPOINT: an invalid state is rejected */
+	state[0] = MQTT_PUBLISH;
+	assert_equal(mqtt_session_load(&mqtt, state, state_len), -EINVAL,
+		     "Invalid state loaded");
+}
+
+static void mqtt_inflight_discard(void)
+{
+	assert_equal(publish(MQTT_QoS1, QOS1_ID), 0, "Cannot publish");
+
+	/** TESTPOINT: the server has no session, the messages are dropped */
+	connect(false, false);
+	assert_equal(sent, 0, "Messages sent again");
+	assert_equal(mqtt_session_save(&mqtt, state, sizeof(state)), 0,
+		     "Messages left in flight");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_mqtt_inflight_test,
+			 ztest_unit_test(mqtt_inflight_setup),
+			 ztest_unit_test(mqtt_inflight_window),
+			 ztest_unit_test(mqtt_inflight_qos2),
+			 ztest_unit_test(mqtt_inflight_retransmit),
+			 ztest_unit_test(mqtt_inflight_resume),
+			 ztest_unit_test(mqtt_inflight_discard)
+			 );
+
+	ztest_run_test_suite(net_mqtt_inflight_test);
+}
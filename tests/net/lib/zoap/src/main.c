@@ -1050,6 +1050,548 @@ done:
 	return result;
 }
 
+#define BLOCK_BODY_LEN 300
+#define MAX_BLOCKS 20
+
+static uint8_t block_body[BLOCK_BODY_LEN];
+static uint8_t block_received[BLOCK_BODY_LEN];
+static int block_writes;
+static int block2_status;
+
+static int block_read(struct zoap_block_context *ctx, uint8_t *data,
+		      uint16_t len, void *user_data)
+{
+	memcpy(data, block_body + ctx->current, len);
+
+	return len;
+}
+
+static int block_write(struct zoap_block_context *ctx, const uint8_t *data,
+		       uint16_t len, bool last, void *user_data)
+{
+	if (ctx->current + len > sizeof(block_received)) {
+		return -ENOMEM;
+	}
+
+	memcpy(block_received + ctx->current, data, len);
+	block_writes++;
+
+	return 0;
+}
+
+static int block2_reply_cb(const struct zoap_packet *response,
+			   struct zoap_reply *reply,
+			   const struct sockaddr *from)
+{
+	block2_status = zoap_block2_response_received(response,
+						      reply->user_data,
+						      block_write, NULL);
+
+	return 0;
+}
+
+static int block_packet_init(struct zoap_packet *pkt, uint8_t type,
+			     uint8_t code, uint16_t id)
+{
+	const char token[] = "token";
+	struct net_buf *buf, *frag;
+	int r;
+
+	buf = net_buf_alloc(&zoap_nbuf_pool, K_NO_WAIT);
+	if (!buf) {
+		return -ENOMEM;
+	}
+
+	frag = net_buf_alloc(&zoap_data_pool, K_NO_WAIT);
+	if (!frag) {
+		net_buf_unref(buf);
+		return -ENOMEM;
+	}
+
+	net_buf_frag_add(buf, frag);
+
+	r = zoap_packet_init(pkt, buf);
+	if (r < 0) {
+		net_buf_unref(buf);
+		return r;
+	}
+
+	zoap_header_set_version(pkt, 1);
+	zoap_header_set_type(pkt, type);
+	zoap_header_set_code(pkt, code);
+	zoap_header_set_id(pkt, id);
+	zoap_header_set_token(pkt, (const uint8_t *) token, strlen(token));
+
+	return 0;
+}
+
+static int test_block2_transfer(void)
+{
+	struct zoap_block_context client_ctx, server_ctx;
+	struct zoap_packet req, rsp, received;
+	struct zoap_reply reply;
+	int result = TC_FAIL;
+	int r, i;
+
+	for (i = 0; i < BLOCK_BODY_LEN; i++) {
+		block_body[i] = i;
+	}
+
+	memset(block_received, 0, sizeof(block_received));
+	block_writes = 0;
+
+	/* The client accepts smaller blocks than the server */
+	zoap_block_transfer_init(&client_ctx, ZOAP_BLOCK_32, 0);
+
+	for (i = 0; i < MAX_BLOCKS; i++) {
+		uint16_t id = zoap_next_id();
+
+		r = block_packet_init(&req, ZOAP_TYPE_CON, ZOAP_METHOD_GET, id);
+		if (r < 0) {
+			TC_PRINT("Unable to initialize request\n");
+			goto done;
+		}
+
+		zoap_add_block2_option(&req, &client_ctx);
+
+		if (i == 0) {
+			zoap_reply_init(&reply, &req);
+			reply.reply = block2_reply_cb;
+			reply.user_data = &client_ctx;
+		}
+
+		r = block_packet_init(&rsp, ZOAP_TYPE_ACK,
+				      ZOAP_RESPONSE_CODE_CONTENT, id);
+		if (r < 0) {
+			TC_PRINT("Unable to initialize response\n");
+			net_buf_unref(req.buf);
+			goto done;
+		}
+
+		/* Server side, it keeps no state between blocks */
+		zoap_block_transfer_init(&server_ctx, ZOAP_BLOCK_64,
+					 BLOCK_BODY_LEN);
+
+		zoap_packet_parse(&received, req.buf);
+		r = zoap_block2_response_fill(&received, &rsp, &server_ctx,
+					      block_read, NULL);
+		net_buf_unref(req.buf);
+		if (r < 0) {
+			TC_PRINT("Unable to fill block %d\n", i);
+			net_buf_unref(rsp.buf);
+			goto done;
+		}
+
+		/* Client side */
+		block2_status = -EINVAL;
+		zoap_packet_parse(&received, rsp.buf);
+		zoap_response_received(&received,
+				       (const struct sockaddr *) &dummy_addr,
+				       &reply, 1);
+		net_buf_unref(rsp.buf);
+
+		if (block2_status <= 0) {
+			break;
+		}
+	}
+
+	if (block2_status != 0) {
+		TC_PRINT("Block-wise transfer did not complete\n");
+		goto done;
+	}
+
+	if (client_ctx.block_size != ZOAP_BLOCK_32 ||
+	    client_ctx.total_size != BLOCK_BODY_LEN ||
+	    block_writes != (BLOCK_BODY_LEN + 31) / 32) {
+		TC_PRINT("Wrong block size negotiated\n");
+		goto done;
+	}
+
+	if (memcmp(block_received, block_body, BLOCK_BODY_LEN)) {
+		TC_PRINT("Body received differs\n");
+		goto done;
+	}
+
+	result = TC_PASS;
+
+done:
+	TC_END_RESULT(result);
+
+	return result;
+}
+
+static int test_block1_transfer(void)
+{
+	struct zoap_block_context client_ctx, server_ctx;
+	struct zoap_packet req, rsp, received;
+	int result = TC_FAIL;
+	int r, i, writes;
+
+	memset(block_received, 0, sizeof(block_received));
+	block_writes = 0;
+
+	/* The server accepts smaller blocks than the client sends */
+	zoap_block_transfer_init(&client_ctx, ZOAP_BLOCK_64, BLOCK_BODY_LEN);
+	zoap_block_transfer_init(&server_ctx, ZOAP_BLOCK_32, 0);
+
+	for (i = 0; i < MAX_BLOCKS; i++) {
+		uint16_t id = zoap_next_id();
+
+		r = block_packet_init(&req, ZOAP_TYPE_CON, ZOAP_METHOD_PUT, id);
+		if (r < 0) {
+			TC_PRINT("Unable to initialize request\n");
+			goto done;
+		}
+
+		r = zoap_block1_request_fill(&req, &client_ctx, block_read,
+					     NULL);
+		if (r < 0) {
+			TC_PRINT("Unable to fill block %d\n", i);
+			net_buf_unref(req.buf);
+			goto done;
+		}
+
+		/* Server side, the first block is received twice */
+		writes = block_writes;
+
+		r = block_packet_init(&rsp, ZOAP_TYPE_ACK,
+				      ZOAP_RESPONSE_CODE_CHANGED, id);
+		if (r < 0) {
+			TC_PRINT("Unable to initialize response\n");
+			net_buf_unref(req.buf);
+			goto done;
+		}
+
+		zoap_packet_parse(&received, req.buf);
+		r = zoap_block1_request_received(&received, &rsp, &server_ctx,
+						 block_write, NULL);
+
+		if (i == 0 && r == 1) {
+			net_buf_unref(rsp.buf);
+
+			r = block_packet_init(&rsp, ZOAP_TYPE_ACK,
+					      ZOAP_RESPONSE_CODE_CHANGED, id);
+			if (r < 0) {
+				TC_PRINT("Unable to initialize response\n");
+				net_buf_unref(req.buf);
+				goto done;
+			}
+
+			zoap_packet_parse(&received, req.buf);
+			r = zoap_block1_request_received(&received, &rsp,
+							 &server_ctx,
+							 block_write, NULL);
+		}
+
+		net_buf_unref(req.buf);
+
+		if (r < 0 || block_writes != writes + 1) {
+			TC_PRINT("Block %d not written once\n", i);
+			net_buf_unref(rsp.buf);
+			goto done;
+		}
+
+		/* Client side */
+		zoap_packet_parse(&received, rsp.buf);
+		r = zoap_block1_response_received(&received, &client_ctx);
+		net_buf_unref(rsp.buf);
+
+		if (r <= 0) {
+			break;
+		}
+	}
+
+	if (r != 0) {
+		TC_PRINT("Block-wise transfer did not complete\n");
+		goto done;
+	}
+
+	if (client_ctx.block_size != ZOAP_BLOCK_32 ||
+	    server_ctx.total_size != BLOCK_BODY_LEN) {
+		TC_PRINT("Wrong block size negotiated\n");
+		goto done;
+	}
+
+	if (memcmp(block_received, block_body, BLOCK_BODY_LEN)) {
+		TC_PRINT("Body received differs\n");
+		goto done;
+	}
+
+	result = TC_PASS;
+
+done:
+	TC_END_RESULT(result);
+
+	return result;
+}
+
+#define NUM_DEDUPS 2
+
+static struct zoap_dedup dedups[NUM_DEDUPS];
+
+static int test_dedup(void)
+{
+	struct sockaddr_in6 other_addr = {
+		.sin6_family = AF_INET6,
+		.sin6_addr = IN6ADDR_LOOPBACK_INIT,
+		.sin6_port = htons(MY_PORT) };
+	struct zoap_packet req, rsp;
+	struct zoap_dedup *dedup;
+	uint16_t id = zoap_next_id();
+	int result = TC_FAIL;
+	int r, i;
+
+	r = block_packet_init(&req, ZOAP_TYPE_CON, ZOAP_METHOD_POST, id);
+	if (r < 0) {
+		TC_PRINT("Unable to initialize request\n");
+		goto done;
+	}
+
+	r = block_packet_init(&rsp, ZOAP_TYPE_ACK,
+			      ZOAP_RESPONSE_CODE_CHANGED, id);
+	if (r < 0) {
+		TC_PRINT("Unable to initialize response\n");
+		net_buf_unref(req.buf);
+		goto done;
+	}
+
+	dedup = zoap_dedup_received(&req, (const struct sockaddr *) &dummy_addr,
+				    dedups, NUM_DEDUPS);
+	if (dedup) {
+		TC_PRINT("First request seen as a duplicate\n");
+		goto release;
+	}
+
+	dedup = zoap_dedup_next_unused(dedups, NUM_DEDUPS);
+	r = zoap_dedup_init(dedup, &req, &rsp,
+			    (const struct sockaddr *) &dummy_addr);
+	if (r < 0) {
+		TC_PRINT("Unable to keep the response\n");
+		net_buf_unref(rsp.buf);
+		goto release;
+	}
+
+	/** TESTPOINT: a retransmission is answered with the response */
+	dedup = zoap_dedup_received(&req, (const struct sockaddr *) &dummy_addr,
+				    dedups, NUM_DEDUPS);
+	if (!dedup || dedup->len != rsp.buf->frags->len ||
+	    memcmp(dedup->data, rsp.buf->frags->data, dedup->len)) {
+		TC_PRINT("Retransmission not detected\n");
+		net_buf_unref(rsp.buf);
+		goto release;
+	}
+
+	/** TESTPOINT: a response too large is not kept */
+	net_buf_add(rsp.buf->frags, CONFIG_ZOAP_DEDUP_RESPONSE_SIZE);
+	r = zoap_dedup_init(dedup, &req, &rsp,
+			    (const struct sockaddr *) &dummy_addr);
+	net_buf_unref(rsp.buf);
+	if (r != -EMSGSIZE || dedup->len) {
+		TC_PRINT("Response too large kept\n");
+		goto release;
+	}
+
+	/** TESTPOINT: a retransmission of that request is processed again,
+	 * as its response could not be sent back
+	 */
+	dedup = zoap_dedup_received(&req, (const struct sockaddr *) &dummy_addr,
+				    dedups, NUM_DEDUPS);
+	if (dedup) {
+		TC_PRINT("Request with a large response seen as duplicate\n");
+		goto release;
+	}
+
+	/** TESTPOINT: the same message ID from another endpoint is new */
+	dedup = zoap_dedup_received(&req, (const struct sockaddr *) &other_addr,
+				    dedups, NUM_DEDUPS);
+	if (dedup) {
+		TC_PRINT("Request of another endpoint seen as duplicate\n");
+		goto release;
+	}
+
+	/** TESTPOINT: the oldest entry is forgotten when the window is
+	 * full
+	 */
+	for (i = 1; i <= NUM_DEDUPS; i++) {
+		zoap_header_set_id(&req, id + i);
+		dedup = zoap_dedup_next_unused(dedups, NUM_DEDUPS);
+		zoap_dedup_init(dedup, &req, NULL,
+				(const struct sockaddr *) &dummy_addr);
+		k_sleep(1);
+	}
+
+	zoap_header_set_id(&req, id);
+	dedup = zoap_dedup_received(&req, (const struct sockaddr *) &dummy_addr,
+				    dedups, NUM_DEDUPS);
+	if (dedup) {
+		TC_PRINT("Oldest entry not forgotten\n");
+		goto release;
+	}
+
+	zoap_header_set_id(&req, id + NUM_DEDUPS);
+	dedup = zoap_dedup_received(&req, (const struct sockaddr *) &dummy_addr,
+				    dedups, NUM_DEDUPS);
+	if (!dedup || dedup->len) {
+		TC_PRINT("Request without response not detected\n");
+		goto release;
+	}
+
+	result = TC_PASS;
+
+release:
+	for (i = 0; i < NUM_DEDUPS; i++) {
+		zoap_dedup_clear(&dedups[i]);
+	}
+
+	net_buf_unref(req.buf);
+
+done:
+	TC_END_RESULT(result);
+
+	return result;
+}
+
+static struct zoap_resource *handled_resource;
+
+static int tree_resource_get(struct zoap_resource *resource,
+			     struct zoap_packet *request,
+			     const struct sockaddr *from)
+{
+	handled_resource = resource;
+
+	return 0;
+}
+
+static const char * const tree_root_path[] = { NULL };
+static const char * const tree_s_path[] = { "s", NULL };
+static const char * const tree_s_1_path[] = { "s", "1", NULL };
+static const char * const tree_s_2_path[] = { "s", "2", NULL };
+static const char * const tree_deep_path[] = { "a", "b", "c", NULL };
+static struct zoap_resource tree_resources[] = {
+	{ .path = tree_s_1_path, .get = tree_resource_get },
+	{ .path = tree_s_2_path, .get = tree_resource_get },
+	{ .path = tree_deep_path, .get = tree_resource_get },
+	{ .path = tree_s_path, .get = tree_resource_get },
+	{ .path = tree_root_path, .get = tree_resource_get },
+	{ },
+};
+
+/* Root, "s", "1", "2", "a", "b" and "c" */
+#define NUM_TREE_NODES 7
+
+static const struct {
+	const char * const path[4];
+	int resource;
+} tree_requests[] = {
+	{ { "s", "1" }, 0 },
+	{ { "s", "2" }, 1 },
+	{ { "a", "b", "c" }, 2 },
+	{ { "s" }, 3 },
+	{ { }, 4 },
+	{ { "a", "b" }, -1 },
+	{ { "s", "3" }, -1 },
+	{ { "s", "1", "x" }, -1 },
+	{ { "x" }, -1 },
+};
+
+static int test_resource_tree(void)
+{
+	struct zoap_resource_node nodes[NUM_TREE_NODES];
+	struct zoap_resource_tree tree;
+	struct zoap_resource *expected;
+	struct zoap_packet req;
+	struct net_buf *frag, *buf = NULL;
+	int result = TC_FAIL;
+	int r, i, j;
+
+	r = zoap_resource_tree_init(&tree, tree_resources, nodes,
+				    NUM_TREE_NODES - 1);
+	if (r != -ENOMEM) {
+		TC_PRINT("The tree should not fit in the nodes\n");
+		goto done;
+	}
+
+	r = zoap_resource_tree_init(&tree, tree_resources, nodes,
+				    NUM_TREE_NODES);
+	if (r) {
+		TC_PRINT("Could not build the resource tree\n");
+		goto done;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(tree_requests); i++) {
+		buf = net_buf_alloc(&zoap_nbuf_pool, K_NO_WAIT);
+		if (!buf) {
+			TC_PRINT("Could not get buffer from pool\n");
+			goto done;
+		}
+
+		frag = net_buf_alloc(&zoap_data_pool, K_NO_WAIT);
+		if (!frag) {
+			TC_PRINT("Could not get buffer from pool\n");
+			goto done;
+		}
+
+		net_buf_frag_add(buf, frag);
+
+		r = zoap_packet_init(&req, buf);
+		if (r < 0) {
+			TC_PRINT("Unable to initialize request\n");
+			goto done;
+		}
+
+		zoap_header_set_version(&req, 1);
+		zoap_header_set_type(&req, ZOAP_TYPE_CON);
+		zoap_header_set_code(&req, ZOAP_METHOD_GET);
+		zoap_header_set_id(&req, zoap_next_id());
+
+		for (j = 0; tree_requests[i].path[j]; j++) {
+			const char *segment = tree_requests[i].path[j];
+
+			zoap_add_option(&req, ZOAP_OPTION_URI_PATH, segment,
+					strlen(segment));
+		}
+
+		if (tree_requests[i].resource < 0) {
+			expected = NULL;
+		} else {
+			expected = &tree_resources[tree_requests[i].resource];
+		}
+
+		handled_resource = NULL;
+		r = zoap_handle_request_tree(&req, &tree,
+					(const struct sockaddr *) &dummy_addr);
+		if (r != (expected ? 0 : -ENOENT) ||
+		    handled_resource != expected) {
+			TC_PRINT("Wrong resource for request %d\n", i);
+			goto done;
+		}
+
+		/* The resource array must give the same result */
+		handled_resource = NULL;
+		r = zoap_handle_request(&req, tree_resources,
+					(const struct sockaddr *) &dummy_addr);
+		if (r != (expected ? 0 : -ENOENT) ||
+		    handled_resource != expected) {
+			TC_PRINT("Wrong array resource for request %d\n", i);
+			goto done;
+		}
+
+		net_buf_unref(buf);
+		buf = NULL;
+	}
+
+	result = TC_PASS;
+
+done:
+	if (buf) {
+		net_buf_unref(buf);
+	}
+
+	TC_END_RESULT(result);
+
+	return result;
+}
+
 static const struct {
 	const char *name;
 	int (*func)(void);
@@ -1063,6 +1605,10 @@ static const struct {
 	{ "Test observer server", test_observer_server, },
 	{ "Test observer client", test_observer_client, },
 	{ "Test block sized transfer", test_block_size, },
+	{ "Test resource tree", test_resource_tree, },
+	{ "Test Block2 transfer", test_block2_transfer, },
+	{ "Test Block1 transfer", test_block1_transfer, },
+	{ "Test deduplication", test_dedup, },
 };
 
 int main(int argc, char *argv[])
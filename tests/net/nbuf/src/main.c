@@ -1190,6 +1190,105 @@ static int test_fragment_compact(void)
 	return 0;
 }
 
+static const uint8_t cursor_data[] = { 0x01, 0x02, 0x03, 0x04, 0x05,
+					0x06, 0x07, 0x08, 0x09, 0x0a };
+
+static int test_nbuf_cursor(void)
+{
+	struct net_nbuf_cursor cur;
+	struct net_buf *buf;
+	struct net_buf *frag;
+	uint8_t data[sizeof(cursor_data)];
+	uint16_t value16;
+	uint32_t value32;
+	uint16_t len;
+	uint8_t *ptr;
+	int i;
+
+	/* Spread the data as 3 + 3 + 3 + 1 bytes over four fragments */
+	buf = net_nbuf_get_reserve_rx(0, K_FOREVER);
+
+	for (i = 0; i < sizeof(cursor_data); i += 3) {
+		frag = net_nbuf_get_reserve_data(LL_RESERVE, K_FOREVER);
+		len = min(3, sizeof(cursor_data) - i);
+		memcpy(net_buf_add(frag, len), cursor_data + i, len);
+		net_buf_frag_add(buf, frag);
+	}
+
+	/* The cursor is bounded by the length given to it */
+	net_nbuf_cursor_init(&cur, buf->frags, 1, 8);
+	if (net_nbuf_cursor_left(&cur) != 8) {
+		printk("Cursor covers %u bytes, expected 8\n",
+		       net_nbuf_cursor_left(&cur));
+		goto fail;
+	}
+
+	if (net_nbuf_cursor_peek(&cur, data, 4) ||
+	    memcmp(data, cursor_data + 1, 4) ||
+	    net_nbuf_cursor_left(&cur) != 8) {
+		printk("Cursor peek failed\n");
+		goto fail;
+	}
+
+	if (net_nbuf_cursor_read_be16(&cur, &value16) || value16 != 0x0203) {
+		printk("Cursor read be16 failed\n");
+		goto fail;
+	}
+
+	/* Read across two fragment boundaries */
+	if (net_nbuf_cursor_read_be32(&cur, &value32) ||
+	    value32 != 0x04050607) {
+		printk("Cursor read be32 failed\n");
+		goto fail;
+	}
+
+	ptr = net_nbuf_cursor_data(&cur, &len);
+	if (len != 2 || ptr[0] != 0x08) {
+		printk("Cursor data has %u bytes, expected 2\n", len);
+		goto fail;
+	}
+
+	/* A read past the bound fails and does not move the cursor */
+	if (net_nbuf_cursor_read(&cur, data, 3) != -ENODATA ||
+	    net_nbuf_cursor_left(&cur) != 2) {
+		printk("Cursor read past the end did not fail\n");
+		goto fail;
+	}
+
+	if (net_nbuf_cursor_skip(&cur, 1) ||
+	    net_nbuf_cursor_read_u8(&cur, data) || data[0] != 0x09 ||
+	    net_nbuf_cursor_left(&cur)) {
+		printk("Cursor skip failed\n");
+		goto fail;
+	}
+
+	/* The cursor is limited to the data in the fragments */
+	net_nbuf_cursor_init(&cur, buf->frags, 6, 100);
+	if (net_nbuf_cursor_left(&cur) != sizeof(cursor_data) - 6) {
+		printk("Cursor covers %u bytes past the data\n",
+		       net_nbuf_cursor_left(&cur));
+		goto fail;
+	}
+
+	/* Application data runs until the end of the fragments */
+	net_nbuf_set_appdatalen(buf, 5);
+	net_nbuf_cursor_init_appdata(&cur, buf);
+	if (net_nbuf_cursor_read(&cur, data, 5) ||
+	    memcmp(data, cursor_data + 5, 5)) {
+		printk("Cursor over application data failed\n");
+		goto fail;
+	}
+
+	net_nbuf_unref(buf);
+
+	return 0;
+
+fail:
+	net_nbuf_unref(buf);
+
+	return -1;
+}
+
 void main(void)
 {
 	if (test_ipv6_multi_frags() < 0) {
@@ -1216,6 +1315,10 @@ void main(void)
 		goto fail;
 	}
 
+	if (test_nbuf_cursor() < 0) {
+		goto fail;
+	}
+
 	printk("nbuf tests passed\n");
 
 	TC_END_REPORT(TC_PASS);
@@ -0,0 +1,458 @@
+/* main.c - Application main entry point */
+
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <misc/printk.h>
+#include <sections.h>
+
+#include <ztest.h>
+
+#include <net/ethernet.h>
+#include <net/buf.h>
+#include <net/nbuf.h>
+#include <net/net_ip.h>
+#include <net/net_if.h>
+#include <net/net_context.h>
+#include <net/net_stats.h>
+
+#include "udp.h"
+#include "tcp.h"
+#include "net_private.h"
+
+#define QUOTA CONFIG_NET_CONTEXT_NBUF_QUOTA
+#define RESERVE CONFIG_NET_NBUF_DATA_RESERVE
+
+#define SLOW_PORT 4242
+#define FAST_PORT 4243
+#define PEER_PORT 4244
+#define TCP_PORT 4245
+
+/* Packets sent to the slow reader, which never consumes them */
+#define SLOW_PACKETS (2 * QUOTA)
+#define FAST_PACKETS (2 * QUOTA)
+
+#define WM_LOW 8
+#define WM_HIGH 12
+
+#define LARGE_LEN 1500
+
+#define WAIT_TIME 100
+
+static struct in6_addr my_addr = { { { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0,
+				       0, 0, 0, 0, 0, 0, 0, 0x1 } } };
+static struct in6_addr peer_addr = { { { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0,
+					 0, 0, 0, 0, 0, 0, 0, 0x2 } } };
+
+static struct net_if *iface;
+static struct net_context *slow_ctx;
+static struct net_context *fast_ctx;
+
+/* The slow reader keeps every packet it receives */
+static struct net_buf *slow_bufs[SLOW_PACKETS];
+static int slow_received;
+static int fast_received;
+static K_SEM_DEFINE(fast_done, 0, FAST_PACKETS);
+
+/* Free fragment count seen by the watermark callback, -1 if not called */
+static int wm_low_at = -1;
+static int wm_high_at = -1;
+
+struct dummy_context {
+	uint8_t mac_addr[sizeof(struct net_eth_addr)];
+};
+
+static struct dummy_context dummy_context_data;
+
+static int dummy_dev_init(struct device *dev)
+{
+	return 0;
+}
+
+static void dummy_iface_init(struct net_if *iface)
+{
+	struct dummy_context *context =
+		net_if_get_device(iface)->driver_data;
+
+	/* 10-00-00-00-00 to 10-00-00-00-FF Documentation RFC7042 */
+	context->mac_addr[0] = 0x10;
+	context->mac_addr[5] = 0x01;
+
+	net_if_set_link_addr(iface, context->mac_addr,
+			     sizeof(context->mac_addr), NET_LINK_ETHERNET);
+}
+
+static int dummy_send(struct net_if *iface, struct net_buf *buf)
+{
+	net_nbuf_unref(buf);
+
+	return 0;
+}
+
+static struct net_if_api dummy_if_api = {
+	.init = dummy_iface_init,
+	.send = dummy_send,
+};
+
+#define _ETH_L2_LAYER DUMMY_L2
+#define _ETH_L2_CTX_TYPE NET_L2_GET_CTX_TYPE(DUMMY_L2)
+
+NET_DEVICE_INIT(nbuf_quota_test, "nbuf_quota_test",
+		dummy_dev_init, &dummy_context_data, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+		&dummy_if_api, _ETH_L2_LAYER, _ETH_L2_CTX_TYPE, 127);
+
+static int data_free(void)
+{
+	int tx, rx, data;
+
+	net_nbuf_get_info(NULL, NULL, NULL, &tx, &rx, &data);
+
+	return data;
+}
+
+static void slow_recv(struct net_context *context, struct net_buf *buf,
+		      int status, void *user_data)
+{
+	slow_bufs[slow_received++] = buf;
+}
+
+static void fast_recv(struct net_context *context, struct net_buf *buf,
+		      int status, void *user_data)
+{
+	net_nbuf_unref(buf);
+
+	fast_received++;
+	k_sem_give(&fast_done);
+}
+
+static void watermark_cb(struct net_nbuf_watermark *wm, bool low)
+{
+	if (low) {
+		wm_low_at = data_free();
+	} else {
+		wm_high_at = data_free();
+	}
+}
+
+static struct net_nbuf_watermark watermark = {
+	.cb = watermark_cb,
+	.low = WM_LOW,
+	.high = WM_HIGH,
+};
+
+static struct net_buf *udp_packet_get(uint16_t port)
+{
+	struct net_buf *buf;
+	struct net_buf *frag;
+
+	buf = net_nbuf_get_reserve_rx(0, K_FOREVER);
+	frag = net_nbuf_get_reserve_data(0, K_FOREVER);
+	net_buf_frag_add(buf, frag);
+
+	net_nbuf_set_iface(buf, iface);
+	net_nbuf_set_family(buf, AF_INET6);
+	net_nbuf_set_ll_reserve(buf, net_buf_headroom(frag));
+
+	NET_IPV6_BUF(buf)->vtc = 0x60;
+	NET_IPV6_BUF(buf)->tcflow = 0;
+	NET_IPV6_BUF(buf)->flow = 0;
+	NET_IPV6_BUF(buf)->len[0] = 0;
+	NET_IPV6_BUF(buf)->len[1] = NET_UDPH_LEN + 1;
+
+	NET_IPV6_BUF(buf)->nexthdr = IPPROTO_UDP;
+	NET_IPV6_BUF(buf)->hop_limit = 255;
+
+	net_ipaddr_copy(&NET_IPV6_BUF(buf)->src, &peer_addr);
+	net_ipaddr_copy(&NET_IPV6_BUF(buf)->dst, &my_addr);
+
+	net_nbuf_set_ip_hdr_len(buf, sizeof(struct net_ipv6_hdr));
+	net_nbuf_set_ext_len(buf, 0);
+
+	NET_UDP_BUF(buf)->src_port = htons(PEER_PORT);
+	NET_UDP_BUF(buf)->dst_port = htons(port);
+	NET_UDP_BUF(buf)->len = htons(NET_UDPH_LEN + 1);
+	NET_UDP_BUF(buf)->chksum = 0;
+
+	net_buf_add(frag, net_nbuf_ip_hdr_len(buf) +
+			  sizeof(struct net_udp_hdr));
+	net_buf_add_u8(frag, 0);
+
+	return buf;
+}
+
+static struct net_context *context_setup(uint16_t port,
+					 net_context_recv_cb_t cb)
+{
+	struct sockaddr_in6 addr = {
+		.sin6_family = AF_INET6,
+		.sin6_port = htons(port),
+	};
+	struct net_context *context;
+	int ret;
+
+	ret = net_context_get(AF_INET6, SOCK_DGRAM, IPPROTO_UDP, &context);
+	assert_equal(ret, 0, "Cannot get context");
+
+	net_ipaddr_copy(&addr.sin6_addr, &my_addr);
+
+	ret = net_context_bind(context, (struct sockaddr *)&addr,
+			       sizeof(addr));
+	assert_equal(ret, 0, "Cannot bind context");
+
+	ret = net_context_recv(context, cb, K_NO_WAIT, NULL);
+	assert_equal(ret, 0, "Cannot receive on context");
+
+	return context;
+}
+
+static void nbuf_quota_setup(void)
+{
+	iface = net_if_get_default();
+
+	assert_not_null(net_if_ipv6_addr_add(iface, &my_addr, NET_ADDR_MANUAL,
+					     0), "Cannot add IPv6 address");
+
+	slow_ctx = context_setup(SLOW_PORT, slow_recv);
+	fast_ctx = context_setup(FAST_PORT, fast_recv);
+}
+
+static void nbuf_quota_isolation(void)
+{
+	struct net_buf *frag;
+	int i;
+
+	/* The test thread is cooperative: all the packets are queued
+	 * before the RX thread gets to run.
+	 */
+	for (i = 0; i < SLOW_PACKETS; i++) {
+		assert_equal(net_recv_data(iface, udp_packet_get(SLOW_PORT)),
+			     0, "Cannot queue packet");
+	}
+
+	for (i = 0; i < FAST_PACKETS; i++) {
+		assert_equal(net_recv_data(iface, udp_packet_get(FAST_PORT)),
+			     0, "Cannot queue packet");
+	}
+
+	for (i = 0; i < FAST_PACKETS; i++) {
+		assert_equal(k_sem_take(&fast_done, WAIT_TIME), 0,
+			     "Timeout, packets not received");
+	}
+
+	/** TESTPOINT: the slow reader only gets its quota */
+	assert_equal(slow_received, QUOTA, "Slow reader over its quota");
+
+	/** TESTPOINT: the other context is not starved by the slow one */
+	assert_equal(fast_received, FAST_PACKETS, "Fast reader starved");
+
+	/** TESTPOINT: the slow reader cannot allocate more either */
+	frag = net_nbuf_get_data(slow_ctx, K_NO_WAIT);
+	assert_is_null(frag, "Allocation over the quota");
+
+	frag = net_nbuf_get_data(fast_ctx, K_NO_WAIT);
+	assert_not_null(frag, "Allocation under the quota failed");
+	net_nbuf_unref(frag);
+
+	for (i = 0; i < slow_received; i++) {
+		net_nbuf_unref(slow_bufs[i]);
+	}
+
+	/** TESTPOINT: the quota is released with the buffers */
+	frag = net_nbuf_get_data(slow_ctx, K_NO_WAIT);
+	assert_not_null(frag, "Quota not released");
+	net_nbuf_unref(frag);
+
+	assert_equal(data_free(), CONFIG_NET_NBUF_DATA_COUNT,
+		     "Data fragments leaked");
+}
+
+static void nbuf_quota_reserve(void)
+{
+	struct net_buf *frags = NULL;
+	struct net_buf *frag;
+
+	net_nbuf_watermark_add(&watermark);
+
+	/* Leave one fragment above the reserve */
+	while (data_free() > RESERVE + 1) {
+		frag = net_nbuf_get_reserve_data(0, K_NO_WAIT);
+		assert_not_null(frag, "Cannot allocate data fragment");
+
+		frag->frags = frags;
+		frags = frag;
+	}
+
+	/** TESTPOINT: the watermark reported the low pool */
+	assert_equal(wm_low_at, WM_LOW, "Low watermark not reported");
+	assert_equal(wm_high_at, -1, "High watermark reported early");
+
+	frag = net_nbuf_get_data(fast_ctx, K_NO_WAIT);
+	assert_not_null(frag, "Cannot allocate above the reserve");
+	frag->frags = frags;
+	frags = frag;
+
+	/** TESTPOINT: contexts cannot take the reserved fragments */
+	frag = net_nbuf_get_data(fast_ctx, K_NO_WAIT);
+	assert_is_null(frag, "Context allocated a reserved fragment");
+
+	/** TESTPOINT: the stack itself still can */
+	frag = net_nbuf_get_reserve_data(0, K_NO_WAIT);
+	assert_not_null(frag, "Stack cannot use the reserve");
+	frag->frags = frags;
+	frags = frag;
+
+	net_nbuf_unref(frags);
+
+	/** TESTPOINT: the watermark reported the recovered pool */
+	assert_equal(wm_high_at, WM_HIGH, "High watermark not reported");
+
+	net_nbuf_watermark_remove(&watermark);
+
+	assert_equal(data_free(), CONFIG_NET_NBUF_DATA_COUNT,
+		     "Data fragments leaked");
+}
+
+static void nbuf_quota_var_data(void)
+{
+	struct net_buf *frag;
+	int i;
+
+	/** TESTPOINT: small lengths use the regular fragments */
+	frag = net_nbuf_get_reserve_data_len(0, 10, K_NO_WAIT);
+	assert_not_null(frag, "Cannot allocate small fragment");
+	assert_equal(frag->size, CONFIG_NET_NBUF_DATA_SIZE,
+		     "Wrong small fragment size");
+	net_nbuf_unref(frag);
+
+	/** TESTPOINT: a large frame fits into a single fragment, and the
+	 * fragments go back to the memory pool
+	 */
+	for (i = 0; i < 2 * CONFIG_NET_NBUF_VAR_DATA_COUNT; i++) {
+		frag = net_nbuf_get_reserve_data_len(0, LARGE_LEN, K_NO_WAIT);
+		assert_not_null(frag, "Cannot allocate large fragment");
+		assert_true(net_buf_tailroom(frag) >= LARGE_LEN,
+			    "Large fragment too small");
+		assert_equal(data_free(), CONFIG_NET_NBUF_DATA_COUNT,
+			     "Large fragment taken from the data pool");
+
+		memset(net_buf_add(frag, LARGE_LEN), i, LARGE_LEN);
+
+		net_nbuf_unref(frag);
+	}
+}
+
+static void nbuf_quota_stats(void)
+{
+	struct net_stats_perf perf;
+	int ret;
+
+	ret = net_mgmt(NET_REQUEST_STATS_GET_PERF, NULL, &perf, sizeof(perf));
+	assert_equal(ret, 0, "Cannot get statistics");
+
+	/** TESTPOINT: the isolation burst waited in the RX queue. How much
+	 * of it was queued at once depends on when the RX thread ran.
+	 */
+	assert_true(perf.rx_queue_max > 0 &&
+		    perf.rx_queue_max <= SLOW_PACKETS + FAST_PACKETS,
+		    "Wrong RX queue high-water mark");
+	assert_true(perf.rx_queue.count >= SLOW_PACKETS + FAST_PACKETS,
+		    "Wrong RX queue sample count");
+
+	/** TESTPOINT: the reserve test took one reserved fragment and
+	 * made context allocations fail
+	 */
+	assert_equal(perf.data_free_min, RESERVE - 1,
+		     "Wrong data low-water mark");
+	assert_true(perf.data_alloc_fail > 0, "Allocation failures missed");
+
+	/** TESTPOINT: every packet went through UDP processing */
+	assert_true(perf.udp.count >= SLOW_PACKETS + FAST_PACKETS,
+		    "UDP processing not accounted");
+}
+
+static void nbuf_quota_tcp(void)
+{
+	struct sockaddr_in6 addr = {
+		.sin6_family = AF_INET6,
+		.sin6_port = htons(TCP_PORT),
+	};
+	struct sockaddr_in6 peer = {
+		.sin6_family = AF_INET6,
+		.sin6_port = htons(PEER_PORT),
+	};
+	struct net_buf *frags = NULL;
+	struct net_context *context;
+	struct net_buf *frag;
+	struct net_buf *buf;
+	int ret;
+
+	ret = net_context_get(AF_INET6, SOCK_STREAM, IPPROTO_TCP, &context);
+	assert_equal(ret, 0, "Cannot get context");
+
+	net_ipaddr_copy(&addr.sin6_addr, &my_addr);
+	net_ipaddr_copy(&peer.sin6_addr, &peer_addr);
+
+	ret = net_context_bind(context, (struct sockaddr *)&addr,
+			       sizeof(addr));
+	assert_equal(ret, 0, "Cannot bind context");
+
+	/* Hold the whole quota, as a slow reader would */
+	while ((frag = net_nbuf_get_data(context, K_NO_WAIT))) {
+		frag->frags = frags;
+		frags = frag;
+	}
+
+	/** TESTPOINT: the stack still acknowledges for the context */
+	buf = NULL;
+	ret = net_tcp_prepare_ack(context->tcp, (struct sockaddr *)&peer,
+				  &buf);
+	assert_equal(ret, 0, "Cannot prepare ACK");
+	assert_not_null(buf, "No ACK over the quota");
+	net_nbuf_unref(buf);
+
+	/* Leave only the reserve in the pool */
+	while (data_free() > RESERVE) {
+		frag = net_nbuf_get_reserve_data(0, K_NO_WAIT);
+		assert_not_null(frag, "Cannot allocate data fragment");
+
+		frag->frags = frags;
+		frags = frag;
+	}
+
+	/** TESTPOINT: and takes the reserve to do so */
+	buf = NULL;
+	ret = net_tcp_prepare_ack(context->tcp, (struct sockaddr *)&peer,
+				  &buf);
+	assert_equal(ret, 0, "Cannot prepare ACK");
+	assert_not_null(buf, "No ACK from the reserve");
+	net_nbuf_unref(buf);
+
+	net_nbuf_unref(frags);
+	net_context_put(context);
+
+	assert_equal(data_free(), CONFIG_NET_NBUF_DATA_COUNT,
+		     "Data fragments leaked");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_nbuf_quota_test,
+			 ztest_unit_test(nbuf_quota_setup),
+			 ztest_unit_test(nbuf_quota_isolation),
+			 ztest_unit_test(nbuf_quota_reserve),
+			 ztest_unit_test(nbuf_quota_var_data),
+			 ztest_unit_test(nbuf_quota_stats),
+			 ztest_unit_test(nbuf_quota_tcp)
+			 );
+
+	ztest_run_test_suite(net_nbuf_quota_test);
+}
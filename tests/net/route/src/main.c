@@ -82,6 +82,9 @@ static struct k_sem wait_data;
 
 #define WAIT_TIME 250
 
+/* Number of times each route is looked up in the benchmark */
+#define BENCHMARK_ROUNDS 16
+
 struct net_route_test {
 	uint8_t mac_addr[sizeof(struct net_eth_addr)];
 	struct net_linkaddr ll_addr;
@@ -288,8 +291,8 @@ static bool test_init(void)
 		memcpy(&dest_addresses[i], &generic_addr,
 		       sizeof(struct in6_addr));
 
-		dest_addresses[i].s6_addr[14] = i + 1;
-		dest_addresses[i].s6_addr[15] = sys_rand32_get();
+		dest_addresses[i].s6_addr[14] = (i + 1) >> 8;
+		dest_addresses[i].s6_addr[15] = i + 1;
 	}
 
 	/* The semaphore is there to wait the data to be received. */
@@ -654,6 +657,128 @@ static bool route_del_many(void)
 	return true;
 }
 
+static bool route_lookup_longest(void)
+{
+	struct net_route_entry *prefix_route, *host_route, *found;
+	struct in6_addr other_addr;
+
+	net_ipaddr_copy(&other_addr, &dest_addr);
+	other_addr.s6_addr[15]++;
+
+	prefix_route = net_route_add(my_iface, &dest_addr, 64, &peer_addr);
+	host_route = net_route_add(my_iface, &dest_addr, 128, &peer_addr);
+	if (!prefix_route || !host_route || prefix_route == host_route) {
+		TC_ERROR("Route add failed\n");
+		return false;
+	}
+
+	found = net_route_lookup(my_iface, &dest_addr);
+	if (found != host_route) {
+		TC_ERROR("Host route not found\n");
+		return false;
+	}
+
+	found = net_route_lookup(my_iface, &other_addr);
+	if (found != prefix_route) {
+		TC_ERROR("Prefix route not found\n");
+		return false;
+	}
+
+	net_route_del(host_route);
+
+	found = net_route_lookup(my_iface, &dest_addr);
+	if (found != prefix_route) {
+		TC_ERROR("Prefix route not found after host route del\n");
+		return false;
+	}
+
+	net_route_del(prefix_route);
+
+	if (net_route_lookup(my_iface, &dest_addr)) {
+		TC_ERROR("Route found after del\n");
+		return false;
+	}
+
+	return true;
+}
+
+static void benchmark_addr(struct in6_addr *addr, int i)
+{
+	net_ipaddr_copy(addr, &generic_addr);
+
+	addr->s6_addr[11] = 0x01;
+	addr->s6_addr[14] = i >> 8;
+	addr->s6_addr[15] = i;
+}
+
+static bool route_benchmark_run(int count)
+{
+	struct net_route_entry *route;
+	struct in6_addr addr;
+	uint32_t start, cycles;
+	int i, round;
+
+	for (i = 0; i < count; i++) {
+		benchmark_addr(&addr, i);
+
+		if (!net_route_add(my_iface, &addr, 128, &peer_addr)) {
+			TC_ERROR("[%d] Route add failed\n", i);
+			return false;
+		}
+	}
+
+	start = k_cycle_get_32();
+
+	for (round = 0; round < BENCHMARK_ROUNDS; round++) {
+		for (i = 0; i < count; i++) {
+			benchmark_addr(&addr, i);
+
+			route = net_route_lookup(my_iface, &addr);
+			if (!route || !net_ipv6_addr_cmp(&route->addr, &addr)) {
+				TC_ERROR("[%d] Route lookup failed\n", i);
+				return false;
+			}
+		}
+	}
+
+	cycles = k_cycle_get_32() - start;
+
+	printk("%d routes: %u cycles per lookup\n", count,
+	       cycles / (count * BENCHMARK_ROUNDS));
+
+	for (i = 0; i < count; i++) {
+		benchmark_addr(&addr, i);
+
+		route = net_route_lookup(my_iface, &addr);
+		if (!route || net_route_del(route)) {
+			TC_ERROR("[%d] Route del failed\n", i);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static bool route_benchmark(void)
+{
+	static const int counts[] = { 16, 256, 1024 };
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(counts); i++) {
+		if (counts[i] > max_routes) {
+			printk("%d routes: skipped, %d routes configured\n",
+			       counts[i], max_routes);
+			continue;
+		}
+
+		if (!route_benchmark_run(counts[i])) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
 static const struct {
 	const char *name;
 	bool (*func)(void);
@@ -675,6 +800,8 @@ static const struct {
 	{ "Populate neighbor cache again", populate_nbr_cache },
 	{ "Add many routes", route_add_many },
 	{ "Del many routes", route_del_many },
+	{ "Lookup longest prefix", route_lookup_longest },
+	{ "Lookup benchmark", route_benchmark },
 };
 
 void main(void)
@@ -0,0 +1,255 @@
+/* main.c - Application main entry point */
+
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <misc/printk.h>
+#include <sections.h>
+
+#include <ztest.h>
+
+#include <net/ethernet.h>
+#include <net/buf.h>
+#include <net/nbuf.h>
+#include <net/net_ip.h>
+#include <net/net_if.h>
+
+#include "udp.h"
+#include "net_private.h"
+
+/* Packets queued to the RX thread before waiting for them to be handled */
+#define ROUND_SIZE 16
+#define ROUNDS 64
+#define PACKETS (ROUND_SIZE * ROUNDS)
+
+#define TEST_PORT 4242
+#define TIMEOUT 1000
+
+#define STACK_SIZE 512
+
+static struct in6_addr my_addr = { { { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0,
+				       0, 0, 0, 0, 0, 0, 0, 0x1 } } };
+static struct in6_addr peer_addr = { { { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0,
+					 0, 0, 0, 0, 0, 0, 0, 0x2 } } };
+
+static struct net_if *iface;
+static struct net_conn_handle *handle;
+
+static K_SEM_DEFINE(round_done, 0, 1);
+static uint32_t received;
+
+/*
+ * The competing thread runs at the same priority as the RX thread and has
+ * one work item per queued packet, so every time the RX thread yields it
+ * gets to run once.
+ */
+static char __noinit __stack competing_stack[STACK_SIZE];
+static K_SEM_DEFINE(competing_work, 0, UINT_MAX);
+
+struct dummy_context {
+	uint8_t mac_addr[sizeof(struct net_eth_addr)];
+};
+
+static struct dummy_context dummy_context_data;
+
+static int dummy_dev_init(struct device *dev)
+{
+	return 0;
+}
+
+static void dummy_iface_init(struct net_if *iface)
+{
+	struct dummy_context *context =
+		net_if_get_device(iface)->driver_data;
+
+	/* 10-00-00-00-00 to 10-00-00-00-FF Documentation RFC7042 */
+	context->mac_addr[0] = 0x10;
+	context->mac_addr[5] = 0x01;
+
+	net_if_set_link_addr(iface, context->mac_addr,
+			     sizeof(context->mac_addr), NET_LINK_ETHERNET);
+}
+
+static int dummy_send(struct net_if *iface, struct net_buf *buf)
+{
+	net_nbuf_unref(buf);
+
+	return 0;
+}
+
+static struct net_if_api dummy_if_api = {
+	.init = dummy_iface_init,
+	.send = dummy_send,
+};
+
+#define _ETH_L2_LAYER DUMMY_L2
+#define _ETH_L2_CTX_TYPE NET_L2_GET_CTX_TYPE(DUMMY_L2)
+
+NET_DEVICE_INIT(rx_burst_test, "rx_burst_test",
+		dummy_dev_init, &dummy_context_data, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+		&dummy_if_api, _ETH_L2_LAYER, _ETH_L2_CTX_TYPE, 127);
+
+static enum net_verdict udp_recv(struct net_conn *conn,
+				 struct net_buf *buf,
+				 void *user_data)
+{
+	net_nbuf_unref(buf);
+
+	if (!(++received % ROUND_SIZE)) {
+		k_sem_give(&round_done);
+	}
+
+	return NET_OK;
+}
+
+static void competing_thread(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (1) {
+		k_sem_take(&competing_work, K_FOREVER);
+		k_yield();
+	}
+}
+
+static struct net_buf *udp_packet_get(void)
+{
+	struct net_buf *buf;
+	struct net_buf *frag;
+
+	buf = net_nbuf_get_reserve_rx(0, K_FOREVER);
+	frag = net_nbuf_get_reserve_data(0, K_FOREVER);
+	net_buf_frag_add(buf, frag);
+
+	net_nbuf_set_iface(buf, iface);
+	net_nbuf_set_ll_reserve(buf, net_buf_headroom(frag));
+
+	NET_IPV6_BUF(buf)->vtc = 0x60;
+	NET_IPV6_BUF(buf)->tcflow = 0;
+	NET_IPV6_BUF(buf)->flow = 0;
+	NET_IPV6_BUF(buf)->len[0] = 0;
+	NET_IPV6_BUF(buf)->len[1] = NET_UDPH_LEN;
+
+	NET_IPV6_BUF(buf)->nexthdr = IPPROTO_UDP;
+	NET_IPV6_BUF(buf)->hop_limit = 255;
+
+	net_ipaddr_copy(&NET_IPV6_BUF(buf)->src, &peer_addr);
+	net_ipaddr_copy(&NET_IPV6_BUF(buf)->dst, &my_addr);
+
+	net_nbuf_set_ip_hdr_len(buf, sizeof(struct net_ipv6_hdr));
+	net_nbuf_set_ext_len(buf, 0);
+
+	NET_UDP_BUF(buf)->src_port = htons(TEST_PORT);
+	NET_UDP_BUF(buf)->dst_port = htons(TEST_PORT);
+	NET_UDP_BUF(buf)->len = htons(NET_UDPH_LEN);
+	NET_UDP_BUF(buf)->chksum = 0;
+
+	net_buf_add(frag, net_nbuf_ip_hdr_len(buf) +
+			  sizeof(struct net_udp_hdr));
+
+	return buf;
+}
+
+/* Returns the number of packets per second handled with the given burst */
+static uint32_t run_benchmark(uint8_t burst)
+{
+	uint32_t start, cycles;
+	int round, i;
+
+	net_if_set_rx_burst(iface, burst);
+	received = 0;
+
+	start = k_cycle_get_32();
+
+	for (round = 0; round < ROUNDS; round++) {
+		/* The test thread is cooperative: the whole round is
+		 * queued before the RX thread gets to run.
+		 */
+		for (i = 0; i < ROUND_SIZE; i++) {
+			assert_true(net_recv_data(iface, udp_packet_get()) == 0,
+				    "Cannot queue packet");
+			k_sem_give(&competing_work);
+		}
+
+		assert_true(k_sem_take(&round_done, TIMEOUT) == 0,
+			    "Timeout, packets not received");
+	}
+
+	cycles = k_cycle_get_32() - start;
+
+	assert_equal(received, PACKETS, "Packets lost");
+
+	/* Let the competing thread drain its remaining work */
+	k_sleep(10);
+
+	return (uint64_t)PACKETS * sys_clock_hw_cycles_per_sec / cycles;
+}
+
+static void rx_burst_setup(void)
+{
+	struct sockaddr_in6 local_addr = {
+		.sin6_family = AF_INET6,
+		.sin6_port = htons(TEST_PORT),
+	};
+	int ret;
+
+	iface = net_if_get_default();
+
+	assert_not_null(net_if_ipv6_addr_add(iface, &my_addr, NET_ADDR_MANUAL,
+					     0), "Cannot add IPv6 address");
+
+	net_ipaddr_copy(&local_addr.sin6_addr, &my_addr);
+
+	ret = net_udp_register(NULL, (struct sockaddr *)&local_addr,
+			       0, TEST_PORT, udp_recv, NULL, &handle);
+	assert_equal(ret, 0, "Cannot register UDP handler");
+
+	k_thread_spawn(competing_stack, STACK_SIZE, competing_thread,
+		       NULL, NULL, NULL, K_PRIO_COOP(8), 0, 0);
+}
+
+static void rx_burst_default_size(void)
+{
+	/** TESTPOINT: the configured burst size is the interface default */
+	assert_equal(net_if_get_rx_burst(iface), CONFIG_NET_RX_BURST_SIZE,
+		     "Wrong default burst size");
+
+	/** TESTPOINT: a burst always holds at least one packet */
+	net_if_set_rx_burst(iface, 0);
+	assert_equal(net_if_get_rx_burst(iface), 1, "Empty burst accepted");
+}
+
+static void rx_burst_benchmark(void)
+{
+	uint32_t single, burst;
+
+	single = run_benchmark(1);
+	burst = run_benchmark(CONFIG_NET_RX_BURST_SIZE);
+
+	TC_PRINT("%d packets, burst 1: %u pps, burst %d: %u pps\n",
+		 PACKETS, single, CONFIG_NET_RX_BURST_SIZE, burst);
+
+	net_if_set_rx_burst(iface, CONFIG_NET_RX_BURST_SIZE);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_rx_burst_test,
+			 ztest_unit_test(rx_burst_setup),
+			 ztest_unit_test(rx_burst_default_size),
+			 ztest_unit_test(rx_burst_benchmark)
+			 );
+
+	ztest_run_test_suite(net_rx_burst_test);
+}
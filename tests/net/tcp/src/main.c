@@ -1065,6 +1065,285 @@ static bool test_v4_seq_check(void)
 	return true;
 }
 
+static bool test_v6_syn_options(void)
+{
+	struct net_tcp *tcp = v6_ctx->tcp;
+	struct net_buf *buf = NULL;
+	uint8_t flags = tcp->flags;
+	int ret;
+
+	ret = net_tcp_prepare_segment(tcp, NET_TCP_SYN, NULL, 0, NULL,
+				      (struct sockaddr *)&peer_v6_addr, &buf);
+	if (ret) {
+		printk("Prepare segment failed (%d)\n", ret);
+		return false;
+	}
+
+	/* Our own SYN carries the IPv6 MSS of 1280 bytes */
+	net_tcp_syn_options_parse(tcp, buf);
+	tcp->flags = flags;
+
+	if (tcp->send_mss != 1280) {
+		printk("Invalid send MSS %u\n", tcp->send_mss);
+		return false;
+	}
+
+	/* min(4 * MSS, max(2 * MSS, 4380)) as per RFC 3390 */
+	if (tcp->cwnd != 4380) {
+		printk("Invalid initial congestion window %u\n", tcp->cwnd);
+		return false;
+	}
+
+	if (tcp->send_wnd != sys_get_be16(NET_TCP_BUF(buf)->wnd)) {
+		printk("Invalid send window %u\n", tcp->send_wnd);
+		return false;
+	}
+
+	if (tcp->rto != 1000 || net_tcp_get_srtt(tcp)) {
+		printk("Invalid initial RTO %u\n", tcp->rto);
+		return false;
+	}
+
+	net_nbuf_unref(buf);
+
+	return true;
+}
+
+static bool test_v6_wscale(void)
+{
+	static const uint8_t wscale[] = { 0x01, 0x03, 0x03, 0x00 };
+	struct net_tcp *tcp = v6_ctx->tcp;
+	struct net_buf *buf = NULL;
+	uint8_t flags = tcp->flags;
+	int ret;
+
+	ret = net_tcp_prepare_segment(tcp, NET_TCP_SYN, NULL, 0, NULL,
+				      (struct sockaddr *)&peer_v6_addr, &buf);
+	if (ret) {
+		printk("Prepare segment failed (%d)\n", ret);
+		return false;
+	}
+
+	if (memcmp((uint8_t *)NET_TCP_BUF(buf) + NET_TCPH_LEN, wscale,
+		   sizeof(wscale))) {
+		printk("Window scale option not found\n");
+		return false;
+	}
+
+	/* A SYN-ACK only accepts window scaling if the SYN offered it */
+	net_nbuf_unref(buf);
+	buf = NULL;
+
+	tcp->flags &= ~NET_TCP_WSCALE_OK;
+	net_tcp_prepare_segment(tcp, NET_TCP_SYN | NET_TCP_ACK, NULL, 0, NULL,
+				(struct sockaddr *)&peer_v6_addr, &buf);
+
+	if (!memcmp((uint8_t *)NET_TCP_BUF(buf) + NET_TCPH_LEN, wscale,
+		    sizeof(wscale))) {
+		printk("Window scale option not offered\n");
+		return false;
+	}
+
+	net_nbuf_unref(buf);
+	tcp->flags = flags;
+
+	return true;
+}
+
+static bool test_v6_send_wnd(void)
+{
+	static const struct {
+		uint32_t seq;
+		uint32_t ack;
+		uint16_t wnd;
+		uint32_t send_wnd;
+	} segs[] = {
+		/* Older segment, ignored */
+		{ 900, 5000, 10, 400 },
+		/* Same segment, older acknowledgment, ignored */
+		{ 1000, 4900, 10, 400 },
+		/* Same segment, same acknowledgment */
+		{ 1000, 5000, 50, 200 },
+		/* Newer segment, even with an older acknowledgment */
+		{ 1100, 4000, 25, 100 },
+		/* Older segment across the wrap-around, ignored */
+		{ 0xfffffff0, 5000, 1, 100 },
+	};
+	struct net_tcp *tcp = v6_ctx->tcp;
+	struct net_tcp_hdr *tcphdr;
+	struct net_buf *buf = NULL;
+	int i;
+
+	net_tcp_prepare_segment(tcp, NET_TCP_ACK, NULL, 0, NULL,
+				(struct sockaddr *)&peer_v6_addr, &buf);
+	tcphdr = NET_TCP_BUF(buf);
+
+	/* The peer windows are scaled, except in a SYN segment */
+	tcp->send_wscale = 2;
+
+	sys_put_be32(1000, tcphdr->seq);
+	sys_put_be32(5000, tcphdr->ack);
+	sys_put_be16(100, tcphdr->wnd);
+	net_tcp_set_send_wnd(tcp, buf);
+
+	if (tcp->send_wnd != 400) {
+		printk("Invalid scaled send window %u\n", tcp->send_wnd);
+		return false;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(segs); i++) {
+		sys_put_be32(segs[i].seq, tcphdr->seq);
+		sys_put_be32(segs[i].ack, tcphdr->ack);
+		sys_put_be16(segs[i].wnd, tcphdr->wnd);
+		net_tcp_update_send_wnd(tcp, buf);
+
+		if (tcp->send_wnd != segs[i].send_wnd) {
+			printk("Invalid send window %u for segment %d\n",
+			       tcp->send_wnd, i);
+			return false;
+		}
+	}
+
+	tcphdr->flags |= NET_TCP_SYN;
+	net_tcp_set_send_wnd(tcp, buf);
+
+	if (tcp->send_wnd != 1) {
+		printk("SYN window scaled\n");
+		return false;
+	}
+
+	tcp->send_wscale = 0;
+	net_nbuf_unref(buf);
+
+	return true;
+}
+
+#if defined(CONFIG_NET_TCP_SACK)
+static bool test_v6_sack_permitted(void)
+{
+	static const uint8_t sack_perm[] = { 0x01, 0x01, 0x04, 0x02 };
+	struct net_tcp *tcp = v6_ctx->tcp;
+	struct net_buf *buf = NULL;
+	int ret;
+
+	ret = net_tcp_prepare_segment(tcp, NET_TCP_SYN, NULL, 0, NULL,
+				      (struct sockaddr *)&peer_v6_addr, &buf);
+	if (ret) {
+		printk("Prepare segment failed (%d)\n", ret);
+		return false;
+	}
+
+	net_hexdump_frags("TCPv6", buf);
+
+	/* After the window scale option */
+	if (NET_TCP_BUF(buf)->offset >> 4 != 7) {
+		printk("Invalid header length %u\n",
+		       (NET_TCP_BUF(buf)->offset >> 4) * 4);
+		return false;
+	}
+
+	if (memcmp((uint8_t *)NET_TCP_BUF(buf) + NET_TCPH_LEN +
+		   NET_TCP_WSCALE_SIZE, sack_perm, sizeof(sack_perm))) {
+		printk("SACK permitted option not found\n");
+		return false;
+	}
+
+	net_nbuf_unref(buf);
+
+	return true;
+}
+
+static struct net_buf *create_v6_segment(struct net_tcp *tcp, uint32_t seq,
+					 uint16_t len)
+{
+	uint32_t send_seq = tcp->send_seq;
+	struct net_buf *buf = NULL;
+
+	tcp->send_seq = seq;
+
+	net_tcp_prepare_segment(tcp, NET_TCP_ACK, NULL, 0, NULL,
+				(struct sockaddr *)&peer_v6_addr, &buf);
+
+	/* Only the sequence number and length matter for queueing */
+	net_nbuf_set_appdatalen(buf, len);
+
+	tcp->send_seq = send_seq;
+
+	return buf;
+}
+
+static bool test_v6_ooo_queue(void)
+{
+	static const uint32_t blocks[] = { 1100, 1200, 1300, 1400 };
+	struct net_tcp *tcp = v6_ctx->tcp;
+	struct net_buf *seg1, *seg2, *buf = NULL;
+	uint8_t *opt;
+	int i;
+
+	tcp->send_ack = 1000;
+	tcp->flags |= NET_TCP_SACK_OK;
+
+	seg2 = create_v6_segment(tcp, 1300, 100);
+	seg1 = create_v6_segment(tcp, 1100, 100);
+
+	if (!net_tcp_queue_ooo(tcp, seg2) || !net_tcp_queue_ooo(tcp, seg1)) {
+		printk("Out-of-order segments not queued\n");
+		return false;
+	}
+
+	if (net_tcp_queue_ooo(tcp, seg1)) {
+		printk("Segment queued twice\n");
+		return false;
+	}
+
+	/* The ACK reports the most recently queued segment first */
+	net_tcp_prepare_segment(tcp, NET_TCP_ACK, NULL, 0, NULL,
+				(struct sockaddr *)&peer_v6_addr, &buf);
+
+	net_hexdump_frags("TCPv6", buf);
+
+	opt = (uint8_t *)NET_TCP_BUF(buf) + NET_TCPH_LEN;
+	if (opt[2] != NET_TCP_OPT_SACK || opt[3] != 2 + sizeof(blocks)) {
+		printk("SACK option not found\n");
+		return false;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(blocks); i++) {
+		if (sys_get_be32(opt + 4 + i * 4) != blocks[i]) {
+			printk("Invalid SACK block edge %u\n",
+			       sys_get_be32(opt + 4 + i * 4));
+			return false;
+		}
+	}
+
+	net_nbuf_unref(buf);
+
+	if (net_tcp_dequeue_ooo(tcp)) {
+		printk("Segment dequeued before the missing data\n");
+		return false;
+	}
+
+	tcp->send_ack = 1100;
+	if (net_tcp_dequeue_ooo(tcp) != seg1) {
+		printk("First segment not dequeued\n");
+		return false;
+	}
+
+	tcp->send_ack = 1300;
+	if (net_tcp_dequeue_ooo(tcp) != seg2) {
+		printk("Second segment not dequeued\n");
+		return false;
+	}
+
+	net_nbuf_unref(seg1);
+	net_nbuf_unref(seg2);
+
+	tcp->flags &= ~NET_TCP_SACK_OK;
+
+	return true;
+}
+#endif /* CONFIG_NET_TCP_SACK */
+
 #if 0
 static void connect_v6_cb(struct net_context *context, void *user_data)
 {
@@ -1457,6 +1736,13 @@ static const struct {
 	{ "test IPv4 TCP fin packet creation", test_create_v4_fin_packet },
 	{ "test IPv6 TCP seq check", test_v6_seq_check },
 	{ "test IPv4 TCP seq check", test_v4_seq_check },
+	{ "test IPv6 TCP SYN options", test_v6_syn_options },
+	{ "test IPv6 TCP window scale option", test_v6_wscale },
+	{ "test IPv6 TCP send window update", test_v6_send_wnd },
+#if defined(CONFIG_NET_TCP_SACK)
+	{ "test IPv6 TCP SACK permitted option", test_v6_sack_permitted },
+	{ "test IPv6 TCP out-of-order queue", test_v6_ooo_queue },
+#endif
 	{ "test TCP reply context init", test_init_tcp_reply_context },
 	{ "test TCP accept init", test_init_tcp_accept },
 #if 0
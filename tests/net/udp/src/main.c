@@ -351,13 +351,16 @@ static void set_port(sa_family_t family, struct sockaddr *raddr,
 	}
 }
 
+#define PEERS 16
+
 static bool run_tests(void)
 {
 	struct net_conn_handle *handlers[CONFIG_NET_MAX_CONN];
 	struct net_if *iface = net_if_get_default();
 	struct net_if_addr *ifaddr;
+	static struct ud peers[PEERS];
 	struct ud *ud;
-	int ret, i = 0;
+	int ret, i = 0, j;
 	bool st;
 
 	struct sockaddr_in6 any_addr6;
@@ -549,6 +552,44 @@ static bool run_tests(void)
 	TEST_IPV4_OK(ud, &in4addr_peer, &in4addr_my, 12345, 42421);
 	TEST_IPV6_OK(ud, &in6addr_peer, &in6addr_my, 12345, 42421);
 
+	/* Many peers on the same local port, each one must get its own
+	 * packets and the listener the rest.
+	 */
+	ud = REGISTER(AF_INET6, NULL, &my_addr6, 0, 5000);
+
+	for (j = 0; j < PEERS; j++) {
+		peers[j].remote_addr = (struct sockaddr *)&peer_addr6;
+		peers[j].local_addr = (struct sockaddr *)&my_addr6;
+		peers[j].remote_port = 2000 + j;
+		peers[j].local_port = 5000;
+		peers[j].test = "peer";
+
+		ret = net_udp_register((struct sockaddr *)&peer_addr6,
+				       (struct sockaddr *)&my_addr6,
+				       2000 + j, 5000, test_ok, &peers[j],
+				       &handlers[i]);
+		if (ret) {
+			printk("UDP register peer %d failed (%d)\n", j, ret);
+			return false;
+		}
+
+		peers[j].handle = handlers[i++];
+	}
+
+	for (j = 0; j < PEERS; j++) {
+		TEST_IPV6_OK((&peers[j]), &in6addr_peer, &in6addr_my,
+			     2000 + j, 5000);
+	}
+
+	TEST_IPV6_OK(ud, &in6addr_peer, &in6addr_my, 1999, 5000);
+
+	for (j = 0; j < PEERS; j++) {
+		UNREGISTER((&peers[j]));
+	}
+
+	TEST_IPV6_OK(ud, &in6addr_peer, &in6addr_my, 2000, 5000);
+	UNREGISTER(ud);
+
 	/* Remote addr same as local addr, these two will never match */
 	REGISTER(AF_INET6, &my_addr6, NULL, 1234, 4242);
 	REGISTER(AF_INET, &my_addr4, NULL, 1234, 4242);
@@ -367,6 +367,125 @@ static bool run_tests(void)
 	return true;
 }
 
+struct chksum_test_data {
+	const char *name;
+	bool ones;
+
+	struct {
+		uint8_t reserve;
+		uint8_t len;
+	} frags[5];
+};
+
+/* The first fragment holds the IPv6 header followed by the first chunk of
+ * ICMPv6 data. The reserve sets the alignment the data starts at.
+ */
+static const struct chksum_test_data chksum_tests[] = {
+	{ "odd length fragments", false,
+	  { { 0, 1 }, { 0, 63 }, { 0, 7 }, { 0, 100 }, { 0, 33 } } },
+	{ "misaligned fragment starts", false,
+	  { { 1, 64 }, { 1, 64 }, { 2, 64 }, { 3, 63 }, { 0, 0 } } },
+	{ "odd fragment boundaries", false,
+	  { { 3, 3 }, { 2, 97 }, { 1, 1 }, { 0, 50 }, { 3, 77 } } },
+	{ "all ones", true,
+	  { { 0, 80 }, { 0, 128 }, { 1, 127 }, { 2, 61 }, { 3, 1 } } },
+};
+
+static uint8_t chksum_payload[512];
+
+/* Byte-wise sum of big endian 16-bit words, as in RFC 1071 */
+static uint16_t chksum_ref(uint32_t sum, const uint8_t *data, size_t len)
+{
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		sum += (i & 1) ? data[i] : data[i] << 8;
+	}
+
+	while (sum >> 16) {
+		sum = (sum & 0xffff) + (sum >> 16);
+	}
+
+	return sum;
+}
+
+static bool test_chksum(const struct chksum_test_data *data)
+{
+	struct net_buf *frag, *buf;
+	uint16_t chksum, expected;
+	size_t total = 0;
+	int i;
+
+	buf = net_nbuf_get_reserve_rx(0, K_FOREVER);
+
+	for (i = 0; i < ARRAY_SIZE(data->frags); i++) {
+		if (i && !data->frags[i].len) {
+			break;
+		}
+
+		frag = net_nbuf_get_reserve_data(data->frags[i].reserve,
+						 K_FOREVER);
+		net_buf_frag_add(buf, frag);
+
+		if (!i) {
+			memcpy(net_buf_add(frag, sizeof(struct net_ipv6_hdr)),
+			       pkt1, sizeof(struct net_ipv6_hdr));
+		}
+
+		memcpy(net_buf_add(frag, data->frags[i].len),
+		       chksum_payload + total, data->frags[i].len);
+		total += data->frags[i].len;
+	}
+
+	net_nbuf_set_ip_hdr_len(buf, sizeof(struct net_ipv6_hdr));
+	net_nbuf_set_family(buf, AF_INET6);
+	net_nbuf_set_ext_len(buf, 0);
+
+	NET_IPV6_BUF(buf)->len[0] = total >> 8;
+	NET_IPV6_BUF(buf)->len[1] = total;
+
+	expected = chksum_ref(total + IPPROTO_ICMPV6,
+			      (uint8_t *)&NET_IPV6_BUF(buf)->src,
+			      2 * sizeof(struct in6_addr));
+	expected = chksum_ref(expected, chksum_payload, total);
+	expected = (expected == 0) ? 0xffff : htons(expected);
+
+	chksum = net_calc_chksum(buf, IPPROTO_ICMPV6);
+
+	net_nbuf_unref(buf);
+
+	if (chksum != expected) {
+		printk("Invalid chksum 0x%x, should be 0x%x\n",
+		       chksum, expected);
+		return false;
+	}
+
+	return true;
+}
+
+static bool run_chksum_tests(void)
+{
+	int count, pass, i;
+
+	for (count = 0, pass = 0; count < ARRAY_SIZE(chksum_tests); count++) {
+		TC_START(chksum_tests[count].name);
+
+		for (i = 0; i < sizeof(chksum_payload); i++) {
+			chksum_payload[i] = chksum_tests[count].ones ?
+				0xff : i * 37 + 11;
+		}
+
+		if (test_chksum(&chksum_tests[count])) {
+			TC_END(PASS, "passed\n");
+			pass++;
+		} else {
+			TC_END(FAIL, "failed\n");
+		}
+	}
+
+	return (pass != ARRAY_SIZE(chksum_tests)) ? false : true;
+}
+
 struct net_addr_test_data {
 	sa_family_t family;
 	bool pton;
@@ -743,7 +862,7 @@ static bool run_net_addr_tests(void)
 
 void main_thread(void)
 {
-	if (run_tests() && run_net_addr_tests()) {
+	if (run_tests() && run_chksum_tests() && run_net_addr_tests()) {
 		TC_END_REPORT(TC_PASS);
 	} else {
 		TC_END_REPORT(TC_FAIL);
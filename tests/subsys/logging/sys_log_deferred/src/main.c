@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2017 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define SYS_LOG_DOMAIN "test"
+
+#include <ztest.h>
+#include <string.h>
+#include <misc/printk.h>
+#include <logging/sys_log.h>
+
+static char out_buf[128];
+static int out_count;
+
+static void hook(const char *fmt, ...)
+{
+	va_list ap;
+
+	va_start(ap, fmt);
+	vsnprintk(out_buf, sizeof(out_buf), fmt, ap);
+	va_end(ap);
+
+	out_count++;
+}
+
+static void reset_output(void)
+{
+	sys_log_flush();
+	out_buf[0] = '\0';
+	out_count = 0;
+}
+
+static void test_deferred_flush(void)
+{
+	reset_output();
+
+	SYS_LOG_INF("value %d %s", 42, "str");
+	assert_equal(out_count, 0, "message formatted in caller context");
+
+	sys_log_flush();
+	assert_equal(out_count, 1, "message not output on flush");
+	assert_not_null(strstr(out_buf, "[test]"), "domain missing");
+	assert_not_null(strstr(out_buf, "value 42 str"), "arguments mangled");
+}
+
+static void test_deferred_thread(void)
+{
+	reset_output();
+
+	SYS_LOG_ERR("from thread %x", 0xcafe);
+	k_sleep(100);
+
+	assert_equal(out_count, 1, "log thread did not output message");
+	assert_not_null(strstr(out_buf, "from thread cafe"),
+			"arguments mangled");
+}
+
+static void test_level_set(void)
+{
+	reset_output();
+
+	assert_equal(sys_log_level_set("test", 5), -EINVAL, NULL);
+	assert_equal(sys_log_level_set("test", SYS_LOG_LEVEL_WARNING), 0,
+		     NULL);
+
+	SYS_LOG_INF("filtered");
+	SYS_LOG_DBG("filtered");
+	sys_log_flush();
+	assert_equal(out_count, 0, "message above runtime level output");
+
+	SYS_LOG_WRN("not filtered");
+	sys_log_flush();
+	assert_equal(out_count, 1, "message below runtime level dropped");
+
+	assert_equal(sys_log_level_set(NULL, SYS_LOG_LEVEL_DEBUG), 0, NULL);
+
+	SYS_LOG_DBG("debug again");
+	sys_log_flush();
+	assert_equal(out_count, 2, "runtime level not restored");
+}
+
+static void test_max_args(void)
+{
+	reset_output();
+
+	SYS_LOG_INF("%d %d %d %d %d %d %d %d %d %d %d %d %d %d %x",
+		    1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 0xf);
+	sys_log_flush();
+
+	assert_equal(out_count, 1, "message not output");
+	assert_not_null(strstr(out_buf, "1 2 3 4 5 6 7 8 9 10 11 12 13 14 f"),
+			"arguments truncated");
+}
+
+static void test_dropped(void)
+{
+	uint32_t dropped = sys_log_dropped_get();
+	int i;
+
+	reset_output();
+
+	/* Each message takes at least 7 words of the 64 word buffer */
+	for (i = 0; i < 16; i++) {
+		SYS_LOG_INF("message %d", i);
+	}
+
+	assert_true(sys_log_dropped_get() > dropped, "no message dropped");
+
+	sys_log_flush();
+	assert_true(out_count < 16, "dropped messages output");
+
+	/* The drop notification is emitted before the next message */
+	SYS_LOG_INF("after drop");
+	sys_log_flush();
+	assert_not_null(strstr(out_buf, "after drop"), NULL);
+}
+
+void test_main(void)
+{
+	syslog_hook_install(hook);
+
+	ztest_test_suite(sys_log_deferred,
+			 ztest_unit_test(test_deferred_flush),
+			 ztest_unit_test(test_deferred_thread),
+			 ztest_unit_test(test_level_set),
+			 ztest_unit_test(test_max_args),
+			 ztest_unit_test(test_dropped));
+	ztest_run_test_suite(sys_log_deferred);
+}